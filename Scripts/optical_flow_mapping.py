@@ -8,7 +8,9 @@ utilizing torch and CUDA.
 import argparse
 
 import cv2
+import Imath
 import numpy as np
+import OpenEXR
 import torch
 import torch.nn as nn
 
@@ -29,16 +31,30 @@ def read_image(image_path: str, use_cuda: bool) -> torch.Tensor:
 def load_optical_flow(optical_flow_image_path: str, use_cuda: bool) -> torch.Tensor:
     """
     Loads optical flow from an .exr image and returns it as a tensor with shape (2, h, w).
+    Images with the U and V channels already contain pixel offsets, while color-coded
+    images are converted from the HSV color wheel.
     """
-    of_image = cv2.imread(optical_flow_image_path, cv2.IMREAD_ANYCOLOR | cv2.IMREAD_ANYDEPTH)
-    h, w, _ = of_image.shape
-    # Convert image to HSV, where H is angle and S is intensity
-    of_image = cv2.cvtColor(of_image, cv2.COLOR_BGR2HSV)
-    ang, mag = of_image[:, :, 0], of_image[:, :, 1]
-    dx, dy = cv2.polarToCart(mag, ang, angleInDegrees=True)
-    dx = torch.Tensor(-w * dx).unsqueeze(0)
-    dy = torch.Tensor(-h * dy).unsqueeze(0)
-    flow = torch.cat((dx, dy), dim=0)
+    exr_file = OpenEXR.InputFile(optical_flow_image_path)
+    channels = exr_file.header()['channels']
+    if 'U' in channels and 'V' in channels:
+        data_window = exr_file.header()['dataWindow']
+        w = data_window.max.x - data_window.min.x + 1
+        h = data_window.max.y - data_window.min.y + 1
+        pixel_type = Imath.PixelType(Imath.PixelType.FLOAT)
+        dx, dy = (
+            np.frombuffer(exr_file.channel(name, pixel_type), dtype=np.float32).reshape(h, w)
+            for name in ('U', 'V'))
+        flow = torch.Tensor(np.stack((dx, dy)))
+    else:
+        of_image = cv2.imread(optical_flow_image_path, cv2.IMREAD_ANYCOLOR | cv2.IMREAD_ANYDEPTH)
+        h, w, _ = of_image.shape
+        # Convert image to HSV, where H is angle and S is intensity
+        of_image = cv2.cvtColor(of_image, cv2.COLOR_BGR2HSV)
+        ang, mag = of_image[:, :, 0], of_image[:, :, 1]
+        dx, dy = cv2.polarToCart(mag, ang, angleInDegrees=True)
+        dx = torch.Tensor(-w * dx).unsqueeze(0)
+        dy = torch.Tensor(-h * dy).unsqueeze(0)
+        flow = torch.cat((dx, dy), dim=0)
     if use_cuda:
         flow = flow.cuda()
     return flow
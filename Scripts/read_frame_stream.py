@@ -0,0 +1,100 @@
+# Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+"""
+This file contains example code for reading frames published by the EasySynth.Render command
+with the Stream= argument, directly from the shared memory region, without reading images from disk.
+"""
+
+import argparse
+import mmap
+import struct
+import sys
+import time
+
+import numpy as np
+
+RING_HEADER = struct.Struct('<IIIIqq')
+SLOT_HEADER = struct.Struct('<qiiii3d4d')
+LAYER_HEADER = struct.Struct('<48sIIIIqq')
+MAGIC = 0x52465345
+VERSION = 1
+PIXEL_TYPES = {0: np.uint8, 1: np.float16, 2: np.float32}
+
+
+def open_region(name: str) -> mmap.mmap:
+    """
+    Maps the shared memory region created by the renderer.
+    """
+    if sys.platform == 'win32':
+        # The size of existing named mappings is only known after mapping their header
+        header = mmap.mmap(-1, RING_HEADER.size, tagname=name, access=mmap.ACCESS_READ)
+        _, _, slot_count, slot_header_size, slot_size, _ = RING_HEADER.unpack_from(header, 0)
+        header.close()
+        return mmap.mmap(-1, slot_header_size + slot_count * slot_size, tagname=name, access=mmap.ACCESS_READ)
+    with open(f'/dev/shm/{name}', 'rb') as region_file:
+        return mmap.mmap(region_file.fileno(), 0, access=mmap.ACCESS_READ)
+
+
+def read_frame(region: mmap.mmap, frame_index: int):
+    """
+    Returns the frame with the provided index as a dictionary of layer arrays with shape (h, w, c),
+    or None if the frame is not published yet or has been overwritten.
+    Color layers store 8-bit BGRA channels, while float layers store RGBA channels.
+    """
+    magic, version, slot_count, slot_header_size, slot_size, _ = RING_HEADER.unpack_from(region, 0)
+    if magic != MAGIC or version != VERSION:
+        raise RuntimeError('Shared memory region does not contain EasySynth frames')
+
+    slot_offset = slot_header_size + (frame_index % slot_count) * slot_size
+    sequence = struct.unpack_from('<q', region, slot_offset)[0]
+    if sequence != 2 * frame_index + 2:
+        return None
+
+    _, frame_number, layer_count, camera_id, _, *pose = SLOT_HEADER.unpack_from(region, slot_offset)
+    layers = {}
+    for i in range(layer_count):
+        name, pixel_type, channel_count, width, height, offset, size = LAYER_HEADER.unpack_from(
+            region, slot_offset + SLOT_HEADER.size + i * LAYER_HEADER.size)
+        dtype = np.dtype(PIXEL_TYPES[pixel_type])
+        data = np.frombuffer(region, dtype=dtype, count=size // dtype.itemsize, offset=slot_offset + offset)
+        # Copy the data so that it stays valid once the slot gets overwritten
+        layers[name.rstrip(b'\0').decode()] = data.reshape(height, width, channel_count).copy()
+
+    # The slot may have been overwritten while it was being copied
+    if struct.unpack_from('<q', region, slot_offset)[0] != sequence:
+        return None
+    return {
+        'frame': frame_number,
+        'camera_id': camera_id,
+        'location': pose[:3],
+        'rotation': pose[3:],
+        'layers': layers,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Prints frames published to the EasySynth shared memory region')
+    parser.add_argument('name', help='Name of the shared memory region, as passed to the Stream= argument')
+    args = parser.parse_args()
+
+    region = open_region(args.name)
+    frame_index = 0
+    while True:
+        published_frame_count = RING_HEADER.unpack_from(region, 0)[5]
+        if frame_index >= published_frame_count:
+            time.sleep(0.001)
+            continue
+        # Skip frames that were already overwritten by the renderer
+        slot_count = RING_HEADER.unpack_from(region, 0)[2]
+        frame_index = max(frame_index, published_frame_count - slot_count)
+
+        frame = read_frame(region, frame_index)
+        frame_index += 1
+        if frame is None:
+            continue
+        layers = ', '.join(f'{name} {layer.shape} {layer.dtype}' for name, layer in frame['layers'].items())
+        print(f"frame {frame['frame']} camera {frame['camera_id']} location {frame['location']}: {layers}")
+
+
+if __name__ == '__main__':
+    main()
@@ -64,6 +64,8 @@ public class EasySynth : ModuleRules
 				"MainFrame",
 				"PropertyEditor",
 				// Image formats
+				"ImageWrapper",
+				"ImageWriteQueue",
 				"UEOpenExrRTTI",
 				// JSON parsing
 				"Json", "JsonUtilities",
@@ -0,0 +1,400 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "BenchmarkCommand.h"
+
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "ImagePixelData.h"
+#include "Interfaces/IPluginManager.h"
+#include "JsonObjectConverter.h"
+#include "LevelSequence.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialInstanceConstant.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "MovieScene.h"
+#include "MovieSceneTimeHelpers.h"
+
+#include "EasySynth.h"
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
+#include "ImageWriting/EncodedImageWriteTask.h"
+#include "ImageWriting/PalettePngEncoder.h"
+#include "RendererTargets/CameraPoseExporter.h"
+#include "SequencerWrapper.h"
+#include "TextureStyles/TextureBackupManager.h"
+#include "TextureStyles/TextureStyleManager.h"
+
+
+const TCHAR* FBenchmarkCommand::CommandName = TEXT("EasySynth.Benchmark");
+
+const FString FBenchmarkCommand::ReportFileName(TEXT("BenchmarkReport.json"));
+
+void FBenchmarkCommand::Register(UTextureStyleManager* InTextureStyleManager)
+{
+	TextureStyleManager = InTextureStyleManager;
+
+	ConsoleCommand = IConsoleManager::Get().RegisterConsoleCommand(
+		CommandName,
+		TEXT("Measures the expensive parts of the plugin on synthetic data and writes the report. Arguments:\n"
+			"Output=<output directory> [Iterations=<count>] [Actors=<comma separated actor counts>]\n"
+			"[Resolutions=<comma separated <width>x<height> resolutions>] [ExrLayers=<max layer count>]\n"
+			"[Sequence=<sequence path for the camera pose export case>] [LevelCheckout] [Quit]"),
+		FConsoleCommandWithArgsDelegate::CreateRaw(this, &FBenchmarkCommand::OnBenchmarkCommand),
+		ECVF_Default);
+}
+
+void FBenchmarkCommand::Unregister()
+{
+	if (ConsoleCommand != nullptr)
+	{
+		IConsoleManager::Get().UnregisterConsoleObject(ConsoleCommand);
+		ConsoleCommand = nullptr;
+	}
+}
+
+void FBenchmarkCommand::OnBenchmarkCommand(const TArray<FString>& Args)
+{
+	// Join arguments back, so that the same parsing utilities as for the command line can be used
+	const FString Params = FString::Join(Args, TEXT(" "));
+	const bool bQuitOnFinish = FParse::Param(*Params, TEXT("Quit"));
+
+	FString OutputDirectory;
+	if (!FParse::Value(*Params, TEXT("Output="), OutputDirectory, false) || OutputDirectory.IsEmpty())
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Output= argument is required"), *FString(__FUNCTION__))
+		return;
+	}
+
+	Iterations = 5;
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	Iterations = FMath::Max(Iterations, 1);
+
+	FString ActorsValue(TEXT("10000"));
+	FParse::Value(*Params, TEXT("Actors="), ActorsValue, false);
+	FString ResolutionsValue(TEXT("1280x720,1920x1080,3840x2160"));
+	FParse::Value(*Params, TEXT("Resolutions="), ResolutionsValue, false);
+	int ExrLayers = 4;
+	FParse::Value(*Params, TEXT("ExrLayers="), ExrLayers);
+
+	BenchmarkReport = FBenchmarkReportContent();
+	BenchmarkReport.plugin_version = IPluginManager::Get().FindPlugin("EasySynth")->GetDescriptor().VersionName;
+	BenchmarkReport.engine_version = FEngineVersion::Current().ToString();
+
+	// Images are written into a scratch directory removed once the benchmark finishes
+	const FString ScratchDirectory = OutputDirectory / TEXT("BenchmarkScratch");
+
+	TArray<FString> ActorCounts;
+	ActorsValue.ParseIntoArray(ActorCounts, TEXT(","));
+	for (const FString& ActorCount : ActorCounts)
+	{
+		if (ActorCount.IsNumeric())
+		{
+			BenchmarkTextureBackup(FCString::Atoi(*ActorCount));
+		}
+	}
+
+	// The open level is only modified temporarily, but it is opt-in as it depends on the level content
+	if (FParse::Param(*Params, TEXT("LevelCheckout")))
+	{
+		BenchmarkTextureStyleCheckout();
+	}
+
+	TArray<FString> Resolutions;
+	ResolutionsValue.ParseIntoArray(Resolutions, TEXT(","));
+	for (const FString& ResolutionValue : Resolutions)
+	{
+		FString Width;
+		FString Height;
+		if (!ResolutionValue.Split(TEXT("x"), &Width, &Height) || !Width.IsNumeric() || !Height.IsNumeric())
+		{
+			UE_LOG(LogEasySynth, Warning, TEXT("%s: Skipping invalid resolution '%s', expected <width>x<height>"),
+				*FString(__FUNCTION__), *ResolutionValue)
+			continue;
+		}
+		const FIntPoint Resolution(FCString::Atoi(*Width), FCString::Atoi(*Height));
+
+		BenchmarkImageWriting(Resolution, ScratchDirectory);
+		for (int LayerCount = 1; LayerCount <= ExrLayers; LayerCount *= 2)
+		{
+			BenchmarkExrWriting(Resolution, LayerCount, ScratchDirectory);
+		}
+	}
+
+	FString SequencePath;
+	if (FParse::Value(*Params, TEXT("Sequence="), SequencePath, false))
+	{
+		BenchmarkPoseExport(SequencePath, ScratchDirectory);
+	}
+
+	const bool bRequireExists = false;
+	const bool bTree = true;
+	IFileManager::Get().DeleteDirectory(*ScratchDirectory, bRequireExists, bTree);
+
+	FString JsonString;
+	FJsonObjectConverter::UStructToJsonObjectString(BenchmarkReport, JsonString);
+	const FString SaveFilePath = OutputDirectory / ReportFileName;
+	if (!FFileHelper::SaveStringToFile(JsonString, *SaveFilePath))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving the file %s"), *FString(__FUNCTION__), *SaveFilePath)
+	}
+	else
+	{
+		UE_LOG(LogEasySynth, Log, TEXT("%s: Measured %d cases, report saved to %s"),
+			*FString(__FUNCTION__), BenchmarkReport.cases.Num(), *SaveFilePath)
+	}
+
+	if (bQuitOnFinish)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void FBenchmarkCommand::BenchmarkTextureBackup(const int ActorCount)
+{
+	UStaticMesh* CubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (CubeMesh == nullptr || ActorCount <= 0)
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: Skipping the texture backup case"), *FString(__FUNCTION__))
+		return;
+	}
+
+	// Actors are spawned inside a separate world, so that the open level stays untouched
+	// Garbage collection does not run before the command returns, so created objects do not need to be rooted
+	const bool bInformEngineOfWorld = false;
+	UWorld* World = UWorld::CreateWorld(EWorldType::EditorPreview, bInformEngineOfWorld, TEXT("EasySynthBenchmark"));
+	TArray<AActor*> Actors;
+	Actors.Reserve(ActorCount);
+	const int GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(ActorCount)));
+	for (int i = 0; i < ActorCount; i++)
+	{
+		const FVector Location(i % GridSize * 200.0, i / GridSize * 200.0, 0.0);
+		AStaticMeshActor* Actor = World->SpawnActor<AStaticMeshActor>(Location, FRotator::ZeroRotator);
+		Actor->GetStaticMeshComponent()->SetStaticMesh(CubeMesh);
+		Actors.Add(Actor);
+	}
+
+	UMaterialInstanceConstant* Material = NewObject<UMaterialInstanceConstant>(GetTransientPackage());
+	Material->SetParentEditorOnly(UMaterial::GetDefaultMaterial(MD_Surface));
+	UTextureBackupManager* TextureBackupManager = NewObject<UTextureBackupManager>();
+
+	auto PaintActors = [&]()
+	{
+		const bool bDoPaint = true;
+		for (AActor* Actor : Actors)
+		{
+			const bool bDoAdd = !TextureBackupManager->ContainsActor(Actor);
+			TextureBackupManager->AddAndPaint(Actor, bDoAdd, bDoPaint, Material);
+		}
+	};
+	auto RestoreActors = [&]()
+	{
+		const bool bDoAdd = false;
+		const bool bDoPaint = true;
+		for (AActor* Actor : Actors)
+		{
+			if (TextureBackupManager->ContainsActor(Actor))
+			{
+				TextureBackupManager->AddAndPaint(Actor, bDoAdd, bDoPaint);
+			}
+		}
+	};
+
+	MeasureCase(FString::Printf(TEXT("TextureBackup.Paint.%d"), ActorCount), ActorCount,
+		RestoreActors, [&]() { PaintActors(); return true; });
+	MeasureCase(FString::Printf(TEXT("TextureBackup.Restore.%d"), ActorCount), ActorCount,
+		PaintActors, [&]() { RestoreActors(); return true; });
+
+	TArray<UMaterialInstanceConstant*> Materials;
+	Materials.Init(Material, Actors.Num());
+	MeasureCase(FString::Printf(TEXT("TextureBackup.BatchPaint.%d"), ActorCount), ActorCount,
+		RestoreActors, [&]() { TextureBackupManager->AddAndPaintActors(Actors, Materials); return true; });
+
+	const bool bInformEngineOfWorldDestroyed = false;
+	World->DestroyWorld(bInformEngineOfWorldDestroyed);
+}
+
+void FBenchmarkCommand::BenchmarkTextureStyleCheckout()
+{
+	UWorld* World = GEditor->GetEditorWorldContext().World();
+	if (TextureStyleManager == nullptr || World == nullptr)
+	{
+		return;
+	}
+
+	// Checkouts start from the original materials, which are restored at the end
+	const ETextureStyle OriginalTextureStyle = TextureStyleManager->SelectedTextureStyle();
+	auto CheckoutColor = [&]() { TextureStyleManager->CheckoutTextureStyle(ETextureStyle::COLOR); };
+	const int64 ActorCount = World->GetActorCount();
+
+	MeasureCase(FString::Printf(TEXT("TextureStyle.Semantic.%lld"), ActorCount), ActorCount, CheckoutColor,
+		[&]() { TextureStyleManager->CheckoutTextureStyle(ETextureStyle::SEMANTIC); return true; });
+	MeasureCase(FString::Printf(TEXT("TextureStyle.InstanceId.%lld"), ActorCount), ActorCount, CheckoutColor,
+		[&]() { TextureStyleManager->CheckoutTextureStyle(ETextureStyle::INSTANCE_ID); return true; });
+	MeasureCase(FString::Printf(TEXT("TextureStyle.Color.%lld"), ActorCount), ActorCount,
+		[&]() { TextureStyleManager->CheckoutTextureStyle(ETextureStyle::SEMANTIC); },
+		[&]() { TextureStyleManager->CheckoutTextureStyle(ETextureStyle::COLOR); return true; });
+
+	TextureStyleManager->CheckoutTextureStyle(OriginalTextureStyle);
+}
+
+void FBenchmarkCommand::BenchmarkImageWriting(const FIntPoint Resolution, const FString& ScratchDirectory)
+{
+	const int64 PixelCount = static_cast<int64>(Resolution.X) * Resolution.Y;
+	const FString ResolutionName = FString::Printf(TEXT("%dx%d"), Resolution.X, Resolution.Y);
+	const TArray64<FFloat16Color> Pixels = SyntheticPixels(Resolution);
+
+	// Tasks take the ownership of the pixel data, so each run gets its own copy
+	TUniquePtr<FEncodedImageWriteTask> WriteTask;
+	for (const EImageFormat ImageFormat : { EImageFormat::JPEG, EImageFormat::PNG })
+	{
+		const bool bJpeg = ImageFormat == EImageFormat::JPEG;
+		const FString FilePath = ScratchDirectory / (bJpeg ? TEXT("Image.jpeg") : TEXT("Image.png"));
+		const bool bRequireTransparentOutput = false;
+		MeasureCase(FString::Printf(TEXT("EncodedImage.%s.%s"), bJpeg ? TEXT("Jpeg") : TEXT("Png"), *ResolutionName), PixelCount,
+			[&]()
+			{
+				TArray64<FFloat16Color> PixelsCopy(Pixels);
+				WriteTask = MakeUnique<FEncodedImageWriteTask>(FilePath, ImageFormat,
+					MakeUnique<TImagePixelData<FFloat16Color>>(Resolution, MoveTemp(PixelsCopy)), bRequireTransparentOutput);
+			},
+			[&]() { return WriteTask->RunTask(); });
+	}
+
+	// Semantic images consist of large regions of a few class colors
+	TArray<FColor> Palette;
+	for (int i = 0; i < 32; i++)
+	{
+		Palette.Add(FColor::MakeRandomSeededColor(i));
+	}
+	TArray64<FColor> SemanticPixels;
+	SemanticPixels.SetNumUninitialized(PixelCount);
+	for (int64 i = 0; i < PixelCount; i++)
+	{
+		const int64 Region = (i % Resolution.X) / 64 + (i / Resolution.X) / 64 * 7;
+		SemanticPixels[i] = Palette[Region % Palette.Num()];
+	}
+	const FPalettePngEncoder PaletteEncoder(Palette);
+	TArray64<uint8> EncodedData;
+	MeasureCase(FString::Printf(TEXT("PalettePng.%s"), *ResolutionName), PixelCount, []() {},
+		[&]() { return PaletteEncoder.Encode(Resolution, SemanticPixels, EncodedData); });
+}
+
+void FBenchmarkCommand::BenchmarkExrWriting(const FIntPoint Resolution, const int LayerCount, const FString& ScratchDirectory)
+{
+#if WITH_UNREALEXR
+	const TArray64<FFloat16Color> Pixels = SyntheticPixels(Resolution);
+
+	TUniquePtr<FEXRImageWriteTaskLocal> WriteTask;
+	MeasureCase(FString::Printf(TEXT("Exr.%dx%d.%dLayers"), Resolution.X, Resolution.Y, LayerCount),
+		static_cast<int64>(Resolution.X) * Resolution.Y * LayerCount,
+		[&]()
+		{
+			WriteTask = MakeUnique<FEXRImageWriteTaskLocal>();
+			WriteTask->Filename = ScratchDirectory / TEXT("Image.exr");
+			WriteTask->Width = Resolution.X;
+			WriteTask->Height = Resolution.Y;
+			for (int i = 0; i < LayerCount; i++)
+			{
+				TArray64<FFloat16Color> PixelsCopy(Pixels);
+				TUniquePtr<FImagePixelData> Layer = MakeUnique<TImagePixelData<FFloat16Color>>(Resolution, MoveTemp(PixelsCopy));
+				if (i > 0)
+				{
+					WriteTask->LayerNames.Add(Layer.Get(), FString::Printf(TEXT("Layer%d"), i));
+				}
+				WriteTask->Layers.Add(MoveTemp(Layer));
+			}
+		},
+		[&]() { return WriteTask->RunTask(); });
+#endif // WITH_UNREALEXR
+}
+
+void FBenchmarkCommand::BenchmarkPoseExport(const FString& SequencePath, const FString& ScratchDirectory)
+{
+	ULevelSequence* LevelSequence = LoadObject<ULevelSequence>(nullptr, *SequencePath);
+	FSequencerWrapper SequencerWrapper;
+	if (LevelSequence == nullptr || !SequencerWrapper.OpenSequence(LevelSequence))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not open level sequence '%s'"), *FString(__FUNCTION__), *SequencePath)
+		return;
+	}
+
+	const UMovieScene* MovieScene = SequencerWrapper.GetMovieScene();
+	const int64 FrameCount = FFrameRate::TransformTime(
+		FFrameTime(UE::MovieScene::DiscreteSize(MovieScene->GetPlaybackRange())),
+		MovieScene->GetTickResolution(),
+		MovieScene->GetDisplayRate()).FloorToFrame().Value;
+
+	const FIntPoint OutputImageResolution(1920, 1080);
+	MeasureCase(FString::Printf(TEXT("CameraPoses.%s"), *LevelSequence->GetName()), FrameCount, []() {},
+		[&]()
+		{
+			FCameraPoseExporter CameraPoseExporter;
+			return CameraPoseExporter.ExportCameraPoses(SequencerWrapper, OutputImageResolution, ScratchDirectory, nullptr);
+		});
+}
+
+TArray64<FFloat16Color> FBenchmarkCommand::SyntheticPixels(const FIntPoint Resolution)
+{
+	FRandomStream RandomStream(Resolution.X * Resolution.Y);
+	TArray64<FFloat16Color> Pixels;
+	Pixels.SetNumUninitialized(static_cast<int64>(Resolution.X) * Resolution.Y);
+	for (int64 y = 0; y < Resolution.Y; y++)
+	{
+		for (int64 x = 0; x < Resolution.X; x++)
+		{
+			const float Noise = RandomStream.FRandRange(-0.02f, 0.02f);
+			Pixels[y * Resolution.X + x] = FFloat16Color(FLinearColor(
+				static_cast<float>(x) / Resolution.X + Noise,
+				static_cast<float>(y) / Resolution.Y + Noise,
+				0.5f + Noise,
+				1.0f));
+		}
+	}
+	return Pixels;
+}
+
+void FBenchmarkCommand::MeasureCase(
+	const FString& Name,
+	const int64 Items,
+	TFunctionRef<void()> Setup,
+	TFunctionRef<bool()> Run)
+{
+	FBenchmarkReportCase& ReportCase = BenchmarkReport.cases.AddDefaulted_GetRef();
+	ReportCase.name = Name;
+	ReportCase.items = Items;
+	ReportCase.iterations = Iterations;
+	ReportCase.success = true;
+
+	TArray<double> Durations;
+	for (int i = 0; i <= Iterations; i++)
+	{
+		Setup();
+		const double StartTime = FPlatformTime::Seconds();
+		ReportCase.success &= Run();
+		const double Duration = FPlatformTime::Seconds() - StartTime;
+
+		// The first run fills caches and loads shaders and modules, so it is not measured
+		if (i > 0)
+		{
+			Durations.Add(Duration);
+		}
+	}
+
+	Durations.Sort();
+	ReportCase.min_seconds = Durations[0];
+	ReportCase.median_seconds = Durations[Durations.Num() / 2];
+	double TotalSeconds = 0.0;
+	for (const double Duration : Durations)
+	{
+		TotalSeconds += Duration;
+	}
+	ReportCase.mean_seconds = TotalSeconds / Durations.Num();
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: %s median %.4f s, min %.4f s over %d runs%s"),
+		*FString(__FUNCTION__), *Name, ReportCase.median_seconds, ReportCase.min_seconds, Iterations,
+		ReportCase.success ? TEXT("") : TEXT(", some of the runs failed"))
+}
@@ -13,6 +13,8 @@
 
 #include "CameraRig/CameraRigData.h"
 #include "EasySynth.h"
+#include "ImageWriting/BackgroundFileWriter.h"
+#include "ImageWriting/ImagePyramid.h"
 
 
 #define LOCTEXT_NAMESPACE "FCameraRigRosInterface"
@@ -188,47 +190,42 @@ FReply FCameraRigRosInterface::OnImportCameraRigClicked()
 bool FCameraRigRosInterface::ExportCameraRig(
 	const FString& OutputDir,
 	TArray<UCameraComponent*> RigCameras,
-	const FIntPoint& SensorSize)
+	const FIntPoint& SensorSize,
+	FBackgroundFileWriter* FileWriter,
+	const int PyramidLevel)
 {
 	FRosJsonContent RosJsonContent;
 
 	for (int i = 0; i < RigCameras.Num(); i++)
 	{
 		// Add each camera
-		AddCamera(i, RigCameras[i], SensorSize, RosJsonContent);
+		AddCamera(i, RigCameras[i], SensorSize, PyramidLevel, RosJsonContent);
 	}
 
 	FString JsonString;
 	FJsonObjectConverter::UStructToJsonObjectString(RosJsonContent, JsonString);
 
 	// Save the file
-	const FString SaveFilePath = FPathUtils::CameraRigFilePath(OutputDir);
-	if (!FFileHelper::SaveStringToFile(
-		JsonString,
-		*SaveFilePath,
-		FFileHelper::EEncodingOptions::AutoDetect,
-		&IFileManager::Get(),
-		EFileWrite::FILEWRITE_None))
-	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving the file %s"), *FString(__FUNCTION__), *SaveFilePath)
-		return false;
-	}
-
-	return true;
+	const FString SaveFilePath =
+		FPathUtils::PyramidLevelFilePath(FPathUtils::CameraRigFilePath(OutputDir), PyramidLevel);
+	return FBackgroundFileWriter::SaveStringToFile(FileWriter, MoveTemp(JsonString), SaveFilePath);
 }
 
 void FCameraRigRosInterface::AddCamera(
 	const int CameraId,
 	UCameraComponent* Camera,
 	const FIntPoint& SensorSize,
+	const int PyramidLevel,
 	FRosJsonContent& RosJsonContent)
 {
 	FRosJsonCamera RosJsonCamera;
 
-	// Add intrinsics
-	const double FocalLength = SensorSize.X / UKismetMathLibrary::DegTan(Camera->FieldOfView / 2.0f) / 2.0f;
-	const double PrincipalPointX = SensorSize.X / 2.0f;
-	const double PrincipalPointY = SensorSize.Y / 2.0f;
+	// Add intrinsics, each pyramid level halves the rendered ones
+	const double LevelScale = FMath::Pow(0.5, PyramidLevel);
+	const double FocalLength =
+		LevelScale * SensorSize.X / UKismetMathLibrary::DegTan(Camera->FieldOfView / 2.0f) / 2.0f;
+	const double PrincipalPointX = LevelScale * SensorSize.X / 2.0f;
+	const double PrincipalPointY = LevelScale * SensorSize.Y / 2.0f;
 	RosJsonCamera.intrinsics.Init(0, 9);
 	RosJsonCamera.intrinsics[0] = FocalLength;
 	RosJsonCamera.intrinsics[2] = PrincipalPointX;
@@ -256,8 +253,9 @@ void FCameraRigRosInterface::AddCamera(
 	RosJsonCamera.rotation.Add(Rotation.W);
 
 	// Add sensor size
-	RosJsonCamera.sensor_size.Add(SensorSize.X);
-	RosJsonCamera.sensor_size.Add(SensorSize.Y);
+	const FIntPoint LevelSensorSize = FImagePyramid::LevelSize(SensorSize, PyramidLevel);
+	RosJsonCamera.sensor_size.Add(LevelSensorSize.X);
+	RosJsonCamera.sensor_size.Add(LevelSensorSize.Y);
 
 	RosJsonContent.cameras.Add(FPathUtils::GetCameraName(Camera), RosJsonCamera);
 }
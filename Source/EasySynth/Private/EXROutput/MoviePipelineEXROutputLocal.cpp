@@ -7,7 +7,10 @@
 #include "Misc/FileHelper.h"
 #include "Async/Async.h"
 #include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 #include "HAL/PlatformTime.h"
+#include "HAL/ThreadSafeCounter.h"
 #include "Math/Float16.h"
 #include "MovieRenderPipelineCoreModule.h"
 #include "MoviePipelineOutputSetting.h"
@@ -18,38 +21,63 @@
 #include "IOpenExrRTTIModule.h"
 #include "Modules/ModuleManager.h"
 #include "MoviePipelineUtils.h"
+#include "FrameSelectionSetting.h"
+#include "ImageWriting/ImageWriterPool.h"
+#include "ImageWriting/OpticalFlowPostProcessor.h"
+#include "ImageWriting/PooledImageSequenceOutputs.h"
+#include "PathUtils.h"
 
 THIRD_PARTY_INCLUDES_START
 #include "OpenEXR/ImfChannelList.h"
+#include "OpenEXR/ImfThreading.h"
 THIRD_PARTY_INCLUDES_END
 
 #if WITH_UNREALEXR
 
-class FExrMemStreamOutLocal : public Imf::OStream
+// Number of EXR files that are currently being written. OpenEXR encodes lines using one global thread pool shared
+// by all files, so the worker threads are divided among the files written at the same time.
+static FThreadSafeCounter NumActiveExrWrites;
+
+static int32 GetNumFileThreads(const int32 InNumActiveWrites)
+{
+	// Once there's a file per core, the files alone keep all of the cores busy and lines are encoded by the writing thread.
+	const int32 NumCores = FPlatformMisc::NumberOfCores();
+	return InNumActiveWrites >= NumCores ? 0 : NumCores / FMath::Max(InNumActiveWrites, 1);
+}
+
+class FExrFileStreamOutLocal : public Imf::OStream
 {
 public:
 
-	FExrMemStreamOutLocal()
-		: Imf::OStream("")
-		, Pos(0)
+	FExrFileStreamOutLocal(const FString& InFilename)
+		: Imf::OStream(TCHAR_TO_ANSI(*InFilename))
+		, Archive(IFileManager::Get().CreateFileWriter(*InFilename))
 	{
 	}
 
-	// InN must be 32bit to match the abstract interface.
-	virtual void write(const char c[/*n*/], int32 InN)
+	bool IsValid() const
 	{
-		int64 SrcN = (int64)InN;
-		int64 DestPost = Pos + SrcN;
-		if (DestPost > Data.Num())
-		{
-			Data.AddUninitialized(DestPost - Data.Num());
-		}
+		return Archive.IsValid() && !Archive->IsError();
+	}
 
-		for (int64 i = 0; i < SrcN; ++i)
+	// Flushes the remaining buffered data and closes the file, returns false if any write failed.
+	bool Close()
+	{
+		if (!Archive.IsValid())
 		{
-			Data[Pos + i] = c[i];
+			return false;
 		}
-		Pos += SrcN;
+		const bool bSuccess = Archive->Close() && !Archive->IsError();
+		Archive.Reset();
+		return bSuccess;
+	}
+
+	// InN must be 32bit to match the abstract interface.
+	// Chunks are passed straight to the buffered file writer, so the encoded image is never held in memory as a whole.
+	// Write errors are kept by the archive and reported when the file is closed.
+	virtual void write(const char c[/*n*/], int32 InN)
+	{
+		Archive->Serialize(const_cast<char*>(c), InN);
 	}
 
 
@@ -62,7 +90,7 @@ public:
 
 	uint64_t tellp() override
 	{
-		return Pos;
+		return Archive->Tell();
 	}
 
 
@@ -73,18 +101,26 @@ public:
 
 	void seekp(uint64_t pos) override
 	{
-		Pos = pos;
+		Archive->Seek(pos);
 	}
 
 
-	int64 Pos;
-	TArray64<uint8> Data;
+	TUniquePtr<FArchive> Archive;
 };
 
 bool FEXRImageWriteTaskLocal::RunTask()
 {
 	bool bSuccess = WriteToDisk();
 
+	// Each pyramid level is downsampled from the previous one, which is released once it has been written.
+	const FString BaseFilename = Filename;
+	for (int32 Level = 1; bSuccess && Level < PyramidLevelCount; Level++)
+	{
+		bSuccess = DownsampleLayers();
+		Filename = FPathUtils::PyramidLevelFilePath(BaseFilename, Level);
+		bSuccess = bSuccess && WriteToDisk();
+	}
+
 	if (OnCompleted)
 	{
 		AsyncTask(ENamedThreads::GameThread, [bSuccess, LocalOnCompleted = MoveTemp(OnCompleted)] { LocalOnCompleted(bSuccess); });
@@ -101,8 +137,52 @@ void FEXRImageWriteTaskLocal::OnAbandoned()
 	}
 }
 
+bool FEXRImageWriteTaskLocal::DownsampleLayers()
+{
+	TArray<TUniquePtr<FImagePixelData>> DownsampledLayers;
+	TMap<FImagePixelData*, FString> DownsampledLayerNames;
+	TMap<FImagePixelData*, EEXRChannelLayoutLocal> DownsampledLayerChannelLayouts;
+	TSet<FImagePixelData*> DownsampledAveragedLayers;
+	for (const TUniquePtr<FImagePixelData>& Layer : Layers)
+	{
+		const bool bAverage = AveragedLayers.Contains(Layer.Get());
+		TUniquePtr<FImagePixelData> DownsampledLayer = FImagePyramid::Downsample(Layer.Get(), bAverage);
+		if (!DownsampledLayer.IsValid())
+		{
+			UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("Failed to downsample a layer of '%s'."), *Filename);
+			return false;
+		}
+
+		// Layer names and channel layouts are keyed by the layer pixel data, so they have to follow the downsampled copies.
+		if (const FString* LayerName = LayerNames.Find(Layer.Get()))
+		{
+			DownsampledLayerNames.Add(DownsampledLayer.Get(), *LayerName);
+		}
+		if (const EEXRChannelLayoutLocal* LayerChannelLayout = LayerChannelLayouts.Find(Layer.Get()))
+		{
+			DownsampledLayerChannelLayouts.Add(DownsampledLayer.Get(), *LayerChannelLayout);
+		}
+		if (bAverage)
+		{
+			DownsampledAveragedLayers.Add(DownsampledLayer.Get());
+		}
+		DownsampledLayers.Add(MoveTemp(DownsampledLayer));
+	}
+
+	const FIntPoint Size = FImagePyramid::LevelSize(FIntPoint(Width, Height), 1);
+	Width = Size.X;
+	Height = Size.Y;
+	Layers = MoveTemp(DownsampledLayers);
+	LayerNames = MoveTemp(DownsampledLayerNames);
+	LayerChannelLayouts = MoveTemp(DownsampledLayerChannelLayouts);
+	AveragedLayers = MoveTemp(DownsampledAveragedLayers);
+	return true;
+}
+
 bool FEXRImageWriteTaskLocal::WriteToDisk()
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(FEXRImageWriteTaskLocal::WriteToDisk);
+
 	// Ensure that the payload filename has the correct extension for the format
 	const TCHAR* FormatExtension = TEXT(".exr");
 	if (FormatExtension && !Filename.EndsWith(FormatExtension))
@@ -112,6 +192,12 @@ bool FEXRImageWriteTaskLocal::WriteToDisk()
 
 	bool bSuccess = EnsureWritableFile();
 
+	NumActiveExrWrites.Increment();
+	ON_SCOPE_EXIT
+	{
+		NumActiveExrWrites.Decrement();
+	};
+
 	if (bSuccess)
 	{
 		Imf::Compression FileCompression = Imf::Compression::NO_COMPRESSION;
@@ -127,6 +213,8 @@ bool FEXRImageWriteTaskLocal::WriteToDisk()
 				FileCompression = Imf::Compression::DWAA_COMPRESSION; break;
 			case EEXRCompressionFormatLocal::DWAB:
 				FileCompression = Imf::Compression::DWAB_COMPRESSION; break;
+			case EEXRCompressionFormatLocal::B44:
+				FileCompression = Imf::Compression::B44_COMPRESSION; break;
 			default:
 				checkNoEntry();
 		}
@@ -159,8 +247,14 @@ bool FEXRImageWriteTaskLocal::WriteToDisk()
 		// Insert our key-value pair metadata (if any, can be an arbitrary set of key/value pairs)
 		AddFileMetadata(Header);
 
-		FExrMemStreamOutLocal OutputFile;
+		FExrFileStreamOutLocal OutputFile(Filename);
+		if (!OutputFile.IsValid())
+		{
+			UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("Failed to open '%s' for writing."), *Filename);
+			bSuccess = false;
+		}
 
+		if (bSuccess)
 		{
 			// The FrameBuffer stores all the channels of the resulting image.
 			Imf::FrameBuffer FrameBuffer;
@@ -168,6 +262,9 @@ bool FEXRImageWriteTaskLocal::WriteToDisk()
 			// If we have to quantize the data (ie: Upscale 8 bit to 16 bit) we need to store them long enough for the file to get written.
 			TArray<TUniquePtr<FImagePixelData>> QuantizedData;
 
+			// Decoded channels also need to be stored until the file gets written.
+			TArray<TArray64<float>> DecodedData;
+
 			for (TUniquePtr<FImagePixelData>& Layer : Layers)
 			{
 				uint8 RawBitDepth = Layer->GetBitDepth();
@@ -187,7 +284,28 @@ bool FEXRImageWriteTaskLocal::WriteToDisk()
 					break;
 				}
 
-				int64 BytesWritten = 0;
+				// Float layers can be written with a reduced set of channels, 8 bit layers are always written as they are.
+				const bool bFloatLayer = RawBitDepth != 8 && Layer->GetNumChannels() >= 3;
+				const EEXRChannelLayoutLocal* LayerChannelLayout = LayerChannelLayouts.Find(Layer.Get());
+				const EEXRChannelLayoutLocal LayerLayout = LayerChannelLayout ? *LayerChannelLayout : ChannelLayout;
+				if (bFloatLayer && LayerLayout == EEXRChannelLayoutLocal::Z)
+				{
+					if (RawBitDepth == 16)
+					{
+						CompressDepth<Imf::HALF>(Header, FrameBuffer, Layer.Get());
+					}
+					else
+					{
+						CompressDepth<Imf::FLOAT>(Header, FrameBuffer, Layer.Get());
+					}
+					continue;
+				}
+				if (bFloatLayer && LayerLayout == EEXRChannelLayoutLocal::UV)
+				{
+					CompressOpticalFlow(Header, FrameBuffer, Layer.Get(), DecodedData.AddDefaulted_GetRef());
+					continue;
+				}
+
 				switch (RawBitDepth)
 				{
 				case 8:
@@ -202,32 +320,29 @@ bool FEXRImageWriteTaskLocal::WriteToDisk()
 						LayerNames.Add(QuantizedData.Last().Get(), LayerName);
 					}
 
-					BytesWritten = CompressRaw<Imf::HALF>(Header, FrameBuffer, QuantizedData.Last().Get());
+					CompressRaw<Imf::HALF>(Header, FrameBuffer, QuantizedData.Last().Get());
 				}
 					break;
 				case 16:
-					BytesWritten = CompressRaw<Imf::HALF>(Header, FrameBuffer, Layer.Get());
+					CompressRaw<Imf::HALF>(Header, FrameBuffer, Layer.Get());
 					break;
 				case 32:
-					BytesWritten = CompressRaw<Imf::FLOAT>(Header, FrameBuffer, Layer.Get());
+					CompressRaw<Imf::FLOAT>(Header, FrameBuffer, Layer.Get());
 					break;
 				default:
 					checkNoEntry();
 				}
-
-				// Reserve enough space in the output file for the whole layer so we don't keep reallocating.
-				OutputFile.Data.Reserve(BytesWritten);
 			}
 
-			// This scope ensures that IMF::Outputfile creates a complete file by closing the file when it goes out of scope.
-			// To complete the file, EXR seeks back into the file and writes the scanline offsets when the file is closed,
-			// which moves the tellp location. So file length is stored in advance for later use. The output file needs to be
-			// created after the header information is filled.
-			Imf::OutputFile ImfFile(OutputFile, Header, FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+			// Compressed chunks are written to the file as soon as they are encoded.
 #if WITH_EDITOR
 			try
 #endif
 			{
+				// This scope ensures that IMF::Outputfile creates a complete file by closing the file when it goes out of scope.
+				// To complete the file, EXR seeks back into the file and writes the scanline offsets when the file is closed.
+				// The output file needs to be created after the header information is filled.
+				Imf::OutputFile ImfFile(OutputFile, Header, GetNumFileThreads(NumActiveExrWrites.GetValue()));
 				ImfFile.setFrameBuffer(FrameBuffer);
 				ImfFile.writePixels(Height);
 			}
@@ -235,14 +350,17 @@ bool FEXRImageWriteTaskLocal::WriteToDisk()
 			catch (const IEX_NAMESPACE::BaseExc& Exception)
 			{
 				UE_LOG(LogMovieRenderPipelineIO, Error, TEXT("Caught exception: %hs"), Exception.message().c_str());
+				bSuccess = false;
 			}
 #endif
 		}
 
-		// Now that the scope has closed for the Imf::OutputFile, now we can write the data to disk.
-		if (bSuccess)
+		// Now that the scope has closed for the Imf::OutputFile, the remaining buffered data can be flushed.
+		bSuccess = OutputFile.Close() && bSuccess;
+		if (!bSuccess)
 		{
-			bSuccess = FFileHelper::SaveArrayToFile(OutputFile.Data, *Filename);
+			// Don't leave a partially written file behind, so that it is rendered again when resuming.
+			IFileManager::Get().Delete(*Filename);
 		}
 	}
 
@@ -341,6 +459,67 @@ int64 FEXRImageWriteTaskLocal::CompressRaw(Imf::Header& InHeader, Imf::FrameBuff
 	return int64(Width) * int64(Height) * NumChannels * int64(OutputFormat == 2 ? 4 : 2);
 }
 
+template <Imf::PixelType OutputFormat>
+void FEXRImageWriteTaskLocal::CompressDepth(Imf::Header& InHeader, Imf::FrameBuffer& InFrameBuffer, FImagePixelData* InLayer)
+{
+	void const* RawDataPtr;
+	int64 RawDataSize;
+	InLayer->GetRawData(RawDataPtr, RawDataSize);
+
+	const FString& LayerName = LayerNames.FindOrAdd(InLayer);
+	const FString ChannelName = LayerName.Len() > 0 ? FString::Printf(TEXT("%s.Z"), *LayerName) : FString(TEXT("Z"));
+	const int32 NumChannels = InLayer->GetNumChannels();
+	const int32 ComponentWidth = GetComponentWidth(InLayer->GetType());
+
+	// Depth is stored in the first channel, other channels only repeat it.
+	InHeader.channels().insert(TCHAR_TO_ANSI(*ChannelName), Imf::Channel(OutputFormat));
+	InFrameBuffer.insert(TCHAR_TO_ANSI(*ChannelName),
+		Imf::Slice(OutputFormat,
+			(char*)RawDataPtr,
+			ComponentWidth * NumChannels,
+			Width * ComponentWidth * NumChannels));
+}
+
+void FEXRImageWriteTaskLocal::CompressOpticalFlow(Imf::Header& InHeader, Imf::FrameBuffer& InFrameBuffer, FImagePixelData* InLayer, TArray64<float>& OutData)
+{
+	void const* RawDataPtr;
+	int64 RawDataSize;
+	InLayer->GetRawData(RawDataPtr, RawDataSize);
+
+	const int32 NumChannels = InLayer->GetNumChannels();
+	const bool bHalf = InLayer->GetType() == EImagePixelType::Float16;
+	const int64 NumPixels = int64(Width) * int64(Height);
+
+	OutData.SetNumUninitialized(NumPixels * 2);
+	for (int64 Pixel = 0; Pixel < NumPixels; Pixel++)
+	{
+		float RGB[3];
+		for (int32 Channel = 0; Channel < 3; Channel++)
+		{
+			const int64 Index = Pixel * NumChannels + Channel;
+			RGB[Channel] = bHalf ? static_cast<const FFloat16*>(RawDataPtr)[Index].GetFloat() : static_cast<const float*>(RawDataPtr)[Index];
+		}
+
+		const FVector2f Offset = FOpticalFlowPostProcessor::DecodeFlowColor(RGB[0], RGB[1], RGB[2], FIntPoint(Width, Height), OpticalFlowScale);
+		OutData[Pixel * 2] = Offset.X;
+		OutData[Pixel * 2 + 1] = Offset.Y;
+	}
+
+	const FString& LayerName = LayerNames.FindOrAdd(InLayer);
+	static const TCHAR* FlowChannelNames[] = { TEXT("U"), TEXT("V") };
+	for (int32 Channel = 0; Channel < 2; Channel++)
+	{
+		const FString ChannelName = LayerName.Len() > 0 ?
+			FString::Printf(TEXT("%s.%s"), *LayerName, FlowChannelNames[Channel]) : FString(FlowChannelNames[Channel]);
+		InHeader.channels().insert(TCHAR_TO_ANSI(*ChannelName), Imf::Channel(Imf::FLOAT));
+		InFrameBuffer.insert(TCHAR_TO_ANSI(*ChannelName),
+			Imf::Slice(Imf::FLOAT,
+				(char*)(OutData.GetData() + Channel),
+				sizeof(float) * 2,
+				Width * sizeof(float) * 2));
+	}
+}
+
 bool FEXRImageWriteTaskLocal::EnsureWritableFile()
 {
 	FString Directory = FPaths::GetPath(Filename);
@@ -382,6 +561,13 @@ void FEXRImageWriteTaskLocal::AddFileMetadata(Imf::Header& InHeader)
 
 void UMoviePipelineImageSequenceOutput_EXRLocal::OnReceiveImageDataImpl(FMoviePipelineMergerOutputFrame* InMergedOutputFrame)
 {
+	// Frames rendered between runs of subsampled frames are not written
+	if (!UMoviePipelineFrameSelectionSetting::IsFrameWritten(GetPipeline(), InMergedOutputFrame))
+	{
+		return;
+	}
+	FEncodedImageSequenceOutput::RenameMainPass(InMergedOutputFrame, MainPassName);
+
 	if (!bMultilayer)
 	{
 		// Some software doesn't support multi-layer, so in that case we fall back to the single-layer-multiple-file
@@ -399,12 +585,18 @@ void UMoviePipelineImageSequenceOutput_EXRLocal::OnReceiveImageDataImpl(FMoviePi
 	UMoviePipelineOutputSetting* OutputSettings = GetPipeline()->GetPipelinePrimaryConfig()->FindSetting<UMoviePipelineOutputSetting>();
 	check(OutputSettings);
 
+	// If no other output receives this frame, the pixel data can be moved into the write tasks instead of being copied.
+	const bool bTakeImageData = IsOnlyEnabledOutput();
+
 	// EXR only supports one resolution per file, but in certain scenarios we can get layers with different resolutions. To solve this, we're
 	// going to write one exr file per image resolution. First we loop through all layers to figure out how many sizes we're dealing with.
 	TArray<FIntPoint> Resolutions;
 	for (TPair<FMoviePipelinePassIdentifier, TUniquePtr<FImagePixelData>>& RenderPassData : InMergedOutputFrame->ImageOutputData)
 	{
-		Resolutions.AddUnique(RenderPassData.Value->GetSize());
+		if (RenderPassData.Value.IsValid())
+		{
+			Resolutions.AddUnique(RenderPassData.Value->GetSize());
+		}
 	}
 
 	// Then submit multiple write tasks. Layers that don't match the current resolution will be skipped until the correct iteration of the loop.
@@ -471,8 +663,10 @@ void UMoviePipelineImageSequenceOutput_EXRLocal::OnReceiveImageDataImpl(FMoviePi
 		TUniquePtr<FEXRImageWriteTaskLocal> MultiLayerImageTask = MakeUnique<FEXRImageWriteTaskLocal>();
 		MultiLayerImageTask->Filename = FinalFilePath;
 		MultiLayerImageTask->Compression = Compression;
-		// MultiLayerImageTask->CompressionLevel is intentionally skipped because it doesn't seem to make any practical difference
-		// so we don't expose it to the user because that will just cause confusion where the setting doesn't seem to do anything.
+		MultiLayerImageTask->CompressionLevel = CompressionLevel;
+		MultiLayerImageTask->ChannelLayout = ChannelLayout;
+		MultiLayerImageTask->OpticalFlowScale = OpticalFlowScale;
+		MultiLayerImageTask->PyramidLevelCount = PyramidSettings.LevelCount;
 
 		// FinalFormatArgs.FileMetadata has been merged by ResolveFilenameFormatArgs with the FrameOutputState,
 		// but we need to convert from FString, FString (needed for BP/Python purposes) to a FStringFormatArg as
@@ -489,32 +683,42 @@ void UMoviePipelineImageSequenceOutput_EXRLocal::OnReceiveImageDataImpl(FMoviePi
 		int32 ShotIndex = 0;
 		for (TPair<FMoviePipelinePassIdentifier, TUniquePtr<FImagePixelData>>& RenderPassData : InMergedOutputFrame->ImageOutputData)
 		{
-			if (RenderPassData.Value->GetSize() != Resolutions[Index])
+			if (!RenderPassData.Value.IsValid() || RenderPassData.Value->GetSize() != Resolutions[Index])
 			{
 				// If this layer isn't for this resolution, don't add it to the multilayer task, a second task will be created soon.
 				continue;
 			}
 
-			// No quantization required, just copy the data as we will move it into the image write task.
-			TUniquePtr<FImagePixelData> PixelData = RenderPassData.Value->CopyImageData();
+			// No quantization required, just move or copy the data into the image write task.
+			TUniquePtr<FImagePixelData> PixelData = bTakeImageData ? MoveTemp(RenderPassData.Value) : RenderPassData.Value->CopyImageData();
 
 			// If there is more than one layer, then we will prefix the layer. The first layer is not prefixed (and gets inserted as RGBA)
 			// as most programs that handle EXRs expect the main image data to be in an unnamed layer.
 			if (LayerIndex == 0)
 			{
 				// Only check the main image pass for transparent output since that's generally considered the 'preview'.
-				FImagePixelDataPayload* Payload = RenderPassData.Value->GetPayload<FImagePixelDataPayload>();
+				FImagePixelDataPayload* Payload = PixelData->GetPayload<FImagePixelDataPayload>();
 				bRequiresTransparentOutput = Payload->bRequireTransparentOutput;
 				ShotIndex = Payload->SampleState.OutputState.ShotIndex;
 				MultiLayerImageTask->OverscanPercentage = Payload->SampleState.OverscanPercentage;
 			}
-			else
+			if (LayerIndex > 0 || bNameAllLayers)
 			{
 				// If there is more than one layer, then we will prefix the layer. The first layer is not prefixed (and gets inserted as RGBA)
 				// as most programs that handle EXRs expect the main image data to be in an unnamed layer.
 				MultiLayerImageTask->LayerNames.FindOrAdd(PixelData.Get(), RenderPassData.Key.Name);
 			}
 
+			if (const EEXRChannelLayoutLocal* PassChannelLayout = PassChannelLayouts.Find(RenderPassData.Key.Name))
+			{
+				MultiLayerImageTask->LayerChannelLayouts.Add(PixelData.Get(), *PassChannelLayout);
+			}
+
+			if (PyramidSettings.AveragesPass(RenderPassData.Key.Name))
+			{
+				MultiLayerImageTask->AveragedLayers.Add(PixelData.Get());
+			}
+
 			MultiLayerImageTask->Width = Resolutions[Index].X;
 			MultiLayerImageTask->Height = Resolutions[Index].Y;
 			MultiLayerImageTask->Layers.Add(MoveTemp(PixelData));
@@ -533,3 +737,47 @@ void UMoviePipelineImageSequenceOutput_EXRLocal::OnReceiveImageDataImpl(FMoviePi
 
 	}
 }
+
+void UMoviePipelineImageSequenceOutput_EXRLocal::SetupForPipelineImpl(UMoviePipeline* InPipeline)
+{
+	Super::SetupForPipelineImpl(InPipeline);
+	ImageWriteQueue = &FImageWriterPool::ForImageFormat(EImageFormat::EXR);
+
+#if WITH_UNREALEXR
+	// Lines of every file are compressed by tasks of the global OpenEXR thread pool, the thread count passed to each file
+	// only limits how many of its lines are in flight. The pool gets a thread per physical core while the pipeline writes,
+	// and its previous size is restored in the teardown, so that other OpenEXR users in the editor are not affected.
+	OriginalGlobalThreadCount = Imf::globalThreadCount();
+	const int32 NumCores = FPlatformMisc::NumberOfCores();
+	if (OriginalGlobalThreadCount != NumCores)
+	{
+		Imf::setGlobalThreadCount(NumCores);
+	}
+#endif // WITH_UNREALEXR
+}
+
+void UMoviePipelineImageSequenceOutput_EXRLocal::TeardownForPipelineImpl(UMoviePipeline* InPipeline)
+{
+#if WITH_UNREALEXR
+	// All output futures are finished by now, so no file is using the pool while it is resized
+	if (OriginalGlobalThreadCount != INDEX_NONE && Imf::globalThreadCount() != OriginalGlobalThreadCount)
+	{
+		Imf::setGlobalThreadCount(OriginalGlobalThreadCount);
+	}
+	OriginalGlobalThreadCount = INDEX_NONE;
+#endif // WITH_UNREALEXR
+
+	Super::TeardownForPipelineImpl(InPipeline);
+}
+
+bool UMoviePipelineImageSequenceOutput_EXRLocal::IsOnlyEnabledOutput() const
+{
+	for (const UMoviePipelineSetting* Setting : GetPipeline()->GetPipelinePrimaryConfig()->FindSettingsByClass(UMoviePipelineOutputBase::StaticClass()))
+	{
+		if (Setting != this && Setting->IsEnabled())
+		{
+			return false;
+		}
+	}
+	return true;
+}
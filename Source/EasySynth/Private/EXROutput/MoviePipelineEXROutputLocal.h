@@ -5,6 +5,7 @@
 #include "ImagePixelData.h"
 #include "MoviePipelineImageSequenceOutput.h"
 #include "Misc/StringFormatArg.h"
+#include "ImageWriting/ImagePyramid.h"
 
 #if WITH_UNREALEXR
 THIRD_PARTY_INCLUDES_START
@@ -34,7 +35,20 @@ enum class EEXRCompressionFormatLocal : uint8
 	/** Lossy DCT-based compression for RGB channels. Alpha and other channels are uncompressed. More efficient than DWAB for partial buffer access on read in 3rd party tools. */
 	DWAA,
 	/** Similar to DWAA but goes in blocks of 256 scanlines instead of 32. More efficient disk space and faster to decode than DWAA. */
-	DWAB
+	DWAB,
+	/** Lossy fixed rate compression of 4x4 pixel blocks of half channels. Float channels are compressed losslessly. */
+	B44
+};
+
+UENUM(BlueprintType)
+enum class EEXRChannelLayoutLocal : uint8
+{
+	/** All channels of the pixel data are written. */
+	RGBA,
+	/** Only the first channel is written, named Z. Used for depth. */
+	Z,
+	/** Optical flow colors are decoded into horizontal and vertical pixel offsets, written as U and V float channels. */
+	UV
 };
 
 #if WITH_UNREALEXR
@@ -74,11 +88,29 @@ public:
 	/** Overscan info used to create apropriate dataWindow for EXR output. Goes from 0.0 to 1.0. */
 	float OverscanPercentage;
 
+	/** Layout of the channels written for every float layer. */
+	EEXRChannelLayoutLocal ChannelLayout;
+
+	/** Optional. Layouts of specific layers, overriding the ChannelLayout. */
+	TMap<FImagePixelData*, EEXRChannelLayoutLocal> LayerChannelLayouts;
+
+	/** The scale optical flow colors were rendered with, used to decode the UV channel layout. */
+	float OpticalFlowScale;
+
+	/** Number of written image pyramid levels, including the rendered resolution. Each level is written to its own level directory. */
+	int32 PyramidLevelCount;
+
+	/** Optional. Layers downsampled by averaging, other layers keep the most frequent value of each block so that ids are not blended. */
+	TSet<FImagePixelData*> AveragedLayers;
+
 	FEXRImageWriteTaskLocal()
 		: bOverwriteFile(true)
 		, Compression(EEXRCompressionFormatLocal::PIZ)
 		, CompressionLevel(45)
 		, OverscanPercentage(0.0f)
+		, ChannelLayout(EEXRChannelLayoutLocal::RGBA)
+		, OpticalFlowScale(1.0f)
+		, PyramidLevelCount(1)
 	{}
 
 public:
@@ -95,6 +127,9 @@ private:
 	 */
 	bool WriteToDisk();
 
+	/** Replaces every layer with its copy downsampled to half of the resolution, keeping the layer names and channel layouts. */
+	bool DownsampleLayers();
+
 	/**
 	 * Ensures that the desired output filename is writable, deleting an existing file if bOverwriteFile is true
 	 *
@@ -109,6 +144,13 @@ private:
 
 	template <Imf::PixelType OutputFormat>
 	int64 CompressRaw(Imf::Header& InHeader, Imf::FrameBuffer& InFrameBuffer, FImagePixelData* InLayer);
+
+	/** Inserts only the first channel of the layer, reading it in place from the interleaved pixel data. */
+	template <Imf::PixelType OutputFormat>
+	void CompressDepth(Imf::Header& InHeader, Imf::FrameBuffer& InFrameBuffer, FImagePixelData* InLayer);
+
+	/** Decodes optical flow colors of the layer into pixel offsets stored inside OutData, and inserts them as two channels. */
+	void CompressOpticalFlow(Imf::Header& InHeader, Imf::FrameBuffer& InFrameBuffer, FImagePixelData* InLayer, TArray64<float>& OutData);
 };
 #endif // WITH_UNREALEXR
 
@@ -130,6 +172,19 @@ public:
 
 	virtual void OnReceiveImageDataImpl(FMoviePipelineMergerOutputFrame* InMergedOutputFrame) override;
 
+protected:
+	/** Replaces the engine image write queue with the EasySynth EXR writer pool, which limits the number of in-flight images. */
+	virtual void SetupForPipelineImpl(UMoviePipeline* InPipeline) override;
+
+	/** Restores the size of the global OpenEXR thread pool changed by the SetupForPipelineImpl. */
+	virtual void TeardownForPipelineImpl(UMoviePipeline* InPipeline) override;
+
+	/** Returns true if no other enabled output receives the merged frames, so their pixel data does not have to be copied. */
+	bool IsOnlyEnabledOutput() const;
+
+	/** Size of the global OpenEXR thread pool before the pipeline was set up, INDEX_NONE outside of the pipeline. */
+	int32 OriginalGlobalThreadCount = INDEX_NONE;
+
 public:
 	/**
 	* Which compression method should the resulting EXR file be compressed with
@@ -137,9 +192,51 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
 	EEXRCompressionFormatLocal Compression;
 
+	/**
+	* When using a lossy DWA compression, what is the base-error (CompressionLevel/100000). Higher values produce smaller files.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR", meta = (UIMin = 0, ClampMin = 0))
+	int32 CompressionLevel = 45;
+
 	/**
 	* Should we write all render passes to the same exr file? Not all software supports multi-layer exr files.
 	*/
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
 	bool bMultilayer;
+
+	/**
+	* Which channels should be written for float layers of multi-layer exr files
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
+	EEXRChannelLayoutLocal ChannelLayout = EEXRChannelLayoutLocal::RGBA;
+
+	/**
+	* Channel layouts of specific render passes inside multi-layer exr files, keyed by the render pass name
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
+	TMap<FString, EEXRChannelLayoutLocal> PassChannelLayouts;
+
+	/**
+	* Should the first render pass also be written as a named layer? Otherwise it's written as the unnamed main layer of multi-layer exr files.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
+	bool bNameAllLayers = false;
+
+	/**
+	* The scale optical flow colors were rendered with, used when decoding them into pixel offsets
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EXR")
+	float OpticalFlowScale = 1.0f;
+
+	/**
+	* Downsampled image levels written next to each multi-layer exr file
+	*/
+	UPROPERTY()
+	FImagePyramidSettings PyramidSettings;
+
+	/**
+	* Name written in place of the main render pass name, the engine name is kept if empty
+	*/
+	UPROPERTY()
+	FString MainPassName;
 };
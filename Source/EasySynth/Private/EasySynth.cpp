@@ -3,6 +3,8 @@
 #include "EasySynth.h"
 #include "EasySynthStyle.h"
 #include "EasySynthCommands.h"
+#include "ImageWriting/ImageWriterPool.h"
+#include "ImageWriting/SharedMemoryFrameRing.h"
 #include "LevelEditor.h"
 #include "ToolMenus.h"
 
@@ -32,6 +34,9 @@ void FEasySynthModule::StartupModule()
 	FGlobalTabmanager::Get()->RegisterNomadTabSpawner(EasySynthTabName, FOnSpawnTab::CreateRaw(&WidgetManager, &FWidgetManager::OnSpawnPluginTab))
 		.SetDisplayName(LOCTEXT("FEasySynthTabTitle", "EasySynth"))
 		.SetMenuType(ETabSpawnerMenuType::Hidden);
+
+	RenderCommand.Register(WidgetManager.GetTextureStyleManager());
+	BenchmarkCommand.Register(WidgetManager.GetTextureStyleManager());
 }
 
 void FEasySynthModule::ShutdownModule()
@@ -48,6 +53,12 @@ void FEasySynthModule::ShutdownModule()
 	FEasySynthCommands::Unregister();
 
 	FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(EasySynthTabName);
+
+	RenderCommand.Unregister();
+	BenchmarkCommand.Unregister();
+
+	FImageWriterPool::ShutdownPools();
+	FSharedMemoryFrameRing::ReleaseRings();
 }
 
 void FEasySynthModule::PluginButtonClicked()
@@ -0,0 +1,24 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "FrameSelectionSetting.h"
+
+#include "Algo/BinarySearch.h"
+#include "MoviePipeline.h"
+#include "MoviePipelinePrimaryConfig.h"
+#include "MovieRenderPipelineDataTypes.h"
+
+
+bool UMoviePipelineFrameSelectionSetting::IsFrameWritten(
+	UMoviePipeline* Pipeline, const FMoviePipelineMergerOutputFrame* MergedOutputFrame)
+{
+	check(Pipeline);
+	check(MergedOutputFrame);
+	const UMoviePipelineFrameSelectionSetting* FrameSelection =
+		Pipeline->GetPipelinePrimaryConfig()->FindSetting<UMoviePipelineFrameSelectionSetting>();
+	if (FrameSelection == nullptr)
+	{
+		return true;
+	}
+
+	return Algo::BinarySearch(FrameSelection->WrittenFrames, MergedOutputFrame->FrameOutputState.SourceFrameNumber) != INDEX_NONE;
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "ImageWriting/BackgroundFileWriter.h"
+
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+
+#include "EasySynth.h"
+
+
+void FBackgroundFileWriter::Launch(TUniqueFunction<bool()>&& Write)
+{
+	PendingWrites.Add(Async(EAsyncExecution::ThreadPool, MoveTemp(Write)));
+}
+
+bool FBackgroundFileWriter::Wait()
+{
+	bool bSuccess = true;
+	for (TFuture<bool>& PendingWrite : PendingWrites)
+	{
+		bSuccess &= PendingWrite.Get();
+	}
+	PendingWrites.Empty();
+	return bSuccess;
+}
+
+bool FBackgroundFileWriter::SaveStringToFile(FBackgroundFileWriter* FileWriter, FString&& Content, const FString& FilePath)
+{
+	if (FileWriter == nullptr)
+	{
+		return SaveString(Content, FilePath);
+	}
+
+	FileWriter->Launch([Content = MoveTemp(Content), FilePath]() { return SaveString(Content, FilePath); });
+	return true;
+}
+
+bool FBackgroundFileWriter::SaveStringArrayToFile(
+	FBackgroundFileWriter* FileWriter,
+	TArray<FString>&& Lines,
+	const FString& FilePath)
+{
+	if (FileWriter == nullptr)
+	{
+		return SaveStringArray(Lines, FilePath);
+	}
+
+	FileWriter->Launch([Lines = MoveTemp(Lines), FilePath]() { return SaveStringArray(Lines, FilePath); });
+	return true;
+}
+
+bool FBackgroundFileWriter::SaveString(const FString& Content, const FString& FilePath)
+{
+	if (!FFileHelper::SaveStringToFile(
+		Content,
+		*FilePath,
+		FFileHelper::EEncodingOptions::AutoDetect,
+		&IFileManager::Get(),
+		EFileWrite::FILEWRITE_None))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving the file %s"), *FString(__FUNCTION__), *FilePath)
+		return false;
+	}
+	return true;
+}
+
+bool FBackgroundFileWriter::SaveStringArray(const TArray<FString>& Lines, const FString& FilePath)
+{
+	if (!FFileHelper::SaveStringArrayToFile(
+		Lines,
+		*FilePath,
+		FFileHelper::EEncodingOptions::AutoDetect,
+		&IFileManager::Get(),
+		EFileWrite::FILEWRITE_None))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving the file %s"), *FString(__FUNCTION__), *FilePath)
+		return false;
+	}
+	return true;
+}
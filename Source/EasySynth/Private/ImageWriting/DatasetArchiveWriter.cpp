@@ -0,0 +1,324 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "ImageWriting/DatasetArchiveWriter.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include "EasySynth.h"
+#include "PathUtils.h"
+#include "RendererTargets/OutputFramesScanner.h"
+
+
+const int64 FDatasetArchiveWriter::TarBlockSize = 512;
+
+bool FDatasetArchiveWriter::PackDirectory(const FString& Directory)
+{
+	OutputDirectory = Directory;
+	IndexLines.Empty();
+
+	// Collect all output files, except for the previously written archives
+	TArray<FString> FilePaths;
+	IFileManager::Get().FindFilesRecursive(FilePaths, *OutputDirectory, TEXT("*"), true, false);
+	TArray<FArchiveEntry> Entries;
+	for (const FString& FilePath : FilePaths)
+	{
+		const FString FileName = FPaths::GetCleanFilename(FilePath);
+		if (FileName == FPathUtils::DatasetIndexFileName ||
+			(FileName.StartsWith(FPathUtils::DatasetArchiveBaseName) && FPaths::GetExtension(FileName) == TEXT("tar")))
+		{
+			continue;
+		}
+
+		FString RelativePath = FilePath;
+		FPaths::MakePathRelativeTo(RelativePath, *(OutputDirectory / TEXT("")));
+		Entries.Add(MakeEntry(FilePath, RelativePath));
+	}
+	if (Entries.Num() == 0)
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: No outputs to pack inside %s"), *FString(__FUNCTION__), *OutputDirectory)
+		return true;
+	}
+
+	// Sidecar entries go first, followed by images grouped by camera frames, as WebDataset samples have to be contiguous
+	Entries.Sort([](const FArchiveEntry& A, const FArchiveEntry& B)
+	{
+		if ((A.Frame == INDEX_NONE) != (B.Frame == INDEX_NONE))
+		{
+			return A.Frame == INDEX_NONE;
+		}
+		if (A.Camera != B.Camera)
+		{
+			return A.Camera < B.Camera;
+		}
+		if (A.Frame != B.Frame)
+		{
+			return A.Frame < B.Frame;
+		}
+		return A.EntryName < B.EntryName;
+	});
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Packing %d outputs inside %s"), *FString(__FUNCTION__), Entries.Num(), *OutputDirectory)
+	if (!OpenArchive())
+	{
+		return false;
+	}
+	for (int i = 0; i < Entries.Num(); i++)
+	{
+		// Only start a new archive between samples, so that all images of a frame end up in the same archive
+		const bool bSampleStart = i == 0 ||
+			Entries[i].Frame == INDEX_NONE ||
+			Entries[i].Frame != Entries[i - 1].Frame ||
+			Entries[i].Camera != Entries[i - 1].Camera;
+		const int64 EntrySize = IFileManager::Get().FileSize(*Entries[i].FilePath);
+		if (bSampleStart && ArchiveBytes > 0 && ArchiveBytes + EntrySize > MaxArchiveBytes)
+		{
+			if (!CloseArchive() || !OpenArchive())
+			{
+				return false;
+			}
+		}
+
+		if (!AppendEntry(Entries[i]))
+		{
+			CloseArchive();
+			return false;
+		}
+	}
+	if (!CloseArchive() || !SaveIndex())
+	{
+		return false;
+	}
+
+	// Packed files are only removed once all archives and the index are written
+	TSet<FString> EntryDirectories;
+	for (const FArchiveEntry& Entry : Entries)
+	{
+		IFileManager::Get().Delete(*Entry.FilePath);
+		EntryDirectories.Add(FPaths::GetPath(Entry.FilePath));
+	}
+
+	// Remove emptied directories, starting from the deepest ones
+	TArray<FString> Directories = EntryDirectories.Array();
+	Directories.Sort([](const FString& A, const FString& B) { return A.Len() > B.Len(); });
+	for (const FString& EntryDirectory : Directories)
+	{
+		if (EntryDirectory != OutputDirectory)
+		{
+			// Only removes the directory if it is empty
+			IFileManager::Get().DeleteDirectory(*EntryDirectory, false, false);
+		}
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Packed outputs into %d archives"), *FString(__FUNCTION__), ArchiveId + 1)
+	return true;
+}
+
+FDatasetArchiveWriter::FArchiveEntry FDatasetArchiveWriter::MakeEntry(const FString& FilePath, const FString& RelativePath)
+{
+	FArchiveEntry Entry;
+	Entry.FilePath = FilePath;
+	Entry.EntryName = RelativePath;
+
+	// Images are stored as <camera>/<target>/<sequence>.<frame>.<extension>,
+	// and their pyramid levels as <camera>/<target>/Level<k>/<sequence>.<frame>.<extension>
+	TArray<FString> PathParts;
+	RelativePath.ParseIntoArray(PathParts, TEXT("/"));
+	if (PathParts.Num() > 1 &&
+		FPathUtils::ParsePyramidLevelDirName(PathParts[PathParts.Num() - 2], Entry.Level))
+	{
+		PathParts.RemoveAt(PathParts.Num() - 2);
+	}
+	if (PathParts.Num() > 1)
+	{
+		Entry.Camera = PathParts[0];
+	}
+	int Frame;
+	if (PathParts.Num() == 3 && FOutputFramesScanner::ParseFrameNumber(PathParts[2], Frame))
+	{
+		Entry.Target = PathParts[1];
+		Entry.Frame = Frame;
+		const FString LevelSuffix = Entry.Level > 0 ? FString::Printf(TEXT(".level%d"), Entry.Level) : TEXT("");
+		Entry.EntryName = FString::Printf(TEXT("%s/%06d.%s%s.%s"),
+			*Entry.Camera, Frame, *Entry.Target, *LevelSuffix, *FPaths::GetExtension(PathParts[2]));
+	}
+
+	return Entry;
+}
+
+bool FDatasetArchiveWriter::OpenArchive()
+{
+	// Continue the numbering of archives packed by previous renderings
+	while (IFileManager::Get().FileExists(*FPathUtils::DatasetArchiveFilePath(OutputDirectory, ArchiveId)))
+	{
+		ArchiveId++;
+	}
+
+	const FString ArchivePath = FPathUtils::DatasetArchiveFilePath(OutputDirectory, ArchiveId);
+	ArchiveWriter.Reset(IFileManager::Get().CreateFileWriter(*ArchivePath));
+	ArchiveBytes = 0;
+	if (!ArchiveWriter.IsValid())
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not create the archive %s"), *FString(__FUNCTION__), *ArchivePath)
+		return false;
+	}
+
+	return true;
+}
+
+bool FDatasetArchiveWriter::CloseArchive()
+{
+	if (!ArchiveWriter.IsValid())
+	{
+		return false;
+	}
+
+	// The archive ends with two empty blocks
+	TArray<uint8> EndBlocks;
+	EndBlocks.SetNumZeroed(2 * TarBlockSize);
+	ArchiveWriter->Serialize(EndBlocks.GetData(), EndBlocks.Num());
+	const bool bSuccess = ArchiveWriter->Close() && !ArchiveWriter->IsError();
+	ArchiveWriter.Reset();
+
+	if (!bSuccess)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while writing the archive %s"),
+			*FString(__FUNCTION__), *FPathUtils::DatasetArchiveFilePath(OutputDirectory, ArchiveId))
+	}
+	return bSuccess;
+}
+
+bool FDatasetArchiveWriter::AppendEntry(const FArchiveEntry& Entry)
+{
+	TArray64<uint8> FileContent;
+	if (!FFileHelper::LoadFileToArray(FileContent, *Entry.FilePath))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not read the file %s"), *FString(__FUNCTION__), *Entry.FilePath)
+		return false;
+	}
+
+	TArray<uint8> Header;
+	Header.SetNumZeroed(TarBlockSize);
+	if (!WriteTarHeader(Entry.EntryName, FileContent.Num(), Header.GetData()))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Entry name %s is too long for the tar header"),
+			*FString(__FUNCTION__), *Entry.EntryName)
+		return false;
+	}
+	ArchiveWriter->Serialize(Header.GetData(), Header.Num());
+	const int64 ContentOffset = ArchiveBytes + TarBlockSize;
+
+	// Content is padded to the whole number of blocks
+	ArchiveWriter->Serialize(FileContent.GetData(), FileContent.Num());
+	const int64 PaddingSize = (TarBlockSize - FileContent.Num() % TarBlockSize) % TarBlockSize;
+	TArray<uint8> Padding;
+	Padding.SetNumZeroed(PaddingSize);
+	ArchiveWriter->Serialize(Padding.GetData(), Padding.Num());
+	ArchiveBytes = ContentOffset + FileContent.Num() + PaddingSize;
+	if (ArchiveWriter->IsError())
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while appending %s to the archive"), *FString(__FUNCTION__), *Entry.FilePath)
+		return false;
+	}
+
+	IndexLines.Add(FString::Printf(TEXT("%s,%s,%s,%d,%s,%lld,%lld,%d"),
+		*Entry.EntryName,
+		*Entry.Camera,
+		*Entry.Target,
+		Entry.Frame,
+		*FPaths::GetCleanFilename(FPathUtils::DatasetArchiveFilePath(OutputDirectory, ArchiveId)),
+		ContentOffset,
+		FileContent.Num(),
+		Entry.Level));
+
+	return true;
+}
+
+bool FDatasetArchiveWriter::SaveIndex() const
+{
+	const FString IndexFilePath = FPathUtils::DatasetIndexFilePath(OutputDirectory);
+
+	// Extend the index of archives packed by previous renderings
+	TArray<FString> Lines;
+	if (!IFileManager::Get().FileExists(*IndexFilePath))
+	{
+		Lines.Add(TEXT("name,camera,target,frame,archive,offset,length,level"));
+	}
+	Lines.Append(IndexLines);
+
+	if (!FFileHelper::SaveStringArrayToFile(
+		Lines,
+		*IndexFilePath,
+		FFileHelper::EEncodingOptions::ForceAnsi,
+		&IFileManager::Get(),
+		EFileWrite::FILEWRITE_Append))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving the file %s"), *FString(__FUNCTION__), *IndexFilePath)
+		return false;
+	}
+
+	return true;
+}
+
+bool FDatasetArchiveWriter::WriteTarHeader(const FString& EntryName, const int64 Size, uint8* OutHeader)
+{
+	FMemory::Memzero(OutHeader, TarBlockSize);
+
+	// Names longer than the name field are split between the prefix and the name fields at a path separator
+	const FTCHARToUTF8 Name(*EntryName);
+	const int NameFieldSize = 100;
+	const int PrefixFieldSize = 155;
+	int NameStart = 0;
+	if (Name.Length() > NameFieldSize)
+	{
+		NameStart = Name.Length() - NameFieldSize;
+		while (NameStart < Name.Length() && Name.Get()[NameStart - 1] != '/')
+		{
+			NameStart++;
+		}
+		if (NameStart >= Name.Length() || NameStart - 1 > PrefixFieldSize)
+		{
+			return false;
+		}
+		FMemory::Memcpy(OutHeader + 345, Name.Get(), NameStart - 1);
+	}
+	FMemory::Memcpy(OutHeader, Name.Get() + NameStart, Name.Length() - NameStart);
+
+	// File mode, owner and group ids, size and modification time
+	WriteOctal(0644, 8, OutHeader + 100);
+	WriteOctal(0, 8, OutHeader + 108);
+	WriteOctal(0, 8, OutHeader + 116);
+	if (!WriteOctal(Size, 12, OutHeader + 124))
+	{
+		return false;
+	}
+	WriteOctal(FDateTime::UtcNow().ToUnixTimestamp(), 12, OutHeader + 136);
+
+	// Regular file of the ustar format
+	OutHeader[156] = '0';
+	FMemory::Memcpy(OutHeader + 257, "ustar", 6);
+	FMemory::Memcpy(OutHeader + 263, "00", 2);
+
+	// Checksum is calculated with the checksum field filled with spaces
+	FMemory::Memset(OutHeader + 148, ' ', 8);
+	uint32 Checksum = 0;
+	for (int i = 0; i < TarBlockSize; i++)
+	{
+		Checksum += OutHeader[i];
+	}
+	WriteOctal(Checksum, 7, OutHeader + 148);
+
+	return true;
+}
+
+bool FDatasetArchiveWriter::WriteOctal(uint64 Value, const int FieldSize, uint8* OutField)
+{
+	OutField[FieldSize - 1] = 0;
+	for (int i = FieldSize - 2; i >= 0; i--)
+	{
+		OutField[i] = '0' + (Value & 7);
+		Value >>= 3;
+	}
+	return Value == 0;
+}
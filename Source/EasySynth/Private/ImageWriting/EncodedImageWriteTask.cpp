@@ -0,0 +1,124 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "ImageWriting/EncodedImageWriteTask.h"
+
+#include "IImageWrapperModule.h"
+#include "Misc/FileHelper.h"
+#include "Modules/ModuleManager.h"
+#include "MoviePipelineImageQuantization.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+#include "EasySynth.h"
+#include "ImageWriting/ImagePyramid.h"
+#include "ImageWriting/PalettePngEncoder.h"
+#include "PathUtils.h"
+
+
+bool FEncodedImageWriteTask::RunTask()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FEncodedImageWriteTask::RunTask);
+
+	for (int Level = 0; Level < PyramidLevelCount; Level++)
+	{
+		const FString FilePath = FPathUtils::PyramidLevelFilePath(Filename, Level);
+		TUniquePtr<FImagePixelData> QuantizedPixelData = QuantizePixelData();
+		if (!QuantizedPixelData.IsValid())
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Could not convert the pixel data of %s"), *FString(__FUNCTION__), *FilePath)
+			return false;
+		}
+
+		// Release the rendered pixel data as soon as possible, since it is larger than the converted copy,
+		// while the next level is downsampled from it before the conversion rounds the colors
+		PixelData = Level + 1 < PyramidLevelCount ? FImagePyramid::Downsample(PixelData.Get(), bAveragePyramidLevels) : nullptr;
+
+		if (!WriteQuantizedImage(QuantizedPixelData.Get(), FilePath))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FEncodedImageWriteTask::WriteQuantizedImage(const FImagePixelData* QuantizedPixelData, const FString& FilePath) const
+{
+	const FIntPoint Size = QuantizedPixelData->GetSize();
+
+	// Palette-indexed images are never written as regular images, which readers of class ids could not parse
+	if (ImageFormat == EImageFormat::PNG && Palette.Num() > 0 && !bRequireTransparentOutput)
+	{
+		TArray64<uint8> PaletteImageData;
+		const FPalettePngEncoder PaletteEncoder(Palette);
+		if (!PaletteEncoder.Encode(Size, static_cast<const TImagePixelData<FColor>*>(QuantizedPixelData)->Pixels, PaletteImageData))
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Could not write %s as a palette-indexed image"), *FString(__FUNCTION__), *FilePath)
+			return false;
+		}
+		if (!FFileHelper::SaveArrayToFile(PaletteImageData, *FilePath))
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Could not write %s"), *FString(__FUNCTION__), *FilePath)
+			return false;
+		}
+		return true;
+	}
+
+	const void* RawData = nullptr;
+	int64 RawSize = 0;
+	QuantizedPixelData->GetRawData(RawData, RawSize);
+
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::GetModuleChecked<IImageWrapperModule>("ImageWrapper");
+	TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(ImageFormat);
+	if (!ImageWrapper.IsValid() || !ImageWrapper->SetRaw(RawData, RawSize, Size.X, Size.Y, ERGBFormat::BGRA, 8))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not encode %s"), *FString(__FUNCTION__), *FilePath)
+		return false;
+	}
+
+	const TArray64<uint8> CompressedData = ImageWrapper->GetCompressed(static_cast<int32>(EImageCompressionQuality::Default));
+	if (CompressedData.Num() == 0 || !FFileHelper::SaveArrayToFile(CompressedData, *FilePath))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not write %s"), *FString(__FUNCTION__), *FilePath)
+		return false;
+	}
+
+	return true;
+}
+
+TUniquePtr<FImagePixelData> FEncodedImageWriteTask::QuantizeToColor(const FImagePixelData* PixelData, const bool bConvertToSrgb)
+{
+	if (PixelData == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Rendered colors are linear, while 8-bit formats store sRGB encoded colors
+	const int32 TargetBitDepth = 8;
+	TUniquePtr<FImagePixelData> QuantizedPixelData = UE::MoviePipeline::QuantizeImagePixelDataToBitDepth(
+		PixelData, TargetBitDepth, nullptr, bConvertToSrgb);
+	if (!QuantizedPixelData.IsValid() || QuantizedPixelData->GetType() != EImagePixelType::Color)
+	{
+		return nullptr;
+	}
+	return QuantizedPixelData;
+}
+
+TUniquePtr<FImagePixelData> FEncodedImageWriteTask::QuantizePixelData() const
+{
+	TUniquePtr<FImagePixelData> QuantizedPixelData = QuantizeToColor(PixelData.Get(), bConvertToSrgb);
+	if (!QuantizedPixelData.IsValid())
+	{
+		return nullptr;
+	}
+
+	if (!bRequireTransparentOutput)
+	{
+		TImagePixelData<FColor>* ColorPixelData = static_cast<TImagePixelData<FColor>*>(QuantizedPixelData.Get());
+		for (FColor& Pixel : ColorPixelData->Pixels)
+		{
+			Pixel.A = 255;
+		}
+	}
+
+	return QuantizedPixelData;
+}
@@ -0,0 +1,120 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "ImageWriting/ImagePyramid.h"
+
+#include "MovieRenderPipelineDataTypes.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+#include "EasySynth.h"
+
+
+TUniquePtr<FImagePixelData> FImagePyramid::Downsample(const FImagePixelData* PixelData, const bool bAverage)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FImagePyramid::Downsample);
+
+	if (PixelData == nullptr)
+	{
+		return nullptr;
+	}
+
+	switch (PixelData->GetType())
+	{
+	case EImagePixelType::Color:
+		return DownsamplePixels<FColor>(PixelData, bAverage);
+	case EImagePixelType::Float16:
+		return DownsamplePixels<FFloat16Color>(PixelData, bAverage);
+	case EImagePixelType::Float32:
+		return DownsamplePixels<FLinearColor>(PixelData, bAverage);
+	default:
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Unsupported pixel type"), *FString(__FUNCTION__))
+		return nullptr;
+	}
+}
+
+FIntPoint FImagePyramid::LevelSize(const FIntPoint& BaseSize, const int Level)
+{
+	// Odd pixels at the right and bottom edges are dropped, so that every level pixel covers a full block
+	FIntPoint Size = BaseSize;
+	for (int i = 0; i < Level; i++)
+	{
+		Size = FIntPoint(FMath::Max(Size.X / 2, 1), FMath::Max(Size.Y / 2, 1));
+	}
+	return Size;
+}
+
+template <typename PixelType>
+TUniquePtr<FImagePixelData> FImagePyramid::DownsamplePixels(const FImagePixelData* PixelData, const bool bAverage)
+{
+	const TArray64<PixelType>& SourcePixels = static_cast<const TImagePixelData<PixelType>*>(PixelData)->Pixels;
+	const FIntPoint SourceSize = PixelData->GetSize();
+	const FIntPoint Size = LevelSize(SourceSize, 1);
+
+	TArray64<PixelType> Pixels;
+	Pixels.SetNumUninitialized(static_cast<int64>(Size.X) * Size.Y);
+	for (int64 y = 0; y < Size.Y; y++)
+	{
+		// Images with a single row or column reuse it for both block rows or columns
+		const PixelType* Row0 = SourcePixels.GetData() + FMath::Min<int64>(2 * y, SourceSize.Y - 1) * SourceSize.X;
+		const PixelType* Row1 = SourcePixels.GetData() + FMath::Min<int64>(2 * y + 1, SourceSize.Y - 1) * SourceSize.X;
+		PixelType* Row = Pixels.GetData() + y * Size.X;
+		for (int64 x = 0; x < Size.X; x++)
+		{
+			const int64 x0 = FMath::Min<int64>(2 * x, SourceSize.X - 1);
+			const int64 x1 = FMath::Min<int64>(2 * x + 1, SourceSize.X - 1);
+			const PixelType Block[4] = { Row0[x0], Row0[x1], Row1[x0], Row1[x1] };
+			Row[x] = bAverage ? AveragePixels(Block) : MostFrequentPixel(Block);
+		}
+	}
+
+	// Pass payloads carry the metadata outputs rely on, such as whether the image requires transparency
+	FImagePixelPayloadPtr Payload;
+	if (const FImagePixelDataPayload* SourcePayload = PixelData->GetPayload<FImagePixelDataPayload>())
+	{
+		Payload = SourcePayload->Copy();
+	}
+	return MakeUnique<TImagePixelData<PixelType>>(Size, MoveTemp(Pixels), Payload);
+}
+
+FColor FImagePyramid::AveragePixels(const FColor (&Block)[4])
+{
+	// Rounded to the nearest value
+	return FColor(
+		static_cast<uint8>((Block[0].R + Block[1].R + Block[2].R + Block[3].R + 2) / 4),
+		static_cast<uint8>((Block[0].G + Block[1].G + Block[2].G + Block[3].G + 2) / 4),
+		static_cast<uint8>((Block[0].B + Block[1].B + Block[2].B + Block[3].B + 2) / 4),
+		static_cast<uint8>((Block[0].A + Block[1].A + Block[2].A + Block[3].A + 2) / 4));
+}
+
+FFloat16Color FImagePyramid::AveragePixels(const FFloat16Color (&Block)[4])
+{
+	const FLinearColor LinearBlock[4] = {
+		Block[0].GetFloats(), Block[1].GetFloats(), Block[2].GetFloats(), Block[3].GetFloats() };
+	return FFloat16Color(AveragePixels(LinearBlock));
+}
+
+FLinearColor FImagePyramid::AveragePixels(const FLinearColor (&Block)[4])
+{
+	return (Block[0] + Block[1] + Block[2] + Block[3]) * 0.25f;
+}
+
+template <typename PixelType>
+PixelType FImagePyramid::MostFrequentPixel(const PixelType (&Block)[4])
+{
+	// Pixels are compared bitwise, as ids have to be kept exactly
+	int BestIndex = 0;
+	int BestCount = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		int Count = 0;
+		for (int j = 0; j < 4; j++)
+		{
+			Count += FMemory::Memcmp(&Block[i], &Block[j], sizeof(PixelType)) == 0 ? 1 : 0;
+		}
+		if (Count > BestCount)
+		{
+			BestIndex = i;
+			BestCount = Count;
+		}
+	}
+	return Block[BestIndex];
+}
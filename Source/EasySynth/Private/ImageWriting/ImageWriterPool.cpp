@@ -0,0 +1,172 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "ImageWriting/ImageWriterPool.h"
+
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/IQueuedWork.h"
+#include "Misc/QueuedThreadPool.h"
+
+#include "EasySynth.h"
+
+
+TMap<EImageFormat, TUniquePtr<FImageWriterPool>> FImageWriterPool::Pools;
+int32 FImageWriterPool::MaxInFlightImages = 16;
+const uint32 FImageWriterPool::InFlightWaitIntervalMs = 10;
+const uint32 FImageWriterPool::WriterThreadStackSize = 1024 * 1024;
+
+class FImageWriterPool::FWriteWork : public IQueuedWork
+{
+public:
+	FWriteWork(FImageWriterPool* InOwner, TUniquePtr<IImageWriteTaskBase>&& InTask) :
+		Owner(InOwner),
+		Task(MoveTemp(InTask))
+	{}
+
+	/** Runs the write task and deletes the work */
+	void DoThreadedWork() override
+	{
+		Promise.SetValue(Task->RunTask());
+		Finish();
+	}
+
+	/** Abandons the write task and deletes the work */
+	void Abandon() override
+	{
+		Task->OnAbandoned();
+		Promise.SetValue(false);
+		Finish();
+	}
+
+	/** Promise fulfilled with the task success once it runs */
+	TPromise<bool> Promise;
+
+private:
+	/** Releases the task data before notifying the owner, so that the memory is freed when the slot is */
+	void Finish()
+	{
+		FImageWriterPool* LocalOwner = Owner;
+		delete this;
+		LocalOwner->OnTaskFinished();
+	}
+
+	/** Pool the work was queued to */
+	FImageWriterPool* Owner;
+
+	/** The image write task */
+	TUniquePtr<IImageWriteTaskBase> Task;
+};
+
+FImageWriterPool::FImageWriterPool(const TCHAR* PoolName, const int32 NumThreads) :
+	ThreadPool(FQueuedThreadPool::Allocate()),
+	TaskFinishedEvent(FPlatformProcess::GetSynchEventFromPool(false))
+{
+	verify(ThreadPool->Create(FMath::Max(NumThreads, 1), WriterThreadStackSize, TPri_BelowNormal, PoolName));
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Created the %s with %d threads"), *FString(__FUNCTION__), PoolName, FMath::Max(NumThreads, 1))
+}
+
+FImageWriterPool::~FImageWriterPool()
+{
+	// Destroying the pool abandons queued tasks and waits for the running ones
+	ThreadPool->Destroy();
+	delete ThreadPool;
+	FPlatformProcess::ReturnSynchEventToPool(TaskFinishedEvent);
+
+	// Release anyone waiting for the abandoned tasks
+	FScopeLock Lock(&FencesCriticalSection);
+	for (TPromise<void>& Fence : PendingFences)
+	{
+		Fence.SetValue();
+	}
+	PendingFences.Empty();
+}
+
+FImageWriterPool& FImageWriterPool::ForImageFormat(const EImageFormat ImageFormat)
+{
+	TUniquePtr<FImageWriterPool>* Pool = Pools.Find(ImageFormat);
+	if (Pool != nullptr)
+	{
+		return **Pool;
+	}
+
+	// EXR compression is the most expensive, so it gets a thread per core,
+	// while PNG and JPEG encoding is fast enough to leave cores to the rendering
+	const int32 NumCores = FPlatformMisc::NumberOfCores();
+	switch (ImageFormat)
+	{
+	case EImageFormat::EXR: return *Pools.Add(ImageFormat, MakeUnique<FImageWriterPool>(TEXT("EasySynthExrWriterPool"), NumCores));
+	case EImageFormat::PNG: return *Pools.Add(ImageFormat, MakeUnique<FImageWriterPool>(TEXT("EasySynthPngWriterPool"), NumCores / 2));
+	case EImageFormat::JPEG: return *Pools.Add(ImageFormat, MakeUnique<FImageWriterPool>(TEXT("EasySynthJpegWriterPool"), NumCores / 4));
+	default: return *Pools.Add(ImageFormat, MakeUnique<FImageWriterPool>(TEXT("EasySynthImageWriterPool"), 1));
+	}
+}
+
+int32 FImageWriterPool::NumPendingImages()
+{
+	int32 PendingImages = 0;
+	for (const TPair<EImageFormat, TUniquePtr<FImageWriterPool>>& Pool : Pools)
+	{
+		PendingImages += Pool.Value->GetNumPendingTasks();
+	}
+	return PendingImages;
+}
+
+void FImageWriterPool::ShutdownPools()
+{
+	Pools.Empty();
+}
+
+TFuture<bool> FImageWriterPool::Enqueue(TUniquePtr<IImageWriteTaskBase>&& InTask, bool bInsertAtFront)
+{
+	// Block the caller, which throttles the rendering, until enough of the in-flight images are written
+	if (MaxInFlightImages > 0 && NumPendingTasks.GetValue() >= MaxInFlightImages)
+	{
+		UE_LOG(LogEasySynth, Verbose, TEXT("%s: Waiting for %d in-flight images to be written"),
+			*FString(__FUNCTION__), NumPendingTasks.GetValue())
+		while (NumPendingTasks.GetValue() >= MaxInFlightImages)
+		{
+			TaskFinishedEvent->Wait(InFlightWaitIntervalMs);
+		}
+	}
+
+	FWriteWork* Work = new FWriteWork(this, MoveTemp(InTask));
+	TFuture<bool> Future = Work->Promise.GetFuture();
+	NumPendingTasks.Increment();
+	ThreadPool->AddQueuedWork(Work, bInsertAtFront ? EQueuedWorkPriority::Highest : EQueuedWorkPriority::Normal);
+
+	return Future;
+}
+
+TFuture<void> FImageWriterPool::CreateFence()
+{
+	FScopeLock Lock(&FencesCriticalSection);
+
+	// Tasks finish out of order, so the fence waits for the pool to become idle
+	if (NumPendingTasks.GetValue() == 0)
+	{
+		TPromise<void> FulfilledFence;
+		FulfilledFence.SetValue();
+		return FulfilledFence.GetFuture();
+	}
+	return PendingFences.AddDefaulted_GetRef().GetFuture();
+}
+
+TFuture<void> FImageWriterPool::GetLastFence()
+{
+	// Every fence is fulfilled once the pool becomes idle, so a new fence is equivalent to the last one
+	return CreateFence();
+}
+
+void FImageWriterPool::OnTaskFinished()
+{
+	FScopeLock Lock(&FencesCriticalSection);
+	if (NumPendingTasks.Decrement() == 0)
+	{
+		for (TPromise<void>& Fence : PendingFences)
+		{
+			Fence.SetValue();
+		}
+		PendingFences.Empty();
+	}
+	TaskFinishedEvent->Trigger();
+}
@@ -0,0 +1,578 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "ImageWriting/OpticalFlowPostProcessor.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+#include "EasySynth.h"
+#include "PathUtils.h"
+#include "RendererTargets/OutputFramesScanner.h"
+
+#if WITH_UNREALEXR
+THIRD_PARTY_INCLUDES_START
+#include "Imath/ImathBox.h"
+#include "OpenEXR/ImfChannelList.h"
+#include "OpenEXR/ImfHeader.h"
+#include "OpenEXR/ImfIO.h"
+#include "OpenEXR/ImfInputFile.h"
+#include "OpenEXR/ImfOutputFile.h"
+THIRD_PARTY_INCLUDES_END
+#endif // WITH_UNREALEXR
+
+
+const float FOpticalFlowPostProcessor::OcclusionDepthTolerance = 0.05f;
+const float FOpticalFlowPostProcessor::ConsistencyTolerancePixels = 1.0f;
+
+#if WITH_UNREALEXR
+/**
+ * Input stream reading the exr image loaded into memory, so that files are read through the engine file manager
+*/
+class FExrMemoryStreamIn : public Imf::IStream
+{
+public:
+	FExrMemoryStreamIn(const FString& FilePath, const TArray64<uint8>& Data) :
+		Imf::IStream(TCHAR_TO_ANSI(*FilePath)),
+		Data(Data)
+	{}
+
+	/** Reads the next bytes, missing bytes are zeroed and reported by the HasError */
+	bool read(char c[], int n) override
+	{
+		const int64 Available = FMath::Clamp<int64>(Data.Num() - Position, 0, n);
+		FMemory::Memcpy(c, Data.GetData() + Position, Available);
+		if (Available < n)
+		{
+			FMemory::Memzero(c + Available, n - Available);
+			bError = true;
+		}
+		Position += n;
+		return Position < Data.Num();
+	}
+
+	/** Returns the current reading position */
+	uint64_t tellg() override { return Position; }
+
+	/** Sets the current reading position */
+	void seekg(uint64_t Pos) override { Position = Pos; }
+
+	/** Checks whether any of the reads went past the end of the image */
+	bool HasError() const { return bError; }
+
+private:
+	/** Loaded image file */
+	const TArray64<uint8>& Data;
+
+	/** Current reading position */
+	int64 Position = 0;
+
+	/** Whether any of the reads went past the end of the image */
+	bool bError = false;
+};
+
+/**
+ * Output stream encoding the exr image into memory, so that files are written through the engine file manager
+*/
+class FExrMemoryStreamOut : public Imf::OStream
+{
+public:
+	explicit FExrMemoryStreamOut(const FString& FilePath) :
+		Imf::OStream(TCHAR_TO_ANSI(*FilePath))
+	{}
+
+	/** Writes the bytes at the current position, the line offset table is written over the reserved bytes */
+	void write(const char c[], int n) override
+	{
+		if (Position + n > Data.Num())
+		{
+			Data.SetNumUninitialized(Position + n);
+		}
+		FMemory::Memcpy(Data.GetData() + Position, c, n);
+		Position += n;
+	}
+
+	/** Returns the current writing position */
+	uint64_t tellp() override { return Position; }
+
+	/** Sets the current writing position */
+	void seekp(uint64_t Pos) override { Position = Pos; }
+
+	/** Encoded image file */
+	TArray64<uint8> Data;
+
+private:
+	/** Current writing position */
+	int64 Position = 0;
+};
+#endif // WITH_UNREALEXR
+
+bool FOpticalFlowPostProcessor::ProcessCameraDirectory(
+	const FString& CameraDirectory,
+	const FString& FlowDirName,
+	const FString& DepthDirName,
+	const FString& PackedDirName) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FOpticalFlowPostProcessor::ProcessCameraDirectory);
+
+	// Targets packed into the same images are only found inside the packed images directory
+	TMap<int, FString> FlowFiles = FindFrameFiles(CameraDirectory / FlowDirName);
+	TMap<int, FString> DepthFiles = FindFrameFiles(CameraDirectory / DepthDirName);
+	const TMap<int, FString> PackedFiles = FindFrameFiles(CameraDirectory / PackedDirName);
+	if (FlowFiles.Num() == 0)
+	{
+		FlowFiles = PackedFiles;
+	}
+	if (DepthFiles.Num() == 0)
+	{
+		DepthFiles = PackedFiles;
+	}
+	if (FlowFiles.Num() == 0)
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: No exr optical flow images inside %s"), *FString(__FUNCTION__), *CameraDirectory)
+		return true;
+	}
+
+	const FString OutputDirectory = FPathUtils::OpticalFlowDataDir(CameraDirectory);
+	if (!IFileManager::Get().MakeDirectory(*OutputDirectory, true))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not create %s"), *FString(__FUNCTION__), *OutputDirectory)
+		return false;
+	}
+
+	// Frames do not depend on each other's results, so each of them is processed by its own worker
+	TArray<int> Frames;
+	FlowFiles.GenerateKeyArray(Frames);
+	TArray<bool> Processed;
+	Processed.Init(false, Frames.Num());
+	ParallelFor(Frames.Num(), [this, &Frames, &FlowFiles, &DepthFiles, &OutputDirectory, &Processed](const int32 Index)
+	{
+		const FString& FlowFilePath = FlowFiles[Frames[Index]];
+		Processed[Index] = ProcessFrame(
+			Frames[Index], FlowFilePath, DepthFiles, OutputDirectory / FPaths::GetCleanFilename(FlowFilePath));
+	});
+	if (Processed.Contains(false))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while processing optical flow images inside %s"),
+			*FString(__FUNCTION__), *CameraDirectory)
+		return false;
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Processed %d optical flow images into %s"),
+		*FString(__FUNCTION__), Frames.Num(), *OutputDirectory)
+	return true;
+}
+
+FVector2f FOpticalFlowPostProcessor::DecodeFlowColor(
+	const float R,
+	const float G,
+	const float B,
+	const FIntPoint& Size,
+	const float Scale)
+{
+	// Flow colors use the HSV color wheel, the hue is the vector angle and the saturation its scaled length,
+	// while the vector coordinates are relative to the image size and point from the current to the previous position
+	const float Max = FMath::Max3(R, G, B);
+	const float Min = FMath::Min3(R, G, B);
+	const float Delta = Max - Min;
+	if (Max <= 0.0f || Delta <= 0.0f)
+	{
+		return FVector2f::ZeroVector;
+	}
+
+	float HueDegrees;
+	if (Max == R)
+	{
+		HueDegrees = 60.0f * (G - B) / Delta;
+	}
+	else if (Max == G)
+	{
+		HueDegrees = 120.0f + 60.0f * (B - R) / Delta;
+	}
+	else
+	{
+		HueDegrees = 240.0f + 60.0f * (R - G) / Delta;
+	}
+	const float Saturation = Delta / Max;
+	const float Angle = FMath::DegreesToRadians(HueDegrees);
+	const float SafeScale = Scale > 0.0f ? Scale : 1.0f;
+	return FVector2f(
+		-Size.X * Saturation * FMath::Cos(Angle) / SafeScale,
+		-Size.Y * Saturation * FMath::Sin(Angle) / SafeScale);
+}
+
+bool FOpticalFlowPostProcessor::ProcessFrame(
+	const int FrameNumber,
+	const FString& FlowFilePath,
+	const TMap<int, FString>& DepthFilePaths,
+	const FString& OutputFilePath) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FOpticalFlowPostProcessor::ProcessFrame);
+
+	FFrameChannels Flow;
+	if (!ReadFlow(FlowFilePath, Flow))
+	{
+		return false;
+	}
+
+	const FString* DepthFilePath = DepthFilePaths.Find(FrameNumber);
+	if (DepthFilePath == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: No exr depth image matches %s"), *FString(__FUNCTION__), *FlowFilePath)
+		return false;
+	}
+	FFrameChannels Depth;
+	if (!ReadDepth(*DepthFilePath, Depth))
+	{
+		return false;
+	}
+	if (Depth.Size != Flow.Size)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Size of %s does not match %s"), *FString(__FUNCTION__), **DepthFilePath, *FlowFilePath)
+		return false;
+	}
+
+	// Depth of neighbouring frames is only available if they were rendered
+	const FIntPoint Size = Flow.Size;
+	auto ReadNeighbourDepth = [this, &DepthFilePaths, &Size](const int NeighbourFrame, FFrameChannels& OutDepth)
+	{
+		const FString* FilePath = DepthFilePaths.Find(NeighbourFrame);
+		return FilePath != nullptr && ReadDepth(*FilePath, OutDepth) && OutDepth.Size == Size;
+	};
+
+	const int64 PixelCount = static_cast<int64>(Size.X) * Size.Y;
+	const TArray64<float>& FlowU = Flow.Channels[0];
+	const TArray64<float>& FlowV = Flow.Channels[1];
+	TArray64<FFloat16> BackwardOcclusion;
+	TArray64<FFloat16> ForwardOcclusion;
+	TArray64<FFloat16> Consistency;
+	BackwardOcclusion.Init(FFloat16(0.0f), PixelCount);
+	ForwardOcclusion.Init(FFloat16(0.0f), PixelCount);
+	Consistency.Init(FFloat16(0.0f), PixelCount);
+
+	// Content of a pixel is occluded if it ends up outside of the other image,
+	// or if the other frame renders something closer at its position
+	auto IsOccluded = [&Size](const float X, const float Y, const float ExpectedDepth, const FFrameChannels* OtherDepth)
+	{
+		const int64 PixelX = FMath::FloorToInt64(X);
+		const int64 PixelY = FMath::FloorToInt64(Y);
+		if (ExpectedDepth <= 0.0f || PixelX < 0 || PixelY < 0 || PixelX >= Size.X || PixelY >= Size.Y)
+		{
+			return true;
+		}
+		return OtherDepth != nullptr &&
+			OtherDepth->Channels[0][PixelY * Size.X + PixelX] < ExpectedDepth * (1.0f - OcclusionDepthTolerance);
+	};
+
+	// The rendered flow points to the previous frame, from where the content is reprojected back using the previous depth,
+	// so that its distance from the starting pixel is the forward-backward consistency error
+	TArray64<float> ReprojectedX;
+	TArray64<float> ReprojectedY;
+	TArray64<float> ReprojectedDepth;
+	if (ReprojectDepth(Depth, FrameNumber, FrameNumber - 1, ReprojectedX, ReprojectedY, ReprojectedDepth))
+	{
+		FFrameChannels PreviousDepth;
+		TArray64<float> BackX;
+		TArray64<float> BackY;
+		TArray64<float> BackDepth;
+		const bool bPreviousDepth =
+			ReadNeighbourDepth(FrameNumber - 1, PreviousDepth) &&
+			ReprojectDepth(PreviousDepth, FrameNumber - 1, FrameNumber, BackX, BackY, BackDepth);
+		const float ToleranceSquared = ConsistencyTolerancePixels * ConsistencyTolerancePixels;
+		for (int64 Pixel = 0; Pixel < PixelCount; Pixel++)
+		{
+			const float X = Pixel % Size.X + 0.5f;
+			const float Y = Pixel / Size.X + 0.5f;
+			const float PreviousX = X + FlowU[Pixel];
+			const float PreviousY = Y + FlowV[Pixel];
+			const bool bOccluded = IsOccluded(
+				PreviousX, PreviousY, ReprojectedDepth[Pixel], bPreviousDepth ? &PreviousDepth : nullptr);
+			BackwardOcclusion[Pixel] = FFloat16(bOccluded ? 1.0f : 0.0f);
+			if (bOccluded || !bPreviousDepth)
+			{
+				continue;
+			}
+
+			// The reprojected position of the nearest previous pixel is shifted by the offset from its center
+			const int64 PreviousPixelX = FMath::FloorToInt64(PreviousX);
+			const int64 PreviousPixel = FMath::FloorToInt64(PreviousY) * Size.X + PreviousPixelX;
+			const float ErrorX = BackX[PreviousPixel] + PreviousX - (PreviousPixelX + 0.5f) - X;
+			const float ErrorY = BackY[PreviousPixel] + PreviousY - (FMath::FloorToFloat(PreviousY) + 0.5f) - Y;
+			const bool bConsistent =
+				BackDepth[PreviousPixel] > 0.0f && ErrorX * ErrorX + ErrorY * ErrorY <= ToleranceSquared;
+			Consistency[Pixel] = FFloat16(bConsistent ? 1.0f : 0.0f);
+		}
+	}
+
+	// There is no rendered flow toward the next frame, so its positions only come from the reprojected depth
+	if (ReprojectDepth(Depth, FrameNumber, FrameNumber + 1, ReprojectedX, ReprojectedY, ReprojectedDepth))
+	{
+		FFrameChannels NextDepth;
+		const bool bNextDepth = ReadNeighbourDepth(FrameNumber + 1, NextDepth);
+		for (int64 Pixel = 0; Pixel < PixelCount; Pixel++)
+		{
+			const bool bOccluded = IsOccluded(
+				ReprojectedX[Pixel], ReprojectedY[Pixel], ReprojectedDepth[Pixel], bNextDepth ? &NextDepth : nullptr);
+			ForwardOcclusion[Pixel] = FFloat16(bOccluded ? 1.0f : 0.0f);
+		}
+	}
+
+	return WriteExr(
+		OutputFilePath,
+		Size,
+		{ { TEXT("U"), &FlowU }, { TEXT("V"), &FlowV } },
+		{
+			{ TEXT("occlusion_backward"), &BackwardOcclusion },
+			{ TEXT("occlusion_forward"), &ForwardOcclusion },
+			{ TEXT("consistency"), &Consistency }
+		});
+}
+
+bool FOpticalFlowPostProcessor::ReprojectDepth(
+	const FFrameChannels& Depth,
+	const int FrameNumber,
+	const int OtherFrameNumber,
+	TArray64<float>& OutX,
+	TArray64<float>& OutY,
+	TArray64<float>& OutDepth) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FOpticalFlowPostProcessor::ReprojectDepth);
+
+	const int PoseId = FrameNumber - FirstPoseFrame;
+	const int OtherPoseId = OtherFrameNumber - FirstPoseFrame;
+	if (!CameraPoses.IsValidIndex(PoseId) || !CameraPoses.IsValidIndex(OtherPoseId))
+	{
+		return false;
+	}
+
+	// Intrinsics match the ones exported with the camera rig, with square pixels and the centered principal point
+	const FIntPoint& Size = Depth.Size;
+	const float FocalLength = Size.X / 2.0f / FMath::Tan(FMath::DegreesToRadians(FieldOfView / 2.0f));
+	const float PrincipalPointX = Size.X / 2.0f;
+	const float PrincipalPointY = Size.Y / 2.0f;
+
+	// Camera space points are transformed from the camera of the frame into the camera of the other frame,
+	// inside which X points forward, Y to the right and Z upward
+	const FMatrix44f Transform((CameraPoses[PoseId] * CameraPoses[OtherPoseId].Inverse()).ToMatrixNoScale());
+	const FVector3f Forward(Transform.M[0][0], Transform.M[0][1], Transform.M[0][2]);
+	const FVector3f Right(Transform.M[1][0], Transform.M[1][1], Transform.M[1][2]);
+	const FVector3f Up(Transform.M[2][0], Transform.M[2][1], Transform.M[2][2]);
+	const FVector3f Translation(Transform.M[3][0], Transform.M[3][1], Transform.M[3][2]);
+
+	const int64 PixelCount = static_cast<int64>(Size.X) * Size.Y;
+	OutX.SetNumUninitialized(PixelCount);
+	OutY.SetNumUninitialized(PixelCount);
+	OutDepth.SetNumUninitialized(PixelCount);
+	for (int64 Y = 0; Y < Size.Y; Y++)
+	{
+		// Rays of a row change linearly with the pixel column, so the loop below has no dependencies between pixels
+		// and only consists of multiply-adds over contiguous arrays, which compilers vectorize
+		const float RayUp = -(Y + 0.5f - PrincipalPointY) / FocalLength;
+		const FVector3f RayStart = Forward + Right * ((0.5f - PrincipalPointX) / FocalLength) + Up * RayUp;
+		const FVector3f RayStep = Right / FocalLength;
+
+		const float* DepthRow = Depth.Channels[0].GetData() + Y * Size.X;
+		float* XRow = OutX.GetData() + Y * Size.X;
+		float* YRow = OutY.GetData() + Y * Size.X;
+		float* DepthOutRow = OutDepth.GetData() + Y * Size.X;
+		for (int32 X = 0; X < Size.X; X++)
+		{
+			const float PointX = DepthRow[X] * (RayStart.X + X * RayStep.X) + Translation.X;
+			const float PointY = DepthRow[X] * (RayStart.Y + X * RayStep.Y) + Translation.Y;
+			const float PointZ = DepthRow[X] * (RayStart.Z + X * RayStep.Z) + Translation.Z;
+			const float InvPointX = 1.0f / FMath::Max(PointX, UE_KINDA_SMALL_NUMBER);
+			XRow[X] = PrincipalPointX + FocalLength * PointY * InvPointX;
+			YRow[X] = PrincipalPointY - FocalLength * PointZ * InvPointX;
+			DepthOutRow[X] = PointX;
+		}
+	}
+
+	return true;
+}
+
+bool FOpticalFlowPostProcessor::ReadFlow(const FString& FilePath, FFrameChannels& OutFlow) const
+{
+	// Flow written by the plugin is already decoded, only flow rendered in a single pass keeps its colors
+	static const TArray<TArray<FString>> FlowChannelSets = {
+		{ TEXT("U"), TEXT("V") },
+		{ TEXT("flow.U"), TEXT("flow.V") },
+		{ TEXT("R"), TEXT("G"), TEXT("B") }
+	};
+	if (!ReadExrChannels(FilePath, FlowChannelSets, OutFlow))
+	{
+		return false;
+	}
+	if (OutFlow.Channels.Num() == 2)
+	{
+		return true;
+	}
+
+	const int64 PixelCount = static_cast<int64>(OutFlow.Size.X) * OutFlow.Size.Y;
+	TArray64<float>& R = OutFlow.Channels[0];
+	TArray64<float>& G = OutFlow.Channels[1];
+	for (int64 Pixel = 0; Pixel < PixelCount; Pixel++)
+	{
+		const FVector2f Offset = DecodeFlowColor(R[Pixel], G[Pixel], OutFlow.Channels[2][Pixel], OutFlow.Size, OpticalFlowScale);
+		R[Pixel] = Offset.X;
+		G[Pixel] = Offset.Y;
+	}
+	OutFlow.Channels.SetNum(2);
+	return true;
+}
+
+bool FOpticalFlowPostProcessor::ReadDepth(const FString& FilePath, FFrameChannels& OutDepth) const
+{
+	// Depth rendered in a single pass repeats the value in all color channels
+	static const TArray<TArray<FString>> DepthChannelSets = {
+		{ TEXT("Z") },
+		{ TEXT("depth.Z") },
+		{ TEXT("R") }
+	};
+	if (!ReadExrChannels(FilePath, DepthChannelSets, OutDepth))
+	{
+		return false;
+	}
+
+	const float DepthScaleCentimeters = DepthScaleMeters * 100.0f;
+	for (float& Value : OutDepth.Channels[0])
+	{
+		Value *= DepthScaleCentimeters;
+	}
+	return true;
+}
+
+TMap<int, FString> FOpticalFlowPostProcessor::FindFrameFiles(const FString& Directory)
+{
+	TMap<int, FString> FrameFiles;
+	TArray<FString> FileNames;
+	IFileManager::Get().FindFiles(FileNames, *(Directory / TEXT("*.exr")), true, false);
+	for (const FString& FileName : FileNames)
+	{
+		int FrameNumber;
+		if (FOutputFramesScanner::ParseFrameNumber(FileName, FrameNumber))
+		{
+			FrameFiles.Add(FrameNumber, Directory / FileName);
+		}
+	}
+	return FrameFiles;
+}
+
+bool FOpticalFlowPostProcessor::ReadExrChannels(
+	const FString& FilePath,
+	const TArray<TArray<FString>>& ChannelSets,
+	FFrameChannels& OutChannels)
+{
+#if WITH_UNREALEXR
+	TRACE_CPUPROFILER_EVENT_SCOPE(FOpticalFlowPostProcessor::ReadExrChannels);
+
+	// Incomplete images would be read past their end
+	TArray64<uint8> FileData;
+	if (!FOutputFramesScanner::IsImageFileComplete(FilePath, EImageFormat::EXR) ||
+		!FFileHelper::LoadFileToArray(FileData, *FilePath))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not read %s"), *FString(__FUNCTION__), *FilePath)
+		return false;
+	}
+
+	// Frames are read in parallel, so each file is decoded by its own thread
+	FExrMemoryStreamIn Stream(FilePath, FileData);
+	Imf::InputFile File(Stream, 0);
+	const Imf::ChannelList& FileChannels = File.header().channels();
+	const TArray<FString>* ChannelNames = ChannelSets.FindByPredicate([&FileChannels](const TArray<FString>& ChannelSet)
+	{
+		return !ChannelSet.ContainsByPredicate([&FileChannels](const FString& ChannelName)
+		{
+			return FileChannels.findChannel(TCHAR_TO_ANSI(*ChannelName)) == nullptr;
+		});
+	});
+	if (ChannelNames == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Expected channels not found inside %s"), *FString(__FUNCTION__), *FilePath)
+		return false;
+	}
+
+	const Imath::Box2i DataWindow = File.header().dataWindow();
+	OutChannels.Size = FIntPoint(DataWindow.max.x - DataWindow.min.x + 1, DataWindow.max.y - DataWindow.min.y + 1);
+	const int64 PixelCount = static_cast<int64>(OutChannels.Size.X) * OutChannels.Size.Y;
+	const int64 WindowOffset = static_cast<int64>(DataWindow.min.y) * OutChannels.Size.X + DataWindow.min.x;
+
+	// Half channels are converted to floats while reading
+	Imf::FrameBuffer FrameBuffer;
+	OutChannels.Channels.SetNum(ChannelNames->Num());
+	for (int i = 0; i < ChannelNames->Num(); i++)
+	{
+		OutChannels.Channels[i].SetNumUninitialized(PixelCount);
+		FrameBuffer.insert(TCHAR_TO_ANSI(*(*ChannelNames)[i]),
+			Imf::Slice(Imf::FLOAT,
+				reinterpret_cast<char*>(OutChannels.Channels[i].GetData() - WindowOffset),
+				sizeof(float),
+				sizeof(float) * OutChannels.Size.X));
+	}
+	File.setFrameBuffer(FrameBuffer);
+	File.readPixels(DataWindow.min.y, DataWindow.max.y);
+
+	if (Stream.HasError())
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not decode %s"), *FString(__FUNCTION__), *FilePath)
+		return false;
+	}
+	return true;
+#else
+	UE_LOG(LogEasySynth, Error, TEXT("%s: Reading exr images is not supported"), *FString(__FUNCTION__))
+	return false;
+#endif // WITH_UNREALEXR
+}
+
+bool FOpticalFlowPostProcessor::WriteExr(
+	const FString& FilePath,
+	const FIntPoint& Size,
+	const TArray<TPair<FString, const TArray64<float>*>>& FloatChannels,
+	const TArray<TPair<FString, const TArray64<FFloat16>*>>& HalfChannels)
+{
+#if WITH_UNREALEXR
+	TRACE_CPUPROFILER_EVENT_SCOPE(FOpticalFlowPostProcessor::WriteExr);
+
+	// Masks mostly consist of long runs of the same value, which the lossless ZIP compression stores compactly
+	Imf::Header Header(Size.X, Size.Y);
+	Header.compression() = Imf::Compression::ZIP_COMPRESSION;
+	Imf::FrameBuffer FrameBuffer;
+	for (const TPair<FString, const TArray64<float>*>& Channel : FloatChannels)
+	{
+		Header.channels().insert(TCHAR_TO_ANSI(*Channel.Key), Imf::Channel(Imf::FLOAT));
+		FrameBuffer.insert(TCHAR_TO_ANSI(*Channel.Key),
+			Imf::Slice(Imf::FLOAT,
+				reinterpret_cast<char*>(const_cast<float*>(Channel.Value->GetData())),
+				sizeof(float),
+				sizeof(float) * Size.X));
+	}
+	for (const TPair<FString, const TArray64<FFloat16>*>& Channel : HalfChannels)
+	{
+		Header.channels().insert(TCHAR_TO_ANSI(*Channel.Key), Imf::Channel(Imf::HALF));
+		FrameBuffer.insert(TCHAR_TO_ANSI(*Channel.Key),
+			Imf::Slice(Imf::HALF,
+				reinterpret_cast<char*>(const_cast<FFloat16*>(Channel.Value->GetData())),
+				sizeof(FFloat16),
+				sizeof(FFloat16) * Size.X));
+	}
+
+	// The line offset table is only written once the file is closed
+	FExrMemoryStreamOut Stream(FilePath);
+	{
+		Imf::OutputFile File(Stream, Header, 0);
+		File.setFrameBuffer(FrameBuffer);
+		File.writePixels(Size.Y);
+	}
+
+	if (!FFileHelper::SaveArrayToFile(Stream.Data, *FilePath))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not write %s"), *FString(__FUNCTION__), *FilePath)
+		return false;
+	}
+	return true;
+#else
+	UE_LOG(LogEasySynth, Error, TEXT("%s: Writing exr images is not supported"), *FString(__FUNCTION__))
+	return false;
+#endif // WITH_UNREALEXR
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "ImageWriting/PalettePngEncoder.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+#include "EasySynth.h"
+
+
+const int FPalettePngEncoder::MaxPaletteSize = 256;
+
+FPalettePngEncoder::FPalettePngEncoder(const TArray<FColor>& Palette) :
+	Palette(Palette)
+{
+	for (int i = 0; i < Palette.Num() && i < MaxPaletteSize; i++)
+	{
+		const FColor OpaqueColor(Palette[i].R, Palette[i].G, Palette[i].B, 255);
+		if (!PaletteIndices.Contains(OpaqueColor))
+		{
+			PaletteIndices.Add(OpaqueColor, static_cast<uint8>(i));
+		}
+	}
+}
+
+bool FPalettePngEncoder::Encode(const FIntPoint Size, const TArray64<FColor>& Pixels, TArray64<uint8>& OutData) const
+{
+	if (Palette.Num() == 0 || Palette.Num() > MaxPaletteSize)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Palette of %d colors can not be stored inside an 8-bit image"),
+			*FString(__FUNCTION__), Palette.Num())
+		return false;
+	}
+	if (Pixels.Num() != static_cast<int64>(Size.X) * Size.Y)
+	{
+		return false;
+	}
+
+	// Each row starts with the filter type byte, with no filtering applied as indices of flat regions compress well
+	const int64 RowSize = Size.X + 1;
+	TArray64<uint8> Rows;
+	Rows.SetNumZeroed(RowSize * Size.Y);
+	FColor LastColor(0, 0, 0, 0);
+	uint8 LastIndex = 0;
+	bool bLastColorValid = false;
+	for (int64 y = 0; y < Size.Y; y++)
+	{
+		uint8* Row = Rows.GetData() + y * RowSize + 1;
+		const FColor* PixelRow = Pixels.GetData() + y * Size.X;
+		for (int64 x = 0; x < Size.X; x++)
+		{
+			// Neighboring pixels mostly share the class, so the last lookup is reused
+			const FColor Color(PixelRow[x].R, PixelRow[x].G, PixelRow[x].B, 255);
+			if (!bLastColorValid || Color != LastColor)
+			{
+				const uint8* Index = PaletteIndices.Find(Color);
+				if (Index == nullptr)
+				{
+					UE_LOG(LogEasySynth, Error, TEXT("%s: Color %s is not inside the palette"),
+						*FString(__FUNCTION__), *Color.ToHex())
+					return false;
+				}
+				LastColor = Color;
+				LastIndex = *Index;
+				bLastColorValid = true;
+			}
+			Row[x] = LastIndex;
+		}
+	}
+
+	uLongf CompressedSize = compressBound(Rows.Num());
+	TArray64<uint8> CompressedRows;
+	CompressedRows.SetNumUninitialized(CompressedSize);
+	if (compress2(CompressedRows.GetData(), &CompressedSize, Rows.GetData(), Rows.Num(), Z_BEST_SPEED) != Z_OK)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not compress the image data"), *FString(__FUNCTION__))
+		return false;
+	}
+	CompressedRows.SetNum(CompressedSize);
+
+	// Header with the 8-bit depth, the indexed color type, and default compression, filter and interlace methods
+	TArray64<uint8> Header;
+	AppendUInt32(Size.X, Header);
+	AppendUInt32(Size.Y, Header);
+	Header.Append({ 8, 3, 0, 0, 0 });
+
+	TArray64<uint8> PaletteData;
+	for (const FColor& Color : Palette)
+	{
+		PaletteData.Append({ Color.R, Color.G, Color.B });
+	}
+
+	OutData.Reset();
+	OutData.Append({ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' });
+	AppendChunk("IHDR", Header, OutData);
+	AppendChunk("PLTE", PaletteData, OutData);
+	AppendChunk("IDAT", CompressedRows, OutData);
+	AppendChunk("IEND", TArray64<uint8>(), OutData);
+	return true;
+}
+
+void FPalettePngEncoder::AppendChunk(const char* ChunkType, const TArray64<uint8>& ChunkData, TArray64<uint8>& OutData)
+{
+	AppendUInt32(ChunkData.Num(), OutData);
+
+	// The checksum covers the chunk type and the data
+	const int64 TypeOffset = OutData.Num();
+	OutData.Append(reinterpret_cast<const uint8*>(ChunkType), 4);
+	OutData.Append(ChunkData);
+	const uLong Checksum = crc32(0, OutData.GetData() + TypeOffset, OutData.Num() - TypeOffset);
+	AppendUInt32(Checksum, OutData);
+}
+
+void FPalettePngEncoder::AppendUInt32(const uint32 Value, TArray64<uint8>& OutData)
+{
+	OutData.Append({
+		static_cast<uint8>(Value >> 24),
+		static_cast<uint8>(Value >> 16),
+		static_cast<uint8>(Value >> 8),
+		static_cast<uint8>(Value) });
+}
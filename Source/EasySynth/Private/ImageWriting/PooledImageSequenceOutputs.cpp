@@ -0,0 +1,147 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "ImageWriting/PooledImageSequenceOutputs.h"
+
+#include "Misc/Paths.h"
+#include "MoviePipeline.h"
+#include "MoviePipelineOutputSetting.h"
+#include "MoviePipelinePrimaryConfig.h"
+#include "MoviePipelineUtils.h"
+
+#include "FrameSelectionSetting.h"
+#include "ImageWriting/EncodedImageWriteTask.h"
+#include "ImageWriting/ImageWriterPool.h"
+#include "RendererTargets/OutputFramesScanner.h"
+
+
+const TCHAR* FEncodedImageSequenceOutput::EngineMainPassName = TEXT("FinalImage");
+
+void FEncodedImageSequenceOutput::EnqueueFrame(
+	UMoviePipelineImageSequenceOutputBase* Output,
+	IImageWriteQueue* ImageWriteQueue,
+	FMoviePipelineMergerOutputFrame* MergedOutputFrame,
+	const EImageFormat ImageFormat,
+	const FImagePyramidSettings& PyramidSettings,
+	const bool bConvertToSrgb,
+	const TArray<FColor>& Palette)
+{
+	check(MergedOutputFrame);
+	UMoviePipeline* Pipeline = Output->GetPipeline();
+	if (!UMoviePipelineFrameSelectionSetting::IsFrameWritten(Pipeline, MergedOutputFrame))
+	{
+		return;
+	}
+
+	UMoviePipelineOutputSetting* OutputSettings = Pipeline->GetPipelinePrimaryConfig()->FindSetting<UMoviePipelineOutputSetting>();
+	check(OutputSettings);
+
+	// Render pass names have to be a part of file names if the frame contains more than one pass
+	FString FileNameFormatString = OutputSettings->FileNameFormat;
+	const bool bIncludeRenderPass = MergedOutputFrame->ImageOutputData.Num() > 1;
+	const bool bTestFrameNumber = true;
+	UE::MoviePipeline::ValidateOutputFormatString(FileNameFormatString, bIncludeRenderPass, bTestFrameNumber);
+	const FString FilePathFormatString = OutputSettings->OutputDirectory.Path / FileNameFormatString;
+	const FString Extension = FOutputFramesScanner::FileExtension(ImageFormat);
+
+	const bool bTakeImageData = IsOnlyEnabledOutput(Output);
+	for (TPair<FMoviePipelinePassIdentifier, TUniquePtr<FImagePixelData>>& RenderPassData : MergedOutputFrame->ImageOutputData)
+	{
+		if (!RenderPassData.Value.IsValid())
+		{
+			continue;
+		}
+
+		TMap<FString, FString> FormatOverrides;
+		FormatOverrides.Add(TEXT("render_pass"), RenderPassData.Key.Name);
+		FormatOverrides.Add(TEXT("ext"), Extension);
+
+		FString FilePath;
+		FMoviePipelineFormatArgs FormatArgs;
+		Pipeline->ResolveFilenameFormatArguments(
+			FilePathFormatString, FormatOverrides, FilePath, FormatArgs, &MergedOutputFrame->FrameOutputState);
+		if (FPaths::IsRelative(FilePath))
+		{
+			FilePath = FPaths::ConvertRelativePathToFull(FilePath);
+		}
+
+		TUniquePtr<FImagePixelData> PixelData =
+			bTakeImageData ? MoveTemp(RenderPassData.Value) : RenderPassData.Value->CopyImageData();
+		const FImagePixelDataPayload* Payload = PixelData->GetPayload<FImagePixelDataPayload>();
+		const bool bRequireTransparentOutput = ImageFormat == EImageFormat::PNG && Payload->bRequireTransparentOutput;
+		const int32 ShotIndex = Payload->SampleState.OutputState.ShotIndex;
+
+		MoviePipeline::FMoviePipelineOutputFutureData OutputData;
+		OutputData.Shot = Pipeline->GetActiveShotList()[ShotIndex];
+		OutputData.PassIdentifier = RenderPassData.Key;
+		OutputData.FilePath = FilePath;
+		Pipeline->AddOutputFuture(
+			ImageWriteQueue->Enqueue(MakeUnique<FEncodedImageWriteTask>(
+				FilePath, ImageFormat, MoveTemp(PixelData), bRequireTransparentOutput, Palette,
+				PyramidSettings.LevelCount, PyramidSettings.AveragesPass(RenderPassData.Key.Name), bConvertToSrgb)),
+			OutputData);
+	}
+}
+
+void FEncodedImageSequenceOutput::RenameMainPass(FMoviePipelineMergerOutputFrame* MergedOutputFrame, const FString& MainPassName)
+{
+	check(MergedOutputFrame);
+	if (MainPassName.IsEmpty())
+	{
+		return;
+	}
+
+	// Outputs receive the same merged frame, so the passes only get renamed by the first of them
+	TArray<FMoviePipelinePassIdentifier> MainPasses;
+	for (const TPair<FMoviePipelinePassIdentifier, TUniquePtr<FImagePixelData>>& RenderPassData : MergedOutputFrame->ImageOutputData)
+	{
+		if (RenderPassData.Key.Name == EngineMainPassName)
+		{
+			MainPasses.Add(RenderPassData.Key);
+		}
+	}
+	for (const FMoviePipelinePassIdentifier& MainPass : MainPasses)
+	{
+		FMoviePipelinePassIdentifier RenamedPass = MainPass;
+		RenamedPass.Name = MainPassName;
+		TUniquePtr<FImagePixelData> PixelData = MoveTemp(MergedOutputFrame->ImageOutputData[MainPass]);
+		MergedOutputFrame->ImageOutputData.Remove(MainPass);
+		MergedOutputFrame->ImageOutputData.Add(RenamedPass, MoveTemp(PixelData));
+	}
+}
+
+bool FEncodedImageSequenceOutput::IsOnlyEnabledOutput(const UMoviePipelineImageSequenceOutputBase* Output)
+{
+	for (const UMoviePipelineSetting* Setting :
+		Output->GetPipeline()->GetPipelinePrimaryConfig()->FindSettingsByClass(UMoviePipelineOutputBase::StaticClass()))
+	{
+		if (Setting != Output && Setting->IsEnabled())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void UMoviePipelineImageSequenceOutput_JPGLocal::OnReceiveImageDataImpl(FMoviePipelineMergerOutputFrame* InMergedOutputFrame)
+{
+	FEncodedImageSequenceOutput::RenameMainPass(InMergedOutputFrame, MainPassName);
+	FEncodedImageSequenceOutput::EnqueueFrame(this, ImageWriteQueue, InMergedOutputFrame, EImageFormat::JPEG, PyramidSettings, bConvertToSrgb);
+}
+
+void UMoviePipelineImageSequenceOutput_JPGLocal::SetupForPipelineImpl(UMoviePipeline* InPipeline)
+{
+	Super::SetupForPipelineImpl(InPipeline);
+	ImageWriteQueue = &FImageWriterPool::ForImageFormat(EImageFormat::JPEG);
+}
+
+void UMoviePipelineImageSequenceOutput_PNGLocal::OnReceiveImageDataImpl(FMoviePipelineMergerOutputFrame* InMergedOutputFrame)
+{
+	FEncodedImageSequenceOutput::RenameMainPass(InMergedOutputFrame, MainPassName);
+	FEncodedImageSequenceOutput::EnqueueFrame(this, ImageWriteQueue, InMergedOutputFrame, EImageFormat::PNG, PyramidSettings, bConvertToSrgb, Palette);
+}
+
+void UMoviePipelineImageSequenceOutput_PNGLocal::SetupForPipelineImpl(UMoviePipeline* InPipeline)
+{
+	Super::SetupForPipelineImpl(InPipeline);
+	ImageWriteQueue = &FImageWriterPool::ForImageFormat(EImageFormat::PNG);
+}
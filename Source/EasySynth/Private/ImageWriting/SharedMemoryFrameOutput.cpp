@@ -0,0 +1,89 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "ImageWriting/SharedMemoryFrameOutput.h"
+
+#include "ImagePixelData.h"
+#include "MovieRenderPipelineDataTypes.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+#include "EasySynth.h"
+#include "FrameSelectionSetting.h"
+#include "ImageWriting/PooledImageSequenceOutputs.h"
+#include "ImageWriting/SharedMemoryFrameRing.h"
+
+
+void UMoviePipelineSharedMemoryOutput::OnReceiveImageDataImpl(FMoviePipelineMergerOutputFrame* InMergedOutputFrame)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UMoviePipelineSharedMemoryOutput::OnReceiveImageDataImpl);
+
+	check(InMergedOutputFrame);
+	if (!UMoviePipelineFrameSelectionSetting::IsFrameWritten(GetPipeline(), InMergedOutputFrame))
+	{
+		return;
+	}
+	FEncodedImageSequenceOutput::RenameMainPass(InMergedOutputFrame, MainPassName);
+
+	FSharedMemoryFrameRing* Ring = FSharedMemoryFrameRing::Get(RegionName, SlotCount, SlotSize);
+	if (!Ring->IsValid())
+	{
+		return;
+	}
+
+	// Passes of all cameras rendered in one job arrive inside the same merged frame, each camera gets its own slot
+	TMap<FString, TArray<FSharedMemoryFrameLayer>> CameraLayers;
+	for (const TPair<FMoviePipelinePassIdentifier, TUniquePtr<FImagePixelData>>& RenderPassData :
+		InMergedOutputFrame->ImageOutputData)
+	{
+		if (!RenderPassData.Value.IsValid())
+		{
+			continue;
+		}
+
+		uint32 PixelType = 0;
+		switch (RenderPassData.Value->GetType())
+		{
+		case EImagePixelType::Color: PixelType = 0; break;
+		case EImagePixelType::Float16: PixelType = 1; break;
+		case EImagePixelType::Float32: PixelType = 2; break;
+		default:
+			UE_LOG(LogEasySynth, Warning, TEXT("%s: Skipping the render pass %s with unsupported pixel type"),
+				*FString(__FUNCTION__), *RenderPassData.Key.Name)
+			continue;
+		}
+
+		FSharedMemoryFrameLayer& Layer = CameraLayers.FindOrAdd(RenderPassData.Key.CameraName).AddDefaulted_GetRef();
+		Layer.Name = RenderPassData.Key.Name;
+		Layer.PixelType = PixelType;
+		Layer.ChannelCount = RenderPassData.Value->GetNumChannels();
+		Layer.Size = RenderPassData.Value->GetSize();
+		RenderPassData.Value->GetRawData(Layer.Data, Layer.DataSize);
+	}
+
+	const int32 FrameNumber = InMergedOutputFrame->FrameOutputState.SourceFrameNumber;
+	for (const TPair<FString, TArray<FSharedMemoryFrameLayer>>& Layers : CameraLayers)
+	{
+		// Frames without a known pose are still published, with the identity pose
+		FTransform CameraPose = FTransform::Identity;
+		int32 CameraId = 0;
+		const FStreamedCamera* Camera = FindCamera(Layers.Key);
+		if (Camera != nullptr)
+		{
+			CameraId = Camera->CameraId;
+			if (Camera->Poses.IsValidIndex(FrameNumber - FirstPoseFrame))
+			{
+				CameraPose = Camera->Poses[FrameNumber - FirstPoseFrame];
+			}
+		}
+
+		Ring->Publish(FrameNumber, CameraId, CameraPose.GetTranslation(), CameraPose.GetRotation(), Layers.Value);
+	}
+}
+
+const FStreamedCamera* UMoviePipelineSharedMemoryOutput::FindCamera(const FString& CameraName) const
+{
+	if (Cameras.Num() == 1)
+	{
+		return &Cameras[0];
+	}
+	return Cameras.FindByPredicate([&CameraName](const FStreamedCamera& Camera) { return Camera.Name == CameraName; });
+}
@@ -0,0 +1,147 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "ImageWriting/SharedMemoryFrameRing.h"
+
+#include "EasySynth.h"
+
+
+TMap<FString, TUniquePtr<FSharedMemoryFrameRing>> FSharedMemoryFrameRing::Rings;
+const int32 FSharedMemoryFrameRing::MaxLayerCount = 8;
+const uint32 FSharedMemoryFrameRing::Magic = 0x52465345;
+const uint32 FSharedMemoryFrameRing::Version = 1;
+const uint32 FSharedMemoryFrameRing::SlotHeaderSize = 1024;
+
+FSharedMemoryFrameRing::FSharedMemoryFrameRing(const FString& Name, const int32 SlotCount, const int64 SlotSize) :
+	Name(Name),
+	SlotCount(SlotCount),
+	SlotSize(SlotSize),
+	Region(nullptr),
+	Header(nullptr)
+{
+	static_assert(sizeof(FSlotHeader) <= 1024, "Slot header does not fit into the reserved slot header size");
+
+	const bool bCreate = true;
+	Region = FPlatformMemory::MapNamedSharedMemoryRegion(
+		Name,
+		bCreate,
+		FPlatformMemory::ESharedMemoryAccess::Read | FPlatformMemory::ESharedMemoryAccess::Write,
+		SlotHeaderSize + SlotCount * SlotSize);
+	if (Region == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not map the shared memory region '%s'"), *FString(__FUNCTION__), *Name)
+		return;
+	}
+
+	// The ring header takes the place of a slot header, so that all of the slots stay aligned
+	Header = static_cast<FRingHeader*>(Region->GetAddress());
+	FMemory::Memzero(Header, SlotHeaderSize);
+	Header->Version = Version;
+	Header->SlotCount = SlotCount;
+	Header->SlotHeaderSize = SlotHeaderSize;
+	Header->SlotSize = SlotSize;
+	for (int64 i = 0; i < SlotCount; i++)
+	{
+		Slot(i)->Sequence = 0;
+	}
+
+	// Readers check the magic value last, once the rest of the header is valid
+	FPlatformMisc::MemoryBarrier();
+	Header->Magic = Magic;
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Publishing frames to the shared memory region '%s', %d slots of %lld bytes"),
+		*FString(__FUNCTION__), *Name, SlotCount, SlotSize)
+}
+
+FSharedMemoryFrameRing::~FSharedMemoryFrameRing()
+{
+	if (Region != nullptr)
+	{
+		FPlatformMemory::UnmapNamedSharedMemoryRegion(Region);
+	}
+}
+
+FSharedMemoryFrameRing* FSharedMemoryFrameRing::Get(const FString& Name, const int32 SlotCount, const int64 SlotSize)
+{
+	TUniquePtr<FSharedMemoryFrameRing>& Ring = Rings.FindOrAdd(Name);
+	if (!Ring.IsValid() || Ring->SlotCount != SlotCount || Ring->SlotSize != SlotSize)
+	{
+		Ring.Reset();
+		Ring = MakeUnique<FSharedMemoryFrameRing>(Name, SlotCount, SlotSize);
+	}
+	return Ring.Get();
+}
+
+void FSharedMemoryFrameRing::ReleaseRings()
+{
+	Rings.Empty();
+}
+
+bool FSharedMemoryFrameRing::Publish(
+	const int32 FrameNumber,
+	const int32 CameraId,
+	const FVector& CameraLocation,
+	const FQuat& CameraRotation,
+	const TArray<FSharedMemoryFrameLayer>& Layers)
+{
+	if (!IsValid())
+	{
+		return false;
+	}
+
+	int64 RequiredSize = SlotHeaderSize;
+	for (const FSharedMemoryFrameLayer& Layer : Layers)
+	{
+		RequiredSize += Layer.DataSize;
+	}
+	if (Layers.Num() > MaxLayerCount || RequiredSize > SlotSize)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Frame %d with %d layers and %lld bytes does not fit into a %lld bytes slot"),
+			*FString(__FUNCTION__), FrameNumber, Layers.Num(), RequiredSize, SlotSize)
+		return false;
+	}
+
+	// Mark the slot as being written, so that readers can discard data overwritten while they read it
+	const int64 FrameIndex = Header->PublishedFrameCount;
+	FSlotHeader* SlotHeader = Slot(FrameIndex % SlotCount);
+	FPlatformAtomics::InterlockedExchange(&SlotHeader->Sequence, 2 * FrameIndex + 1);
+
+	SlotHeader->FrameNumber = FrameNumber;
+	SlotHeader->LayerCount = Layers.Num();
+	SlotHeader->CameraId = CameraId;
+	SlotHeader->Reserved = 0;
+	SlotHeader->CameraLocation[0] = CameraLocation.X;
+	SlotHeader->CameraLocation[1] = CameraLocation.Y;
+	SlotHeader->CameraLocation[2] = CameraLocation.Z;
+	SlotHeader->CameraRotation[0] = CameraRotation.X;
+	SlotHeader->CameraRotation[1] = CameraRotation.Y;
+	SlotHeader->CameraRotation[2] = CameraRotation.Z;
+	SlotHeader->CameraRotation[3] = CameraRotation.W;
+
+	uint8* SlotData = reinterpret_cast<uint8*>(SlotHeader);
+	int64 Offset = SlotHeaderSize;
+	for (int32 i = 0; i < Layers.Num(); i++)
+	{
+		const FSharedMemoryFrameLayer& Layer = Layers[i];
+		FLayerHeader& LayerHeader = SlotHeader->Layers[i];
+		FMemory::Memzero(LayerHeader.Name);
+		FCStringAnsi::Strncpy(LayerHeader.Name, TCHAR_TO_ANSI(*Layer.Name), UE_ARRAY_COUNT(LayerHeader.Name));
+		LayerHeader.PixelType = Layer.PixelType;
+		LayerHeader.ChannelCount = Layer.ChannelCount;
+		LayerHeader.Width = Layer.Size.X;
+		LayerHeader.Height = Layer.Size.Y;
+		LayerHeader.Offset = Offset;
+		LayerHeader.Size = Layer.DataSize;
+		FMemory::Memcpy(SlotData + Offset, Layer.Data, Layer.DataSize);
+		Offset += Layer.DataSize;
+	}
+
+	// Publish the slot only once all of its data is written
+	FPlatformAtomics::InterlockedExchange(&SlotHeader->Sequence, 2 * FrameIndex + 2);
+	FPlatformAtomics::InterlockedExchange(&Header->PublishedFrameCount, FrameIndex + 1);
+	return true;
+}
+
+FSharedMemoryFrameRing::FSlotHeader* FSharedMemoryFrameRing::Slot(const int64 SlotIndex) const
+{
+	return reinterpret_cast<FSlotHeader*>(reinterpret_cast<uint8*>(Header) + SlotHeaderSize + SlotIndex * SlotSize);
+}
@@ -0,0 +1,171 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "ImageWriting/VideoSequenceEncoder.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include "EasySynth.h"
+#include "PathUtils.h"
+#include "RendererTargets/OutputFramesScanner.h"
+
+
+const FString FVideoSequenceEncoder::InputListFileName(TEXT("VideoFrames.txt"));
+const EImageFormat FVideoSequenceEncoder::ImageFormat = EImageFormat::PNG;
+
+bool FVideoSequenceEncoder::EncodeDirectory(const FString& ImagesDirectory, const FString& ImageExtension) const
+{
+	// Collect rendered images ordered by their frame numbers
+	TArray<FString> FileNames;
+	IFileManager::Get().FindFiles(FileNames, *(ImagesDirectory / FString::Printf(TEXT("*.%s"), *ImageExtension)), true, false);
+	TArray<TPair<int, FString>> Frames;
+	for (const FString& FileName : FileNames)
+	{
+		int FrameNumber;
+		if (FOutputFramesScanner::ParseFrameNumber(FileName, FrameNumber))
+		{
+			Frames.Emplace(FrameNumber, ImagesDirectory / FileName);
+		}
+	}
+	if (Frames.Num() == 0)
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: No images to encode inside %s"), *FString(__FUNCTION__), *ImagesDirectory)
+		return true;
+	}
+	Frames.Sort([](const TPair<int, FString>& A, const TPair<int, FString>& B) { return A.Key < B.Key; });
+
+	const FString InputListPath = ImagesDirectory / InputListFileName;
+	const FString VideoFilePath = FPathUtils::VideoFilePath(ImagesDirectory);
+	if (!SaveInputList(Frames, InputListPath) ||
+		!SaveFrameIndex(Frames, FPathUtils::VideoFrameIndexFilePath(ImagesDirectory)))
+	{
+		return false;
+	}
+
+	// Try the hardware encoders until one of them succeeds, ffmpeg fails quickly if the encoder is not available
+	bool bEncoded = false;
+	for (const FString& EncoderName : EncoderNames(Codec))
+	{
+		if (RunEncoder(EncoderName, InputListPath, VideoFilePath))
+		{
+			UE_LOG(LogEasySynth, Log, TEXT("%s: Encoded %d frames into %s using %s"),
+				*FString(__FUNCTION__), Frames.Num(), *VideoFilePath, *EncoderName)
+			bEncoded = true;
+			break;
+		}
+	}
+	if (!bEncoded)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not encode %s, is ffmpeg available at '%s'?"),
+			*FString(__FUNCTION__), *VideoFilePath, *ExecutablePath)
+		return false;
+	}
+
+	// Images are only removed once the video is written
+	const bool bRequireExists = true;
+	const bool bTree = true;
+	IFileManager::Get().DeleteDirectory(*ImagesDirectory, bRequireExists, bTree);
+	return true;
+}
+
+bool FVideoSequenceEncoder::ParseCodec(const FString& CodecName, EVideoCodec& OutCodec)
+{
+	static const TMap<FString, EVideoCodec> Codecs = {
+		{ TEXT("h264"), EVideoCodec::H264 },
+		{ TEXT("hevc"), EVideoCodec::HEVC },
+		{ TEXT("av1"), EVideoCodec::AV1 },
+	};
+
+	const EVideoCodec* Found = Codecs.Find(CodecName.ToLower());
+	if (Found == nullptr)
+	{
+		return false;
+	}
+	OutCodec = *Found;
+	return true;
+}
+
+bool FVideoSequenceEncoder::IsExecutableAvailable(const FString& ExecutablePath)
+{
+	int32 ReturnCode = -1;
+	FString StdErr;
+	if (!FPlatformProcess::ExecProcess(*ExecutablePath, TEXT("-hide_banner -version"), &ReturnCode, nullptr, &StdErr) ||
+		ReturnCode != 0)
+	{
+		UE_LOG(LogEasySynth, Log, TEXT("%s: Could not run '%s': %s"), *FString(__FUNCTION__), *ExecutablePath, *StdErr.TrimEnd())
+		return false;
+	}
+	return true;
+}
+
+bool FVideoSequenceEncoder::SaveInputList(const TArray<TPair<int, FString>>& Frames, const FString& FilePath) const
+{
+	TArray<FString> Lines;
+	Lines.Add(TEXT("ffconcat version 1.0"));
+	const FString FrameDuration = FString::Printf(TEXT("duration %.9f"), 1.0 / FrameRate);
+	for (const TPair<int, FString>& Frame : Frames)
+	{
+		Lines.Add(FString::Printf(TEXT("file '%s'"), *FPaths::ConvertRelativePathToFull(Frame.Value).Replace(TEXT("'"), TEXT("'\\''"))));
+		Lines.Add(FrameDuration);
+	}
+
+	if (!FFileHelper::SaveStringArrayToFile(Lines, *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving the file %s"), *FString(__FUNCTION__), *FilePath)
+		return false;
+	}
+	return true;
+}
+
+bool FVideoSequenceEncoder::SaveFrameIndex(const TArray<TPair<int, FString>>& Frames, const FString& FilePath) const
+{
+	// The id column matches the id column of camera poses files
+	TArray<FString> Lines;
+	Lines.Add("video_frame,id,frame");
+	for (int i = 0; i < Frames.Num(); i++)
+	{
+		Lines.Add(FString::Printf(TEXT("%d,%d,%d"), i, Frames[i].Key - FirstPoseFrame, Frames[i].Key));
+	}
+
+	if (!FFileHelper::SaveStringArrayToFile(Lines, *FilePath))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving the file %s"), *FString(__FUNCTION__), *FilePath)
+		return false;
+	}
+	return true;
+}
+
+bool FVideoSequenceEncoder::RunEncoder(
+	const FString& EncoderName,
+	const FString& InputListPath,
+	const FString& VideoFilePath) const
+{
+	// Every image is passed through as a single video frame, so that the frame index stays valid
+	const FString Params = FString::Printf(
+		TEXT("-y -hide_banner -loglevel error -f concat -safe 0 -i \"%s\" -vsync passthrough -c:v %s -pix_fmt yuv420p \"%s\""),
+		*InputListPath, *EncoderName, *VideoFilePath);
+
+	int32 ReturnCode = -1;
+	FString StdErr;
+	if (!FPlatformProcess::ExecProcess(*ExecutablePath, *Params, &ReturnCode, nullptr, &StdErr) || ReturnCode != 0)
+	{
+		UE_LOG(LogEasySynth, Log, TEXT("%s: Encoder %s is not available: %s"), *FString(__FUNCTION__), *EncoderName, *StdErr.TrimEnd())
+		IFileManager::Get().Delete(*VideoFilePath);
+		return false;
+	}
+	return true;
+}
+
+TArray<FString> FVideoSequenceEncoder::EncoderNames(const EVideoCodec Codec)
+{
+	// NVIDIA, Intel and AMD hardware encoders, followed by the software encoder
+	switch (Codec)
+	{
+	case EVideoCodec::H264: return { TEXT("h264_nvenc"), TEXT("h264_qsv"), TEXT("h264_amf"), TEXT("libx264") }; break;
+	case EVideoCodec::HEVC: return { TEXT("hevc_nvenc"), TEXT("hevc_qsv"), TEXT("hevc_amf"), TEXT("libx265") }; break;
+	case EVideoCodec::AV1: return { TEXT("av1_nvenc"), TEXT("av1_qsv"), TEXT("av1_amf"), TEXT("libsvtav1") }; break;
+	default: return {};
+	}
+}
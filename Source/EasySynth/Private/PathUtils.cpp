@@ -11,8 +11,18 @@ const FString FPathUtils::PostProcessMaterialDirName(TEXT("PostProcessMaterials"
 
 const FString FPathUtils::TextureMappingAssetName(TEXT("TextureMappingAsset"));
 const FString FPathUtils::WidgetStateAssetName(TEXT("WidgetStateAsset"));
+const FString FPathUtils::SemanticMaterialsDirName(TEXT("SemanticMaterials"));
 
 const FString FPathUtils::RenderingOutputDirName(TEXT("RenderingOutput"));
 const FString FPathUtils::CameraRigFileName(TEXT("CameraRig.json"));
 const FString FPathUtils::SemanticClassesFileName(TEXT("SemanticClasses.csv"));
+const FString FPathUtils::InstanceIdsFileName(TEXT("InstanceIds.csv"));
 const FString FPathUtils::CameraPosesFileName(TEXT("CameraPoses.csv"));
+const FString FPathUtils::BinaryPosesFileExtension(TEXT("npy"));
+const FString FPathUtils::DatasetArchiveBaseName(TEXT("Dataset"));
+const FString FPathUtils::DatasetIndexFileName(TEXT("DatasetIndex.csv"));
+const FString FPathUtils::VideoFileExtension(TEXT("mp4"));
+const FString FPathUtils::VideoFrameIndexFileSuffix(TEXT("Frames.csv"));
+const FString FPathUtils::RenderReportBaseName(TEXT("RenderReport"));
+const FString FPathUtils::PyramidLevelDirPrefix(TEXT("Level"));
+const FString FPathUtils::OpticalFlowDataDirName(TEXT("OpticalFlowData"));
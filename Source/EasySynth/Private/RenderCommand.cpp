@@ -0,0 +1,418 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "RenderCommand.h"
+
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Parse.h"
+
+#include "EasySynth.h"
+#include "SequenceRenderer.h"
+#include "TextureStyles/SemanticCsvInterface.h"
+#include "TextureStyles/TextureStyleManager.h"
+
+
+const TCHAR* FRenderCommand::CommandName = TEXT("EasySynth.Render");
+
+void FRenderCommand::Register(UTextureStyleManager* InTextureStyleManager)
+{
+	TextureStyleManager = InTextureStyleManager;
+
+	// Use a separate renderer, so that the widget state is not affected by the command
+	SequenceRenderer = NewObject<USequenceRenderer>();
+	check(SequenceRenderer)
+	SequenceRenderer->AddToRoot();
+
+	SequenceRenderer->OnRenderingFinished().AddRaw(this, &FRenderCommand::OnRenderingFinished);
+	SequenceRenderer->SetTextureStyleManager(TextureStyleManager);
+
+	ConsoleCommand = IConsoleManager::Get().RegisterConsoleCommand(
+		CommandName,
+		TEXT("Renders level sequences without the plugin widget. Arguments:\n"
+			"Sequences=<comma separated sequence paths> and/or Folder=<content folder containing sequences>\n"
+			"Targets=<comma separated Target:format pairs, e.g. ColorImage:jpeg,DepthImage:exr>\n"
+			"Output=<output directory> [Resolution=<width>x<height>] [DepthRange=<meters>] [OpticalFlowScale=<scale>]\n"
+			"[ExrCompressionLevel=<level>] [MaxInFlightImages=<count>] [ArchiveSizeMB=<megabytes>] [Scheduler=<TextureStyle|CameraMajor>] "
+			"[FrameStride=<frames>] [KeyframeDistance=<centimeters>] [KeyframeAngle=<degrees>] "
+			"[Stream=<shared memory name>] [StreamSlots=<count>] [StreamSlotSizeMB=<megabytes>] "
+			"[PyramidLevels=<count>] [PreloadFrames=<frames>] [ActorClasses=<actor classes CSV file>] "
+			"[VideoCodec=<h264|hevc|av1>] [Ffmpeg=<ffmpeg executable path>] [CustomPPMaterial=<material path>] "
+			"[CameraPoses] [BinaryPoses] [SinglePass] [PackExr] [AllCameras] [Resume] [StencilSemantics] [PaletteSemantics] "
+			"[MetricDepth] [Archive] [FlowMasks] [Quit]"),
+		FConsoleCommandWithArgsDelegate::CreateRaw(this, &FRenderCommand::OnRenderCommand),
+		ECVF_Default);
+}
+
+void FRenderCommand::Unregister()
+{
+	if (ConsoleCommand != nullptr)
+	{
+		IConsoleManager::Get().UnregisterConsoleObject(ConsoleCommand);
+		ConsoleCommand = nullptr;
+	}
+}
+
+void FRenderCommand::OnRenderCommand(const TArray<FString>& Args)
+{
+	if (SequenceRenderer->IsRendering())
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Rendering is already in progress"), *FString(__FUNCTION__))
+		return;
+	}
+
+	// Join arguments back, so that the same parsing utilities as for the command line can be used
+	const FString Params = FString::Join(Args, TEXT(" "));
+	bQuitOnFinish = FParse::Param(*Params, TEXT("Quit"));
+
+	FString SequencesValue;
+	FString FolderValue;
+	FParse::Value(*Params, TEXT("Sequences="), SequencesValue, false);
+	FParse::Value(*Params, TEXT("Folder="), FolderValue, false);
+	TArray<FAssetData> Sequences;
+	if (!FindSequences(SequencesValue, FolderValue, Sequences))
+	{
+		OnRenderingFinished(false);
+		return;
+	}
+
+	FRendererTargetOptions RendererTargetOptions;
+	FString TargetsValue;
+	if (!FParse::Value(*Params, TEXT("Targets="), TargetsValue, false) ||
+		!ParseTargets(TargetsValue, RendererTargetOptions))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Valid Targets= argument is required"), *FString(__FUNCTION__))
+		OnRenderingFinished(false);
+		return;
+	}
+
+	float DepthRange;
+	if (FParse::Value(*Params, TEXT("DepthRange="), DepthRange))
+	{
+		RendererTargetOptions.SetDepthRangeMeters(DepthRange);
+	}
+	float OpticalFlowScale;
+	if (FParse::Value(*Params, TEXT("OpticalFlowScale="), OpticalFlowScale))
+	{
+		RendererTargetOptions.SetOpticalFlowScale(OpticalFlowScale);
+	}
+	int ExrCompressionLevel;
+	if (FParse::Value(*Params, TEXT("ExrCompressionLevel="), ExrCompressionLevel))
+	{
+		RendererTargetOptions.SetExrCompressionLevel(ExrCompressionLevel);
+	}
+	int ArchiveSizeMegabytes;
+	if (FParse::Value(*Params, TEXT("ArchiveSizeMB="), ArchiveSizeMegabytes))
+	{
+		RendererTargetOptions.SetArchiveSizeMegabytes(ArchiveSizeMegabytes);
+	}
+	int MaxInFlightImages;
+	if (FParse::Value(*Params, TEXT("MaxInFlightImages="), MaxInFlightImages))
+	{
+		RendererTargetOptions.SetMaxInFlightImages(MaxInFlightImages);
+	}
+	FString VideoCodecName;
+	if (FParse::Value(*Params, TEXT("VideoCodec="), VideoCodecName))
+	{
+		EVideoCodec VideoCodec;
+		if (!FVideoSequenceEncoder::ParseCodec(VideoCodecName, VideoCodec))
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Unknown video codec '%s', expected h264, hevc or av1"),
+				*FString(__FUNCTION__), *VideoCodecName)
+			OnRenderingFinished(false);
+			return;
+		}
+		RendererTargetOptions.SetVideoCodec(VideoCodec);
+	}
+	FString SchedulerName;
+	if (FParse::Value(*Params, TEXT("Scheduler="), SchedulerName))
+	{
+		ERenderSchedulerType SchedulerType;
+		if (!FRenderScheduler::ParseSchedulerType(SchedulerName, SchedulerType))
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Unknown scheduler '%s', expected TextureStyle or CameraMajor"),
+				*FString(__FUNCTION__), *SchedulerName)
+			OnRenderingFinished(false);
+			return;
+		}
+		RendererTargetOptions.SetSchedulerType(SchedulerType);
+	}
+	int FrameStride;
+	if (FParse::Value(*Params, TEXT("FrameStride="), FrameStride))
+	{
+		if (FrameStride < 1)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Frame stride has to be at least 1"), *FString(__FUNCTION__))
+			OnRenderingFinished(false);
+			return;
+		}
+		RendererTargetOptions.SetFrameStride(FrameStride);
+	}
+	float KeyframeDistance;
+	if (FParse::Value(*Params, TEXT("KeyframeDistance="), KeyframeDistance))
+	{
+		RendererTargetOptions.SetKeyframeDistance(KeyframeDistance);
+	}
+	float KeyframeAngle;
+	if (FParse::Value(*Params, TEXT("KeyframeAngle="), KeyframeAngle))
+	{
+		RendererTargetOptions.SetKeyframeAngle(KeyframeAngle);
+	}
+	FString StreamName;
+	if (FParse::Value(*Params, TEXT("Stream="), StreamName))
+	{
+		RendererTargetOptions.SetStreamName(StreamName);
+	}
+	int StreamSlotCount;
+	if (FParse::Value(*Params, TEXT("StreamSlots="), StreamSlotCount))
+	{
+		RendererTargetOptions.SetStreamSlotCount(StreamSlotCount);
+	}
+	int StreamSlotSizeMegabytes;
+	if (FParse::Value(*Params, TEXT("StreamSlotSizeMB="), StreamSlotSizeMegabytes))
+	{
+		RendererTargetOptions.SetStreamSlotSizeMegabytes(StreamSlotSizeMegabytes);
+	}
+	if (RendererTargetOptions.StreamSlotCount() <= 0 || RendererTargetOptions.StreamSlotSizeMegabytes() <= 0)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Stream slot count and size have to be positive"), *FString(__FUNCTION__))
+		OnRenderingFinished(false);
+		return;
+	}
+	int PyramidLevels;
+	if (FParse::Value(*Params, TEXT("PyramidLevels="), PyramidLevels))
+	{
+		if (PyramidLevels < 1)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Pyramid level count has to be at least 1"), *FString(__FUNCTION__))
+			OnRenderingFinished(false);
+			return;
+		}
+		RendererTargetOptions.SetPyramidLevels(PyramidLevels);
+	}
+	int PreloadFrames;
+	if (FParse::Value(*Params, TEXT("PreloadFrames="), PreloadFrames))
+	{
+		if (PreloadFrames < 0)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Preloaded frame count cannot be negative"), *FString(__FUNCTION__))
+			OnRenderingFinished(false);
+			return;
+		}
+		RendererTargetOptions.SetPreloadFrames(PreloadFrames);
+	}
+	FString VideoEncoderPath;
+	if (FParse::Value(*Params, TEXT("Ffmpeg="), VideoEncoderPath, false))
+	{
+		RendererTargetOptions.SetVideoEncoderPath(VideoEncoderPath);
+	}
+	FString CustomPPMaterialPath;
+	if (FParse::Value(*Params, TEXT("CustomPPMaterial="), CustomPPMaterialPath, false))
+	{
+		FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
+		RendererTargetOptions.SetCustomPPMaterialAssetData(
+			AssetRegistryModule.Get().GetAssetByObjectPath(FSoftObjectPath(CustomPPMaterialPath)));
+	}
+	RendererTargetOptions.SetExportCameraPoses(FParse::Param(*Params, TEXT("CameraPoses")));
+	RendererTargetOptions.SetBinaryCameraPoses(FParse::Param(*Params, TEXT("BinaryPoses")));
+	RendererTargetOptions.SetSinglePassRendering(FParse::Param(*Params, TEXT("SinglePass")));
+	RendererTargetOptions.SetPackExrTargets(FParse::Param(*Params, TEXT("PackExr")));
+	RendererTargetOptions.SetRenderAllCamerasInOneJob(FParse::Param(*Params, TEXT("AllCameras")));
+	RendererTargetOptions.SetResumeRendering(FParse::Param(*Params, TEXT("Resume")));
+	RendererTargetOptions.SetStencilSemantics(FParse::Param(*Params, TEXT("StencilSemantics")));
+	RendererTargetOptions.SetPaletteSemantics(FParse::Param(*Params, TEXT("PaletteSemantics")));
+	RendererTargetOptions.SetMetricDepth(FParse::Param(*Params, TEXT("MetricDepth")));
+	RendererTargetOptions.SetPackOutputArchives(FParse::Param(*Params, TEXT("Archive")));
+	RendererTargetOptions.SetProcessOpticalFlow(FParse::Param(*Params, TEXT("FlowMasks")));
+
+	// Resuming finds written frames by their image files, which packed archives and encoded videos replace
+	if (RendererTargetOptions.ResumeRendering() &&
+		(RendererTargetOptions.PackOutputArchives() || RendererTargetOptions.ColorVideoOutput()))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Resume can not be combined with Archive or ColorImage:video"), *FString(__FUNCTION__))
+		OnRenderingFinished(false);
+		return;
+	}
+
+	FIntPoint OutputImageResolution(1920, 1080);
+	FString ResolutionValue;
+	if (FParse::Value(*Params, TEXT("Resolution="), ResolutionValue))
+	{
+		FString Width;
+		FString Height;
+		if (!ResolutionValue.Split(TEXT("x"), &Width, &Height) ||
+			!Width.IsNumeric() || !Height.IsNumeric())
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Invalid resolution '%s', expected <width>x<height>"),
+				*FString(__FUNCTION__), *ResolutionValue)
+			OnRenderingFinished(false);
+			return;
+		}
+		// Keep the resolution even, same as inside the widget
+		OutputImageResolution = FIntPoint(FCString::Atoi(*Width) / 2 * 2, FCString::Atoi(*Height) / 2 * 2);
+	}
+
+	FString OutputDirectory;
+	if (!FParse::Value(*Params, TEXT("Output="), OutputDirectory, false) || OutputDirectory.IsEmpty())
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Output= argument is required"), *FString(__FUNCTION__))
+		OnRenderingFinished(false);
+		return;
+	}
+
+	// Each sequence is rendered into its own subdirectory when more than one is requested
+	TArray<FString> OutputDirectories;
+	for (const FAssetData& Sequence : Sequences)
+	{
+		OutputDirectories.Add(Sequences.Num() == 1 ? OutputDirectory : OutputDirectory / Sequence.AssetName.ToString());
+	}
+
+	// Actor classes produced by external labeling rules are applied before the rendering starts
+	FString ActorClassesFilePath;
+	if (FParse::Value(*Params, TEXT("ActorClasses="), ActorClassesFilePath, false))
+	{
+		FSemanticCsvInterface SemanticCsvInterface;
+		if (!SemanticCsvInterface.ImportActorClasses(ActorClassesFilePath, TextureStyleManager))
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Could not import actor classes from '%s'"),
+				*FString(__FUNCTION__), *ActorClassesFilePath)
+			OnRenderingFinished(false);
+			return;
+		}
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering %d sequences into %s"),
+		*FString(__FUNCTION__), Sequences.Num(), *OutputDirectory)
+	if (!SequenceRenderer->RenderSequences(Sequences, RendererTargetOptions, OutputImageResolution, OutputDirectories))
+	{
+		OnRenderingFinished(false);
+	}
+}
+
+bool FRenderCommand::FindSequences(
+	const FString& SequencesValue,
+	const FString& FolderValue,
+	TArray<FAssetData>& OutSequences) const
+{
+	FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
+	IAssetRegistry& AssetRegistry = AssetRegistryModule.Get();
+
+	// Make sure all assets are discovered, as commands passed using -ExecCmds can run before the initial scan finishes
+	AssetRegistry.SearchAllAssets(true);
+
+	TArray<FString> SequencePaths;
+	SequencesValue.ParseIntoArray(SequencePaths, TEXT(","));
+	for (const FString& SequencePath : SequencePaths)
+	{
+		const FAssetData AssetData = AssetRegistry.GetAssetByObjectPath(FSoftObjectPath(SequencePath));
+		if (!AssetData.IsValid() || AssetData.AssetClassPath.GetAssetName() != FName("LevelSequence"))
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Could not find level sequence '%s'"),
+				*FString(__FUNCTION__), *SequencePath)
+			return false;
+		}
+		OutSequences.Add(AssetData);
+	}
+
+	if (!FolderValue.IsEmpty())
+	{
+		TArray<FAssetData> FolderSequences;
+		TArray<FAssetData> AssetDataList;
+		AssetRegistry.GetAssetsByPath(FName(*FolderValue), AssetDataList, true);
+		for (const FAssetData& AssetData : AssetDataList)
+		{
+			if (AssetData.AssetClassPath.GetAssetName() == FName("LevelSequence"))
+			{
+				FolderSequences.Add(AssetData);
+			}
+		}
+
+		// Sort sequences so that the rendering order does not depend on the asset registry
+		FolderSequences.Sort([](const FAssetData& A, const FAssetData& B) {
+			return A.PackageName.ToString() < B.PackageName.ToString();
+		});
+		OutSequences.Append(FolderSequences);
+	}
+
+	if (OutSequences.Num() == 0)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: No level sequences to render, use Sequences= or Folder= arguments"),
+			*FString(__FUNCTION__))
+		return false;
+	}
+
+	return true;
+}
+
+bool FRenderCommand::ParseTargets(const FString& TargetsValue, FRendererTargetOptions& OutRendererTargetOptions) const
+{
+	static const TMap<FString, FRendererTargetOptions::TargetType> TargetTypes = {
+		{ TEXT("ColorImage"), FRendererTargetOptions::COLOR_IMAGE },
+		{ TEXT("DepthImage"), FRendererTargetOptions::DEPTH_IMAGE },
+		{ TEXT("NormalImage"), FRendererTargetOptions::NORMAL_IMAGE },
+		{ TEXT("OpticalFlowImage"), FRendererTargetOptions::OPTICAL_FLOW_IMAGE },
+		{ TEXT("SemanticImage"), FRendererTargetOptions::SEMANTIC_IMAGE },
+		{ TEXT("InstanceIdImage"), FRendererTargetOptions::INSTANCE_ID_IMAGE },
+		{ TEXT("CustomPPMaterial"), FRendererTargetOptions::CUSTOM_PP_MATERIAL },
+	};
+	static const TMap<FString, EImageFormat> ImageFormats = {
+		{ TEXT("jpeg"), EImageFormat::JPEG },
+		{ TEXT("png"), EImageFormat::PNG },
+		{ TEXT("exr"), EImageFormat::EXR },
+	};
+
+	TArray<FString> TargetSpecs;
+	TargetsValue.ParseIntoArray(TargetSpecs, TEXT(","));
+	for (const FString& TargetSpec : TargetSpecs)
+	{
+		// The format is optional, in which case the default target format is kept
+		FString TargetName = TargetSpec;
+		FString FormatName;
+		TargetSpec.Split(TEXT(":"), &TargetName, &FormatName);
+
+		const FRendererTargetOptions::TargetType* TargetType = TargetTypes.Find(TargetName);
+		if (TargetType == nullptr)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Unknown target '%s'"), *FString(__FUNCTION__), *TargetName)
+			return false;
+		}
+		OutRendererTargetOptions.SetSelectedTarget(*TargetType, true);
+
+		// Color images can also be encoded into videos, which are rendered as jpeg images
+		if (*TargetType == FRendererTargetOptions::COLOR_IMAGE && FormatName.Equals(TEXT("video"), ESearchCase::IgnoreCase))
+		{
+			OutRendererTargetOptions.SetColorVideoOutput(true);
+			OutRendererTargetOptions.SetOutputFormat(*TargetType, EImageFormat::JPEG);
+		}
+		else if (!FormatName.IsEmpty())
+		{
+			const EImageFormat* ImageFormat = ImageFormats.Find(FormatName.ToLower());
+			if (ImageFormat == nullptr)
+			{
+				UE_LOG(LogEasySynth, Error, TEXT("%s: Unknown output format '%s'"), *FString(__FUNCTION__), *FormatName)
+				return false;
+			}
+			OutRendererTargetOptions.SetOutputFormat(*TargetType, *ImageFormat);
+		}
+	}
+
+	return OutRendererTargetOptions.AnyOptionSelected();
+}
+
+void FRenderCommand::OnRenderingFinished(bool bSuccess)
+{
+	if (bSuccess)
+	{
+		UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering finished successfully"), *FString(__FUNCTION__))
+	}
+	else
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Rendering failed: %s"),
+			*FString(__FUNCTION__), *SequenceRenderer->GetErrorMessage())
+	}
+
+	if (bQuitOnFinish)
+	{
+		// Exit code lets batch scripts detect failed rendering jobs
+		FPlatformMisc::RequestExitWithStatus(false, bSuccess ? 0 : 1);
+	}
+}
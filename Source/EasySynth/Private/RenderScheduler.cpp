@@ -0,0 +1,53 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "RenderScheduler.h"
+
+#include "RendererTargets/RendererTarget.h"
+
+
+TUniquePtr<FRenderScheduler> FRenderScheduler::Create(const ERenderSchedulerType SchedulerType)
+{
+	switch (SchedulerType)
+	{
+	case ERenderSchedulerType::CAMERA_MAJOR:
+		return MakeUnique<FCameraMajorRenderScheduler>();
+	case ERenderSchedulerType::TEXTURE_STYLE_MAJOR:
+		return MakeUnique<FTextureStyleMajorRenderScheduler>();
+	default:
+		return nullptr;
+	}
+}
+
+bool FRenderScheduler::ParseSchedulerType(const FString& SchedulerName, ERenderSchedulerType& OutSchedulerType)
+{
+	static const TMap<FString, ERenderSchedulerType> SchedulerTypes = {
+		{ TEXT("cameramajor"), ERenderSchedulerType::CAMERA_MAJOR },
+		{ TEXT("texturestyle"), ERenderSchedulerType::TEXTURE_STYLE_MAJOR },
+	};
+
+	const ERenderSchedulerType* Found = SchedulerTypes.Find(SchedulerName.ToLower());
+	if (Found == nullptr)
+	{
+		return false;
+	}
+	OutSchedulerType = *Found;
+	return true;
+}
+
+void FTextureStyleMajorRenderScheduler::Schedule(
+	TArray<FRenderWorkItem>& WorkItems,
+	const ETextureStyle InitialTextureStyle) const
+{
+	// Start with the already selected style, followed by other styles in the order of their first targets
+	TArray<ETextureStyle> TextureStyles = { InitialTextureStyle };
+	for (const FRenderWorkItem& WorkItem : WorkItems)
+	{
+		TextureStyles.AddUnique(WorkItem.Target->TextureStyle());
+	}
+
+	// Items are provided in the camera-major order, which the stable sort keeps inside each style
+	WorkItems.StableSort([&TextureStyles](const FRenderWorkItem& A, const FRenderWorkItem& B)
+	{
+		return TextureStyles.IndexOfByKey(A.Target->TextureStyle()) < TextureStyles.IndexOfByKey(B.Target->TextureStyle());
+	});
+}
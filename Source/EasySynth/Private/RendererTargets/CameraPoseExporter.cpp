@@ -2,57 +2,184 @@
 
 #include "RendererTargets/CameraPoseExporter.h"
 
+#include "Async/ParallelFor.h"
 #include "Camera/CameraComponent.h"
 #include "EntitySystem/Interrogation/MovieSceneInterrogationLinker.h"
 #include "EntitySystem/MovieSceneEntitySystemTypes.h"
-#include "ILevelSequenceEditorToolkit.h"
-#include "ISequencer.h"
 #include "Kismet/KismetMathLibrary.h"
-#include "LevelSequence.h"
 #include "Misc/FileHelper.h"
 #include "MovieScene.h"
-#include "MovieSceneObjectBindingID.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 #include "Sections/MovieSceneCameraCutSection.h"
-#include "Subsystems/AssetEditorSubsystem.h"
 #include "Tracks/MovieScene3DTransformTrack.h"
 
 #include "EasySynth.h"
+#include "ImageWriting/BackgroundFileWriter.h"
+#include "PathUtils.h"
+#include "SequencerWrapper.h"
 
 
+const int FCameraPoseExporter::InterrogationBatchSize = 256;
+
 bool FCameraPoseExporter::ExportCameraPoses(
-	ULevelSequence* LevelSequence,
+	const FSequencerWrapper& SequencerWrapper,
 	const FIntPoint OutputImageResolution,
 	const FString& OutputDir,
 	UCameraComponent* CameraComponent)
 {
-	// Open the received level sequence inside the sequencer wrapper
-	if (!SequencerWrapper.OpenSequence(LevelSequence))
+	if (CameraComponent == nullptr)
 	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Sequencer wrapper opening failed"), *FString(__FUNCTION__))
-		return false;
+		const bool bExportRigPoses = true;
+		return ExportCameraPoses(SequencerWrapper, OutputImageResolution, OutputDir, {}, bExportRigPoses);
+	}
+	const bool bExportRigPoses = false;
+	return ExportCameraPoses(SequencerWrapper, OutputImageResolution, OutputDir, { CameraComponent }, bExportRigPoses);
+}
+
+bool FCameraPoseExporter::ExportCameraPoses(
+	const FSequencerWrapper& SequencerWrapper,
+	const FIntPoint OutputImageResolution,
+	const FString& OutputDir,
+	const TArray<UCameraComponent*>& CameraComponents,
+	const bool bExportRigPoses,
+	FBackgroundFileWriter* FileWriter)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCameraPoseExporter::ExportCameraPoses);
+
+	if (CameraComponents.Num() == 0 && !bExportRigPoses)
+	{
+		return true;
 	}
 
 	OutputResolution = OutputImageResolution;
 
-	// Extract the camera pose transforms
-	const bool bAccumulateCameraOffset = (CameraComponent != nullptr);
-	if (!ExtractCameraTransforms(bAccumulateCameraOffset))
+	// Extract the camera rig pose transforms, shared by all cameras
+	if (!bTransformsExtracted && !ExtractCameraTransforms(SequencerWrapper))
 	{
 		UE_LOG(LogEasySynth, Error, TEXT("%s: Camera pose extraction failed"), *FString(__FUNCTION__))
 		return false;
 	}
 
-	// Store to file
-	FString SaveFilePath;
-	if (CameraComponent == nullptr)
+	// Collect pose files to be written, their camera components are only accessed from the game thread
+	TArray<FString> FilePaths;
+	TArray<FTransform> CameraOffsets;
+	if (bExportRigPoses)
 	{
-		SaveFilePath = FPathUtils::CameraRigPosesFilePath(OutputDir);
+		FilePaths.Add(FPathUtils::CameraRigPosesFilePath(OutputDir));
+		CameraOffsets.Add(FTransform::Identity);
 	}
-	else
+	for (UCameraComponent* CameraComponent : CameraComponents)
 	{
-		SaveFilePath = FPathUtils::CameraPosesFilePath(OutputDir, CameraComponent);
+		FilePaths.Add(FPathUtils::CameraPosesFilePath(OutputDir, CameraComponent));
+		CameraOffsets.Add(CameraComponent->GetRelativeTransform());
 	}
-	if (!SavePosesToCSV(SaveFilePath))
+
+	// The writer gets its own copy of the extracted poses, so this exporter can be discarded right away
+	if (FileWriter != nullptr)
+	{
+		FileWriter->Launch([Exporter = *this, FilePaths = MoveTemp(FilePaths), CameraOffsets = MoveTemp(CameraOffsets)]()
+		{
+			return Exporter.SavePoseFiles(FilePaths, CameraOffsets);
+		});
+		return true;
+	}
+
+	return SavePoseFiles(FilePaths, CameraOffsets);
+}
+
+bool FCameraPoseExporter::ExtractCameraPoses(
+	const FSequencerWrapper& SequencerWrapper,
+	const TArray<UCameraComponent*>& CameraComponents,
+	TArray<TArray<FTransform>>& OutCameraPoses,
+	int& OutFirstFrame)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCameraPoseExporter::ExtractCameraPoses);
+
+	OutCameraPoses.Empty();
+	OutFirstFrame = 0;
+	if (!bTransformsExtracted && !ExtractCameraTransforms(SequencerWrapper))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Camera pose extraction failed"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	const TArray<UMovieSceneCameraCutSection*>& CutSections = SequencerWrapper.GetMovieSceneCutSections();
+	if (CutSections.Num() > 0)
+	{
+		const UMovieScene* MovieScene = SequencerWrapper.GetMovieScene();
+		OutFirstFrame = FFrameRate::TransformTime(
+			FFrameTime(CutSections[0]->GetTrueRange().GetLowerBoundValue()),
+			MovieScene->GetTickResolution(),
+			MovieScene->GetDisplayRate()).FloorToFrame().Value;
+	}
+
+	for (UCameraComponent* CameraComponent : CameraComponents)
+	{
+		const FTransform CameraOffset = CameraComponent->GetRelativeTransform();
+		TArray<FTransform>& CameraPoses = OutCameraPoses.AddDefaulted_GetRef();
+		CameraPoses.Reserve(CameraTransforms.Num());
+		for (int i = 0; i < CameraTransforms.Num(); i++)
+		{
+			CameraPoses.Add(CameraPose(i, CameraOffset));
+		}
+	}
+
+	return true;
+}
+
+bool FCameraPoseExporter::SelectFrames(
+	const FSequencerWrapper& SequencerWrapper,
+	const int FrameStride,
+	const float KeyframeDistance,
+	const float KeyframeAngle,
+	TArray<int>& OutPoseIds)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCameraPoseExporter::SelectFrames);
+
+	OutPoseIds.Empty();
+	if (!bTransformsExtracted && !ExtractCameraTransforms(SequencerWrapper))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Camera pose extraction failed"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	// Rig poses are compared instead of camera poses, so that all rig cameras render the same frames
+	const bool bKeyframesOnly = KeyframeDistance > 0.0f || KeyframeAngle > 0.0f;
+	for (int i = 0; i < CameraTransforms.Num(); i += FMath::Max(FrameStride, 1))
+	{
+		if (bKeyframesOnly && OutPoseIds.Num() > 0)
+		{
+			const FTransform& LastTransform = CameraTransforms[OutPoseIds.Last()];
+			const double Distance = FVector::Dist(LastTransform.GetTranslation(), CameraTransforms[i].GetTranslation());
+			const double Angle =
+				FMath::RadiansToDegrees(LastTransform.GetRotation().AngularDistance(CameraTransforms[i].GetRotation()));
+			const bool bMoved =
+				(KeyframeDistance > 0.0f && Distance >= KeyframeDistance) ||
+				(KeyframeAngle > 0.0f && Angle >= KeyframeAngle);
+			if (!bMoved)
+			{
+				continue;
+			}
+		}
+		OutPoseIds.Add(i);
+	}
+
+	SelectedPoseIds = OutPoseIds;
+	return true;
+}
+
+bool FCameraPoseExporter::SavePoseFiles(const TArray<FString>& FilePaths, const TArray<FTransform>& CameraOffsets) const
+{
+	// All files are derived from the same rig poses, so they are formatted and written in parallel
+	TArray<bool> Saved;
+	Saved.Init(false, FilePaths.Num());
+	ParallelFor(FilePaths.Num(), [this, &FilePaths, &CameraOffsets, &Saved](const int32 Index)
+	{
+		Saved[Index] =
+			SavePosesToCSV(FilePaths[Index], CameraOffsets[Index]) &&
+			(!bSaveBinaryPoses || SavePosesToNpy(FPathUtils::BinaryPosesFilePath(FilePaths[Index]), CameraOffsets[Index]));
+	});
+	if (Saved.Contains(false))
 	{
 		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving camera poses to the file"), *FString(__FUNCTION__))
 		return false;
@@ -61,8 +188,14 @@ bool FCameraPoseExporter::ExportCameraPoses(
 	return true;
 }
 
-bool FCameraPoseExporter::ExtractCameraTransforms(const bool bAccumulateCameraOffset)
+bool FCameraPoseExporter::ExtractCameraTransforms(const FSequencerWrapper& SequencerWrapper)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCameraPoseExporter::ExtractCameraTransforms);
+
+	CameraTransforms.Empty();
+	Timestamps.Empty();
+	bTransformsExtracted = false;
+
 	// Get level sequence fps
 	const FFrameRate DisplayRate = SequencerWrapper.GetMovieScene()->GetDisplayRate();
 	const double FrameTime = 1.0f / DisplayRate.AsDecimal();
@@ -77,39 +210,14 @@ bool FCameraPoseExporter::ExtractCameraTransforms(const bool bAccumulateCameraOf
 	const int TicksPerFrame = TickResolutions.AsDecimal() / DisplayRate.AsDecimal();
 
 	// Get the camera poses from each cut section
-	TArray<UMovieSceneCameraCutSection*>& CutSections = SequencerWrapper.GetMovieSceneCutSections();
-	for (auto CutSection : CutSections)
-	{
-		// Get the camera component
-		UCameraComponent* Camera = CutSection->GetFirstCamera(
-			*SequencerWrapper.GetSequencer(),
-			SequencerWrapper.GetSequencer()->GetFocusedTemplateID());
-		if (Camera == nullptr)
-		{
-			UE_LOG(LogEasySynth, Error, TEXT("%s: Cut section camera component is null"), *FString(__FUNCTION__))
-			return false;
-		}
-
-		// Get the current cut section camera binding id
-		const FMovieSceneObjectBindingID& CameraBindingID = CutSection->GetCameraBindingID();
+	const TArray<UMovieSceneCameraCutSection*>& CutSections = SequencerWrapper.GetMovieSceneCutSections();
+	const TArray<UMovieScene3DTransformTrack*>& TransformTracks = SequencerWrapper.GetCutSectionTransformTracks();
+	for (int CutSectionId = 0; CutSectionId < CutSections.Num(); CutSectionId++)
+	{
+		UMovieSceneCameraCutSection* CutSection = CutSections[CutSectionId];
 
-		// Find the track inside the level sequence that corresponds to the
-		// pose transformation of the camera
-		UMovieScene3DTransformTrack* CameraTransformTrack = nullptr;
-		for (const FMovieSceneBinding& Binding : SequencerWrapper.GetMovieScene()->GetBindings())
-		{
-			if (Binding.GetObjectGuid() == CameraBindingID.GetGuid())
-			{
-				for (UMovieSceneTrack* Track : Binding.GetTracks())
-				{
-					CameraTransformTrack = Cast<UMovieScene3DTransformTrack>(Track);
-					if (CameraTransformTrack != nullptr)
-					{
-						break;
-					}
-				}
-			}
-		}
+		// Transform track of the cut section camera is resolved when the sequence is opened
+		UMovieScene3DTransformTrack* CameraTransformTrack = TransformTracks[CutSectionId];
 		if (CameraTransformTrack == nullptr)
 		{
 			UE_LOG(LogEasySynth, Error, TEXT("%s: Could not find camera transform track"), *FString(__FUNCTION__))
@@ -123,63 +231,65 @@ bool FCameraPoseExporter::ExtractCameraTransforms(const bool bAccumulateCameraOf
 		FFrameNumber StartTickNumber = CutSection->GetTrueRange().GetLowerBoundValue();
 		// Exclusive upper bound of the movie scene ticks that belong to this cut section
 		FFrameNumber EndTickNumber = CutSection->GetTrueRange().GetUpperBoundValue();
-		for (FFrameNumber TickNumber = StartTickNumber; TickNumber < EndTickNumber; TickNumber += TicksPerFrame)
+		FFrameNumber TickNumber = StartTickNumber;
+		while (TickNumber < EndTickNumber)
 		{
-			// Reinitialize the interrogator for each frame
+			// The track is imported once per batch, and all frames of the batch are evaluated by a single update
 			Interrogator.Reset();
 			TGuardValue<UE::MovieScene::FEntityManager*> DebugVizGuard(
 				UE::MovieScene::GEntityManagerForDebuggingVisualizers, &Interrogator.GetLinker()->EntityManager);
 			Interrogator.ImportTrack(CameraTransformTrack, UE::MovieScene::FInterrogationChannel::Default());
 
-			// Add frame interrogation
-			if (Interrogator.AddInterrogation(TickNumber) == INDEX_NONE)
+			int BatchFrameCount = 0;
+			for (; TickNumber < EndTickNumber && BatchFrameCount < InterrogationBatchSize; TickNumber += TicksPerFrame)
 			{
-				UE_LOG(LogEasySynth, Error, TEXT("%s: Adding interrogation failed"), *FString(__FUNCTION__))
-				return false;
+				if (Interrogator.AddInterrogation(TickNumber) == INDEX_NONE)
+				{
+					UE_LOG(LogEasySynth, Error, TEXT("%s: Adding interrogation failed"), *FString(__FUNCTION__))
+					return false;
+				}
+				BatchFrameCount++;
 			}
 			Interrogator.Update();
 
-			// Get the camera pose transform for the frame
-			// Engine crashes in case multiple interrogations are added at once
-			TArray<FTransform> TempTransforms;
-			Interrogator.QueryWorldSpaceTransforms(UE::MovieScene::FInterrogationChannel::Default(), TempTransforms);
-			if (TempTransforms.Num() == 0)
+			// Get the camera pose transforms for all frames of the batch, in the order of interrogations
+			TArray<FTransform> BatchTransforms;
+			Interrogator.QueryWorldSpaceTransforms(UE::MovieScene::FInterrogationChannel::Default(), BatchTransforms);
+			if (BatchTransforms.Num() != BatchFrameCount)
 			{
-				UE_LOG(LogEasySynth, Error, TEXT("%s: No camera transforms found"), *FString(__FUNCTION__))
+				UE_LOG(LogEasySynth, Error, TEXT("%s: Found %d camera transforms for %d frames"),
+					*FString(__FUNCTION__), BatchTransforms.Num(), BatchFrameCount)
 				return false;
 			}
 
-			for (FTransform& Transform : TempTransforms)
+			for (int i = 0; i < BatchTransforms.Num(); i++)
 			{
-				if (bAccumulateCameraOffset)
-				{
-					Transform.Accumulate(Camera->GetRelativeTransform());
-				}
-
 				AccumulatedFrameTime += FrameTime;
 				Timestamps.Add(AccumulatedFrameTime);
 			}
-
-			CameraTransforms.Append(TempTransforms);
+			CameraTransforms.Append(BatchTransforms);
 		}
 	}
 
+	bTransformsExtracted = true;
 	return true;
 }
 
-bool FCameraPoseExporter::SavePosesToCSV(const FString& FilePath)
+bool FCameraPoseExporter::SavePosesToCSV(const FString& FilePath, const FTransform& CameraOffset) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCameraPoseExporter::SavePosesToCSV);
+
 	// Create the file content
 	TArray<FString> Lines;
+	Lines.Reserve(ExportedPoseCount() + 1);
 	Lines.Add("id,tx,ty,tz,qx,qy,qz,qw,t");
 
-	for (int i = 0; i < CameraTransforms.Num(); i++)
+	for (int j = 0; j < ExportedPoseCount(); j++)
 	{
-		// Remove the scaling that makes no impact on camera functionality,
-		// but my be used to scale the camera placeholder mesh as user desires
-		CameraTransforms[i].SetScale3D(FVector(1.0f, 1.0f, 1.0f));
-		const FVector Translation = CameraTransforms[i].GetTranslation();
-		const FQuat Rotation = CameraTransforms[i].GetRotation();
+		const int i = ExportedPoseId(j);
+		const FTransform CameraTransform = CameraPose(i, CameraOffset);
+		const FVector Translation = CameraTransform.GetTranslation();
+		const FQuat Rotation = CameraTransform.GetRotation();
 
 		Lines.Add(FString::Printf(TEXT("%d,%f,%f,%f,%f,%f,%f,%f,%f"),
 			i,
@@ -202,3 +312,69 @@ bool FCameraPoseExporter::SavePosesToCSV(const FString& FilePath)
 
 	return true;
 }
+
+bool FCameraPoseExporter::SavePosesToNpy(const FString& FilePath, const FTransform& CameraOffset) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCameraPoseExporter::SavePosesToNpy);
+
+	const int ColumnCount = 9;
+	FString Header = FString::Printf(
+		TEXT("{'descr': '<f8', 'fortran_order': False, 'shape': (%d, %d), }"), ExportedPoseCount(), ColumnCount);
+
+	// The header is padded with spaces and terminated by a newline, so that the data starts at a multiple of 64 bytes
+	const uint8 Magic[] = { 0x93, 'N', 'U', 'M', 'P', 'Y', 1, 0 };
+	const int PrefixSize = sizeof(Magic) + sizeof(uint16);
+	const int PaddedHeaderSize = Align(PrefixSize + Header.Len() + 1, 64) - PrefixSize;
+	Header = Header.RightPad(PaddedHeaderSize - 1) + TEXT("\n");
+
+	TArray64<uint8> Data;
+	Data.Reserve(PrefixSize + PaddedHeaderSize + ExportedPoseCount() * ColumnCount * sizeof(double));
+	Data.Append(Magic, sizeof(Magic));
+	Data.Add(static_cast<uint8>(PaddedHeaderSize & 0xFF));
+	Data.Add(static_cast<uint8>(PaddedHeaderSize >> 8));
+	Data.Append(reinterpret_cast<const uint8*>(TCHAR_TO_ANSI(*Header)), PaddedHeaderSize);
+
+	// Values are stored in the native byte order, which is little-endian on all supported platforms
+	for (int j = 0; j < ExportedPoseCount(); j++)
+	{
+		const int i = ExportedPoseId(j);
+		const FTransform CameraTransform = CameraPose(i, CameraOffset);
+		const FVector Translation = CameraTransform.GetTranslation();
+		const FQuat Rotation = CameraTransform.GetRotation();
+		const double Row[ColumnCount] = {
+			static_cast<double>(i),
+			Translation.X, Translation.Y, Translation.Z,
+			Rotation.X, Rotation.Y, Rotation.Z, Rotation.W,
+			Timestamps[i] };
+		Data.Append(reinterpret_cast<const uint8*>(Row), sizeof(Row));
+	}
+
+	if (!FFileHelper::SaveArrayToFile(Data, *FilePath))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving the file %s"), *FString(__FUNCTION__), *FilePath)
+		return false;
+	}
+
+	return true;
+}
+
+int FCameraPoseExporter::ExportedPoseCount() const
+{
+	return SelectedPoseIds.Num() > 0 ? SelectedPoseIds.Num() : CameraTransforms.Num();
+}
+
+int FCameraPoseExporter::ExportedPoseId(const int ExportedPoseIndex) const
+{
+	return SelectedPoseIds.Num() > 0 ? SelectedPoseIds[ExportedPoseIndex] : ExportedPoseIndex;
+}
+
+FTransform FCameraPoseExporter::CameraPose(const int Frame, const FTransform& CameraOffset) const
+{
+	FTransform CameraTransform = CameraTransforms[Frame];
+	CameraTransform.Accumulate(CameraOffset);
+
+	// Remove the scaling that makes no impact on camera functionality,
+	// but my be used to scale the camera placeholder mesh as user desires
+	CameraTransform.SetScale3D(FVector(1.0f, 1.0f, 1.0f));
+	return CameraTransform;
+}
@@ -2,50 +2,48 @@
 
 #include "RendererTargets/ColorImageTarget.h"
 
-#include "Camera/CameraComponent.h"
-
 #include "EasySynth.h"
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
 #include "LevelSequence.h"
 #include "TextureStyles/TextureStyleManager.h"
 
 
-bool FColorImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
+ETextureStyle FColorImageTarget::TextureStyle() const
 {
-	// Update texture style inside the level
-	TextureStyleManager->CheckoutTextureStyle(ETextureStyle::COLOR);
+	return ETextureStyle::COLOR;
+}
 
-	// Get all camera components bound to the level sequence
-	TArray<UCameraComponent*> Cameras = GetCameras(LevelSequence);
-	if (Cameras.Num() == 0)
-	{
-		UE_LOG(LogEasySynth, Warning, TEXT("%s: No cameras bound to the level sequence found"), *FString(__FUNCTION__))
-		return false;
-	}
+EEXRCompressionFormatLocal FColorImageTarget::ExrCompression() const
+{
+	return EEXRCompressionFormatLocal::DWAB;
+}
 
-	// Prepare the camera post process material
-	UMaterial* PostProcessMaterial = LoadPostProcessMaterial();
-	if (PostProcessMaterial == nullptr)
+UMaterialInterface* FColorImageTarget::CreatePostProcessMaterial()
+{
+	UMaterial* Material = LoadPostProcessMaterial();
+	if (Material == nullptr)
 	{
 		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load color post process material"), *FString(__FUNCTION__))
-		return false;
 	}
+	return Material;
+}
+
+bool FColorImageTarget::PrepareSequence(const FSequencerWrapper& SequencerWrapper)
+{
+	// Update texture style inside the level
+	TextureStyleManager->CheckoutTextureStyle(TextureStyle());
 
-	for (UCameraComponent* Camera : Cameras)
+	// Prepare the camera post process material
+	UMaterialInterface* CameraPostProcessMaterial = PostProcessMaterial();
+	if (CameraPostProcessMaterial == nullptr)
 	{
-		if (Camera == nullptr)
-		{
-			UE_LOG(LogEasySynth, Error, TEXT("%s: Found camera is null"), *FString(__FUNCTION__))
-			return false;
-		}
-
-		Camera->PostProcessSettings.WeightedBlendables.Array.Empty();
-		Camera->PostProcessSettings.WeightedBlendables.Array.Add(FWeightedBlendable(1.0f, PostProcessMaterial));
+		return false;
 	}
 
-	return true;
+	return BindCameraPostProcess(SequencerWrapper, CameraPostProcessMaterial);
 }
 
-bool FColorImageTarget::FinalizeSequence(ULevelSequence* LevelSequence)
+bool FColorImageTarget::FinalizeSequence(const FSequencerWrapper& SequencerWrapper)
 {
-	return ClearCameraPostProcess(LevelSequence);
+	return ClearCameraPostProcess(SequencerWrapper);
 }
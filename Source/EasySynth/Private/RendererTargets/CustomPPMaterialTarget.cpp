@@ -4,25 +4,46 @@
 
 #include "Camera/CameraComponent.h"
 #include "LevelSequence.h"
+#include "Materials/Material.h"
 
 #include "EasySynth.h"
 #include "TextureStyles/TextureStyleManager.h"
 
 
-bool FCustomPPMaterialTarget::PrepareSequence(ULevelSequence* LevelSequence)
+ETextureStyle FCustomPPMaterialTarget::TextureStyle() const
 {
-	// Update texture style inside the level
-	TextureStyleManager->CheckoutTextureStyle(ETextureStyle::COLOR);
+	return ETextureStyle::COLOR;
+}
 
+UMaterialInterface* FCustomPPMaterialTarget::CreatePostProcessMaterial()
+{
 	// Make sure the custom post process material is not null
 	if (CustomPPMaterial == nullptr)
 	{
 		UE_LOG(LogEasySynth, Error, TEXT("%s: Custom post process material is null"), *FString(__FUNCTION__))
+	}
+	return CustomPPMaterial;
+}
+
+FString FCustomPPMaterialTarget::PostProcessMaterialKey() const
+{
+	return FString::Printf(TEXT("%s_%s"), *Name(), CustomPPMaterial != nullptr ? *CustomPPMaterial->GetPathName() : TEXT(""));
+}
+
+bool FCustomPPMaterialTarget::PrepareSequence(const FSequencerWrapper& SequencerWrapper)
+{
+	// Update texture style inside the level
+	TextureStyleManager->CheckoutTextureStyle(TextureStyle());
+
+	// Make sure the custom post process material is not null
+	UMaterialInterface* CameraPostProcessMaterial = PostProcessMaterial();
+	if (CameraPostProcessMaterial == nullptr)
+	{
 		return false;
 	}
 
 	// Get all camera components bound to the level sequence
-	TArray<UCameraComponent*> Cameras = GetCameras(LevelSequence);
+	const TArray<UCameraComponent*>& Cameras = GetCameras(SequencerWrapper);
 	if (Cameras.Num() == 0)
 	{
 		UE_LOG(LogEasySynth, Warning, TEXT("%s: No cameras bound to the level sequence found"), *FString(__FUNCTION__))
@@ -38,13 +59,13 @@ bool FCustomPPMaterialTarget::PrepareSequence(ULevelSequence* LevelSequence)
 		}
 
 		Camera->PostProcessSettings.WeightedBlendables.Array.Empty();
-		Camera->PostProcessSettings.WeightedBlendables.Array.Add(FWeightedBlendable(1.0f, CustomPPMaterial));
+		Camera->PostProcessSettings.WeightedBlendables.Array.Add(FWeightedBlendable(1.0f, CameraPostProcessMaterial));
 	}
 
 	return true;
 }
 
-bool FCustomPPMaterialTarget::FinalizeSequence(ULevelSequence* LevelSequence)
+bool FCustomPPMaterialTarget::FinalizeSequence(const FSequencerWrapper& SequencerWrapper)
 {
-	return ClearCameraPostProcess(LevelSequence);
+	return ClearCameraPostProcess(SequencerWrapper);
 }
@@ -4,45 +4,90 @@
 
 #include "Camera/CameraComponent.h"
 #include "LevelSequence.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialExpressionComponentMask.h"
+#include "Materials/MaterialExpressionMin.h"
+#include "Materials/MaterialExpressionMultiply.h"
+#include "Materials/MaterialExpressionSceneTexture.h"
 #include "Materials/MaterialInstanceDynamic.h"
 
 #include "EasySynth.h"
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
 #include "TextureStyles/TextureStyleManager.h"
 
 
 const FString FDepthImageTarget::DepthRangeMetersParameter("DepthRangeMeters");
+const float FDepthImageTarget::MaxMetricDepthMeters = 65504.0f;
 
-bool FDepthImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
+ETextureStyle FDepthImageTarget::TextureStyle() const
 {
-	// Update texture style inside the level
-	TextureStyleManager->CheckoutTextureStyle(ETextureStyle::COLOR);
+	return ETextureStyle::COLOR;
+}
 
-	// Get all camera components bound to the level sequence
-	TArray<UCameraComponent*> Cameras = GetCameras(LevelSequence);
-	if (Cameras.Num() == 0)
+UMaterialInterface* FDepthImageTarget::CreatePostProcessMaterial()
+{
+	if (bMetricDepth)
 	{
-		UE_LOG(LogEasySynth, Warning, TEXT("%s: No cameras bound to the level sequence found"), *FString(__FUNCTION__))
-		return false;
+		return MetricDepthPostProcessMaterial();
 	}
 
-	// Prepare the camera post process material
-	UMaterial* PostProcessMaterial = LoadPostProcessMaterial();
-	if (PostProcessMaterial == nullptr)
+	UMaterial* Material = LoadPostProcessMaterial();
+	if (Material == nullptr)
 	{
 		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load depth post process material"), *FString(__FUNCTION__))
-		return false;
+		return nullptr;
 	}
 
 	// Create the material instance and set the range parameter
 	UMaterialInstanceDynamic* PostProcessMaterialInstance =
-		UMaterialInstanceDynamic::Create(PostProcessMaterial, nullptr);
+		UMaterialInstanceDynamic::Create(Material, nullptr);
 	if (PostProcessMaterialInstance == nullptr)
 	{
 		UE_LOG(LogTemp, Error, TEXT("%s: Could not create the material instance dynamic"), *FString(__FUNCTION__))
-		return false;
+		return nullptr;
 	}
 	PostProcessMaterialInstance->SetScalarParameterValue(*DepthRangeMetersParameter, DepthRangeMeters);
 
+	return PostProcessMaterialInstance;
+}
+
+FString FDepthImageTarget::PostProcessMaterialKey() const
+{
+	return FString::Printf(TEXT("%s_%f_%d"), *Name(), DepthRangeMeters, bMetricDepth);
+}
+
+EEXRChannelLayoutLocal FDepthImageTarget::ExrChannelLayout() const
+{
+	return EEXRChannelLayoutLocal::Z;
+}
+
+bool FDepthImageTarget::PrepareSequence(const FSequencerWrapper& SequencerWrapper)
+{
+	// Only floating point images can store depth values larger than one
+	if (bMetricDepth && ImageFormat != EImageFormat::EXR)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Metric depth images require the EXR output format"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	// Update texture style inside the level
+	TextureStyleManager->CheckoutTextureStyle(TextureStyle());
+
+	// Get all camera components bound to the level sequence
+	const TArray<UCameraComponent*>& Cameras = GetCameras(SequencerWrapper);
+	if (Cameras.Num() == 0)
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: No cameras bound to the level sequence found"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	// Prepare the camera post process material
+	UMaterialInterface* PostProcessMaterialInstance = PostProcessMaterial();
+	if (PostProcessMaterialInstance == nullptr)
+	{
+		return false;
+	}
+
 	for (UCameraComponent* Camera : Cameras)
 	{
 		if (Camera == nullptr)
@@ -57,7 +102,48 @@ bool FDepthImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 	return true;
 }
 
-bool FDepthImageTarget::FinalizeSequence(ULevelSequence* LevelSequence)
+bool FDepthImageTarget::FinalizeSequence(const FSequencerWrapper& SequencerWrapper)
+{
+	return ClearCameraPostProcess(SequencerWrapper);
+}
+
+UMaterialInterface* FDepthImageTarget::MetricDepthPostProcessMaterial() const
 {
-	return ClearCameraPostProcess(LevelSequence);
+	UMaterial* Material = NewObject<UMaterial>(GetTransientPackage(), NAME_None, RF_Transient);
+	if (Material == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not create metric depth post process material"), *FString(__FUNCTION__))
+		return nullptr;
+	}
+	Material->MaterialDomain = EMaterialDomain::MD_PostProcess;
+	// Replacing the tonemapper keeps depth values unchanged by exposure, bloom and color grading
+	Material->BlendableLocation = EBlendableLocation::BL_ReplacingTonemapper;
+
+	UMaterialExpressionSceneTexture* SceneDepthExpression = NewObject<UMaterialExpressionSceneTexture>(Material);
+	SceneDepthExpression->SceneTextureId = ESceneTextureId::PPI_SceneDepth;
+	Material->GetExpressionCollection().AddExpression(SceneDepthExpression);
+
+	UMaterialExpressionComponentMask* DepthMaskExpression = NewObject<UMaterialExpressionComponentMask>(Material);
+	DepthMaskExpression->R = 1;
+	DepthMaskExpression->Input.Connect(0, SceneDepthExpression);
+	Material->GetExpressionCollection().AddExpression(DepthMaskExpression);
+
+	// Scene depth is provided in centimeters
+	UMaterialExpressionMultiply* MetersExpression = NewObject<UMaterialExpressionMultiply>(Material);
+	MetersExpression->A.Connect(0, DepthMaskExpression);
+	MetersExpression->ConstB = 0.01f;
+	Material->GetExpressionCollection().AddExpression(MetersExpression);
+
+	// The sky is infinitely far, clamp it so that it is not written as inf
+	UMaterialExpressionMin* ClampExpression = NewObject<UMaterialExpressionMin>(Material);
+	ClampExpression->A.Connect(0, MetersExpression);
+	ClampExpression->ConstB = MaxMetricDepthMeters;
+	Material->GetExpressionCollection().AddExpression(ClampExpression);
+	Material->GetEditorOnlyData()->EmissiveColor.Connect(0, ClampExpression);
+
+	// Compile the material, rendering waits for shader compilation to finish before starting
+	Material->PreEditChange(nullptr);
+	Material->PostEditChange();
+
+	return Material;
 }
@@ -0,0 +1,146 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "RendererTargets/InstanceIdImageTarget.h"
+
+#include "Camera/CameraComponent.h"
+#include "ImagePixelData.h"
+#include "LevelSequence.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialExpressionSceneTexture.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+#include "EasySynth.h"
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
+#include "ImageWriting/EncodedImageWriteTask.h"
+#include "TextureStyles/TextureStyleManager.h"
+
+
+ETextureStyle FInstanceIdImageTarget::TextureStyle() const
+{
+	return ETextureStyle::INSTANCE_ID;
+}
+
+EEXRCompressionFormatLocal FInstanceIdImageTarget::ExrCompression() const
+{
+	return EEXRCompressionFormatLocal::ZIP;
+}
+
+UMaterialInterface* FInstanceIdImageTarget::CreatePostProcessMaterial()
+{
+	UMaterial* Material = NewObject<UMaterial>(GetTransientPackage(), NAME_None, RF_Transient);
+	if (Material == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not create instance id post process material"), *FString(__FUNCTION__))
+		return nullptr;
+	}
+	Material->MaterialDomain = EMaterialDomain::MD_PostProcess;
+	// Replacing the tonemapper keeps encoded ids unchanged by exposure, bloom and color grading
+	Material->BlendableLocation = EBlendableLocation::BL_ReplacingTonemapper;
+
+	UMaterialExpressionSceneTexture* SceneColorExpression = NewObject<UMaterialExpressionSceneTexture>(Material);
+	SceneColorExpression->SceneTextureId = ESceneTextureId::PPI_PostProcessInput0;
+	Material->GetExpressionCollection().AddExpression(SceneColorExpression);
+	Material->GetEditorOnlyData()->EmissiveColor.Connect(0, SceneColorExpression);
+
+	// Compile the material, rendering waits for shader compilation to finish before starting
+	Material->PreEditChange(nullptr);
+	Material->PostEditChange();
+
+	return Material;
+}
+
+bool FInstanceIdImageTarget::PrepareSequence(const FSequencerWrapper& SequencerWrapper)
+{
+	// Lossy compression would change encoded ids
+	if (ImageFormat == EImageFormat::JPEG)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Instance id images require a lossless output format"), *FString(__FUNCTION__))
+		return false;
+	}
+	if (!VerifyIdEncoding())
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Instance ids do not survive the 8-bit image conversion"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	// Update texture style inside the level
+	TextureStyleManager->CheckoutTextureStyle(TextureStyle());
+
+	// Get all camera components bound to the level sequence
+	const TArray<UCameraComponent*>& Cameras = GetCameras(SequencerWrapper);
+	if (Cameras.Num() == 0)
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: No cameras bound to the level sequence found"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	// Prepare the camera post process material
+	UMaterialInterface* CameraPostProcessMaterial = PostProcessMaterial();
+	if (CameraPostProcessMaterial == nullptr)
+	{
+		return false;
+	}
+
+	for (UCameraComponent* Camera : Cameras)
+	{
+		if (Camera == nullptr)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Found camera is null"), *FString(__FUNCTION__))
+			return false;
+		}
+		Camera->PostProcessSettings.WeightedBlendables.Array.Empty();
+		Camera->PostProcessSettings.WeightedBlendables.Array.Add(FWeightedBlendable(1.0f, CameraPostProcessMaterial));
+	}
+
+	return true;
+}
+
+bool FInstanceIdImageTarget::FinalizeSequence(const FSequencerWrapper& SequencerWrapper)
+{
+	return ClearCameraPostProcess(SequencerWrapper);
+}
+
+bool FInstanceIdImageTarget::VerifyIdEncoding()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FInstanceIdImageTarget::VerifyIdEncoding);
+
+	// Each id byte is stored in its own channel, so every byte value in every channel covers the whole encoding,
+	// boundary and alternating bit pattern ids check the channels together
+	TArray<uint32> Ids;
+	for (uint32 Byte = 0; Byte < 256; Byte++)
+	{
+		Ids.Add(Byte);
+		Ids.Add(Byte << 8);
+		Ids.Add(Byte << 16);
+		Ids.Add(Byte | (Byte << 8) | (Byte << 16));
+	}
+	Ids.Append({ 0x00FFFE, 0x00FFFF, 0x010000, 0x010001, 0xFFFFFE, 0xFFFFFF, 0x555555, 0xAAAAAA, 0x0F0F0F, 0xF0F0F0, 0x123456 });
+
+	TArray64<FFloat16Color> Pixels;
+	Pixels.Reserve(Ids.Num());
+	for (const uint32 Id : Ids)
+	{
+		Pixels.Add(FFloat16Color(UTextureStyleManager::EncodeInstanceId(Id)));
+	}
+	const FImagePixelData* PixelData = new TImagePixelData<FFloat16Color>(FIntPoint(Ids.Num(), 1), MoveTemp(Pixels));
+	TUniquePtr<const FImagePixelData> RenderedPixelData(PixelData);
+	const bool bConvertToSrgb = false;
+	TUniquePtr<FImagePixelData> QuantizedPixelData = FEncodedImageWriteTask::QuantizeToColor(PixelData, bConvertToSrgb);
+	if (!QuantizedPixelData.IsValid())
+	{
+		return false;
+	}
+
+	const TArray64<FColor>& Colors = static_cast<TImagePixelData<FColor>*>(QuantizedPixelData.Get())->Pixels;
+	for (int i = 0; i < Ids.Num(); i++)
+	{
+		const uint32 DecodedId = UTextureStyleManager::DecodeInstanceId(Colors[i]);
+		if (DecodedId != Ids[i])
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Instance id %u is decoded as %u"), *FString(__FUNCTION__), Ids[i], DecodedId)
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,183 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "RendererTargets/MultiPassTarget.h"
+
+#include "Camera/CameraComponent.h"
+#include "LevelSequence.h"
+#include "MoviePipelineDeferredPasses.h"
+
+#include "EasySynth.h"
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
+#include "TextureStyles/TextureStyleManager.h"
+
+
+const TCHAR* FMultiPassTarget::PackedOutputName = TEXT("PackedImage");
+
+void FMultiPassTarget::SetPostProcessMaterialCache(FPostProcessMaterialCache* MaterialCache)
+{
+	FRendererTarget::SetPostProcessMaterialCache(MaterialCache);
+	for (TSharedPtr<FRendererTarget>& Target : Targets)
+	{
+		Target->SetPostProcessMaterialCache(MaterialCache);
+	}
+}
+
+bool FMultiPassTarget::PrepareSequence(const FSequencerWrapper& SequencerWrapper)
+{
+	// Update texture style inside the level
+	TextureStyleManager->CheckoutTextureStyle(TextureStyle());
+
+	// Only the target rendered by the main pass binds its material to cameras
+	if (!ClearCameraPostProcess(SequencerWrapper))
+	{
+		return false;
+	}
+
+	// Prepare level state and post process materials of all grouped targets
+	PassMaterials.Empty();
+	for (TSharedPtr<FRendererTarget>& Target : Targets)
+	{
+		if (!Target->PrepareLevel())
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Could not prepare the level for the %s pass"),
+				*FString(__FUNCTION__), *Target->Name())
+			PassMaterials.Empty();
+			return false;
+		}
+
+		UMaterialInterface* PassMaterial = Target->PostProcessMaterial();
+		if (PassMaterial == nullptr)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Could not prepare the %s pass material"),
+				*FString(__FUNCTION__), *Target->Name())
+			PassMaterials.Empty();
+			return false;
+		}
+		PassMaterials.Emplace(PassMaterial);
+
+		if (&Target == MainPassTarget() && !BindCameraPostProcess(SequencerWrapper, PassMaterial))
+		{
+			PassMaterials.Empty();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FMultiPassTarget::FinalizeSequence(const FSequencerWrapper& SequencerWrapper)
+{
+	for (TSharedPtr<FRendererTarget>& Target : Targets)
+	{
+		Target->FinalizeLevel();
+	}
+	PassMaterials.Empty();
+	return ClearCameraPostProcess(SequencerWrapper);
+}
+
+bool FMultiPassTarget::RequiresAntiAliasing() const
+{
+	for (const TSharedPtr<FRendererTarget>& Target : Targets)
+	{
+		if (Target->RequiresAntiAliasing())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+FString FMultiPassTarget::MainPassName() const
+{
+	const TSharedPtr<FRendererTarget>* Target = MainPassTarget();
+	if (Target == nullptr)
+	{
+		return TEXT("");
+	}
+	return bPackedExr ? (*Target)->LayerName() : (*Target)->Name();
+}
+
+const TSharedPtr<FRendererTarget>* FMultiPassTarget::MainPassTarget() const
+{
+	return Targets.FindByPredicate([](const TSharedPtr<FRendererTarget>& Target) { return Target->RendersMainPass(); });
+}
+
+TArray<FString> FMultiPassTarget::OutputNames() const
+{
+	if (bPackedExr)
+	{
+		return { PackedOutputName };
+	}
+
+	TArray<FString> Names;
+	for (const TSharedPtr<FRendererTarget>& Target : Targets)
+	{
+		Names.Add(Target->Name());
+	}
+	return Names;
+}
+
+TMap<FString, EEXRChannelLayoutLocal> FMultiPassTarget::ExrPassChannelLayouts() const
+{
+	TMap<FString, EEXRChannelLayoutLocal> ChannelLayouts;
+	if (bPackedExr)
+	{
+		for (const TSharedPtr<FRendererTarget>& Target : Targets)
+		{
+			ChannelLayouts.Add(Target->LayerName(), Target->ExrChannelLayout());
+		}
+	}
+	return ChannelLayouts;
+}
+
+TSet<FString> FMultiPassTarget::AveragedPyramidPasses() const
+{
+	// Pass names are set by the ConfigureRenderPass
+	TSet<FString> PassNames;
+	for (const TSharedPtr<FRendererTarget>& Target : Targets)
+	{
+		if (Target->AveragesPyramidLevels())
+		{
+			PassNames.Add(bPackedExr ? Target->LayerName() : Target->Name());
+		}
+	}
+	return PassNames;
+}
+
+bool FMultiPassTarget::ConfigureRenderPass(UMoviePipelineDeferredPassBase* DeferredPass)
+{
+	if (DeferredPass == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Deferred render pass is null"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	if (PassMaterials.Num() != Targets.Num())
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Expected %d pass materials, found %d"),
+			*FString(__FUNCTION__), Targets.Num(), PassMaterials.Num())
+		return false;
+	}
+
+	// The main pass renders the target that needs the final image, while other targets get their own passes
+	const TSharedPtr<FRendererTarget>* MainTarget = MainPassTarget();
+	DeferredPass->bRenderMainPass = MainTarget != nullptr;
+	DeferredPass->AdditionalPostProcessMaterials.Empty();
+	for (int i = 0; i < Targets.Num(); i++)
+	{
+		if (&Targets[i] == MainTarget)
+		{
+			continue;
+		}
+
+		// Pass names match target names, so that each pass ends up in the target output directory,
+		// while packed images name their layers after pass names
+		FMoviePipelinePostProcessPass PostProcessPass;
+		PostProcessPass.bEnabled = true;
+		PostProcessPass.Name = bPackedExr ? Targets[i]->LayerName() : Targets[i]->Name();
+		PostProcessPass.Material = PassMaterials[i].Get();
+		DeferredPass->AdditionalPostProcessMaterials.Add(PostProcessPass);
+	}
+
+	return true;
+}
@@ -6,16 +6,37 @@
 #include "LevelSequence.h"
 
 #include "EasySynth.h"
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
 #include "TextureStyles/TextureStyleManager.h"
 
 
-bool FNormalImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
+ETextureStyle FNormalImageTarget::TextureStyle() const
+{
+	return ETextureStyle::COLOR;
+}
+
+EEXRCompressionFormatLocal FNormalImageTarget::ExrCompression() const
+{
+	return EEXRCompressionFormatLocal::B44;
+}
+
+UMaterialInterface* FNormalImageTarget::CreatePostProcessMaterial()
+{
+	UMaterial* Material = LoadPostProcessMaterial();
+	if (Material == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load normals post process material"), *FString(__FUNCTION__))
+	}
+	return Material;
+}
+
+bool FNormalImageTarget::PrepareSequence(const FSequencerWrapper& SequencerWrapper)
 {
 	// Update texture style inside the level
-	TextureStyleManager->CheckoutTextureStyle(ETextureStyle::COLOR);
+	TextureStyleManager->CheckoutTextureStyle(TextureStyle());
 
 	// Get all camera components bound to the level sequence
-	TArray<UCameraComponent*> Cameras = GetCameras(LevelSequence);
+	const TArray<UCameraComponent*>& Cameras = GetCameras(SequencerWrapper);
 	if (Cameras.Num() == 0)
 	{
 		UE_LOG(LogEasySynth, Warning, TEXT("%s: No cameras bound to the level sequence found"), *FString(__FUNCTION__))
@@ -23,10 +44,9 @@ bool FNormalImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 	}
 
 	// Prepare the camera post process material
-	UMaterial* PostProcessMaterial = LoadPostProcessMaterial();
-	if (PostProcessMaterial == nullptr)
+	UMaterialInterface* CameraPostProcessMaterial = PostProcessMaterial();
+	if (CameraPostProcessMaterial == nullptr)
 	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load normals post process material"), *FString(__FUNCTION__))
 		return false;
 	}
 
@@ -38,13 +58,13 @@ bool FNormalImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 			return false;
 		}
 		Camera->PostProcessSettings.WeightedBlendables.Array.Empty();
-		Camera->PostProcessSettings.WeightedBlendables.Array.Add(FWeightedBlendable(1.0f, PostProcessMaterial));
+		Camera->PostProcessSettings.WeightedBlendables.Array.Add(FWeightedBlendable(1.0f, CameraPostProcessMaterial));
 	}
 
 	return true;
 }
 
-bool FNormalImageTarget::FinalizeSequence(ULevelSequence* LevelSequence)
+bool FNormalImageTarget::FinalizeSequence(const FSequencerWrapper& SequencerWrapper)
 {
-	return ClearCameraPostProcess(LevelSequence);
+	return ClearCameraPostProcess(SequencerWrapper);
 }
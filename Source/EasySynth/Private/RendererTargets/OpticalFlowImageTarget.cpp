@@ -7,18 +7,56 @@
 #include "Materials/MaterialInstanceDynamic.h"
 
 #include "EasySynth.h"
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
 #include "TextureStyles/TextureStyleManager.h"
 
 
 const FString FOpticalFlowImageTarget::OpticalFlowScaleParameter("OpticalFlowScale");
 
-bool FOpticalFlowImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
+ETextureStyle FOpticalFlowImageTarget::TextureStyle() const
+{
+	return ETextureStyle::COLOR;
+}
+
+UMaterialInterface* FOpticalFlowImageTarget::CreatePostProcessMaterial()
+{
+	UMaterial* Material = LoadPostProcessMaterial();
+	if (Material == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load optical flow post process material"), *FString(__FUNCTION__))
+		return nullptr;
+	}
+
+	// Create the material instance and set the scale parameter
+	UMaterialInstanceDynamic* PostProcessMaterialInstance =
+		UMaterialInstanceDynamic::Create(Material, nullptr);
+	if (PostProcessMaterialInstance == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s: Could not create the material instance dynamic"), *FString(__FUNCTION__))
+		return nullptr;
+	}
+	PostProcessMaterialInstance->SetScalarParameterValue(*OpticalFlowScaleParameter, OpticalFlowScale);
+
+	return PostProcessMaterialInstance;
+}
+
+FString FOpticalFlowImageTarget::PostProcessMaterialKey() const
+{
+	return FString::Printf(TEXT("%s_%f"), *Name(), OpticalFlowScale);
+}
+
+EEXRChannelLayoutLocal FOpticalFlowImageTarget::ExrChannelLayout() const
+{
+	return EEXRChannelLayoutLocal::UV;
+}
+
+bool FOpticalFlowImageTarget::PrepareSequence(const FSequencerWrapper& SequencerWrapper)
 {
 	// Update texture style inside the level
-	TextureStyleManager->CheckoutTextureStyle(ETextureStyle::COLOR);
+	TextureStyleManager->CheckoutTextureStyle(TextureStyle());
 
 	// Get all camera components bound to the level sequence
-	TArray<UCameraComponent*> Cameras = GetCameras(LevelSequence);
+	const TArray<UCameraComponent*>& Cameras = GetCameras(SequencerWrapper);
 	if (Cameras.Num() == 0)
 	{
 		UE_LOG(LogEasySynth, Warning, TEXT("%s: No cameras bound to the level sequence found"), *FString(__FUNCTION__))
@@ -26,22 +64,11 @@ bool FOpticalFlowImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 	}
 
 	// Prepare the camera post process material
-	UMaterial* PostProcessMaterial = LoadPostProcessMaterial();
-	if (PostProcessMaterial == nullptr)
-	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load optical flow post process material"), *FString(__FUNCTION__))
-		return false;
-	}
-
-	// Create the material instance and set the scale parameter
-	UMaterialInstanceDynamic* PostProcessMaterialInstance =
-		UMaterialInstanceDynamic::Create(PostProcessMaterial, nullptr);
+	UMaterialInterface* PostProcessMaterialInstance = PostProcessMaterial();
 	if (PostProcessMaterialInstance == nullptr)
 	{
-		UE_LOG(LogTemp, Error, TEXT("%s: Could not create the material instance dynamic"), *FString(__FUNCTION__))
 		return false;
 	}
-	PostProcessMaterialInstance->SetScalarParameterValue(*OpticalFlowScaleParameter, OpticalFlowScale);
 
 	for (UCameraComponent* Camera : Cameras)
 	{
@@ -57,7 +84,7 @@ bool FOpticalFlowImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 	return true;
 }
 
-bool FOpticalFlowImageTarget::FinalizeSequence(ULevelSequence* LevelSequence)
+bool FOpticalFlowImageTarget::FinalizeSequence(const FSequencerWrapper& SequencerWrapper)
 {
-	return ClearCameraPostProcess(LevelSequence);
+	return ClearCameraPostProcess(SequencerWrapper);
 }
@@ -0,0 +1,236 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "RendererTargets/OutputFramesScanner.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+#include "EasySynth.h"
+
+
+TSet<int> FOutputFramesScanner::FindCompleteFrames(const FString& Directory, const EImageFormat ImageFormat)
+{
+	TSet<int> CompleteFrames;
+
+	TArray<FString> FileNames;
+	const FString SearchPattern = Directory / FString::Printf(TEXT("*.%s"), *FileExtension(ImageFormat));
+	IFileManager::Get().FindFiles(FileNames, *SearchPattern, true, false);
+	for (const FString& FileName : FileNames)
+	{
+		int FrameNumber;
+		if (!ParseFrameNumber(FileName, FrameNumber))
+		{
+			continue;
+		}
+
+		const FString FilePath = Directory / FileName;
+		if (IsImageFileComplete(FilePath, ImageFormat))
+		{
+			CompleteFrames.Add(FrameNumber);
+		}
+		else
+		{
+			UE_LOG(LogEasySynth, Warning, TEXT("%s: Found incomplete file %s"), *FString(__FUNCTION__), *FilePath)
+		}
+	}
+
+	return CompleteFrames;
+}
+
+bool FOutputFramesScanner::IsImageFileComplete(const FString& FilePath, const EImageFormat ImageFormat)
+{
+	TUniquePtr<FArchive> FileReader(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!FileReader.IsValid() || FileReader->TotalSize() == 0)
+	{
+		return false;
+	}
+
+	if (ImageFormat == EImageFormat::EXR)
+	{
+		return IsExrFileComplete(*FileReader);
+	}
+
+	// Other formats are checked using their last bytes
+	const int64 FileEndSize = 12;
+	if (FileReader->TotalSize() < FileEndSize)
+	{
+		return false;
+	}
+	TArray<uint8> FileEnd;
+	FileEnd.SetNumUninitialized(FileEndSize);
+	FileReader->Seek(FileReader->TotalSize() - FileEndSize);
+	FileReader->Serialize(FileEnd.GetData(), FileEndSize);
+	if (FileReader->IsError())
+	{
+		return false;
+	}
+
+	switch (ImageFormat)
+	{
+	case EImageFormat::PNG: return IsPngFileComplete(FileEnd); break;
+	case EImageFormat::JPEG: return IsJpegFileComplete(FileEnd); break;
+	default: return false;
+	}
+}
+
+bool FOutputFramesScanner::ParseFrameNumber(const FString& FilePath, int& OutFrameNumber)
+{
+	const FString BaseName = FPaths::GetBaseFilename(FilePath);
+
+	// Find where the trailing digits start
+	int DigitsStart = BaseName.Len();
+	while (DigitsStart > 0 && FChar::IsDigit(BaseName[DigitsStart - 1]))
+	{
+		DigitsStart--;
+	}
+	if (DigitsStart == BaseName.Len())
+	{
+		return false;
+	}
+
+	OutFrameNumber = FCString::Atoi(*BaseName.RightChop(DigitsStart));
+	return true;
+}
+
+bool FOutputFramesScanner::IsPngFileComplete(const TArray<uint8>& FileEnd)
+{
+	// The last chunk is the IEND chunk, consisting of the zero length, the chunk type and the CRC
+	const int TypeOffset = FileEnd.Num() - 8;
+	return
+		FileEnd[TypeOffset] == 'I' &&
+		FileEnd[TypeOffset + 1] == 'E' &&
+		FileEnd[TypeOffset + 2] == 'N' &&
+		FileEnd[TypeOffset + 3] == 'D';
+}
+
+bool FOutputFramesScanner::IsJpegFileComplete(const TArray<uint8>& FileEnd)
+{
+	return FileEnd[FileEnd.Num() - 2] == 0xFF && FileEnd[FileEnd.Num() - 1] == 0xD9;
+}
+
+bool FOutputFramesScanner::IsExrFileComplete(FArchive& FileReader)
+{
+	const int32 ExrMagicNumber = 20000630;
+	const int32 TiledFlag = 0x200;
+	const int32 NonImageFlag = 0x800;
+	const int32 MultipartFlag = 0x1000;
+
+	int32 MagicNumber = 0;
+	int32 Version = 0;
+	FileReader << MagicNumber;
+	FileReader << Version;
+	if (FileReader.IsError() || MagicNumber != ExrMagicNumber)
+	{
+		return false;
+	}
+
+	// Only single part scanline images are written by the plugin, so there is no need to validate other layouts
+	if ((Version & (TiledFlag | NonImageFlag | MultipartFlag)) != 0)
+	{
+		return true;
+	}
+
+	// Read header attributes until the empty attribute name marking the end of the header
+	int32 DataWindowMinY = 0;
+	int32 DataWindowMaxY = -1;
+	uint8 Compression = 0;
+	auto ReadNullTerminatedString = [&FileReader]()
+	{
+		FString String;
+		uint8 Character = 0;
+		FileReader << Character;
+		while (Character != 0 && !FileReader.IsError())
+		{
+			String.AppendChar(Character);
+			FileReader << Character;
+		}
+		return String;
+	};
+	while (true)
+	{
+		// Attributes consist of the null-terminated name and type, followed by the value size and the value
+		const FString AttributeName = ReadNullTerminatedString();
+		if (FileReader.IsError())
+		{
+			return false;
+		}
+		if (AttributeName.IsEmpty())
+		{
+			break;
+		}
+		ReadNullTerminatedString();
+
+		int32 AttributeSize = 0;
+		FileReader << AttributeSize;
+		const int64 AttributeEnd = FileReader.Tell() + AttributeSize;
+		if (FileReader.IsError() || AttributeSize < 0 || AttributeEnd > FileReader.TotalSize())
+		{
+			return false;
+		}
+
+		if (AttributeName == TEXT("dataWindow") && AttributeSize == 4 * sizeof(int32))
+		{
+			int32 DataWindowMinX = 0;
+			int32 DataWindowMaxX = 0;
+			FileReader << DataWindowMinX << DataWindowMinY << DataWindowMaxX << DataWindowMaxY;
+		}
+		else if (AttributeName == TEXT("compression") && AttributeSize == sizeof(uint8))
+		{
+			FileReader << Compression;
+		}
+		FileReader.Seek(AttributeEnd);
+	}
+
+	// Number of scanlines stored within a single chunk depends on the compression
+	int LinesPerChunk;
+	switch (Compression)
+	{
+	case 0: case 1: case 2: LinesPerChunk = 1; break;		// NONE, RLE, ZIPS
+	case 3: case 5: LinesPerChunk = 16; break;				// ZIP, PXR24
+	case 4: case 6: case 7: case 8: LinesPerChunk = 32; break;	// PIZ, B44, B44A, DWAA
+	case 9: LinesPerChunk = 256; break;						// DWAB
+	default: return false;
+	}
+	const int64 Height = static_cast<int64>(DataWindowMaxY) - DataWindowMinY + 1;
+	const int64 ChunkCount = (Height + LinesPerChunk - 1) / LinesPerChunk;
+	if (ChunkCount <= 0)
+	{
+		return false;
+	}
+
+	// Find the chunk stored last inside the file
+	uint64 LastChunkOffset = 0;
+	for (int64 i = 0; i < ChunkCount; i++)
+	{
+		uint64 ChunkOffset = 0;
+		FileReader << ChunkOffset;
+		LastChunkOffset = FMath::Max(LastChunkOffset, ChunkOffset);
+	}
+	if (FileReader.IsError() || LastChunkOffset == 0 || LastChunkOffset + 8 > static_cast<uint64>(FileReader.TotalSize()))
+	{
+		return false;
+	}
+
+	// Each chunk starts with its first scanline y coordinate and its data size
+	int32 ChunkY = 0;
+	int32 ChunkDataSize = 0;
+	FileReader.Seek(LastChunkOffset);
+	FileReader << ChunkY << ChunkDataSize;
+	if (FileReader.IsError() || ChunkDataSize < 0)
+	{
+		return false;
+	}
+
+	return LastChunkOffset + 8 + ChunkDataSize <= static_cast<uint64>(FileReader.TotalSize());
+}
+
+FString FOutputFramesScanner::FileExtension(const EImageFormat ImageFormat)
+{
+	switch (ImageFormat)
+	{
+	case EImageFormat::JPEG: return TEXT("jpeg"); break;
+	case EImageFormat::PNG: return TEXT("png"); break;
+	case EImageFormat::EXR: return TEXT("exr"); break;
+	default: return TEXT("");
+	}
+}
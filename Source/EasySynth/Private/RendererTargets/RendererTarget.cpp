@@ -2,59 +2,100 @@
 
 #include "RendererTargets/RendererTarget.h"
 
-#include "ILevelSequenceEditorToolkit.h"
-#include "ISequencer.h"
-#include "LevelSequence.h"
-#include "MovieScene.h"
-#include "Sections/MovieSceneCameraCutSection.h"
-#include "Subsystems/AssetEditorSubsystem.h"
+#include "Camera/CameraComponent.h"
+#include "MoviePipelineDeferredPasses.h"
 
 #include "EasySynth.h"
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
+#include "RendererTargets/PostProcessMaterialCache.h"
 #include "SequencerWrapper.h"
 
 
-TArray<UCameraComponent*> FRendererTarget::GetCameras(ULevelSequence* LevelSequence)
+UMaterialInterface* FRendererTarget::PostProcessMaterial()
 {
-	TArray<UCameraComponent*> Cameras;
+	const FString Key = PostProcessMaterialKey();
+	if (PostProcessMaterialCache != nullptr)
+	{
+		UMaterialInterface* CachedMaterial = PostProcessMaterialCache->Find(Key);
+		if (CachedMaterial != nullptr)
+		{
+			return CachedMaterial;
+		}
+	}
 
-	FSequencerWrapper SequencerWrapper;
-	if (!SequencerWrapper.OpenSequence(LevelSequence))
+	UMaterialInterface* Material = CreatePostProcessMaterial();
+	if (Material != nullptr && PostProcessMaterialCache != nullptr)
 	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Sequencer wrapper opening failed"), *FString(__FUNCTION__))
-		return Cameras;
+		PostProcessMaterialCache->Add(Key, Material);
 	}
+	return Material;
+}
+
+const TArray<UCameraComponent*>& FRendererTarget::GetCameras(const FSequencerWrapper& SequencerWrapper)
+{
+	// Cameras are resolved once when the sequence is opened, and shared by all targets
+	return SequencerWrapper.GetCutSectionCameras();
+}
+
+EEXRChannelLayoutLocal FRendererTarget::ExrChannelLayout() const
+{
+	return EEXRChannelLayoutLocal::RGBA;
+}
 
-	// Get the camera from each section
-	TArray<UMovieSceneCameraCutSection*>& CutSections = SequencerWrapper.GetMovieSceneCutSections();
-	for (auto CutSection : CutSections)
+EEXRCompressionFormatLocal FRendererTarget::ExrCompression() const
+{
+	return EEXRCompressionFormatLocal::PIZ;
+}
+
+bool FRendererTarget::ConfigureRenderPass(UMoviePipelineDeferredPassBase* DeferredPass)
+{
+	if (DeferredPass == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Deferred render pass is null"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	// Only the main pass is rendered, the target post process material is bound to cameras
+	DeferredPass->bRenderMainPass = true;
+	DeferredPass->AdditionalPostProcessMaterials.Empty();
+
+	return true;
+}
+
+bool FRendererTarget::ClearCameraPostProcess(const FSequencerWrapper& SequencerWrapper)
+{
+	// Get all camera components bound to the level sequence
+	const TArray<UCameraComponent*>& Cameras = GetCameras(SequencerWrapper);
+	if (Cameras.Num() == 0)
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: No cameras bound to the level sequence found"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	// Clear post process materials
+	for (UCameraComponent* Camera : Cameras)
 	{
-		// Get the camera componenet
-		UCameraComponent* Camera = CutSection->GetFirstCamera(
-			*SequencerWrapper.GetSequencer(),
-			SequencerWrapper.GetSequencer()->GetFocusedTemplateID());
 		if (Camera == nullptr)
 		{
-			UE_LOG(LogEasySynth, Error, TEXT("%s: Cut section camera component is null"), *FString(__FUNCTION__))
-			Cameras.Empty();
-			return Cameras;
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Found camera is null"), *FString(__FUNCTION__))
+			return false;
 		}
-		Cameras.Add(Camera);
+		Camera->PostProcessSettings.WeightedBlendables.Array.Empty();
 	}
 
-	return Cameras;
+	return true;
 }
 
-bool FRendererTarget::ClearCameraPostProcess(ULevelSequence* LevelSequence)
+bool FRendererTarget::BindCameraPostProcess(const FSequencerWrapper& SequencerWrapper, UMaterialInterface* Material)
 {
 	// Get all camera components bound to the level sequence
-	TArray<UCameraComponent*> Cameras = GetCameras(LevelSequence);
+	const TArray<UCameraComponent*>& Cameras = GetCameras(SequencerWrapper);
 	if (Cameras.Num() == 0)
 	{
 		UE_LOG(LogEasySynth, Warning, TEXT("%s: No cameras bound to the level sequence found"), *FString(__FUNCTION__))
 		return false;
 	}
 
-	// Clear post process materials
 	for (UCameraComponent* Camera : Cameras)
 	{
 		if (Camera == nullptr)
@@ -62,7 +103,9 @@ bool FRendererTarget::ClearCameraPostProcess(ULevelSequence* LevelSequence)
 			UE_LOG(LogEasySynth, Error, TEXT("%s: Found camera is null"), *FString(__FUNCTION__))
 			return false;
 		}
+
 		Camera->PostProcessSettings.WeightedBlendables.Array.Empty();
+		Camera->PostProcessSettings.WeightedBlendables.Array.Add(FWeightedBlendable(1.0f, Material));
 	}
 
 	return true;
@@ -4,18 +4,79 @@
 
 #include "Camera/CameraComponent.h"
 #include "LevelSequence.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialExpressionCustom.h"
+#include "Materials/MaterialExpressionSceneTexture.h"
 
 #include "EasySynth.h"
+#include "EXROutput/MoviePipelineEXROutputLocal.h"
+#include "ImageWriting/PalettePngEncoder.h"
+#include "TextureStyles/TextureMappingAsset.h"
 #include "TextureStyles/TextureStyleManager.h"
 
 
-bool FSemanticImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
+ETextureStyle FSemanticImageTarget::TextureStyle() const
 {
+	// Stencil semantics do not need any material changes, so the target can share the job with color targets
+	return bStencilSemantics ? ETextureStyle::COLOR : ETextureStyle::SEMANTIC;
+}
+
+EEXRCompressionFormatLocal FSemanticImageTarget::ExrCompression() const
+{
+	return EEXRCompressionFormatLocal::ZIP;
+}
+
+TArray<FColor> FSemanticImageTarget::PngPalette() const
+{
+	TArray<FColor> Palette;
+	if (WritesPaletteImages())
+	{
+		for (const FSemanticClass* SemanticClass : TextureStyleManager->SemanticClasses())
+		{
+			Palette.Add(SemanticClass->Color);
+		}
+	}
+	return Palette;
+}
+
+UMaterialInterface* FSemanticImageTarget::CreatePostProcessMaterial()
+{
+	if (bStencilSemantics)
+	{
+		return StencilPostProcessMaterial();
+	}
+
+	UMaterial* Material = LoadPostProcessMaterial();
+	if (Material == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load semantic post process material"), *FString(__FUNCTION__))
+	}
+	return Material;
+}
+
+FString FSemanticImageTarget::PostProcessMaterialKey() const
+{
+	return FString::Printf(TEXT("%s_%d"), *Name(), bStencilSemantics);
+}
+
+bool FSemanticImageTarget::PrepareSequence(const FSequencerWrapper& SequencerWrapper)
+{
+	if (WritesPaletteImages() && TextureStyleManager->SemanticClasses().Num() > FPalettePngEncoder::MaxPaletteSize)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Palette-indexed images support at most %d semantic classes"),
+			*FString(__FUNCTION__), FPalettePngEncoder::MaxPaletteSize)
+		return false;
+	}
+
 	// Update texture style inside the level
-	TextureStyleManager->CheckoutTextureStyle(ETextureStyle::SEMANTIC);
+	TextureStyleManager->CheckoutTextureStyle(TextureStyle());
+	if (!PrepareLevel())
+	{
+		return false;
+	}
 
 	// Get all camera components bound to the level sequence
-	TArray<UCameraComponent*> Cameras = GetCameras(LevelSequence);
+	const TArray<UCameraComponent*>& Cameras = GetCameras(SequencerWrapper);
 	if (Cameras.Num() == 0)
 	{
 		UE_LOG(LogEasySynth, Warning, TEXT("%s: No cameras bound to the level sequence found"), *FString(__FUNCTION__))
@@ -23,10 +84,9 @@ bool FSemanticImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 	}
 
 	// Prepare the camera post process material
-	UMaterial* PostProcessMaterial = LoadPostProcessMaterial();
-	if (PostProcessMaterial == nullptr)
+	UMaterialInterface* CameraPostProcessMaterial = PostProcessMaterial();
+	if (CameraPostProcessMaterial == nullptr)
 	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not load semantic post process material"), *FString(__FUNCTION__))
 		return false;
 	}
 
@@ -38,13 +98,95 @@ bool FSemanticImageTarget::PrepareSequence(ULevelSequence* LevelSequence)
 			return false;
 		}
 		Camera->PostProcessSettings.WeightedBlendables.Array.Empty();
-		Camera->PostProcessSettings.WeightedBlendables.Array.Add(FWeightedBlendable(1.0f, PostProcessMaterial));
+		Camera->PostProcessSettings.WeightedBlendables.Array.Add(FWeightedBlendable(1.0f, CameraPostProcessMaterial));
+	}
+
+	return true;
+}
+
+bool FSemanticImageTarget::FinalizeSequence(const FSequencerWrapper& SequencerWrapper)
+{
+	FinalizeLevel();
+	return ClearCameraPostProcess(SequencerWrapper);
+}
+
+bool FSemanticImageTarget::PrepareLevel()
+{
+	if (!bStencilSemantics)
+	{
+		return true;
 	}
 
+	if (!TextureStyleManager->ApplySemanticStencils())
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not apply semantic stencil values"), *FString(__FUNCTION__))
+		return false;
+	}
 	return true;
 }
 
-bool FSemanticImageTarget::FinalizeSequence(ULevelSequence* LevelSequence)
+void FSemanticImageTarget::FinalizeLevel()
 {
-	return ClearCameraPostProcess(LevelSequence);
+	if (bStencilSemantics)
+	{
+		TextureStyleManager->RestoreSemanticStencils();
+	}
+}
+
+UMaterialInterface* FSemanticImageTarget::StencilPostProcessMaterial()
+{
+	// Bake class colors into the lookup table, indexed by the stencil value decreased by one
+	// Class colors are sRGB, while the material outputs linear colors that get sRGB encoded when written
+	const TArray<const FSemanticClass*> SemanticClasses = TextureStyleManager->SemanticClasses();
+	TArray<FString> PaletteEntries;
+	for (const FSemanticClass* SemanticClass : SemanticClasses)
+	{
+		const FLinearColor LinearColor(SemanticClass->Color);
+		PaletteEntries.Add(FString::Printf(TEXT("float3(%.9ef, %.9ef, %.9ef)"),
+			LinearColor.R, LinearColor.G, LinearColor.B));
+	}
+	if (PaletteEntries.Num() == 0)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: No semantic classes found"), *FString(__FUNCTION__))
+		return nullptr;
+	}
+
+	UMaterial* Material = NewObject<UMaterial>(GetTransientPackage(), NAME_None, RF_Transient);
+	if (Material == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not create the stencil post process material"), *FString(__FUNCTION__))
+		return nullptr;
+	}
+	Material->MaterialDomain = EMaterialDomain::MD_PostProcess;
+	// Replacing the tonemapper keeps class colors exact, and stencil values are never anti-aliased
+	Material->BlendableLocation = EBlendableLocation::BL_ReplacingTonemapper;
+
+	UMaterialExpressionSceneTexture* StencilExpression = NewObject<UMaterialExpressionSceneTexture>(Material);
+	StencilExpression->SceneTextureId = ESceneTextureId::PPI_CustomStencil;
+	Material->GetExpressionCollection().AddExpression(StencilExpression);
+
+	UMaterialExpressionCustom* PaletteExpression = NewObject<UMaterialExpressionCustom>(Material);
+	PaletteExpression->Description = TEXT("SemanticStencilPalette");
+	PaletteExpression->OutputType = ECustomMaterialOutputType::CMOT_Float3;
+	PaletteExpression->Inputs.Empty();
+	FCustomInput& StencilInput = PaletteExpression->Inputs.AddDefaulted_GetRef();
+	StencilInput.InputName = TEXT("Stencil");
+	StencilInput.Input.Connect(0, StencilExpression);
+	// Pixels without actors and unknown stencil values get the undefined class color, same as when swapping materials
+	PaletteExpression->Code = FString::Printf(TEXT(
+		"const float3 Palette[%d] = { %s };\n"
+		"const int Index = (int)round(Stencil.r);\n"
+		"if (Index < 1 || Index > %d) { return Palette[%d]; }\n"
+		"return Palette[Index - 1];"),
+		PaletteEntries.Num(), *FString::Join(PaletteEntries, TEXT(", ")), PaletteEntries.Num(),
+		UTextureStyleManager::UndefinedSemanticClassId);
+	Material->GetExpressionCollection().AddExpression(PaletteExpression);
+
+	Material->GetEditorOnlyData()->EmissiveColor.Connect(0, PaletteExpression);
+
+	// Compile the material, rendering waits for shader compilation to finish before starting
+	Material->PreEditChange(nullptr);
+	Material->PostEditChange();
+
+	return Material;
 }
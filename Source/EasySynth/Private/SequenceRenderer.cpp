@@ -2,34 +2,128 @@
 
 #include "SequenceRenderer.h"
 
+#include "Async/Async.h"
 #include "CineCameraComponent.h"
+#include "ContentStreaming.h"
 #include "ISequencer.h"
+#include "HAL/FileManager.h"
+#include "JsonObjectConverter.h"
+#include "Materials/MaterialInterface.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "MoviePipelineAntiAliasingSetting.h"
+#include "MoviePipelineCameraSetting.h"
+#include "MoviePipelineDeferredPasses.h"
 #include "MoviePipelineImageSequenceOutput.h"
 #include "MoviePipelineOutputSetting.h"
 #include "MoviePipelineQueueSubsystem.h"
 #include "MovieRenderPipelineSettings.h"
+#include "MovieScene.h"
+#include "MovieSceneCommonHelpers.h"
+#include "MovieSceneTimeHelpers.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 #include "Sections/MovieSceneCameraCutSection.h"
+#include "ShaderCompiler.h"
 
 #include "EasySynth.h"
 #include "EXROutput/MoviePipelineEXROutputLocal.h"
+#include "FrameSelectionSetting.h"
+#include "ImageWriting/DatasetArchiveWriter.h"
+#include "ImageWriting/ImagePyramid.h"
+#include "ImageWriting/ImageWriterPool.h"
+#include "ImageWriting/OpticalFlowPostProcessor.h"
+#include "ImageWriting/PooledImageSequenceOutputs.h"
+#include "ImageWriting/SharedMemoryFrameOutput.h"
 #include "PathUtils.h"
 #include "RendererTargets/CameraPoseExporter.h"
+#include "RendererTargets/OutputFramesScanner.h"
 #include "RendererTargets/RendererTarget.h"
 #include "TextureStyles/SemanticCsvInterface.h"
+#include "TrajectoryPreloadSetting.h"
 
 
 const float FRendererTargetOptions::DefaultDepthRangeMetersValue = 100.0f;
 const float FRendererTargetOptions::DefaultOpticalFlowScaleValue = 1.0f;
+const int FRendererTargetOptions::DefaultExrCompressionLevelValue = 45;
+const int FRendererTargetOptions::DefaultArchiveSizeMegabytesValue = 1024;
+const int FRendererTargetOptions::DefaultMaxInFlightImagesValue = 16;
+const FString FRendererTargetOptions::DefaultVideoEncoderPathValue(TEXT("ffmpeg"));
+const int FRendererTargetOptions::DefaultStreamSlotCountValue = 4;
+const int FRendererTargetOptions::DefaultStreamSlotSizeMegabytesValue = 128;
+const TCHAR* FRendererTargetOptions::ShardIndexSwitch = TEXT("EasySynthShardIndex=");
+const TCHAR* FRendererTargetOptions::ShardCountSwitch = TEXT("EasySynthShardCount=");
+const TCHAR* FRendererTargetOptions::StartFrameSwitch = TEXT("EasySynthStartFrame=");
+const TCHAR* FRendererTargetOptions::EndFrameSwitch = TEXT("EasySynthEndFrame=");
+const TCHAR* FRendererTargetOptions::FrameShardCountSwitch = TEXT("EasySynthFrameShardCount=");
+
+const float USequenceRenderer::RendererPauseCheckIntervalSeconds = 0.1f;
+const float USequenceRenderer::RendererPauseMaxSeconds = 2.0f;
+const float USequenceRenderer::RenderingProgressIntervalSeconds = 1.0f;
+const int USequenceRenderer::MaxDroppedFrameCount = 16;
+const double USequenceRenderer::RenderingProgressLogIntervalSeconds = 10.0;
 
 FRendererTargetOptions::FRendererTargetOptions() :
 	bExportCameraPoses(false),
+	bBinaryCameraPoses(false),
+	bSinglePassRendering(false),
+	bPackExrTargets(false),
+	bRenderAllCamerasInOneJob(false),
+	bStencilSemantics(false),
+	bMetricDepth(false),
+	bPackOutputArchives(false),
+	bColorVideoOutput(false),
+	bPaletteSemantics(false),
+	bProcessOpticalFlow(false),
+	ShardIndexValue(0),
+	ShardCountValue(1),
+	bResumeRendering(false),
+	bCustomFrameRange(false),
+	StartFrameValue(0),
+	EndFrameValue(0),
+	FrameShardCountValue(1),
+	FrameStrideValue(1),
+	KeyframeDistanceValue(0.0f),
+	KeyframeAngleValue(0.0f),
 	DepthRangeMetersValue(DefaultDepthRangeMetersValue),
-	OpticalFlowScaleValue(DefaultOpticalFlowScaleValue)
+	OpticalFlowScaleValue(DefaultOpticalFlowScaleValue),
+	ExrCompressionLevelValue(DefaultExrCompressionLevelValue),
+	ArchiveSizeMegabytesValue(DefaultArchiveSizeMegabytesValue),
+	MaxInFlightImagesValue(DefaultMaxInFlightImagesValue),
+	VideoCodecValue(EVideoCodec::H264),
+	VideoEncoderPathValue(DefaultVideoEncoderPathValue),
+	SchedulerTypeValue(ERenderSchedulerType::TEXTURE_STYLE_MAJOR),
+	StreamSlotCountValue(DefaultStreamSlotCountValue),
+	StreamSlotSizeMegabytesValue(DefaultStreamSlotSizeMegabytesValue),
+	PyramidLevelsValue(1),
+	PreloadFramesValue(0)
 {
 	SelectedTargets.Init(false, TargetType::COUNT);
 	OutputFormats.Init(EImageFormat::JPEG, TargetType::COUNT);
 }
 
+void FRendererTargetOptions::ApplyCommandLineSwitches(const TCHAR* CommandLine)
+{
+	int ShardIndex = ShardIndexValue;
+	int ShardCount = ShardCountValue;
+	FParse::Value(CommandLine, ShardIndexSwitch, ShardIndex);
+	FParse::Value(CommandLine, ShardCountSwitch, ShardCount);
+	SetShard(ShardIndex, ShardCount);
+
+	int FrameShardCount = FrameShardCountValue;
+	if (FParse::Value(CommandLine, FrameShardCountSwitch, FrameShardCount))
+	{
+		SetFrameShardCount(FrameShardCount);
+	}
+
+	int StartFrame = 0;
+	int EndFrame = 0;
+	if (FParse::Value(CommandLine, StartFrameSwitch, StartFrame) && FParse::Value(CommandLine, EndFrameSwitch, EndFrame))
+	{
+		SetFrameRange(StartFrame, EndFrame);
+	}
+}
+
 bool FRendererTargetOptions::AnyOptionSelected() const
 {
 	for (bool TargetSelected : SelectedTargets)
@@ -53,22 +147,54 @@ void FRendererTargetOptions::GetSelectedTargets(
 	TQueue<TSharedPtr<FRendererTarget>>& OutTargetsQueue) const
 {
 	OutTargetsQueue.Empty();
+	TArray<TSharedPtr<FMultiPassTarget>> MultiPassTargets;
 	for (int i = 0; i < TargetType::COUNT; i++)
 	{
 		if (SelectedTargets[i])
 		{
 			TSharedPtr<FRendererTarget> Target = RendererTarget(i, TextureStyleManager);
-			if (Target != nullptr)
-			{
-				OutTargetsQueue.Enqueue(Target);
-			}
-			else
+			if (Target == nullptr)
 			{
 				UE_LOG(LogEasySynth, Error, TEXT("%s: Target selection mapped to null renderer target"),
 					*FString(__FUNCTION__))
 				OutTargetsQueue.Empty();
 				return;
 			}
+
+			// Palettes are bound to the whole job, so targets writing palette-indexed images are never grouped,
+			// same as exr targets the engine output would write differently when the grouped targets are not packed
+			if (!bSinglePassRendering || Target->PngPalette().Num() > 0 ||
+				(Target->ImageFormat == EImageFormat::EXR && !bPackExrTargets && !EngineExrOutputMatches(*Target)))
+			{
+				OutTargetsQueue.Enqueue(Target);
+				continue;
+			}
+
+			// Add the target to the group that shares its texture style and output format
+			TSharedPtr<FMultiPassTarget>* MultiPassTarget = MultiPassTargets.FindByPredicate(
+				[&Target](const TSharedPtr<FMultiPassTarget>& Group)
+				{
+					return Group->TextureStyle() == Target->TextureStyle() && Group->ImageFormat == Target->ImageFormat;
+				});
+			if (MultiPassTarget == nullptr)
+			{
+				MultiPassTarget = &MultiPassTargets.Add_GetRef(MakeShared<FMultiPassTarget>(
+					TextureStyleManager, Target->ImageFormat, Target->TextureStyle(), bPackExrTargets));
+			}
+			(*MultiPassTarget)->AddTarget(Target);
+		}
+	}
+
+	// Groups containing a single target are rendered the same way as without grouping
+	for (TSharedPtr<FMultiPassTarget>& MultiPassTarget : MultiPassTargets)
+	{
+		if (MultiPassTarget->GetTargets().Num() == 1)
+		{
+			OutTargetsQueue.Enqueue(MultiPassTarget->GetTargets()[0]);
+		}
+		else
+		{
+			OutTargetsQueue.Enqueue(MultiPassTarget);
 		}
 	}
 }
@@ -80,23 +206,45 @@ TSharedPtr<FRendererTarget> FRendererTargetOptions::RendererTarget(
 	const EImageFormat OutputFormat = OutputFormats[TargetType];
 	switch (TargetType)
 	{
-	case COLOR_IMAGE: return MakeShared<FColorImageTarget>(TextureStyleManager, OutputFormat); break;
+	case COLOR_IMAGE: return MakeShared<FColorImageTarget>(
+		TextureStyleManager, bColorVideoOutput ? FVideoSequenceEncoder::ImageFormat : OutputFormat); break;
 	case DEPTH_IMAGE: return MakeShared<FDepthImageTarget>(
-		TextureStyleManager, OutputFormat, DepthRangeMetersValue); break;
+		TextureStyleManager, OutputFormat, DepthRangeMetersValue, bMetricDepth); break;
 	case NORMAL_IMAGE: return MakeShared<FNormalImageTarget>(TextureStyleManager, OutputFormat); break;
 	case OPTICAL_FLOW_IMAGE: return MakeShared<FOpticalFlowImageTarget>(
 		TextureStyleManager, OutputFormat, OpticalFlowScaleValue); break;
-	case SEMANTIC_IMAGE: return MakeShared<FSemanticImageTarget>(TextureStyleManager, OutputFormat); break;
+	case SEMANTIC_IMAGE: return MakeShared<FSemanticImageTarget>(
+		TextureStyleManager, OutputFormat, bStencilSemantics, bPaletteSemantics); break;
+	case INSTANCE_ID_IMAGE: return MakeShared<FInstanceIdImageTarget>(TextureStyleManager, OutputFormat); break;
 	case CUSTOM_PP_MATERIAL: return MakeShared<FCustomPPMaterialTarget>(
 		TextureStyleManager, OutputFormat, Cast<UMaterial>(CustomPostProcessMaterialAssetData.GetAsset())); break;
 	default: return nullptr;
 	}
 }
 
+bool FRendererTargetOptions::EngineExrOutputMatches(const FRendererTarget& Target) const
+{
+	return PyramidLevelsValue <= 1 &&
+		ExrCompressionLevelValue == DefaultExrCompressionLevelValue &&
+		Target.ExrChannelLayout() == EEXRChannelLayoutLocal::RGBA &&
+		Target.ExrCompression() == EEXRCompressionFormatLocal::PIZ;
+}
+
 USequenceRenderer::USequenceRenderer() :
 	EasySynthMoviePipelineConfig(DuplicateObject<UMoviePipelinePrimaryConfig>(
 		LoadObject<UMoviePipelinePrimaryConfig>(nullptr, *FPathUtils::DefaultMoviePipelineConfigPath()), nullptr)),
+	PreparationStepId(0),
+	NextWorkItemIndex(0),
+	TotalWorkItems(0),
+	StartedWorkItems(0),
+	DefaultAntiAliasingSetting(nullptr),
 	bCurrentlyRendering(false),
+	LastProgressLogTime(0.0),
+	ShaderWarmUpStartTime(0.0),
+	ShaderWarmUpSeconds(0.0),
+	RenderingStartTime(0.0),
+	TargetRenderStartTime(0.0),
+	TargetOutputSizeBefore(0),
 	ErrorMessage("")
 {
 	// Check if the config asset is loaded correctly
@@ -106,6 +254,22 @@ USequenceRenderer::USequenceRenderer() :
 		UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 		check(EasySynthMoviePipelineConfig)
 	}
+
+	// Remember the default file name format, as multi-pass jobs prefix it with the pass name
+	UMoviePipelineOutputSetting* OutputSetting =
+		EasySynthMoviePipelineConfig->FindSetting<UMoviePipelineOutputSetting>();
+	if (OutputSetting != nullptr)
+	{
+		DefaultFileNameFormat = OutputSetting->FileNameFormat;
+	}
+
+	// Remember the default anti-aliasing, as targets requiring exact pixel values disable it
+	UMoviePipelineAntiAliasingSetting* AntiAliasingSetting = Cast<UMoviePipelineAntiAliasingSetting>(
+		EasySynthMoviePipelineConfig->FindOrAddSettingByClass(UMoviePipelineAntiAliasingSetting::StaticClass(), true));
+	if (AntiAliasingSetting != nullptr)
+	{
+		DefaultAntiAliasingSetting = DuplicateObject<UMoviePipelineAntiAliasingSetting>(AntiAliasingSetting, this);
+	}
 }
 
 bool USequenceRenderer::RenderSequence(
@@ -113,9 +277,21 @@ bool USequenceRenderer::RenderSequence(
 	const FRendererTargetOptions RenderingTargets,
 	const FIntPoint OutputImageResolution,
 	const FString& OutputDirectory)
+{
+	return RenderSequences({ LevelSequenceAssetData }, RenderingTargets, OutputImageResolution, { OutputDirectory });
+}
+
+bool USequenceRenderer::RenderSequences(
+	const TArray<FAssetData>& LevelSequenceAssets,
+	FRendererTargetOptions RenderingTargets,
+	const FIntPoint OutputImageResolution,
+	const TArray<FString>& OutputDirectories)
 {
 	UE_LOG(LogEasySynth, Log, TEXT("%s"), *FString(__FUNCTION__))
 
+	// Editor instances started as render workers select their shard and frame range through the command line
+	RenderingTargets.ApplyCommandLineSwitches(FCommandLine::Get());
+
 	if (TextureStyleManager == nullptr)
 	{
 		UE_LOG(LogEasySynth, Error, TEXT("%s: Texture style manager is null"), *FString(__FUNCTION__))
@@ -130,12 +306,11 @@ bool USequenceRenderer::RenderSequence(
 		return false;
 	}
 
-	// Check if LevelSequence is valid
-	RenderingSequencePath = LevelSequenceAssetData.GetSoftObjectPath();
-	RenderingSequence = Cast<ULevelSequence>(LevelSequenceAssetData.GetAsset());
-	if (RenderingSequence == nullptr)
+	// Check if each level sequence has its output directory
+	if (LevelSequenceAssets.Num() == 0 || LevelSequenceAssets.Num() != OutputDirectories.Num())
 	{
-		ErrorMessage = "Provided level sequence is null";
+		ErrorMessage = FString::Printf(TEXT("Expected an output directory for each of %d level sequences, got %d"),
+			LevelSequenceAssets.Num(), OutputDirectories.Num());
 		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 		return false;
 	}
@@ -148,80 +323,299 @@ bool USequenceRenderer::RenderSequence(
 		return false;
 	}
 
+	// Check if the selected shard is valid
+	if (!RenderingTargets.ShardValid())
+	{
+		ErrorMessage = FString::Printf(TEXT("Invalid rendering shard %d of %d"),
+			RenderingTargets.ShardIndex(), RenderingTargets.ShardCount());
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
+	// Check if the frame shard count is valid
+	if (RenderingTargets.FrameShardCount() < 1)
+	{
+		ErrorMessage = FString::Printf(TEXT("Invalid frame shard count %d"), RenderingTargets.FrameShardCount());
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
+	// Archives are packed from the whole output directory, which other shards may still be writing to
+	if (RenderingTargets.PackOutputArchives() && RenderingTargets.ShardCount() > 1)
+	{
+		ErrorMessage = "Outputs can not be packed into archives when the rendering is split into shards";
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
+	// Videos are encoded from all frames of a camera, which other shards may still be rendering
+	if (RenderingTargets.ColorVideoOutput() && RenderingTargets.ShardCount() > 1)
+	{
+		ErrorMessage = "Color images can not be encoded into videos when the rendering is split into shards";
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
+	// Videos are encoded once all frames are rendered, so a missing encoder has to be found before the rendering starts
+	if (RenderingTargets.ColorVideoOutput() && !FVideoSequenceEncoder::IsExecutableAvailable(RenderingTargets.VideoEncoderPath()))
+	{
+		ErrorMessage = FString::Printf(TEXT("Color videos require ffmpeg, which could not be run from '%s'"),
+			*RenderingTargets.VideoEncoderPath());
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
+	// Optical flow is post-processed using the depth of neighbouring frames, which other shards may still be rendering
+	if (RenderingTargets.ProcessOpticalFlow() && RenderingTargets.ShardCount() > 1)
+	{
+		ErrorMessage = "Optical flow images can not be post-processed when the rendering is split into shards";
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
+	// Post-processing reads the decoded flow and depth values, which only exr images store
+	if (RenderingTargets.ProcessOpticalFlow() && (
+		!RenderingTargets.TargetSelected(FRendererTargetOptions::OPTICAL_FLOW_IMAGE) ||
+		!RenderingTargets.TargetSelected(FRendererTargetOptions::DEPTH_IMAGE) ||
+		RenderingTargets.OutputFormat(FRendererTargetOptions::OPTICAL_FLOW_IMAGE) != EImageFormat::EXR ||
+		RenderingTargets.OutputFormat(FRendererTargetOptions::DEPTH_IMAGE) != EImageFormat::EXR))
+	{
+		ErrorMessage = "Optical flow post-processing requires exr optical flow and depth images";
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
 	// Store parameters
 	RendererTargetOptions = RenderingTargets;
+	FImageWriterPool::SetMaxInFlightImages(RendererTargetOptions.MaxInFlightImages());
 	OutputResolution = OutputImageResolution;
-	RenderingDirectory = OutputDirectory;
+	CurrentRigCameraId = -1;
+	CurrentWorkItemId = -1;
+	RenderingStartTime = FPlatformTime::Seconds();
+	RenderReport = FRenderReportContent();
+	RenderReport.shard_index = RendererTargetOptions.ShardIndex();
+	RenderReport.shard_count = RendererTargetOptions.ShardCount();
+
+	// Prepare all of the sequences before starting, so that an invalid sequence does not fail the batch halfway
+	// Each sequence is prepared inside its own editor tick, so that the editor stays responsive on large batches
+	RenderingSequences.Empty();
+	PreparingSequenceAssets = LevelSequenceAssets;
+	PreparingOutputDirectories = OutputDirectories;
+	PreparationStepId = 0;
+	OriginalTextureStyle = TextureStyleManager->SelectedTextureStyle();
+	bCurrentlyRendering = true;
+	GEditor->GetEditorWorldContext().World()->GetTimerManager().SetTimerForNextTick(this, &USequenceRenderer::OnPreparationStep);
+
+	return true;
+}
+
+void USequenceRenderer::RestoreCameraAspectRatios(const FSequenceRenderingState& SequenceState)
+{
+	for (const FCameraAspectRatioState& AspectRatioState : SequenceState.OriginalCameraAspectRatios)
+	{
+		UCameraComponent* Camera = AspectRatioState.Camera.Get();
+		if (Camera == nullptr)
+		{
+			continue;
+		}
+
+		UCineCameraComponent* CineCameraComponent = Cast<UCineCameraComponent>(Camera);
+		if (CineCameraComponent != nullptr)
+		{
+			CineCameraComponent->Filmback.SensorHeight = AspectRatioState.SensorHeight;
+			CineCameraComponent->Filmback.SensorAspectRatio = AspectRatioState.SensorAspectRatio;
+		}
+		Camera->SetAspectRatio(AspectRatioState.AspectRatio);
+		Camera->SetConstraintAspectRatio(AspectRatioState.bConstrainAspectRatio);
+	}
+}
+
+void USequenceRenderer::OnPreparationStep()
+{
+	// Sequences are prepared first, followed by creating target materials, requesting their shaders
+	// and waiting for the shaders to compile
+	const int SequenceCount = PreparingSequenceAssets.Num();
+	const int StepCount = SequenceCount + 3;
+	const int StepId = PreparationStepId++;
+	const double StepStartTime = FPlatformTime::Seconds();
+
+	if (StepId < SequenceCount)
+	{
+		const FAssetData& LevelSequenceAsset = PreparingSequenceAssets[StepId];
+		PreparationProgressEvent.Broadcast(
+			FString::Printf(TEXT("Preparing the %s sequence"), *LevelSequenceAsset.AssetName.ToString()),
+			static_cast<float>(StepId) / StepCount);
+
+		FSequenceRenderingState& SequenceState = RenderingSequences.AddDefaulted_GetRef();
+		if (!PrepareSequenceState(LevelSequenceAsset, PreparingOutputDirectories[StepId], SequenceState))
+		{
+			// Propagate the error message set inside the PrepareSequenceState
+			// Cameras are only moved while rendering, so the partially prepared state is dropped
+			// once the aspect ratios changed by the PrepareSequenceState are reverted
+			ErrorMessage = FString::Printf(TEXT("%s: %s"), *LevelSequenceAsset.AssetName.ToString(), *ErrorMessage);
+			RestoreCameraAspectRatios(SequenceState);
+			RenderingSequences.Pop();
+			return BroadcastRenderingFinished(false);
+		}
+
+		RenderReport.sequence_preparation_seconds = FPlatformTime::Seconds() - RenderingStartTime;
+	}
+	else if (StepId == SequenceCount)
+	{
+		PreparationProgressEvent.Broadcast(TEXT("Creating target materials"), static_cast<float>(StepId) / StepCount);
+
+		// Create target materials once for the whole rendering, instead of once per camera and sequence
+		PostProcessMaterialCache.Empty();
+		if (!WarmUpPostProcessMaterials())
+		{
+			return BroadcastRenderingFinished(false);
+		}
+
+		RenderReport.warm_up_seconds += FPlatformTime::Seconds() - StepStartTime;
+	}
+	else if (StepId == SequenceCount + 1)
+	{
+		PreparationProgressEvent.Broadcast(TEXT("Compiling target shaders"), static_cast<float>(StepId) / StepCount);
+
+		// Make sure semantic bindings used by the rendering are saved, in case the editor does not exit cleanly
+		TextureStyleManager->FlushTextureMappingAssetSave();
+
+		WarmUpShaders();
+	}
+	else
+	{
+		// Repeat the step on every editor tick until the requested shaders are compiled
+		if (GShaderCompilingManager != nullptr && GShaderCompilingManager->IsCompiling())
+		{
+			PreparationProgressEvent.Broadcast(
+				FString::Printf(TEXT("Compiling target shaders, %d left"), GShaderCompilingManager->GetNumRemainingJobs()),
+				static_cast<float>(StepId) / StepCount);
+			PreparationStepId = StepId;
+			GEditor->GetEditorWorldContext().World()->GetTimerManager().SetTimerForNextTick(this, &USequenceRenderer::OnPreparationStep);
+			return;
+		}
+
+		ShaderWarmUpSeconds = FPlatformTime::Seconds() - ShaderWarmUpStartTime;
+		RenderReport.warm_up_seconds += ShaderWarmUpSeconds;
+		UE_LOG(LogEasySynth, Log, TEXT("%s: Compiled target shaders in %.2f s"), *FString(__FUNCTION__), ShaderWarmUpSeconds)
+
+		if (!PrepareRigCameras())
+		{
+			return BroadcastRenderingFinished(false);
+		}
+
+		ScheduleWorkItems();
+		TotalWorkItems = WorkItems.Num();
+		StartedWorkItems = 0;
+
+		PreparationProgressEvent.Broadcast(TEXT("Rendering"), 1.0f);
+		UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering %d sequences, shard %d/%d, using the %s scheduler..."),
+			*FString(__FUNCTION__), RenderingSequences.Num(), RendererTargetOptions.ShardIndex() + 1,
+			RendererTargetOptions.ShardCount(), *RenderReport.scheduler)
+
+		return FindNextTarget();
+	}
 
-	// Find the sequencer source actor
-	FSequencerWrapper SequencerWrapper;
-	if (!SequencerWrapper.OpenSequence(RenderingSequence))
+	GEditor->GetEditorWorldContext().World()->GetTimerManager().SetTimerForNextTick(this, &USequenceRenderer::OnPreparationStep);
+}
+
+bool USequenceRenderer::PrepareSequenceState(
+	const FAssetData& LevelSequenceAssetData,
+	const FString& OutputDirectory,
+	FSequenceRenderingState& OutSequenceState)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(USequenceRenderer::PrepareSequenceState);
+
+	// Check if LevelSequence is valid
+	OutSequenceState.SequencePath = LevelSequenceAssetData.GetSoftObjectPath();
+	OutSequenceState.Sequence = Cast<ULevelSequence>(LevelSequenceAssetData.GetAsset());
+	OutSequenceState.OutputDirectory = OutputDirectory;
+	if (OutSequenceState.Sequence == nullptr)
+	{
+		ErrorMessage = "Provided level sequence is null";
+		return false;
+	}
+
+	// Open the sequence once, its cut sections and cameras are shared by all targets and pose exports
+	FSequencerWrapper& SequencerWrapper = OutSequenceState.SequencerWrapper;
+	if (!SequencerWrapper.OpenSequence(OutSequenceState.Sequence))
 	{
 		ErrorMessage = "Sequencer wrapper opening failed";
-		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+		return false;
+	}
+
+	// Find frames to be rendered
+	if (!FindRenderingFrameRange(OutSequenceState))
+	{
+		// Propagate the error message set inside the FindRenderingFrameRange
 		return false;
 	}
 
 	// Assume the same source actor is used for all camera cuts
-	TArray<UMovieSceneCameraCutSection*> CutSections = SequencerWrapper.GetMovieSceneCutSections();
+	const TArray<UMovieSceneCameraCutSection*>& CutSections = SequencerWrapper.GetMovieSceneCutSections();
 	if (CutSections.Num() == 0)
 	{
-		UE_LOG(LogEasySynth, Warning, TEXT("%s: No sections inside the camera cut track"), *FString(__FUNCTION__))
+		ErrorMessage = "No sections inside the camera cut track";
 		return false;
 	}
 	UMovieSceneCameraCutSection* CutSection = CutSections[0];
 
 	// Get the sequence source actor
+	OutSequenceState.CameraRigBindingGuid = CutSection->GetCameraBindingID().GetGuid();
 	TArrayView<TWeakObjectPtr<>> SourceObjects = SequencerWrapper.GetSequencer()->FindBoundObjects(
-		CutSection->GetCameraBindingID().GetGuid(),
+		OutSequenceState.CameraRigBindingGuid,
 		SequencerWrapper.GetSequencer()->GetFocusedTemplateID());
 	if (SourceObjects.Num() == 0)
 	{
 		ErrorMessage = "No sources assigned to the sequencer";
-		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 		return false;
 	}
 
 	// Assume the same source actor is used throughout the camera cut
-	CameraRigActor = Cast<AActor>(SourceObjects[0].Get());
-	if (CameraRigActor == nullptr)
+	OutSequenceState.CameraRigActor = Cast<AActor>(SourceObjects[0].Get());
+	if (OutSequenceState.CameraRigActor == nullptr)
 	{
 		ErrorMessage = "Expected an actor as a sequence source";
-		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 		return false;
 	}
 
-	// Prepare rig cameras information
-	RigCameras.Empty();
-	CurrentRigCameraId = -1;
-
 	// Find all camera components inside the source actor
 	TArray<UActorComponent*> ActorComponents;
 	const bool bIncludeFromChildActors = true;
-	CameraRigActor->GetComponents(UCameraComponent::StaticClass(), ActorComponents, bIncludeFromChildActors);
+	OutSequenceState.CameraRigActor->GetComponents(UCameraComponent::StaticClass(), ActorComponents, bIncludeFromChildActors);
 
 	// If no mesh components are found, ignore the actor
 	if (ActorComponents.Num() == 0)
 	{
 		ErrorMessage = "No cameras found inside the actor";
-		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 		return false;
 	}
 
 	// Store pointers to all cameras inside the rig for later selection of the active camera
+	TArray<UCameraComponent*>& RigCameras = OutSequenceState.RigCameras;
 	for (UActorComponent* ActorComponent : ActorComponents)
 	{
 		UCameraComponent* CameraComponent = Cast<UCameraComponent>(ActorComponent);
 		if (CameraComponent == nullptr)
 		{
 			ErrorMessage = "Got null camera component";
-			UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 			return false;
 		}
 
+		// Remember the original aspect ratio, so that a failed preparation leaves the camera unchanged
+		FCameraAspectRatioState& AspectRatioState = OutSequenceState.OriginalCameraAspectRatios.AddDefaulted_GetRef();
+		AspectRatioState.Camera = CameraComponent;
+		AspectRatioState.AspectRatio = CameraComponent->AspectRatio;
+		AspectRatioState.bConstrainAspectRatio = CameraComponent->bConstrainAspectRatio;
+		UCineCameraComponent* CineCameraComponent = Cast<UCineCameraComponent>(CameraComponent);
+		if (CineCameraComponent != nullptr)
+		{
+			AspectRatioState.SensorHeight = CineCameraComponent->Filmback.SensorHeight;
+			AspectRatioState.SensorAspectRatio = CineCameraComponent->Filmback.SensorAspectRatio;
+		}
+
 		// Set required camera aspect ratio
 		const float AspectRatio = 1.0f * OutputResolution.X / OutputResolution.Y;
-		UCineCameraComponent* CineCameraComponent = Cast<UCineCameraComponent>(CameraComponent);
 		if (CineCameraComponent != nullptr)
 		{
 			// Additional steps needed for cine cameras
@@ -241,25 +635,24 @@ bool USequenceRenderer::RenderSequence(
 		return A.GetReadableName().Compare(B.GetReadableName()) < 0;
 	});
 
-	// Export camera rig information
-	FCameraRigRosInterface CameraRigRosInterface;
-	if (!CameraRigRosInterface.ExportCameraRig(RenderingDirectory, RigCameras, OutputResolution))
+	// Remember the transform of the first camera, that is used for rendering all cameras one by one
+	OutSequenceState.OriginalCameraTransform = RigCameras[0]->GetRelativeTransform();
+	OutSequenceState.OriginalCameraFOV = RigCameras[0]->FieldOfView;
+
+	// Outputs shared by all shards are only exported by the primary one
+	if (!RendererTargetOptions.IsPrimaryShard())
 	{
-		ErrorMessage = "Could not save the camera rig ROS JSON file";
-		UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
-		return false;
+		return true;
 	}
 
-	// Export camera rig poses if requested
-	if (RendererTargetOptions.ExportCameraPoses())
+	// Export camera rig information, each image pyramid level gets its own file
+	FCameraRigRosInterface CameraRigRosInterface;
+	for (int Level = 0; Level < RendererTargetOptions.PyramidLevels(); Level++)
 	{
-		FCameraPoseExporter CameraPoseExporter;
-		UCameraComponent* NoSpecificCamera = nullptr;
-		if (!CameraPoseExporter.ExportCameraPoses(
-			RenderingSequence, OutputResolution, RenderingDirectory, NoSpecificCamera))
+		if (!CameraRigRosInterface.ExportCameraRig(
+			OutputDirectory, RigCameras, OutputResolution, &BackgroundFileWriter, Level))
 		{
-			ErrorMessage = "Could not export camera rig poses";
-			UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
+			ErrorMessage = "Could not save the camera rig ROS JSON file";
 			return false;
 		}
 	}
@@ -267,31 +660,46 @@ bool USequenceRenderer::RenderSequence(
 	// Export semantic class information if semantic rendering is selected
 	if (RendererTargetOptions.TargetSelected(FRendererTargetOptions::TargetType::SEMANTIC_IMAGE))
 	{
-		if (!TextureStyleManager->ExportSemanticClasses(RenderingDirectory))
+		if (!TextureStyleManager->ExportSemanticClasses(OutputDirectory, &BackgroundFileWriter))
 		{
 			ErrorMessage = "Could not save the semantic class CSV file";
-			UE_LOG(LogEasySynth, Error, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 			return false;
 		}
 	}
 
-	OriginalTextureStyle = TextureStyleManager->SelectedTextureStyle();
-
-	UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering..."), *FString(__FUNCTION__))
-	bCurrentlyRendering = true;
-
-	FindNextCamera();
+	// Export the instance id table if instance id rendering is selected
+	if (RendererTargetOptions.TargetSelected(FRendererTargetOptions::TargetType::INSTANCE_ID_IMAGE))
+	{
+		if (!TextureStyleManager->ExportInstanceIds(OutputDirectory, &BackgroundFileWriter))
+		{
+			ErrorMessage = "Could not save the instance ids CSV file";
+			return false;
+		}
+	}
 
 	return true;
 }
 
 void USequenceRenderer::OnExecutorFinished(UMoviePipelineExecutorBase* InPipelineExecutor, bool bSuccess)
 {
-	// Revert target specific modifications to the sequence
-	if (!CurrentTarget->FinalizeSequence(RenderingSequence))
+	GEditor->GetEditorWorldContext().World()->GetTimerManager().ClearTimer(RenderingProgressTimerHandle);
+
+	// Output futures are fulfilled before the executor finishes, so all of the target images are written by now
+	FRenderReportJob& ReportJob = RenderReport.camera_target_jobs.Last();
+	ReportJob.render_seconds = FPlatformTime::Seconds() - TargetRenderStartTime;
+	ReportJob.frames_per_second = ReportJob.render_seconds > 0.0 ? ReportJob.frames / ReportJob.render_seconds : 0.0;
+	ReportJob.bytes_written = CurrentTargetOutputSize() - TargetOutputSizeBefore;
+	RenderReport.frames += ReportJob.frames;
+	RenderReport.bytes_written += ReportJob.bytes_written;
+
+	// Revert target specific modifications to the sequences
+	for (FSequenceRenderingState& SequenceState : RenderingSequences)
 	{
-		ErrorMessage = FString::Printf(TEXT("Failed while finalizing the rendering of the %s target"), *CurrentTarget->Name());
-		return BroadcastRenderingFinished(false);
+		if (SequenceState.FrameRanges.Num() > 0 && !CurrentTarget->FinalizeSequence(SequenceState.SequencerWrapper))
+		{
+			ErrorMessage = FString::Printf(TEXT("Failed while finalizing the rendering of the %s target"), *CurrentTarget->Name());
+			return BroadcastRenderingFinished(false);
+		}
 	}
 
 	if (!bSuccess)
@@ -304,123 +712,739 @@ void USequenceRenderer::OnExecutorFinished(UMoviePipelineExecutorBase* InPipelin
 	FindNextTarget();
 }
 
-void USequenceRenderer::FindNextCamera()
+bool USequenceRenderer::PrepareRigCameras()
 {
-	CurrentRigCameraId++;
-
-	// Check if the end is reached
-	if (CurrentRigCameraId == RigCameras.Num())
+	const bool bAllCamerasInOneJob = RendererTargetOptions.RenderAllCamerasInOneJob();
+	for (FSequenceRenderingState& SequenceState : RenderingSequences)
 	{
-		return BroadcastRenderingFinished(true);
-	}
+		TArray<UCameraComponent*>& RigCameras = SequenceState.RigCameras;
 
-	if (CurrentRigCameraId == 0)
-	{
-		// Remember the transform of the first camera
-		OriginalCameraTransform = RigCameras[0]->GetRelativeTransform();
-		OriginalCameraFOV = RigCameras[0]->FieldOfView;
-	}
-	else
-	{
-		// Transfer the transform of the current camera to the first one that is used for rendering
-		RigCameras[0]->SetRelativeTransform(RigCameras[CurrentRigCameraId]->GetRelativeTransform());
-		RigCameras[0]->SetFieldOfView(RigCameras[CurrentRigCameraId]->FieldOfView);
-	}
+		// Make all rig cameras visible to the movie pipeline
+		if (bAllCamerasInOneJob && !BindRigCameras(SequenceState))
+		{
+			ErrorMessage = "Could not bind rig cameras to the sequence";
+			return false;
+		}
 
-	// Export camera poses if requested
-	if (RendererTargetOptions.ExportCameraPoses())
-	{
-		FCameraPoseExporter CameraPoseExporter;
-		if (!CameraPoseExporter.ExportCameraPoses(
-			RenderingSequence, OutputResolution, RenderingDirectory, RigCameras[CurrentRigCameraId]))
+		// Rig poses are extracted once for all of the following uses, before any of the cameras is re-posed
+		FCameraPoseExporter CameraPoseExporter(RendererTargetOptions.BinaryCameraPoses());
+
+		// Frames are selected before exporting camera poses, so that poses are only exported for the rendered frames
+		// Pose ids count frames from the start of the playback range, so selected frames do not depend on the frame range
+		SequenceState.SelectedFrames.Empty();
+		if (RendererTargetOptions.SubsampleFrames())
 		{
-			ErrorMessage = "Could not export camera poses";
-			return BroadcastRenderingFinished(false);
+			TArray<int> SelectedPoseIds;
+			if (!CameraPoseExporter.SelectFrames(
+				SequenceState.SequencerWrapper,
+				RendererTargetOptions.FrameStride(),
+				RendererTargetOptions.KeyframeDistance(),
+				RendererTargetOptions.KeyframeAngle(),
+				SelectedPoseIds))
+			{
+				ErrorMessage = "Could not select the rendered frames";
+				return false;
+			}
+			const int FirstFrame = FirstPoseFrame(SequenceState);
+			for (const int PoseId : SelectedPoseIds)
+			{
+				const int Frame = FirstFrame + PoseId;
+				if (Frame >= SequenceState.StartFrame && Frame < SequenceState.EndFrame)
+				{
+					SequenceState.SelectedFrames.Add(Frame);
+				}
+			}
+			UE_LOG(LogEasySynth, Log, TEXT("%s: Selected %d of %d frames of the %s sequence"),
+				*FString(__FUNCTION__), SequenceState.SelectedFrames.Num(), SequenceState.EndFrame - SequenceState.StartFrame,
+				*SequenceState.SequencePath.GetAssetName())
 		}
-	}
 
-	// Prepare the targets queue
-	RendererTargetOptions.GetSelectedTargets(TextureStyleManager, TargetsQueue);
-	CurrentTarget = nullptr;
+		// Export camera poses if requested, each camera poses file is written by a single shard
+		if (RendererTargetOptions.ExportCameraPoses())
+		{
+			TArray<UCameraComponent*> ShardCameras;
+			for (int i = 0; i < RigCameras.Num(); i++)
+			{
+				if (RendererTargetOptions.InShard(i))
+				{
+					ShardCameras.Add(RigCameras[i]);
+				}
+			}
 
-	UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering camera %d/%d"), *FString(__FUNCTION__), CurrentRigCameraId + 1, RigCameras.Num())
+			// Rig poses are shared by all shards, so they are only exported by the primary one
+			const double PoseExportStartTime = FPlatformTime::Seconds();
+			if (!CameraPoseExporter.ExportCameraPoses(
+				SequenceState.SequencerWrapper, OutputResolution, SequenceState.OutputDirectory,
+				ShardCameras, RendererTargetOptions.IsPrimaryShard(), &BackgroundFileWriter))
+			{
+				ErrorMessage = "Could not export camera poses";
+				return false;
+			}
+			RenderReport.camera_pose_export_seconds += FPlatformTime::Seconds() - PoseExportStartTime;
+		}
 
-	// Find the next target and start rendering
-	FindNextTarget();
+		// Streamed frames, optical flow post-processing and trajectory preloading need camera poses,
+		// which the movie pipeline does not provide
+		const bool bRequiresCameraPoses =
+			!RendererTargetOptions.StreamName().IsEmpty() ||
+			RendererTargetOptions.ProcessOpticalFlow() ||
+			RendererTargetOptions.PreloadFrames() > 0;
+		if (bRequiresCameraPoses &&
+			!CameraPoseExporter.ExtractCameraPoses(SequenceState.SequencerWrapper, RigCameras,
+				SequenceState.RigCameraPoses, SequenceState.FirstRigCameraPoseFrame))
+		{
+			ErrorMessage = "Could not extract camera poses of the rig cameras";
+			return false;
+		}
+	}
+
+	return true;
 }
 
-void USequenceRenderer::FindNextTarget()
+void USequenceRenderer::ScheduleWorkItems()
 {
-	// Check if the end is reached
-	if (TargetsQueue.IsEmpty())
+	// All cameras are covered by the first iteration when rendered in one job
+	int RigCameraCount = 0;
+	for (const FSequenceRenderingState& SequenceState : RenderingSequences)
 	{
-		return FindNextCamera();
+		RigCameraCount = FMath::Max(RigCameraCount, SequenceState.RigCameras.Num());
 	}
-
-	// Select the next requested target
-	TargetsQueue.Dequeue(CurrentTarget);
-
-	// Setup specifics of the current rendering target
-	UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering the %s target"), *FString(__FUNCTION__), *CurrentTarget->Name())
-	if (!CurrentTarget->PrepareSequence(RenderingSequence))
+	const bool bAllCamerasInOneJob = RendererTargetOptions.RenderAllCamerasInOneJob();
+	const int CameraIterationCount = bAllCamerasInOneJob ? FMath::Min(RigCameraCount, 1) : RigCameraCount;
+
+	// Create work items in the camera-major order, each camera iteration rendering all of the selected targets
+	// Every sequence that has the camera adds one distributed work item for each of its frame ranges
+	WorkItems.Empty();
+	NextWorkItemIndex = 0;
+	int ShardWorkItemId = 0;
+	for (int RigCameraId = 0; RigCameraId < CameraIterationCount; RigCameraId++)
 	{
-		ErrorMessage = FString::Printf(TEXT("Failed while preparing the rendering of the %s target"), *CurrentTarget->Name());
-		return BroadcastRenderingFinished(false);
+		int SequenceCount = 0;
+		for (const FSequenceRenderingState& SequenceState : RenderingSequences)
+		{
+			if (bAllCamerasInOneJob || SequenceState.RigCameras.IsValidIndex(RigCameraId))
+			{
+				SequenceCount++;
+			}
+		}
+
+		TQueue<TSharedPtr<FRendererTarget>> TargetsQueue;
+		RendererTargetOptions.GetSelectedTargets(TextureStyleManager, TargetsQueue);
+		TSharedPtr<FRendererTarget> Target;
+		while (TargetsQueue.Dequeue(Target))
+		{
+			WorkItems.Add(FRenderWorkItem{ RigCameraId, Target, ShardWorkItemId });
+			ShardWorkItemId += SequenceCount * RendererTargetOptions.FrameShardCount();
+		}
 	}
 
-	// Start the rendering after a brief pause
-	const float DelaySeconds = 2.0f;
-	const bool bLoop = false;
-	GEditor->GetEditorWorldContext().World()->GetTimerManager().SetTimer(
-		RendererPauseTimerHandle,
-		this,
-		&USequenceRenderer::StartRendering,
-		DelaySeconds,
-		bLoop);
+	TUniquePtr<FRenderScheduler> Scheduler = FRenderScheduler::Create(RendererTargetOptions.SchedulerType());
+	check(Scheduler)
+	Scheduler->Schedule(WorkItems, OriginalTextureStyle);
+	RenderReport.scheduler = Scheduler->Name();
 }
 
-void USequenceRenderer::StartRendering()
+void USequenceRenderer::ActivateRigCamera(const int RigCameraId)
 {
-	// Make sure the sequence is still sound
-	if (RenderingSequence == nullptr)
-	{
-		ErrorMessage = "Provided level sequence is null when starting the recording";
-		return BroadcastRenderingFinished(false);
-	}
+	CurrentRigCameraId = RigCameraId;
 
-	// Make sure a renderer target is selected
-	if (!CurrentTarget.IsValid())
+	// Rig cameras are bound to the sequence instead of being moved when rendered in one job
+	if (RendererTargetOptions.RenderAllCamerasInOneJob())
 	{
-		ErrorMessage = "Current renderer target null when starting the recording";
-		return BroadcastRenderingFinished(false);
+		UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering all cameras in one job"), *FString(__FUNCTION__))
+		return;
 	}
 
-	// Get the movie rendering editor subsystem
-	UMoviePipelineQueueSubsystem* MoviePipelineQueueSubsystem =
-		GEditor->GetEditorSubsystem<UMoviePipelineQueueSubsystem>();
-	if (MoviePipelineQueueSubsystem == nullptr)
+	int RigCameraCount = 0;
+	for (FSequenceRenderingState& SequenceState : RenderingSequences)
 	{
-		ErrorMessage = "Could not get the UMoviePipelineQueueSubsystem";
-		return BroadcastRenderingFinished(false);
-	}
+		TArray<UCameraComponent*>& RigCameras = SequenceState.RigCameras;
+		RigCameraCount = FMath::Max(RigCameraCount, RigCameras.Num());
 
-	// Add received level sequence to the queue as a new job
-	if (!PrepareJobQueue(MoviePipelineQueueSubsystem))
-	{
-		// Propagate the error message set inside the PrepareJobQueue
-		return BroadcastRenderingFinished(false);
-	}
+		// Sequences with smaller rigs have already rendered all of their cameras
+		if (!RigCameras.IsValidIndex(RigCameraId))
+		{
+			continue;
+		}
 
-	// Get the default movie rendering settings
-	const UMovieRenderPipelineProjectSettings* ProjectSettings = GetDefault<UMovieRenderPipelineProjectSettings>();
-	if (ProjectSettings->DefaultLocalExecutor == nullptr)
-	{
-		ErrorMessage = "Could not get the UMovieRenderPipelineProjectSettings";
-		return BroadcastRenderingFinished(false);
+		// Transfer the transform of the current camera to the first one that is used for rendering
+		// The first camera itself can be activated again after the other ones, so its original transform is used
+		if (RigCameraId == 0)
+		{
+			RigCameras[0]->SetRelativeTransform(SequenceState.OriginalCameraTransform);
+			RigCameras[0]->SetFieldOfView(SequenceState.OriginalCameraFOV);
+		}
+		else
+		{
+			RigCameras[0]->SetRelativeTransform(RigCameras[RigCameraId]->GetRelativeTransform());
+			RigCameras[0]->SetFieldOfView(RigCameras[RigCameraId]->FieldOfView);
+		}
 	}
 
-	// Run the rendering
-	UMoviePipelineExecutorBase* ActiveExecutor =
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering camera %d/%d"), *FString(__FUNCTION__), RigCameraId + 1, RigCameraCount)
+}
+
+void USequenceRenderer::FindNextTarget()
+{
+	// Skip work items rendered by other shards or already rendered, until one with frames left to render is found
+	double TargetStartTime = 0.0;
+	int JobCount = 0;
+	int TargetFrameCount = 0;
+	while (JobCount == 0)
+	{
+		// Check if the end is reached
+		if (NextWorkItemIndex == WorkItems.Num())
+		{
+			return BroadcastRenderingFinished(true);
+		}
+
+		// Select the next work item, moving the rig camera only if it differs from the previous one
+		const FRenderWorkItem& WorkItem = WorkItems[NextWorkItemIndex++];
+		if (WorkItem.RigCameraId != CurrentRigCameraId)
+		{
+			ActivateRigCamera(WorkItem.RigCameraId);
+		}
+		CurrentTarget = WorkItem.Target;
+		CurrentTarget->SetPostProcessMaterialCache(&PostProcessMaterialCache);
+		CurrentWorkItemId = WorkItem.FirstShardWorkItemId - 1;
+		StartedWorkItems++;
+
+		// Select frame ranges of each sequence that belong to the current shard
+		TargetStartTime = FPlatformTime::Seconds();
+		JobCount = 0;
+		TargetFrameCount = 0;
+		const int FrameShardCount = RendererTargetOptions.FrameShardCount();
+		for (FSequenceRenderingState& SequenceState : RenderingSequences)
+		{
+			SequenceState.FrameRanges.Empty();
+			SequenceState.OutputFrames.Empty();
+			if (CurrentCameras(SequenceState).Num() == 0)
+			{
+				continue;
+			}
+
+			for (int FrameShardId = 0; FrameShardId < FrameShardCount; FrameShardId++)
+			{
+				CurrentWorkItemId++;
+				const TRange<int> FrameRange =
+					FrameShardRange(SequenceState.StartFrame, SequenceState.EndFrame, FrameShardId, FrameShardCount);
+				if (RendererTargetOptions.InShard(CurrentWorkItemId) && !FrameRange.IsEmpty())
+				{
+					SequenceState.FrameRanges.Add(FrameRange);
+				}
+			}
+
+			// Skip frames rendered before the rendering got interrupted
+			if (RendererTargetOptions.ResumeRendering())
+			{
+				RemoveWrittenFrames(SequenceState);
+			}
+
+			// Skip frames not selected by the subsampling, which has to happen last as it joins the remaining frames into strided runs
+			if (RendererTargetOptions.SubsampleFrames())
+			{
+				RemoveUnselectedFrames(SequenceState);
+			}
+
+			JobCount += SequenceState.FrameRanges.Num();
+			for (const TRange<int>& FrameRange : SequenceState.FrameRanges)
+			{
+				TargetFrameCount += RenderedFrameCount(FrameRange) * CurrentCameras(SequenceState).Num();
+			}
+		}
+
+		if (JobCount == 0)
+		{
+			UE_LOG(LogEasySynth, Log, TEXT("%s: Skipping the %s target, no frames left to render in this shard"),
+				*FString(__FUNCTION__), *CurrentTarget->Name())
+		}
+	}
+
+	FRenderReportJob& ReportJob = RenderReport.camera_target_jobs.AddDefaulted_GetRef();
+	ReportJob.camera = RendererTargetOptions.RenderAllCamerasInOneJob() ? TEXT("all") : TEXT("");
+	for (const FSequenceRenderingState& SequenceState : RenderingSequences)
+	{
+		if (ReportJob.camera.IsEmpty() && SequenceState.RigCameras.IsValidIndex(CurrentRigCameraId))
+		{
+			ReportJob.camera = FPathUtils::GetCameraName(SequenceState.RigCameras[CurrentRigCameraId]);
+		}
+	}
+	ReportJob.target = CurrentTarget->Name();
+	ReportJob.job_count = JobCount;
+	ReportJob.frames = TargetFrameCount;
+
+	// Setup specifics of the current rendering target
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Rendering the %s target in %d jobs"), *FString(__FUNCTION__), *CurrentTarget->Name(), JobCount)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(USequenceRenderer::PrepareTarget);
+		for (FSequenceRenderingState& SequenceState : RenderingSequences)
+		{
+			if (SequenceState.FrameRanges.Num() > 0 && !CurrentTarget->PrepareSequence(SequenceState.SequencerWrapper))
+			{
+				ErrorMessage = FString::Printf(TEXT("Failed while preparing the rendering of the %s target"), *CurrentTarget->Name());
+				return BroadcastRenderingFinished(false);
+			}
+		}
+	}
+	ReportJob.preparation_seconds = FPlatformTime::Seconds() - TargetStartTime;
+
+	// Start the rendering as soon as the target changes are applied to the world
+	RendererPauseStartTime = FPlatformTime::Seconds();
+	const bool bLoop = true;
+	GEditor->GetEditorWorldContext().World()->GetTimerManager().SetTimer(
+		RendererPauseTimerHandle,
+		this,
+		&USequenceRenderer::OnRendererPauseTimer,
+		RendererPauseCheckIntervalSeconds,
+		bLoop);
+}
+
+void USequenceRenderer::OnRendererPauseTimer()
+{
+	const bool bShadersReady = IsWorldReadyForRendering();
+
+	// Keep waiting, unless the pause is already too long
+	if (!bShadersReady && FPlatformTime::Seconds() - RendererPauseStartTime < RendererPauseMaxSeconds)
+	{
+		return;
+	}
+
+	GEditor->GetEditorWorldContext().World()->GetTimerManager().ClearTimer(RendererPauseTimerHandle);
+	if (!bShadersReady)
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: The %s target shaders not compiled after %.2f s, %d jobs left, starting anyway"),
+			*FString(__FUNCTION__), *CurrentTarget->Name(), FPlatformTime::Seconds() - RendererPauseStartTime,
+			GShaderCompilingManager != nullptr ? GShaderCompilingManager->GetNumRemainingJobs() : 0)
+	}
+
+	// Editor worlds keep requesting textures, so streaming is waited for within the rest of the pause,
+	// instead of polling until nothing is wanted
+	const float StreamingSeconds = FMath::Max(
+		static_cast<float>(RendererPauseMaxSeconds - (FPlatformTime::Seconds() - RendererPauseStartTime)), 0.0f);
+	IStreamingManager::Get().StreamAllResources(StreamingSeconds);
+	if (IStreamingManager::Get().GetNumWantingResources() > 0)
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: The %s target has %d textures left to stream, starting anyway"),
+			*FString(__FUNCTION__), *CurrentTarget->Name(), IStreamingManager::Get().GetNumWantingResources())
+	}
+
+	// Make sure the render thread has processed all of the changes
+	FlushRenderingCommands();
+
+	const double PauseSeconds = FPlatformTime::Seconds() - RendererPauseStartTime;
+	RenderReport.camera_target_jobs.Last().pause_seconds = PauseSeconds;
+	UE_LOG(LogEasySynth, Log, TEXT("%s: The %s target ready after %.2f s"),
+		*FString(__FUNCTION__), *CurrentTarget->Name(), PauseSeconds)
+
+	StartRendering();
+}
+
+bool USequenceRenderer::IsWorldReadyForRendering() const
+{
+	// Materials swapped while preparing the target need to have their shaders compiled
+	return GShaderCompilingManager == nullptr || !GShaderCompilingManager->IsCompiling();
+}
+
+bool USequenceRenderer::FindRenderingFrameRange(FSequenceRenderingState& SequenceState)
+{
+	if (RendererTargetOptions.CustomFrameRange())
+	{
+		SequenceState.StartFrame = RendererTargetOptions.StartFrame();
+		SequenceState.EndFrame = RendererTargetOptions.EndFrame();
+	}
+	else
+	{
+		UMovieScene* MovieScene = SequenceState.Sequence->GetMovieScene();
+		if (MovieScene == nullptr)
+		{
+			ErrorMessage = "Rendering sequence has no movie scene";
+			return false;
+		}
+
+		// Convert the playback range from ticks to frames
+		const TRange<FFrameNumber> PlaybackRange = MovieScene->GetPlaybackRange();
+		const FFrameRate TickResolution = MovieScene->GetTickResolution();
+		const FFrameRate DisplayRate = MovieScene->GetDisplayRate();
+		SequenceState.StartFrame = FFrameRate::TransformTime(
+			FFrameTime(UE::MovieScene::DiscreteInclusiveLower(PlaybackRange)), TickResolution, DisplayRate).FloorToFrame().Value;
+		SequenceState.EndFrame = FFrameRate::TransformTime(
+			FFrameTime(UE::MovieScene::DiscreteExclusiveUpper(PlaybackRange)), TickResolution, DisplayRate).CeilToFrame().Value;
+	}
+
+	if (SequenceState.StartFrame >= SequenceState.EndFrame)
+	{
+		ErrorMessage = FString::Printf(TEXT("Invalid frame range [%d, %d)"), SequenceState.StartFrame, SequenceState.EndFrame);
+		return false;
+	}
+
+	return true;
+}
+
+TArray<UCameraComponent*> USequenceRenderer::CurrentCameras(const FSequenceRenderingState& SequenceState) const
+{
+	if (RendererTargetOptions.RenderAllCamerasInOneJob())
+	{
+		return SequenceState.RigCameras;
+	}
+
+	TArray<UCameraComponent*> Cameras;
+	if (SequenceState.RigCameras.IsValidIndex(CurrentRigCameraId))
+	{
+		Cameras.Add(SequenceState.RigCameras[CurrentRigCameraId]);
+	}
+	return Cameras;
+}
+
+void USequenceRenderer::RemoveWrittenFrames(FSequenceRenderingState& SequenceState)
+{
+	// Find all directories the current target job writes to
+	TArray<FString> OutputDirectories;
+	for (UCameraComponent* Camera : CurrentCameras(SequenceState))
+	{
+		for (const FString& OutputName : CurrentTarget->OutputNames())
+		{
+			OutputDirectories.Add(FPathUtils::RigCameraDir(SequenceState.OutputDirectory, Camera) / OutputName);
+		}
+	}
+	if (OutputDirectories.Num() == 0)
+	{
+		return;
+	}
+
+	// A frame is written only if all of the outputs have written it
+	TSet<int> WrittenFrames = FOutputFramesScanner::FindCompleteFrames(OutputDirectories[0], CurrentTarget->ImageFormat);
+	for (int i = 1; i < OutputDirectories.Num(); i++)
+	{
+		WrittenFrames = WrittenFrames.Intersect(
+			FOutputFramesScanner::FindCompleteFrames(OutputDirectories[i], CurrentTarget->ImageFormat));
+	}
+	if (WrittenFrames.Num() == 0)
+	{
+		return;
+	}
+
+	// Split frame ranges into contiguous ranges of missing frames
+	int SkippedFrameCount = 0;
+	TArray<TRange<int>> MissingFrameRanges;
+	for (const TRange<int>& FrameRange : SequenceState.FrameRanges)
+	{
+		int MissingRangeStart = FrameRange.GetLowerBoundValue();
+		for (int Frame = FrameRange.GetLowerBoundValue(); Frame < FrameRange.GetUpperBoundValue(); Frame++)
+		{
+			if (WrittenFrames.Contains(Frame))
+			{
+				if (MissingRangeStart < Frame)
+				{
+					MissingFrameRanges.Add(TRange<int>(MissingRangeStart, Frame));
+				}
+				MissingRangeStart = Frame + 1;
+				SkippedFrameCount++;
+			}
+		}
+		if (MissingRangeStart < FrameRange.GetUpperBoundValue())
+		{
+			MissingFrameRanges.Add(TRange<int>(MissingRangeStart, FrameRange.GetUpperBoundValue()));
+		}
+	}
+	SequenceState.FrameRanges = MissingFrameRanges;
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Skipping %d frames of the %s target written by a previous rendering"),
+		*FString(__FUNCTION__), SkippedFrameCount, *CurrentTarget->Name())
+}
+
+void USequenceRenderer::RemoveUnselectedFrames(FSequenceRenderingState& SequenceState) const
+{
+	SequenceState.FrameRanges = SelectedFrameRanges(
+		SequenceState.FrameRanges, SequenceState.SelectedFrames, RendererTargetOptions.FrameStride(), MaxDroppedFrameCount,
+		SequenceState.OutputFrames);
+}
+
+TRange<int> USequenceRenderer::FrameShardRange(
+	const int StartFrame,
+	const int EndFrame,
+	const int FrameShardId,
+	const int FrameShardCount)
+{
+	const int FrameCount = EndFrame - StartFrame;
+	return TRange<int>(
+		StartFrame + FrameCount * FrameShardId / FrameShardCount,
+		StartFrame + FrameCount * (FrameShardId + 1) / FrameShardCount);
+}
+
+TArray<TRange<int>> USequenceRenderer::SelectedFrameRanges(
+	const TArray<TRange<int>>& FrameRanges,
+	const TArray<int>& SelectedFrames,
+	const int FrameStride,
+	const int MaxDroppedFrames,
+	TArray<int>& OutOutputFrames)
+{
+	// Selected frames one stride apart are rendered by the same job using the output frame step
+	TArray<TRange<int>> SelectedRanges;
+	for (const TRange<int>& FrameRange : FrameRanges)
+	{
+		for (const int Frame : SelectedFrames)
+		{
+			if (!FrameRange.Contains(Frame))
+			{
+				continue;
+			}
+			OutOutputFrames.Add(Frame);
+
+			// Starting a job costs more than rendering a few frames, so a run starting close after the previous one
+			// continues its range if its frames stay one stride apart from the range start
+			if (SelectedRanges.Num() > 0)
+			{
+				TRange<int>& LastRange = SelectedRanges.Last();
+				const int LastFrame = LastRange.GetUpperBoundValue() - 1;
+				const int DroppedFrameCount = (Frame - LastFrame) / FrameStride - 1;
+				if ((Frame - LastFrame) % FrameStride == 0 && DroppedFrameCount <= MaxDroppedFrames)
+				{
+					LastRange = TRange<int>(LastRange.GetLowerBoundValue(), Frame + 1);
+					continue;
+				}
+			}
+			SelectedRanges.Add(TRange<int>(Frame, Frame + 1));
+		}
+	}
+	return SelectedRanges;
+}
+
+int USequenceRenderer::RenderedFrameCount(const TRange<int>& FrameRange) const
+{
+	const int FrameStride = RendererTargetOptions.FrameStride();
+	return (FrameRange.Size<int>() + FrameStride - 1) / FrameStride;
+}
+
+int USequenceRenderer::FirstPoseFrame(const FSequenceRenderingState& SequenceState)
+{
+	const UMovieScene* MovieScene = SequenceState.Sequence->GetMovieScene();
+	return FFrameRate::TransformTime(
+		FFrameTime(UE::MovieScene::DiscreteInclusiveLower(MovieScene->GetPlaybackRange())),
+		MovieScene->GetTickResolution(), MovieScene->GetDisplayRate()).FloorToFrame().Value;
+}
+
+bool USequenceRenderer::BindRigCameras(FSequenceRenderingState& SequenceState)
+{
+	UMovieScene* MovieScene = SequenceState.Sequence->GetMovieScene();
+	if (MovieScene == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Rendering sequence has no movie scene"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	FMovieScenePossessable* RigPossessable = MovieScene->FindPossessable(SequenceState.CameraRigBindingGuid);
+	FMovieSceneBinding* RigBinding = MovieScene->FindBinding(SequenceState.CameraRigBindingGuid);
+	if (RigPossessable == nullptr || RigBinding == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Rendering all cameras in one job requires a possessable camera rig"),
+			*FString(__FUNCTION__))
+		return false;
+	}
+
+	// The rig binding itself is rendered through its first active camera
+	UCameraComponent* RigBindingCamera = MovieSceneHelpers::CameraComponentFromActor(SequenceState.CameraRigActor);
+	if (RigBindingCamera == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Camera rig has no active cameras"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	// Each camera output is named by its binding, so name the rig binding after the camera it renders
+	SequenceState.OriginalCameraRigBindingName = RigPossessable->GetName();
+	RigPossessable->SetName(FPathUtils::GetCameraName(RigBindingCamera));
+	RigBinding->SetName(FPathUtils::GetCameraName(RigBindingCamera));
+
+	// Bind the remaining cameras as components of the rig binding
+	for (UCameraComponent* Camera : SequenceState.RigCameras)
+	{
+		if (Camera == RigBindingCamera)
+		{
+			continue;
+		}
+
+		// Components of child actors cannot be bound relative to the rig binding
+		if (Camera->GetOwner() != SequenceState.CameraRigActor)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Camera '%s' does not belong to the camera rig actor"),
+				*FString(__FUNCTION__), *FPathUtils::GetCameraName(Camera))
+			UnbindRigCameras(SequenceState);
+			return false;
+		}
+
+		const FGuid CameraGuid = MovieScene->AddPossessable(FPathUtils::GetCameraName(Camera), Camera->GetClass());
+		FMovieScenePossessable* CameraPossessable = MovieScene->FindPossessable(CameraGuid);
+		if (CameraPossessable == nullptr)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Could not add the '%s' camera binding"),
+				*FString(__FUNCTION__), *FPathUtils::GetCameraName(Camera))
+			UnbindRigCameras(SequenceState);
+			return false;
+		}
+		CameraPossessable->SetParent(SequenceState.CameraRigBindingGuid, MovieScene);
+		SequenceState.Sequence->BindPossessableObject(CameraGuid, *Camera, SequenceState.CameraRigActor);
+		SequenceState.RigCameraBindings.Add(CameraGuid);
+	}
+
+	return true;
+}
+
+void USequenceRenderer::UnbindRigCameras(FSequenceRenderingState& SequenceState)
+{
+	if (SequenceState.Sequence == nullptr || SequenceState.Sequence->GetMovieScene() == nullptr)
+	{
+		SequenceState.RigCameraBindings.Empty();
+		SequenceState.OriginalCameraRigBindingName.Empty();
+		return;
+	}
+	UMovieScene* MovieScene = SequenceState.Sequence->GetMovieScene();
+
+	// Remove temporary camera bindings
+	for (const FGuid& CameraGuid : SequenceState.RigCameraBindings)
+	{
+		SequenceState.Sequence->UnbindPossessableObjects(CameraGuid);
+		MovieScene->RemovePossessable(CameraGuid);
+	}
+	SequenceState.RigCameraBindings.Empty();
+
+	// Restore the original rig binding name
+	if (!SequenceState.OriginalCameraRigBindingName.IsEmpty())
+	{
+		FMovieScenePossessable* RigPossessable = MovieScene->FindPossessable(SequenceState.CameraRigBindingGuid);
+		FMovieSceneBinding* RigBinding = MovieScene->FindBinding(SequenceState.CameraRigBindingGuid);
+		if (RigPossessable != nullptr)
+		{
+			RigPossessable->SetName(SequenceState.OriginalCameraRigBindingName);
+		}
+		if (RigBinding != nullptr)
+		{
+			RigBinding->SetName(SequenceState.OriginalCameraRigBindingName);
+		}
+		SequenceState.OriginalCameraRigBindingName.Empty();
+	}
+}
+
+bool USequenceRenderer::WarmUpPostProcessMaterials()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(USequenceRenderer::WarmUpPostProcessMaterials);
+
+	// Targets are grouped the same way they are rendered, so every material requested later is found in the cache
+	TQueue<TSharedPtr<FRendererTarget>> WarmUpTargets;
+	RendererTargetOptions.GetSelectedTargets(TextureStyleManager, WarmUpTargets);
+	TSharedPtr<FRendererTarget> Target;
+	while (WarmUpTargets.Dequeue(Target))
+	{
+		TArray<TSharedPtr<FRendererTarget>> MaterialTargets;
+		if (Target->RendersMultiplePasses())
+		{
+			MaterialTargets = StaticCastSharedPtr<FMultiPassTarget>(Target)->GetTargets();
+		}
+		else
+		{
+			MaterialTargets.Add(Target);
+		}
+
+		for (TSharedPtr<FRendererTarget>& MaterialTarget : MaterialTargets)
+		{
+			MaterialTarget->SetPostProcessMaterialCache(&PostProcessMaterialCache);
+			if (MaterialTarget->PostProcessMaterial() == nullptr)
+			{
+				ErrorMessage = FString::Printf(TEXT("Could not create the %s post process material"), *MaterialTarget->Name());
+				return false;
+			}
+		}
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Prepared %d post process materials"), *FString(__FUNCTION__), PostProcessMaterialCache.Num())
+	return true;
+}
+
+void USequenceRenderer::WarmUpShaders()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(USequenceRenderer::WarmUpShaders);
+
+	ShaderWarmUpStartTime = FPlatformTime::Seconds();
+
+	// Target materials are already created by the WarmUpPostProcessMaterials
+	TArray<UMaterialInterface*> Materials = PostProcessMaterialCache.GetMaterials();
+
+	// Texture styles swap level materials, collect the ones needed by selected targets without applying the styles
+	TArray<ETextureStyle> TextureStyles;
+	TQueue<TSharedPtr<FRendererTarget>> WarmUpTargets;
+	RendererTargetOptions.GetSelectedTargets(TextureStyleManager, WarmUpTargets);
+	TSharedPtr<FRendererTarget> Target;
+	while (WarmUpTargets.Dequeue(Target))
+	{
+		TextureStyles.AddUnique(Target->TextureStyle());
+	}
+	for (const ETextureStyle TextureStyle : TextureStyles)
+	{
+		for (UMaterialInterface* Material : TextureStyleManager->TextureStyleMaterials(TextureStyle))
+		{
+			if (Material != nullptr)
+			{
+				Materials.AddUnique(Material);
+			}
+		}
+	}
+
+	// Shaders are compiled in the background, the following preparation steps wait for them to finish
+	for (UMaterialInterface* Material : Materials)
+	{
+		Material->CacheShaders();
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Requested shaders of %d materials used by %d texture styles"),
+		*FString(__FUNCTION__), Materials.Num(), TextureStyles.Num())
+}
+
+void USequenceRenderer::StartRendering()
+{
+	// Make sure the sequences are still sound
+	for (const FSequenceRenderingState& SequenceState : RenderingSequences)
+	{
+		if (SequenceState.Sequence == nullptr)
+		{
+			ErrorMessage = "Provided level sequence is null when starting the recording";
+			return BroadcastRenderingFinished(false);
+		}
+	}
+
+	// Make sure a renderer target is selected
+	if (!CurrentTarget.IsValid())
+	{
+		ErrorMessage = "Current renderer target null when starting the recording";
+		return BroadcastRenderingFinished(false);
+	}
+
+	// Get the movie rendering editor subsystem
+	UMoviePipelineQueueSubsystem* MoviePipelineQueueSubsystem =
+		GEditor->GetEditorSubsystem<UMoviePipelineQueueSubsystem>();
+	if (MoviePipelineQueueSubsystem == nullptr)
+	{
+		ErrorMessage = "Could not get the UMoviePipelineQueueSubsystem";
+		return BroadcastRenderingFinished(false);
+	}
+
+	TargetOutputSizeBefore = CurrentTargetOutputSize();
+	TargetRenderStartTime = FPlatformTime::Seconds();
+
+	// Add received level sequences to the queue as new jobs
+	if (!PrepareJobQueue(MoviePipelineQueueSubsystem))
+	{
+		// Propagate the error message set inside the PrepareJobQueue
+		return BroadcastRenderingFinished(false);
+	}
+
+	// Get the default movie rendering settings
+	const UMovieRenderPipelineProjectSettings* ProjectSettings = GetDefault<UMovieRenderPipelineProjectSettings>();
+	if (ProjectSettings->DefaultLocalExecutor == nullptr)
+	{
+		ErrorMessage = "Could not get the UMovieRenderPipelineProjectSettings";
+		return BroadcastRenderingFinished(false);
+	}
+
+	// Run the rendering
+	UMoviePipelineExecutorBase* ActiveExecutor =
 		MoviePipelineQueueSubsystem->RenderQueueWithExecutor(ProjectSettings->DefaultLocalExecutor.ResolveClass());
 	if (ActiveExecutor == nullptr)
 	{
@@ -430,28 +1454,211 @@ void USequenceRenderer::StartRendering()
 
 	// Assign rendering finished callback
 	ActiveExecutor->OnExecutorFinished().AddUObject(this, &USequenceRenderer::OnExecutorFinished);
+
+	// Report the progress while the target is being rendered
+	const bool bLoop = true;
+	GEditor->GetEditorWorldContext().World()->GetTimerManager().SetTimer(
+		RenderingProgressTimerHandle,
+		this,
+		&USequenceRenderer::OnRenderingProgressTimer,
+		RenderingProgressIntervalSeconds,
+		bLoop);
+}
+
+void USequenceRenderer::OnRenderingProgressTimer()
+{
+	const FRenderingProgress Progress = CurrentProgress();
+	RenderingProgressEvent.Broadcast(Progress);
+
+	// Key value pairs, so that the line can be parsed by schedulers of headless renderings
+	const double CurrentTime = FPlatformTime::Seconds();
+	if (CurrentTime - LastProgressLogTime >= RenderingProgressLogIntervalSeconds)
+	{
+		LastProgressLogTime = CurrentTime;
+		UE_LOG(LogEasySynth, Display,
+			TEXT("%s: camera=%s target=%s frames=%d/%d items=%d/%d fps=%.2f eta_seconds=%.0f pending_images=%d"),
+			*FString(__FUNCTION__), *Progress.Camera, *Progress.Target, Progress.CompletedFrames, Progress.TotalFrames,
+			Progress.CompletedWorkItems, Progress.TotalWorkItems, Progress.FramesPerSecond, Progress.EtaSeconds,
+			Progress.PendingImages)
+	}
+}
+
+FRenderingProgress USequenceRenderer::CurrentProgress() const
+{
+	FRenderingProgress Progress;
+	if (RenderReport.camera_target_jobs.Num() == 0)
+	{
+		return Progress;
+	}
+	const FRenderReportJob& ReportJob = RenderReport.camera_target_jobs.Last();
+	Progress.Camera = ReportJob.camera;
+	Progress.Target = ReportJob.target;
+	Progress.TotalFrames = ReportJob.frames;
+	Progress.CompletedWorkItems = StartedWorkItems - 1;
+	Progress.TotalWorkItems = TotalWorkItems;
+	Progress.PendingImages = FImageWriterPool::NumPendingImages();
+
+	// Jobs report the completed fraction of their frames, which the movie pipeline updates every frame
+	for (int i = 0; i < TargetJobs.Num(); i++)
+	{
+		if (TargetJobs[i] != nullptr)
+		{
+			Progress.CompletedFrames += FMath::FloorToInt(FMath::Clamp(TargetJobs[i]->GetStatusProgress(), 0.0f, 1.0f) * TargetJobFrames[i]);
+		}
+	}
+	const double RenderSeconds = FPlatformTime::Seconds() - TargetRenderStartTime;
+	Progress.FramesPerSecond = RenderSeconds > 0.0 ? Progress.CompletedFrames / RenderSeconds : 0.0;
+	if (Progress.FramesPerSecond <= 0.0)
+	{
+		return Progress;
+	}
+
+	// Remaining work items are expected to take as long as the previous ones on average, including their preparation
+	const double CurrentItemSeconds = ReportJob.preparation_seconds + ReportJob.pause_seconds + Progress.TotalFrames / Progress.FramesPerSecond;
+	double RenderedItemsSeconds = 0.0;
+	for (int i = 0; i < RenderReport.camera_target_jobs.Num() - 1; i++)
+	{
+		const FRenderReportJob& RenderedJob = RenderReport.camera_target_jobs[i];
+		RenderedItemsSeconds += RenderedJob.preparation_seconds + RenderedJob.pause_seconds + RenderedJob.render_seconds;
+	}
+	const int RenderedItemCount = RenderReport.camera_target_jobs.Num() - 1;
+	const double AverageItemSeconds = RenderedItemCount > 0 ? RenderedItemsSeconds / RenderedItemCount : CurrentItemSeconds;
+	const int RemainingItems = FMath::Max(TotalWorkItems - StartedWorkItems, 0);
+	Progress.EtaSeconds = (Progress.TotalFrames - Progress.CompletedFrames) / Progress.FramesPerSecond + RemainingItems * AverageItemSeconds;
+
+	return Progress;
 }
 
 bool USequenceRenderer::PrepareJobQueue(UMoviePipelineQueueSubsystem* MoviePipelineQueueSubsystem)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(USequenceRenderer::PrepareJobQueue);
+
 	check(MoviePipelineQueueSubsystem)
 
+	// Engine image outputs stored inside the config asset are replaced by the ones that write through the plugin writer pools
+	for (UMoviePipelineSetting* Setting : EasySynthMoviePipelineConfig->FindSettingsByClass(
+		UMoviePipelineImageSequenceOutputBase::StaticClass(), true))
+	{
+		Setting->SetIsEnabled(false);
+	}
+
 	// Update export image format
 	UMoviePipelineSetting* JpegSetting = EasySynthMoviePipelineConfig->FindOrAddSettingByClass(
-		UMoviePipelineImageSequenceOutput_JPG::StaticClass(), true);
-	UMoviePipelineSetting* PngSetting = EasySynthMoviePipelineConfig->FindSettingByClass(
-		UMoviePipelineImageSequenceOutput_PNG::StaticClass(), true);
+		UMoviePipelineImageSequenceOutput_JPGLocal::StaticClass(), true);
+	UMoviePipelineSetting* PngSetting = EasySynthMoviePipelineConfig->FindOrAddSettingByClass(
+		UMoviePipelineImageSequenceOutput_PNGLocal::StaticClass(), true);
 	UMoviePipelineSetting* ExrSetting = EasySynthMoviePipelineConfig->FindOrAddSettingByClass(
 		UMoviePipelineImageSequenceOutput_EXRLocal::StaticClass(), true);
-	if (JpegSetting == nullptr || PngSetting == nullptr || ExrSetting == nullptr)
+	UMoviePipelineSetting* StreamSetting = EasySynthMoviePipelineConfig->FindOrAddSettingByClass(
+		UMoviePipelineSharedMemoryOutput::StaticClass(), true);
+	UMoviePipelineSetting* PreloadSetting = EasySynthMoviePipelineConfig->FindOrAddSettingByClass(
+		UMoviePipelineTrajectoryPreloadSetting::StaticClass(), true);
+	UMoviePipelineSetting* SelectionSetting = EasySynthMoviePipelineConfig->FindOrAddSettingByClass(
+		UMoviePipelineFrameSelectionSetting::StaticClass(), true);
+	if (JpegSetting == nullptr || PngSetting == nullptr || ExrSetting == nullptr || StreamSetting == nullptr ||
+		PreloadSetting == nullptr || SelectionSetting == nullptr)
 	{
-		ErrorMessage = "JPEG, PNG or EXR settings not found";
+		ErrorMessage = "JPEG, PNG, EXR, stream, preload or frame selection settings not found";
 		return false;
 	}
 	JpegSetting->SetIsEnabled(CurrentTarget->ImageFormat == EImageFormat::JPEG);
 	PngSetting->SetIsEnabled(CurrentTarget->ImageFormat == EImageFormat::PNG);
 	ExrSetting->SetIsEnabled(CurrentTarget->ImageFormat == EImageFormat::EXR);
 
+	// Multiple passes have to be written into separate files, so that each target gets its own directory,
+	// unless they are packed into the same file as named layers
+	UMoviePipelineImageSequenceOutput_EXRLocal* ExrOutput = CastChecked<UMoviePipelineImageSequenceOutput_EXRLocal>(ExrSetting);
+	ExrOutput->bMultilayer = !CurrentTarget->RendersMultiplePasses() || CurrentTarget->WritesPackedExr();
+	ExrOutput->bNameAllLayers = CurrentTarget->WritesPackedExr();
+	ExrOutput->PassChannelLayouts = CurrentTarget->ExrPassChannelLayouts();
+	ExrOutput->ChannelLayout = CurrentTarget->ExrChannelLayout();
+	ExrOutput->OpticalFlowScale = RendererTargetOptions.OpticalFlowScale();
+	ExrOutput->Compression = CurrentTarget->ExrCompression();
+	ExrOutput->CompressionLevel = RendererTargetOptions.ExrCompressionLevel();
+	CastChecked<UMoviePipelineImageSequenceOutput_PNGLocal>(PngSetting)->Palette = CurrentTarget->PngPalette();
+
+	// Grouped targets rendered by the main pass are written under their own pass names
+	const FString MainPassName = CurrentTarget->MainPassName();
+	CastChecked<UMoviePipelineImageSequenceOutput_JPGLocal>(JpegSetting)->MainPassName = MainPassName;
+	CastChecked<UMoviePipelineImageSequenceOutput_PNGLocal>(PngSetting)->MainPassName = MainPassName;
+	ExrOutput->MainPassName = MainPassName;
+
+	// Data values, such as encoded instance ids, have to reach 8-bit images without the sRGB encoding
+	const bool bConvertToSrgb = !CurrentTarget->WritesDataValues();
+	CastChecked<UMoviePipelineImageSequenceOutput_JPGLocal>(JpegSetting)->bConvertToSrgb = bConvertToSrgb;
+	CastChecked<UMoviePipelineImageSequenceOutput_PNGLocal>(PngSetting)->bConvertToSrgb = bConvertToSrgb;
+
+	// Downsampled levels are written by the image outputs from the rendered images
+	FImagePyramidSettings PyramidSettings;
+	PyramidSettings.LevelCount = RendererTargetOptions.PyramidLevels();
+	PyramidSettings.bAverageAllPasses = CurrentTarget->AveragesPyramidLevels();
+	PyramidSettings.AveragedPasses = CurrentTarget->AveragedPyramidPasses();
+	CastChecked<UMoviePipelineImageSequenceOutput_JPGLocal>(JpegSetting)->PyramidSettings = PyramidSettings;
+	CastChecked<UMoviePipelineImageSequenceOutput_PNGLocal>(PngSetting)->PyramidSettings = PyramidSettings;
+	ExrOutput->PyramidSettings = PyramidSettings;
+
+	// Frames are published to the shared memory ring in addition to being written to disk
+	UMoviePipelineSharedMemoryOutput* StreamOutput = CastChecked<UMoviePipelineSharedMemoryOutput>(StreamSetting);
+	StreamOutput->SetIsEnabled(!RendererTargetOptions.StreamName().IsEmpty());
+	StreamOutput->RegionName = RendererTargetOptions.StreamName();
+	StreamOutput->SlotCount = RendererTargetOptions.StreamSlotCount();
+	StreamOutput->SlotSize = static_cast<int64>(RendererTargetOptions.StreamSlotSizeMegabytes()) * 1024 * 1024;
+	StreamOutput->MainPassName = MainPassName;
+
+	// Textures and streaming cells seen by the upcoming frames are requested while the current frames are rendered
+	UMoviePipelineTrajectoryPreloadSetting* TrajectoryPreload = CastChecked<UMoviePipelineTrajectoryPreloadSetting>(PreloadSetting);
+	TrajectoryPreload->SetIsEnabled(RendererTargetOptions.PreloadFrames() > 0);
+	TrajectoryPreload->PreloadFrameCount = RendererTargetOptions.PreloadFrames();
+	TrajectoryPreload->FrameStep = RendererTargetOptions.FrameStride();
+	UMoviePipelineFrameSelectionSetting* FrameSelection = CastChecked<UMoviePipelineFrameSelectionSetting>(SelectionSetting);
+
+	// Update the rendered passes for the current target
+	UMoviePipelineDeferredPassBase* DeferredPass =
+		EasySynthMoviePipelineConfig->FindSetting<UMoviePipelineDeferredPassBase>();
+	if (DeferredPass == nullptr)
+	{
+		ErrorMessage = "Could not find the deferred render pass setting inside the default config";
+		return false;
+	}
+	if (!CurrentTarget->ConfigureRenderPass(DeferredPass))
+	{
+		ErrorMessage = FString::Printf(TEXT("Failed while configuring render passes of the %s target"), *CurrentTarget->Name());
+		return false;
+	}
+
+	// Render all bound rig cameras within the same job if requested
+	UMoviePipelineCameraSetting* CameraSetting = Cast<UMoviePipelineCameraSetting>(
+		EasySynthMoviePipelineConfig->FindOrAddSettingByClass(UMoviePipelineCameraSetting::StaticClass(), true));
+	if (CameraSetting == nullptr)
+	{
+		ErrorMessage = "Could not find the camera setting inside the default config";
+		return false;
+	}
+	CameraSetting->bRenderAllCameras = RendererTargetOptions.RenderAllCamerasInOneJob();
+
+	// Targets storing exact per-pixel values are rendered without any sample blending
+	UMoviePipelineAntiAliasingSetting* AntiAliasingSetting = Cast<UMoviePipelineAntiAliasingSetting>(
+		EasySynthMoviePipelineConfig->FindOrAddSettingByClass(UMoviePipelineAntiAliasingSetting::StaticClass(), true));
+	if (AntiAliasingSetting == nullptr || DefaultAntiAliasingSetting == nullptr)
+	{
+		ErrorMessage = "Could not find the anti-aliasing setting inside the default config";
+		return false;
+	}
+	if (CurrentTarget->RequiresAntiAliasing())
+	{
+		AntiAliasingSetting->SpatialSampleCount = DefaultAntiAliasingSetting->SpatialSampleCount;
+		AntiAliasingSetting->TemporalSampleCount = DefaultAntiAliasingSetting->TemporalSampleCount;
+		AntiAliasingSetting->bOverrideAntiAliasing = DefaultAntiAliasingSetting->bOverrideAntiAliasing;
+		AntiAliasingSetting->AntiAliasingMethod = DefaultAntiAliasingSetting->AntiAliasingMethod;
+	}
+	else
+	{
+		AntiAliasingSetting->SpatialSampleCount = 1;
+		AntiAliasingSetting->TemporalSampleCount = 1;
+		AntiAliasingSetting->bOverrideAntiAliasing = true;
+		AntiAliasingSetting->AntiAliasingMethod = EAntiAliasingMethod::AAM_None;
+	}
+
 	// Update pipeline output settings for the current target
 	UMoviePipelineOutputSetting* OutputSetting =
 		EasySynthMoviePipelineConfig->FindSetting<UMoviePipelineOutputSetting>();
@@ -460,11 +1667,15 @@ bool USequenceRenderer::PrepareJobQueue(UMoviePipelineQueueSubsystem* MoviePipel
 		ErrorMessage = "Could not find the output setting inside the default config";
 		return false;
 	}
-	// Update the image output directory
-	OutputSetting->OutputDirectory.Path =
-		FPathUtils::RigCameraDir(RenderingDirectory, RigCameras[CurrentRigCameraId]) / CurrentTarget->Name();
+	// Pass names match target names, so each pass is written to its target directory
+	const FString TargetFileNameFormat = CurrentTarget->RendersMultiplePasses() && !CurrentTarget->WritesPackedExr() ?
+		FString(TEXT("{render_pass}")) / DefaultFileNameFormat :
+		CurrentTarget->OutputNames()[0] / DefaultFileNameFormat;
 	OutputSetting->OutputResolution = OutputResolution;
 
+	// Frame ranges of subsampled frames are runs of frames placed one stride apart, possibly with dropped frames between them
+	OutputSetting->OutputFrameStep = RendererTargetOptions.FrameStride();
+
 	// Get the queue of sequences to be renderer
 	UMoviePipelineQueue* MoviePipelineQueue = MoviePipelineQueueSubsystem->GetQueue();
 	if (MoviePipelineQueue == nullptr)
@@ -475,6 +1686,8 @@ bool USequenceRenderer::PrepareJobQueue(UMoviePipelineQueueSubsystem* MoviePipel
 	MoviePipelineQueue->Modify();
 
 	// Clear the current queue
+	TargetJobs.Empty();
+	TargetJobFrames.Empty();
 	TArray<UMoviePipelineExecutorJob*> ExistingJobs = MoviePipelineQueue->GetJobs();
 	for (UMoviePipelineExecutorJob* MoviePipelineExecutorJob : ExistingJobs)
 	{
@@ -486,41 +1699,339 @@ bool USequenceRenderer::PrepareJobQueue(UMoviePipelineQueueSubsystem* MoviePipel
 		return false;
 	}
 
-	// Add received level sequence to the queue as a new job
-	UMoviePipelineExecutorJob* NewJob = MoviePipelineQueue->AllocateNewJob(UMoviePipelineExecutorJob::StaticClass());
-	if (NewJob == nullptr)
+	// Add all sequences to the same queue, so that the executor stays warm between them
+	for (const FSequenceRenderingState& SequenceState : RenderingSequences)
 	{
-		ErrorMessage = "Failed to create new rendering job";
-		return false;
-	}
-	NewJob->Modify();
-	NewJob->Map = FSoftObjectPath(GEditor->GetEditorWorldContext().World());
-	NewJob->Author = FPlatformProcess::UserName(false);
-	NewJob->SetSequence(RenderingSequencePath);
-	NewJob->JobName = NewJob->Sequence.GetAssetName();
+		// Update the image output directory
+		if (RendererTargetOptions.RenderAllCamerasInOneJob())
+		{
+			// Camera names match rig camera binding names, so each camera is written to its camera directory
+			OutputSetting->OutputDirectory.Path = SequenceState.OutputDirectory;
+			OutputSetting->FileNameFormat = FString(TEXT("{camera_name}")) / TargetFileNameFormat;
+		}
+		else if (SequenceState.FrameRanges.Num() > 0)
+		{
+			OutputSetting->OutputDirectory.Path = FPathUtils::RigCameraDir(
+				SequenceState.OutputDirectory, SequenceState.RigCameras[CurrentRigCameraId]);
+			OutputSetting->FileNameFormat = TargetFileNameFormat;
+		}
+
+		// Streamed frames of each camera rendered by the job are published with the camera poses
+		StreamOutput->Cameras.Empty();
+		StreamOutput->FirstPoseFrame = SequenceState.FirstRigCameraPoseFrame;
+		for (UCameraComponent* Camera : CurrentCameras(SequenceState))
+		{
+			const int CameraId = SequenceState.RigCameras.Find(Camera);
+			if (SequenceState.RigCameraPoses.IsValidIndex(CameraId))
+			{
+				FStreamedCamera& StreamedCamera = StreamOutput->Cameras.AddDefaulted_GetRef();
+				StreamedCamera.Name = FPathUtils::GetCameraName(Camera);
+				StreamedCamera.CameraId = CameraId;
+				StreamedCamera.Poses = SequenceState.RigCameraPoses[CameraId];
+			}
+		}
 
-	// The SetConfiguration method creates and assigns the copy of the provided config
-	NewJob->SetConfiguration(EasySynthMoviePipelineConfig);
+		// Poses of each camera rendered by the job are preloaded, following the frame selection if frames are subsampled
+		TrajectoryPreload->Cameras.Empty();
+		TrajectoryPreload->FirstPoseFrame = SequenceState.FirstRigCameraPoseFrame;
+		TrajectoryPreload->RenderedFrames = SequenceState.SelectedFrames;
+		for (UCameraComponent* Camera : CurrentCameras(SequenceState))
+		{
+			const int CameraId = SequenceState.RigCameras.Find(Camera);
+			if (SequenceState.RigCameraPoses.IsValidIndex(CameraId))
+			{
+				TrajectoryPreload->Cameras.AddDefaulted_GetRef().Poses = SequenceState.RigCameraPoses[CameraId];
+			}
+		}
+
+		// Frames rendered between joined runs of subsampled frames are dropped by the outputs
+		FrameSelection->SetIsEnabled(SequenceState.OutputFrames.Num() > 0);
+		FrameSelection->WrittenFrames = SequenceState.OutputFrames;
+
+		// Add the level sequence to the queue as a new job for each frame range
+		const bool bWholeSequence =
+			!RendererTargetOptions.CustomFrameRange() &&
+			SequenceState.FrameRanges.Num() == 1 &&
+			SequenceState.FrameRanges[0] == TRange<int>(SequenceState.StartFrame, SequenceState.EndFrame);
+		for (const TRange<int>& FrameRange : SequenceState.FrameRanges)
+		{
+			UMoviePipelineExecutorJob* NewJob = MoviePipelineQueue->AllocateNewJob(UMoviePipelineExecutorJob::StaticClass());
+			if (NewJob == nullptr)
+			{
+				ErrorMessage = "Failed to create new rendering job";
+				return false;
+			}
+			TargetJobs.Add(NewJob);
+			TargetJobFrames.Add(RenderedFrameCount(FrameRange) * CurrentCameras(SequenceState).Num());
+			NewJob->Modify();
+			NewJob->Map = FSoftObjectPath(GEditor->GetEditorWorldContext().World());
+			NewJob->Author = FPlatformProcess::UserName(false);
+			NewJob->SetSequence(SequenceState.SequencePath);
+			NewJob->JobName = NewJob->Sequence.GetAssetName();
+
+			// Restrict the job to its frame range, frame numbers in file names stay relative to the sequence
+			OutputSetting->bUseCustomPlaybackRange = !bWholeSequence;
+			OutputSetting->CustomStartFrame = FrameRange.GetLowerBoundValue();
+			OutputSetting->CustomEndFrame = FrameRange.GetUpperBoundValue();
+			if (!bWholeSequence)
+			{
+				NewJob->JobName += FString::Printf(TEXT("_%d-%d"), OutputSetting->CustomStartFrame, OutputSetting->CustomEndFrame);
+			}
+
+			// The SetConfiguration method creates and assigns the copy of the provided config
+			NewJob->SetConfiguration(EasySynthMoviePipelineConfig);
+		}
+	}
 
 	return true;
 }
 
+TArray<FOutputFinalizationStep> USequenceRenderer::OutputFinalizationSteps() const
+{
+	TArray<FOutputFinalizationStep> FinalizationSteps;
+	for (const FSequenceRenderingState& SequenceState : RenderingSequences)
+	{
+		if (RendererTargetOptions.ProcessOpticalFlow())
+		{
+			FinalizationSteps.Add({
+				FString::Printf(TEXT("Could not process optical flow images inside %s"), *SequenceState.OutputDirectory),
+				OpticalFlowProcessingStep(SequenceState) });
+		}
+
+		// Encode color videos before packing archives, so that videos get packed instead of images
+		if (RendererTargetOptions.ColorVideoOutput() &&
+			RendererTargetOptions.TargetSelected(FRendererTargetOptions::COLOR_IMAGE))
+		{
+			FinalizationSteps.Add({
+				FString::Printf(TEXT("Could not encode color videos inside %s"), *SequenceState.OutputDirectory),
+				ColorVideoEncodingStep(SequenceState) });
+		}
+
+		// Pack outputs of each sequence once all of them are written
+		if (RendererTargetOptions.PackOutputArchives())
+		{
+			const int64 MaxArchiveBytes = static_cast<int64>(RendererTargetOptions.ArchiveSizeMegabytes()) * 1024 * 1024;
+			const FString OutputDirectory = SequenceState.OutputDirectory;
+			FinalizationSteps.Add({
+				FString::Printf(TEXT("Could not pack outputs inside %s into archives"), *SequenceState.OutputDirectory),
+				[MaxArchiveBytes, OutputDirectory]()
+				{
+					FDatasetArchiveWriter ArchiveWriter(MaxArchiveBytes);
+					return ArchiveWriter.PackDirectory(OutputDirectory);
+				} });
+		}
+	}
+	return FinalizationSteps;
+}
+
+void USequenceRenderer::FinalizeOutputs()
+{
+	TArray<FOutputFinalizationStep> FinalizationSteps = OutputFinalizationSteps();
+	if (FinalizationSteps.Num() == 0)
+	{
+		return OnOutputsFinalized(true, 0.0);
+	}
+
+	// Steps read and write the whole dataset, so they run on their own thread while the editor keeps ticking
+	const double FinalizationStartTime = FPlatformTime::Seconds();
+	TWeakObjectPtr<USequenceRenderer> WeakSequenceRenderer(this);
+	Async(EAsyncExecution::Thread,
+		[WeakSequenceRenderer, FinalizationStartTime, LocalFinalizationSteps = MoveTemp(FinalizationSteps)]()
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(USequenceRenderer::FinalizeOutputs);
+
+			FString FailedStepError;
+			for (const FOutputFinalizationStep& FinalizationStep : LocalFinalizationSteps)
+			{
+				if (!FinalizationStep.Run())
+				{
+					FailedStepError = FinalizationStep.ErrorMessage;
+					break;
+				}
+			}
+			const double FinalizationSeconds = FPlatformTime::Seconds() - FinalizationStartTime;
+
+			AsyncTask(ENamedThreads::GameThread, [WeakSequenceRenderer, FailedStepError, FinalizationSeconds]()
+			{
+				if (!WeakSequenceRenderer.IsValid())
+				{
+					return;
+				}
+				if (!FailedStepError.IsEmpty())
+				{
+					WeakSequenceRenderer->ErrorMessage = FailedStepError;
+				}
+				WeakSequenceRenderer->OnOutputsFinalized(FailedStepError.IsEmpty(), FinalizationSeconds);
+			});
+		});
+}
+
+TFunction<bool()> USequenceRenderer::OpticalFlowProcessingStep(const FSequenceRenderingState& SequenceState) const
+{
+	// Depth images store the depth normalized by the depth range, unless they are metric
+	const float DepthScaleMeters = RendererTargetOptions.MetricDepth() ? 1.0f : RendererTargetOptions.DepthRangeMeters();
+	const FOpticalFlowImageTarget OpticalFlowImageTarget(TextureStyleManager, EImageFormat::EXR, RendererTargetOptions.OpticalFlowScale());
+	const FDepthImageTarget DepthImageTarget(
+		TextureStyleManager, EImageFormat::EXR, RendererTargetOptions.DepthRangeMeters(), RendererTargetOptions.MetricDepth());
+	TArray<TPair<FString, FOpticalFlowPostProcessor>> CameraPostProcessors;
+	for (int i = 0; i < SequenceState.RigCameras.Num() && i < SequenceState.RigCameraPoses.Num(); i++)
+	{
+		// The first camera is used to render all of them one by one, so its own field of view is kept separately
+		UCameraComponent* Camera = SequenceState.RigCameras[i];
+		const float FieldOfView = i == 0 ? SequenceState.OriginalCameraFOV : Camera->FieldOfView;
+		CameraPostProcessors.Emplace(
+			FPathUtils::RigCameraDir(SequenceState.OutputDirectory, Camera),
+			FOpticalFlowPostProcessor(
+				RendererTargetOptions.OpticalFlowScale(), DepthScaleMeters,
+				SequenceState.RigCameraPoses[i], SequenceState.FirstRigCameraPoseFrame, FieldOfView));
+	}
+
+	return [CameraPostProcessors, FlowDirName = OpticalFlowImageTarget.Name(), DepthDirName = DepthImageTarget.Name()]()
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(USequenceRenderer::ProcessOpticalFlow);
+		for (const TPair<FString, FOpticalFlowPostProcessor>& CameraPostProcessor : CameraPostProcessors)
+		{
+			if (!CameraPostProcessor.Value.ProcessCameraDirectory(
+				CameraPostProcessor.Key, FlowDirName, DepthDirName, FMultiPassTarget::PackedOutputName))
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+}
+
+TFunction<bool()> USequenceRenderer::ColorVideoEncodingStep(const FSequenceRenderingState& SequenceState) const
+{
+	// Camera poses ids count frames from the start of the sequence playback range
+	const FFrameRate DisplayRate = SequenceState.Sequence->GetMovieScene()->GetDisplayRate();
+	const FVideoSequenceEncoder VideoEncoder(
+		RendererTargetOptions.VideoEncoderPath(), RendererTargetOptions.VideoCodec(), DisplayRate.AsDecimal(),
+		FirstPoseFrame(SequenceState));
+	const FColorImageTarget ColorImageTarget(TextureStyleManager, FVideoSequenceEncoder::ImageFormat);
+	TArray<FString> ImagesDirectories;
+	for (UCameraComponent* Camera : SequenceState.RigCameras)
+	{
+		ImagesDirectories.Add(FPathUtils::RigCameraDir(SequenceState.OutputDirectory, Camera) / ColorImageTarget.Name());
+	}
+
+	return [VideoEncoder, ImagesDirectories, ImageExtension = FOutputFramesScanner::FileExtension(ColorImageTarget.ImageFormat)]()
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(USequenceRenderer::EncodeColorVideos);
+		for (const FString& ImagesDirectory : ImagesDirectories)
+		{
+			if (!VideoEncoder.EncodeDirectory(ImagesDirectory, ImageExtension))
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+}
+
+int64 USequenceRenderer::CurrentTargetOutputSize() const
+{
+	int64 OutputSize = 0;
+	for (const FSequenceRenderingState& SequenceState : RenderingSequences)
+	{
+		if (SequenceState.FrameRanges.Num() == 0)
+		{
+			continue;
+		}
+
+		for (UCameraComponent* Camera : CurrentCameras(SequenceState))
+		{
+			for (const FString& OutputName : CurrentTarget->OutputNames())
+			{
+				const FString OutputDirectory = FPathUtils::RigCameraDir(SequenceState.OutputDirectory, Camera) / OutputName;
+				IFileManager::Get().IterateDirectoryStatRecursively(*OutputDirectory,
+					[&OutputSize](const TCHAR* Path, const FFileStatData& StatData)
+					{
+						if (!StatData.bIsDirectory)
+						{
+							OutputSize += StatData.FileSize;
+						}
+						return true;
+					});
+			}
+		}
+	}
+	return OutputSize;
+}
+
+void USequenceRenderer::SaveRenderReport(const bool bSuccess)
+{
+	RenderReport.success = bSuccess;
+	RenderReport.total_seconds = FPlatformTime::Seconds() - RenderingStartTime;
+	RenderReport.peak_used_physical_bytes = FPlatformMemory::GetStats().PeakUsedPhysical;
+
+	FString JsonString;
+	FJsonObjectConverter::UStructToJsonObjectString(RenderReport, JsonString);
+
+	// Every sequence output directory gets the report of the whole batch
+	for (const FSequenceRenderingState& SequenceState : RenderingSequences)
+	{
+		const FString SaveFilePath = FPathUtils::RenderReportFilePath(
+			SequenceState.OutputDirectory, RenderReport.shard_index, RenderReport.shard_count);
+		if (!FFileHelper::SaveStringToFile(JsonString, *SaveFilePath))
+		{
+			UE_LOG(LogEasySynth, Warning, TEXT("%s: Failed while saving the file %s"), *FString(__FUNCTION__), *SaveFilePath)
+		}
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Rendered %d frames in %.2f s, writing %lld bytes"),
+		*FString(__FUNCTION__), RenderReport.frames, RenderReport.total_seconds, RenderReport.bytes_written)
+}
+
 void USequenceRenderer::BroadcastRenderingFinished(const bool bSuccess)
 {
+	// Metadata files written in the background have to be complete before outputs are finalized
+	if (!BackgroundFileWriter.Wait() && bSuccess)
+	{
+		ErrorMessage = "Could not write sequence metadata files";
+		return BroadcastRenderingFinished(false);
+	}
+
+	GEditor->GetEditorWorldContext().World()->GetTimerManager().ClearTimer(RenderingProgressTimerHandle);
+	TargetJobs.Empty();
+	TargetJobFrames.Empty();
+
+	// The rendering stays in progress until the outputs are finalized
+	if (bSuccess)
+	{
+		return FinalizeOutputs();
+	}
+	OnOutputsFinalized(false, 0.0);
+}
+
+void USequenceRenderer::OnOutputsFinalized(const bool bSuccess, const double FinalizationSeconds)
+{
+	RenderReport.output_finalization_seconds = FinalizationSeconds;
+	SaveRenderReport(bSuccess);
+
 	if (!bSuccess)
 	{
 		UE_LOG(LogEasySynth, Warning, TEXT("%s: %s"), *FString(__FUNCTION__), *ErrorMessage)
 	}
 
-	if (RigCameras.Num() > 0)
+	for (FSequenceRenderingState& SequenceState : RenderingSequences)
 	{
-		// Restore the transform of the original camera
-		RigCameras[0]->SetRelativeTransform(OriginalCameraTransform);
-		RigCameras[0]->SetFieldOfView(OriginalCameraFOV);
+		// Remove rig camera bindings added for rendering all cameras in one job
+		UnbindRigCameras(SequenceState);
+
+		if (SequenceState.RigCameras.Num() > 0)
+		{
+			// Restore the transform of the original camera
+			SequenceState.RigCameras[0]->SetRelativeTransform(SequenceState.OriginalCameraTransform);
+			SequenceState.RigCameras[0]->SetFieldOfView(SequenceState.OriginalCameraFOV);
+		}
 	}
 
-	RigCameras.Empty();
-	TargetsQueue.Empty();
+	RenderingSequences.Empty();
+	PreparingSequenceAssets.Empty();
+	PreparingOutputDirectories.Empty();
+	WorkItems.Empty();
+	PostProcessMaterialCache.Empty();
 
 	// Revert world state to the original one
 	TextureStyleManager->CheckoutTextureStyle(OriginalTextureStyle);
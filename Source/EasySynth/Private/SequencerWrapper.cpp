@@ -2,12 +2,14 @@
 
 #include "SequencerWrapper.h"
 
+#include "Camera/CameraComponent.h"
 #include "ILevelSequenceEditorToolkit.h"
 #include "ISequencer.h"
 #include "LevelSequence.h"
 #include "MovieScene.h"
 #include "Sections/MovieSceneCameraCutSection.h"
 #include "Subsystems/AssetEditorSubsystem.h"
+#include "Tracks/MovieScene3DTransformTrack.h"
 
 #include "EasySynth.h"
 
@@ -32,7 +34,7 @@ bool FSequencerWrapper::OpenSequence(ULevelSequence* LevelSequence)
 		return false;
 	}
 
-	GetMovieSceneCutSections();
+	FindMovieSceneCutSections();
 
 	// Open sequencer editor for the level sequence asset
 	TArray<UObject*> Assets;
@@ -68,10 +70,12 @@ bool FSequencerWrapper::OpenSequence(ULevelSequence* LevelSequence)
 		return false;
 	}
 
+	FindCutSectionBindings();
+
 	return true;
 }
 
-TArray<UMovieSceneCameraCutSection*>& FSequencerWrapper::GetMovieSceneCutSections()
+void FSequencerWrapper::FindMovieSceneCutSections()
 {
 	MovieSceneCutSections.Empty();
 
@@ -80,7 +84,7 @@ TArray<UMovieSceneCameraCutSection*>& FSequencerWrapper::GetMovieSceneCutSection
 	if (MovieSceneSections.Num() == 0)
 	{
 		UE_LOG(LogEasySynth, Warning, TEXT("%s: No sections inside the camera cut track"), *FString(__FUNCTION__))
-		return MovieSceneCutSections;
+		return;
 	}
 
 	// Convert camera track sections to cut sections
@@ -91,10 +95,53 @@ TArray<UMovieSceneCameraCutSection*>& FSequencerWrapper::GetMovieSceneCutSection
 		{
 			UE_LOG(LogEasySynth, Error, TEXT("%s: Could not convert MovieSceneSection into a CutSection"),
 				*FString(__FUNCTION__));
-			return MovieSceneCutSections;
+			return;
 		}
 		MovieSceneCutSections.Add(CutSection);
 	}
+}
+
+void FSequencerWrapper::FindCutSectionBindings()
+{
+	CutSectionCameras.Empty();
+	CutSectionTransformTracks.Empty();
+
+	ISequencer* Sequencer = GetSequencer();
+	bool bAllCamerasFound = true;
+	for (UMovieSceneCameraCutSection* CutSection : MovieSceneCutSections)
+	{
+		// Get the camera component
+		UCameraComponent* Camera = CutSection->GetFirstCamera(*Sequencer, Sequencer->GetFocusedTemplateID());
+		if (Camera == nullptr)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Cut section camera component is null"), *FString(__FUNCTION__))
+			bAllCamerasFound = false;
+		}
+		CutSectionCameras.Add(Camera);
+
+		// Find the track inside the level sequence that corresponds to the pose transformation of the camera
+		UMovieScene3DTransformTrack* CameraTransformTrack = nullptr;
+		const FGuid CameraBindingGuid = CutSection->GetCameraBindingID().GetGuid();
+		for (const FMovieSceneBinding& Binding : MovieScene->GetBindings())
+		{
+			if (Binding.GetObjectGuid() == CameraBindingGuid)
+			{
+				for (UMovieSceneTrack* Track : Binding.GetTracks())
+				{
+					CameraTransformTrack = Cast<UMovieScene3DTransformTrack>(Track);
+					if (CameraTransformTrack != nullptr)
+					{
+						break;
+					}
+				}
+			}
+		}
+		CutSectionTransformTracks.Add(CameraTransformTrack);
+	}
 
-	return MovieSceneCutSections;
+	// Users of cameras expect all of them to be valid
+	if (!bAllCamerasFound)
+	{
+		CutSectionCameras.Empty();
+	}
 }
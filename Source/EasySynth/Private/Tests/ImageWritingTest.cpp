@@ -0,0 +1,200 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "ImageWriteTask.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+
+#include "ImageWriting/DatasetArchiveWriter.h"
+#include "ImageWriting/ImageWriterPool.h"
+#include "ImageWriting/OpticalFlowPostProcessor.h"
+#include "ImageWriting/PalettePngEncoder.h"
+#include "PathUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FDecodeFlowColorTest,
+	"EasySynth.ImageWriting.DecodeFlowColor",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDecodeFlowColorTest::RunTest(const FString& Parameters)
+{
+	const FIntPoint Size(100, 50);
+	const float Scale = 2.0f;
+	const float Tolerance = 1e-3f;
+
+	// Colors without saturation encode the zero offset
+	TestTrue(TEXT("Black is no motion"), FOpticalFlowPostProcessor::DecodeFlowColor(0.0f, 0.0f, 0.0f, Size, Scale).IsNearlyZero());
+	TestTrue(TEXT("Gray is no motion"), FOpticalFlowPostProcessor::DecodeFlowColor(0.5f, 0.5f, 0.5f, Size, Scale).IsNearlyZero());
+
+	// The hue is the offset angle, pointing from the current to the previous position
+	const FVector2f Red = FOpticalFlowPostProcessor::DecodeFlowColor(1.0f, 0.0f, 0.0f, Size, Scale);
+	TestEqual(TEXT("Red horizontal offset"), Red.X, -50.0f, Tolerance);
+	TestEqual(TEXT("Red vertical offset"), Red.Y, 0.0f, Tolerance);
+
+	const FVector2f Green = FOpticalFlowPostProcessor::DecodeFlowColor(0.0f, 1.0f, 0.0f, Size, Scale);
+	TestEqual(TEXT("Green horizontal offset"), Green.X, 25.0f, Tolerance);
+	TestEqual(TEXT("Green vertical offset"), Green.Y, -12.5f * FMath::Sqrt(3.0f), Tolerance);
+
+	// The saturation is the offset length
+	const FVector2f PaleRed = FOpticalFlowPostProcessor::DecodeFlowColor(1.0f, 0.5f, 0.5f, Size, Scale);
+	TestEqual(TEXT("Pale red horizontal offset"), PaleRed.X, -25.0f, Tolerance);
+	TestEqual(TEXT("Pale red vertical offset"), PaleRed.Y, 0.0f, Tolerance);
+
+	// Non-positive scales are treated as no scaling
+	const FVector2f Unscaled = FOpticalFlowPostProcessor::DecodeFlowColor(1.0f, 0.0f, 0.0f, Size, 0.0f);
+	TestEqual(TEXT("Unscaled horizontal offset"), Unscaled.X, -100.0f, Tolerance);
+
+	return true;
+}
+
+
+/**
+ * Image write task that blocks its writer thread until the test releases it
+*/
+class FBlockingWriteTask : public IImageWriteTaskBase
+{
+public:
+	explicit FBlockingWriteTask(FEvent* ReleaseEvent) : ReleaseEvent(ReleaseEvent) {}
+
+	bool RunTask() override { return ReleaseEvent->Wait(10000); }
+	void OnAbandoned() override {}
+
+private:
+	/** Event the task waits for */
+	FEvent* ReleaseEvent;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FImageWriterPoolFenceTest,
+	"EasySynth.ImageWriting.ImageWriterPoolFence",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FImageWriterPoolFenceTest::RunTest(const FString& Parameters)
+{
+	FImageWriterPool Pool(TEXT("EasySynthTestWriterPool"), 2);
+
+	// Fences of the idle pool are fulfilled right away
+	TestTrue(TEXT("Idle pool fence is ready"), Pool.CreateFence().IsReady());
+
+	// Fences wait for all of the tasks enqueued before them
+	FEvent* ReleaseEvent = FPlatformProcess::GetSynchEventFromPool(true);
+	TFuture<bool> FirstTask = Pool.Enqueue(MakeUnique<FBlockingWriteTask>(ReleaseEvent));
+	TFuture<bool> SecondTask = Pool.Enqueue(MakeUnique<FBlockingWriteTask>(ReleaseEvent));
+	TFuture<void> Fence = Pool.CreateFence();
+	TestEqual(TEXT("Pending tasks"), Pool.GetNumPendingTasks(), 2);
+	TestFalse(TEXT("Fence waits for the blocked tasks"), Fence.WaitFor(FTimespan::FromMilliseconds(100)));
+
+	ReleaseEvent->Trigger();
+	TestTrue(TEXT("Fence is fulfilled once the tasks finish"), Fence.WaitFor(FTimespan::FromSeconds(10)));
+	TestTrue(TEXT("First task succeeded"), FirstTask.Get());
+	TestTrue(TEXT("Second task succeeded"), SecondTask.Get());
+	TestEqual(TEXT("No pending tasks"), Pool.GetNumPendingTasks(), 0);
+	FPlatformProcess::ReturnSynchEventToPool(ReleaseEvent);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FPalettePngEncoderTest,
+	"EasySynth.ImageWriting.PalettePngEncoder",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FPalettePngEncoderTest::RunTest(const FString& Parameters)
+{
+	const FPalettePngEncoder Encoder({ FColor::Red, FColor::Green, FColor::Blue });
+	const FIntPoint Size(3, 2);
+	const TArray64<FColor> Pixels = {
+		FColor::Red, FColor::Red, FColor::Green,
+		FColor::Blue, FColor::Green, FColor::Red
+	};
+	TArray64<uint8> EncodedData;
+	if (!TestTrue(TEXT("Palette colors are encoded"), Encoder.Encode(Size, Pixels, EncodedData)))
+	{
+		return false;
+	}
+
+	// Decoding the palette-indexed image gives back the exact colors
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+	TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+	TArray64<uint8> RawData;
+	if (!TestTrue(TEXT("Encoded image is a valid png"), ImageWrapper->SetCompressed(EncodedData.GetData(), EncodedData.Num())) ||
+		!TestTrue(TEXT("Encoded image is decoded"), ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, RawData)))
+	{
+		return false;
+	}
+	TestEqual(TEXT("Decoded width"), static_cast<int>(ImageWrapper->GetWidth()), Size.X);
+	TestEqual(TEXT("Decoded height"), static_cast<int>(ImageWrapper->GetHeight()), Size.Y);
+	TestTrue(TEXT("Decoded colors"),
+		RawData.Num() == Pixels.Num() * sizeof(FColor) && FMemory::Memcmp(RawData.GetData(), Pixels.GetData(), RawData.Num()) == 0);
+
+	// Images with colors outside of the palette are left to the regular encoder
+	AddExpectedError(TEXT("is not inside the palette"), EAutomationExpectedErrorFlags::Contains, 1);
+	const TArray64<FColor> UnknownPixels = {
+		FColor::Red, FColor::Red, FColor::Green,
+		FColor::Blue, FColor::White, FColor::Red
+	};
+	TestFalse(TEXT("Colors outside of the palette are rejected"), Encoder.Encode(Size, UnknownPixels, EncodedData));
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FDatasetArchiveIndexTest,
+	"EasySynth.ImageWriting.DatasetArchiveIndex",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDatasetArchiveIndexTest::RunTest(const FString& Parameters)
+{
+	const FString Directory = FPaths::ConvertRelativePathToFull(FPaths::AutomationTransientDir() / TEXT("EasySynthDatasetArchive"));
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+
+	// Frame images, a pyramid level image and a sidecar output shared by all cameras
+	const FString ImageFilePath = Directory / TEXT("Camera") / TEXT("ColorImage") / TEXT("Sequence.0003.png");
+	FFileHelper::SaveStringToFile(TEXT("abc"), *ImageFilePath);
+	FFileHelper::SaveStringToFile(TEXT("de"), *FPathUtils::PyramidLevelFilePath(ImageFilePath, 1));
+	FFileHelper::SaveStringToFile(TEXT("pose"), *(Directory / TEXT("CameraPoses.csv")));
+
+	FDatasetArchiveWriter ArchiveWriter(1024 * 1024);
+	if (!TestTrue(TEXT("Directory is packed"), ArchiveWriter.PackDirectory(Directory)))
+	{
+		return false;
+	}
+
+	// Each entry takes the header block followed by its content padded to whole blocks
+	const FString ArchiveName = FPaths::GetCleanFilename(FPathUtils::DatasetArchiveFilePath(Directory, 0));
+	TArray<FString> IndexLines;
+	FFileHelper::LoadFileToStringArray(IndexLines, *FPathUtils::DatasetIndexFilePath(Directory));
+	const TArray<FString> ExpectedLines = {
+		TEXT("name,camera,target,frame,archive,offset,length,level"),
+		FString::Printf(TEXT("CameraPoses.csv,,,-1,%s,512,4,0"), *ArchiveName),
+		FString::Printf(TEXT("Camera/000003.ColorImage.level1.png,Camera,ColorImage,3,%s,1536,2,1"), *ArchiveName),
+		FString::Printf(TEXT("Camera/000003.ColorImage.png,Camera,ColorImage,3,%s,2560,3,0"), *ArchiveName)
+	};
+	if (TestEqual(TEXT("Number of index lines"), IndexLines.Num(), ExpectedLines.Num()))
+	{
+		for (int i = 0; i < ExpectedLines.Num(); i++)
+		{
+			TestEqual(FString::Printf(TEXT("Index line %d"), i), IndexLines[i], ExpectedLines[i]);
+		}
+	}
+
+	// The archive ends with two empty blocks, and the packed files are removed
+	TestEqual(TEXT("Archive size"), IFileManager::Get().FileSize(*FPathUtils::DatasetArchiveFilePath(Directory, 0)), 4096ll);
+	TestFalse(TEXT("Packed image is removed"), IFileManager::Get().FileExists(*ImageFilePath));
+
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
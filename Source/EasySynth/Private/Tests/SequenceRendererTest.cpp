@@ -0,0 +1,129 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "SequenceRenderer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FFrameShardRangeTest,
+	"EasySynth.SequenceRenderer.FrameShardRange",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FFrameShardRangeTest::RunTest(const FString& Parameters)
+{
+	// Frame shards cover the whole range without gaps or overlaps
+	const int StartFrame = 10;
+	const int EndFrame = 20;
+	const int FrameShardCount = 3;
+	int NextFrame = StartFrame;
+	for (int FrameShardId = 0; FrameShardId < FrameShardCount; FrameShardId++)
+	{
+		const TRange<int> FrameRange = USequenceRenderer::FrameShardRange(StartFrame, EndFrame, FrameShardId, FrameShardCount);
+		TestEqual(TEXT("Frame shard starts where the previous one ends"), FrameRange.GetLowerBoundValue(), NextFrame);
+		TestTrue(TEXT("Frame shard is not empty"), !FrameRange.IsEmpty());
+		NextFrame = FrameRange.GetUpperBoundValue();
+	}
+	TestEqual(TEXT("Last frame shard ends at the end frame"), NextFrame, EndFrame);
+
+	// The same frame shard always gets the same frames
+	const TRange<int> FirstRange = USequenceRenderer::FrameShardRange(StartFrame, EndFrame, 0, FrameShardCount);
+	TestEqual(TEXT("First frame shard start"), FirstRange.GetLowerBoundValue(), 10);
+	TestEqual(TEXT("First frame shard end"), FirstRange.GetUpperBoundValue(), 13);
+
+	// Sequences shorter than the frame shard count leave some of the shards empty
+	int CoveredFrameCount = 0;
+	for (int FrameShardId = 0; FrameShardId < 4; FrameShardId++)
+	{
+		const TRange<int> FrameRange = USequenceRenderer::FrameShardRange(0, 2, FrameShardId, 4);
+		CoveredFrameCount += FrameRange.GetUpperBoundValue() - FrameRange.GetLowerBoundValue();
+	}
+	TestEqual(TEXT("Short sequence frames are covered once"), CoveredFrameCount, 2);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FShardSplittingTest,
+	"EasySynth.SequenceRenderer.ShardSplitting",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FShardSplittingTest::RunTest(const FString& Parameters)
+{
+	// Every work item is rendered by exactly one of the shards
+	const int ShardCount = 3;
+	TArray<FRendererTargetOptions> Shards;
+	for (int ShardIndex = 0; ShardIndex < ShardCount; ShardIndex++)
+	{
+		FRendererTargetOptions& Options = Shards.AddDefaulted_GetRef();
+		Options.SetShard(ShardIndex, ShardCount);
+		TestTrue(TEXT("Shard is valid"), Options.ShardValid());
+	}
+	for (int WorkItemId = 0; WorkItemId < 20; WorkItemId++)
+	{
+		int OwnerCount = 0;
+		for (const FRendererTargetOptions& Options : Shards)
+		{
+			OwnerCount += Options.InShard(WorkItemId) ? 1 : 0;
+		}
+		TestEqual(FString::Printf(TEXT("Work item %d shard count"), WorkItemId), OwnerCount, 1);
+	}
+
+	FRendererTargetOptions InvalidOptions;
+	InvalidOptions.SetShard(3, ShardCount);
+	TestFalse(TEXT("Shard index outside of the shard count is invalid"), InvalidOptions.ShardValid());
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FSelectedFrameRangesTest,
+	"EasySynth.SequenceRenderer.SelectedFrameRanges",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FSelectedFrameRangesTest::RunTest(const FString& Parameters)
+{
+	const TArray<TRange<int>> FrameRanges = { TRange<int>(0, 100) };
+	const TArray<int> SelectedFrames = { 0, 2, 4, 10, 50, 51, 150 };
+	const int FrameStride = 2;
+	const int MaxDroppedFrames = 2;
+	TArray<int> OutputFrames;
+	const TArray<TRange<int>> SelectedRanges =
+		USequenceRenderer::SelectedFrameRanges(FrameRanges, SelectedFrames, FrameStride, MaxDroppedFrames, OutputFrames);
+
+	// Frames 4 and 10 are joined over two dropped strided frames, frame 50 is too far and frame 51 is off the stride
+	if (TestEqual(TEXT("Number of selected ranges"), SelectedRanges.Num(), 3))
+	{
+		TestEqual(TEXT("Joined range start"), SelectedRanges[0].GetLowerBoundValue(), 0);
+		TestEqual(TEXT("Joined range end"), SelectedRanges[0].GetUpperBoundValue(), 11);
+		TestEqual(TEXT("Distant frame range start"), SelectedRanges[1].GetLowerBoundValue(), 50);
+		TestEqual(TEXT("Distant frame range end"), SelectedRanges[1].GetUpperBoundValue(), 51);
+		TestEqual(TEXT("Unaligned frame range start"), SelectedRanges[2].GetLowerBoundValue(), 51);
+		TestEqual(TEXT("Unaligned frame range end"), SelectedRanges[2].GetUpperBoundValue(), 52);
+	}
+
+	// Only the selected frames are written, selected frames outside of the frame ranges are not rendered at all
+	TestTrue(TEXT("Output frames"), OutputFrames == TArray<int>({ 0, 2, 4, 10, 50, 51 }));
+
+	// Without dropped frames allowed, ranges are only extended by consecutive strided frames
+	TArray<int> StrictOutputFrames;
+	const TArray<TRange<int>> StrictRanges =
+		USequenceRenderer::SelectedFrameRanges(FrameRanges, SelectedFrames, FrameStride, 0, StrictOutputFrames);
+	TestEqual(TEXT("Number of strict ranges"), StrictRanges.Num(), 4);
+
+	// Selected frames are collected from each of the frame ranges of the shard
+	const TArray<TRange<int>> ShardRanges = { TRange<int>(0, 5), TRange<int>(8, 12) };
+	TArray<int> ShardOutputFrames;
+	const TArray<TRange<int>> ShardSelectedRanges =
+		USequenceRenderer::SelectedFrameRanges(ShardRanges, { 3, 6, 9 }, 1, 0, ShardOutputFrames);
+	TestEqual(TEXT("Number of shard ranges"), ShardSelectedRanges.Num(), 2);
+	TestTrue(TEXT("Shard output frames"), ShardOutputFrames == TArray<int>({ 3, 9 }));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -7,12 +7,15 @@
 #include "Serialization/Csv/CsvParser.h"
 
 #include "EasySynth.h"
+#include "ImageWriting/BackgroundFileWriter.h"
 #include "TextureStyles/TextureMappingAsset.h"
 #include "TextureStyles/TextureStyleManager.h"
 
 
 #define LOCTEXT_NAMESPACE "FSemanticCsvInterface"
 
+const TCHAR* FSemanticCsvInterface::ActorClassesHeader = TEXT("actor,class");
+
 FReply FSemanticCsvInterface::OnImportSemanticClassesClicked(UTextureStyleManager* TextureStyleManager)
 {
 	UE_LOG(LogEasySynth, Log, TEXT("%s"), *FString(__FUNCTION__))
@@ -90,29 +93,164 @@ FReply FSemanticCsvInterface::OnImportSemanticClassesClicked(UTextureStyleManage
 	return FReply::Handled();
 }
 
-bool FSemanticCsvInterface::ExportSemanticClasses(const FString& OutputDir, UTextureMappingAsset* TextureMappingAsset)
+FReply FSemanticCsvInterface::OnImportActorClassesClicked(UTextureStyleManager* TextureStyleManager)
+{
+	UE_LOG(LogEasySynth, Log, TEXT("%s"), *FString(__FUNCTION__))
+
+	FString FilePath;
+	const bool bSave = false;
+	if (SelectCsvFile(TEXT("Import actor classes"), bSave, FilePath) && !ImportActorClasses(FilePath, TextureStyleManager))
+	{
+		const FText MessageBoxTitle = LOCTEXT("InvalidActorClassesCsvMessageBoxTitle", "Failed to load CSV");
+		FMessageDialog::Open(
+			EAppMsgType::Ok,
+			LOCTEXT("InvalidActorClassesCsvMessageBoxText", "Expected line format \"actor GUID or pattern, class\""),
+			&MessageBoxTitle);
+	}
+
+	return FReply::Handled();
+}
+
+FReply FSemanticCsvInterface::OnExportActorClassesClicked(UTextureStyleManager* TextureStyleManager)
+{
+	UE_LOG(LogEasySynth, Log, TEXT("%s"), *FString(__FUNCTION__))
+
+	FString FilePath;
+	const bool bSave = true;
+	if (SelectCsvFile(TEXT("Export actor classes"), bSave, FilePath))
+	{
+		TextureStyleManager->ExportActorClasses(FilePath);
+	}
+
+	return FReply::Handled();
+}
+
+bool FSemanticCsvInterface::ImportActorClasses(const FString& FilePath, UTextureStyleManager* TextureStyleManager)
+{
+	FString FileContent;
+	if (!FFileHelper::LoadFileToString(FileContent, *FilePath))
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: Could not load the file %s"), *FString(__FUNCTION__), *FilePath)
+		return false;
+	}
+
+	// Validate all of the rows before applying any of them
+	const FCsvParser CsvParser(FileContent);
+	const FCsvParser::FRows& Rows = CsvParser.GetRows();
+	TArray<TPair<FString, FString>> Rules;
+	Rules.Reserve(Rows.Num());
+	for (int i = 0; i < Rows.Num(); i++)
+	{
+		const TArray<const TCHAR*>& Row = Rows[i];
+		if (Row.Num() != 2)
+		{
+			UE_LOG(LogEasySynth, Warning, TEXT("%s: Line %d of %s does not have exactly 2 columns"),
+				*FString(__FUNCTION__), i + 1, *FilePath)
+			return false;
+		}
+		const FString Actor = FString(Row[0]).TrimStartAndEnd();
+		const FString ClassName = FString(Row[1]).TrimStartAndEnd();
+		if (i == 0 && FString::Printf(TEXT("%s,%s"), *Actor, *ClassName) == ActorClassesHeader)
+		{
+			continue;
+		}
+		Rules.Emplace(Actor, ClassName);
+	}
+
+	TextureStyleManager->ApplyActorClassRules(Rules);
+	return true;
+}
+
+bool FSemanticCsvInterface::ExportActorClasses(const FString& FilePath, UTextureMappingAsset* TextureMappingAsset)
+{
+	// Sorted by GUIDs, so that exports of the same bindings are identical
+	TArray<FGuid> ActorGuids;
+	TextureMappingAsset->ActorClassIds.GetKeys(ActorGuids);
+	ActorGuids.Sort();
+
+	TArray<FString> Lines;
+	Lines.Reserve(ActorGuids.Num() + 1);
+	Lines.Add(ActorClassesHeader);
+	for (const FGuid& ActorGuid : ActorGuids)
+	{
+		const uint16 ClassId = TextureMappingAsset->ActorClassIds[ActorGuid];
+		if (TextureMappingAsset->SemanticClassTable.IsValidIndex(ClassId))
+		{
+			Lines.Add(FString::Printf(TEXT("%s,%s"),
+				*ActorGuid.ToString(EGuidFormats::DigitsWithHyphens),
+				*TextureMappingAsset->SemanticClassTable[ClassId].Name));
+		}
+	}
+
+	return FBackgroundFileWriter::SaveStringArrayToFile(nullptr, MoveTemp(Lines), FilePath);
+}
+
+bool FSemanticCsvInterface::ExportSemanticClasses(
+	const FString& OutputDir,
+	UTextureMappingAsset* TextureMappingAsset,
+	FBackgroundFileWriter* FileWriter)
 {
 	TArray<FString> Lines;
 
-	for (auto Element : TextureMappingAsset->SemanticClasses)
+	for (const FSemanticClass& Class : TextureMappingAsset->SemanticClassTable)
 	{
-		const FSemanticClass& Class = Element.Value;
 		Lines.Add(FString::Printf(TEXT("%s,%d,%d,%d"), *Class.Name, Class.Color.R, Class.Color.G, Class.Color.B));
 	}
 
 	// Save the file
 	const FString SaveFilePath = FPathUtils::SemanticClassesFilePath(OutputDir);
-	if (!FFileHelper::SaveStringArrayToFile(
-		Lines,
-		*SaveFilePath,
-		FFileHelper::EEncodingOptions::AutoDetect,
-		&IFileManager::Get(),
-		EFileWrite::FILEWRITE_None))
+	return FBackgroundFileWriter::SaveStringArrayToFile(FileWriter, MoveTemp(Lines), SaveFilePath);
+}
+
+bool FSemanticCsvInterface::ExportInstanceIds(
+	const FString& OutputDir,
+	UTextureMappingAsset* TextureMappingAsset,
+	const TArray<AActor*>& InstanceActors,
+	FBackgroundFileWriter* FileWriter)
+{
+	TArray<FString> Lines;
+	Lines.Reserve(InstanceActors.Num() + 1);
+	Lines.Add(TEXT("id,guid,actor,class"));
+
+	for (int i = 0; i < InstanceActors.Num(); i++)
+	{
+		// Actors without an assigned class are displayed as undefined inside semantic images
+		const FGuid ActorGuid = InstanceActors[i]->GetActorGuid();
+		const uint16* ClassId = TextureMappingAsset->ActorClassIds.Find(ActorGuid);
+		const bool bClassValid = ClassId != nullptr && TextureMappingAsset->SemanticClassTable.IsValidIndex(*ClassId);
+		Lines.Add(FString::Printf(TEXT("%d,%s,%s,%s"),
+			i + 1,
+			*ActorGuid.ToString(EGuidFormats::DigitsWithHyphens),
+			*InstanceActors[i]->GetName(),
+			bClassValid ? *TextureMappingAsset->SemanticClassTable[*ClassId].Name : TEXT("Undefined")));
+	}
+
+	// Save the file
+	const FString SaveFilePath = FPathUtils::InstanceIdsFilePath(OutputDir);
+	return FBackgroundFileWriter::SaveStringArrayToFile(FileWriter, MoveTemp(Lines), SaveFilePath);
+}
+
+bool FSemanticCsvInterface::SelectCsvFile(const FString& Title, const bool bSave, FString& OutFilePath)
+{
+	void* ParentWindowPtr = FSlateApplication::Get().GetActiveTopLevelWindow()->GetNativeWindow()->GetOSWindowHandle();
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (DesktopPlatform == nullptr)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Could not get the desktop platform"), *FString(__FUNCTION__))
+		return false;
+	}
+
+	TArray<FString> OutFilenames;
+	const FString FileTypes(TEXT("CSV (*.csv)|*.csv"));
+	const bool bFileSelected = bSave ?
+		DesktopPlatform->SaveFileDialog(ParentWindowPtr, Title, TEXT(""), TEXT(""), FileTypes, EFileDialogFlags::None, OutFilenames) :
+		DesktopPlatform->OpenFileDialog(ParentWindowPtr, Title, TEXT(""), TEXT(""), FileTypes, EFileDialogFlags::None, OutFilenames);
+	if (!bFileSelected || OutFilenames.Num() == 0)
 	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving the file %s"), *FString(__FUNCTION__), *SaveFilePath)
 		return false;
 	}
 
+	OutFilePath = OutFilenames[0];
 	return true;
 }
 
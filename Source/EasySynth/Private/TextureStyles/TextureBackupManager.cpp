@@ -2,11 +2,18 @@
 
 #include "TextureStyles/TextureBackupManager.h"
 
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Components/MeshComponent.h"
 #include "LandscapeProxy.h"
+#include "PhysicsEngine/BodyInstance.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
 #include "EasySynth.h"
 
 
+const int UTextureBackupManager::MinActorsPerGatherTask = 256;
+
 void UTextureBackupManager::AddAndPaint(
 	AActor* Actor,
 	const bool bDoAdd,
@@ -23,6 +30,89 @@ void UTextureBackupManager::AddAndPaint(
 	AddDefaultActor(Actor, bDoAdd, bDoPaint, Material);
 }
 
+void UTextureBackupManager::AddAndPaintActors(
+	const TArray<AActor*>& Actors,
+	const TArray<UMaterialInstanceConstant*>& Materials)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UTextureBackupManager::AddAndPaintActors);
+	check(Actors.Num() == Materials.Num())
+
+	// Collect actors painted for the first time, except for landscapes that are backed up separately
+	TArray<AActor*> GatheredActors;
+	for (int i = 0; i < Actors.Num(); i++)
+	{
+		if (Materials[i] != nullptr && Cast<ALandscapeProxy>(Actors[i]) == nullptr && !ContainsActor(Actors[i]))
+		{
+			GatheredActors.Add(Actors[i]);
+		}
+	}
+
+	// Gather original materials in parallel, each task into its own records and actor ranges
+	const int TaskCount = FMath::Clamp(
+		GatheredActors.Num() / MinActorsPerGatherTask,
+		1,
+		FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+	const int ActorsPerTask = FMath::DivideAndRoundUp(GatheredActors.Num(), TaskCount);
+	TArray<TArray<FOriginalMaterialRecord>> TaskRecords;
+	TArray<TArray<FOriginalActorRange>> TaskActorRanges;
+	TaskRecords.SetNum(TaskCount);
+	TaskActorRanges.SetNum(TaskCount);
+	ParallelFor(TaskCount, [&GatheredActors, &TaskRecords, &TaskActorRanges, ActorsPerTask](const int32 TaskIndex)
+	{
+		const int First = TaskIndex * ActorsPerTask;
+		const int End = FMath::Min(First + ActorsPerTask, GatheredActors.Num());
+		TaskActorRanges[TaskIndex].Reserve(End - First);
+		for (int i = First; i < End; i++)
+		{
+			FOriginalActorRange& ActorRange = TaskActorRanges[TaskIndex].AddDefaulted_GetRef();
+			ActorRange.First = TaskRecords[TaskIndex].Num();
+			GatherOriginalMaterials(GatheredActors[i], TaskRecords[TaskIndex]);
+			ActorRange.Num = TaskRecords[TaskIndex].Num() - ActorRange.First;
+		}
+	});
+
+	// Move the gathered records at the end of the shared records
+	OriginalActorRanges.Reserve(OriginalActorRanges.Num() + GatheredActors.Num());
+	for (int TaskIndex = 0; TaskIndex < TaskCount; TaskIndex++)
+	{
+		const int RecordsOffset = OriginalMaterialRecords.Num();
+		OriginalMaterialRecords.Append(MoveTemp(TaskRecords[TaskIndex]));
+		for (int i = 0; i < TaskActorRanges[TaskIndex].Num(); i++)
+		{
+			FOriginalActorRange& ActorRange = TaskActorRanges[TaskIndex][i];
+			ActorRange.First += RecordsOffset;
+			OriginalActorRanges.Add(GatheredActors[TaskIndex * ActorsPerTask + i], ActorRange);
+		}
+	}
+
+	// Swap the materials, all actors except landscapes are backed up at this point
+	const bool bDoPaint = true;
+	for (int i = 0; i < Actors.Num(); i++)
+	{
+		const bool bDoAdd = !ContainsActor(Actors[i]);
+		if (bDoAdd && Materials[i] == nullptr)
+		{
+			// Original materials are already displayed
+			continue;
+		}
+		AddAndPaint(Actors[i], bDoAdd, bDoPaint, Materials[i]);
+	}
+}
+
+void UTextureBackupManager::PaintComponent(UPrimitiveComponent* PrimitiveComponent, UMaterialInterface* Material)
+{
+	if (!OriginalActorRanges.Contains(PrimitiveComponent->GetOwner()))
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: Actor of the component '%s' expected but not found in OriginalActorRanges"),
+			*FString(__FUNCTION__), *PrimitiveComponent->GetName())
+		return;
+	}
+
+	TArray<UMaterialInterface*, TInlineAllocator<16>> NewMaterials;
+	NewMaterials.Init(Material, PrimitiveComponent->GetNumMaterials());
+	SetComponentMaterials(PrimitiveComponent, NewMaterials);
+}
+
 bool UTextureBackupManager::ContainsActor(AActor* Actor)
 {
 	ALandscapeProxy* LandscapeProxy = Cast<ALandscapeProxy>(Actor);
@@ -31,7 +121,7 @@ bool UTextureBackupManager::ContainsActor(AActor* Actor)
 		return LandscapeActorDescriptors.Contains(LandscapeProxy);
 	}
 
-	return OriginalActorDescriptors.Contains(Actor);
+	return OriginalActorRanges.Contains(Actor);
 }
 
 void UTextureBackupManager::RemoveActor(AActor* Actor)
@@ -43,7 +133,7 @@ void UTextureBackupManager::RemoveActor(AActor* Actor)
 		return;
 	}
 
-	OriginalActorDescriptors.Remove(Actor);
+	RemoveActorRange(Actor);
 }
 
 void UTextureBackupManager::AddLandscapeActor(
@@ -113,97 +203,183 @@ void UTextureBackupManager::AddDefaultActor(
 {
 	const bool bDoRestore = (Material == nullptr);
 
+	UMaterialInterface* MaterialInterface = nullptr;
+	if (!bDoRestore)
+	{
+		MaterialInterface = Cast<UMaterialInterface>(Material);
+		if (MaterialInterface == nullptr)
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Failed cast to UMaterialInterface"), *FString(__FUNCTION__))
+			return;
+		}
+	}
+
 	if (bDoAdd)
 	{
-		OriginalActorDescriptors.Add(Actor);
+		// Replace the previous backup, if there is one
+		RemoveActorRange(Actor);
+
+		// Append the original materials of all component slots at the end of the records
+		FOriginalActorRange ActorRange;
+		ActorRange.First = OriginalMaterialRecords.Num();
+		GatherOriginalMaterials(Actor, OriginalMaterialRecords);
+		ActorRange.Num = OriginalMaterialRecords.Num() - ActorRange.First;
+		OriginalActorRanges.Add(Actor, ActorRange);
 	}
-	else if (!OriginalActorDescriptors.Contains(Actor))
+
+	const FOriginalActorRange* ActorRange = OriginalActorRanges.Find(Actor);
+	if (ActorRange == nullptr)
 	{
-		UE_LOG(LogEasySynth, Warning, TEXT("%s: Actor expected but not found in OriginalActorDescriptors"),
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: Actor expected but not found in OriginalActorRanges"),
 			*FString(__FUNCTION__))
 		return;
 	}
 
-	// Get actor mesh components
-	TArray<UActorComponent*> ActorComponents;
-	const bool bIncludeFromChildActors = true;
-	Actor->GetComponents(UPrimitiveComponent::StaticClass(), ActorComponents, bIncludeFromChildActors);
+	// Set new materials, one component at a time
+	if (bDoPaint)
+	{
+		TArray<UMaterialInterface*, TInlineAllocator<16>> NewMaterials;
+		const int RangeEnd = ActorRange->First + ActorRange->Num;
+		int ComponentEnd = ActorRange->First;
+		for (int ComponentFirst = ActorRange->First; ComponentFirst < RangeEnd; ComponentFirst = ComponentEnd)
+		{
+			UPrimitiveComponent* PrimitiveComponent = OriginalMaterialRecords[ComponentFirst].Component;
+			while (ComponentEnd < RangeEnd && OriginalMaterialRecords[ComponentEnd].Component == PrimitiveComponent)
+			{
+				ComponentEnd++;
+			}
+
+			if (!IsValid(PrimitiveComponent))
+			{
+				UE_LOG(LogEasySynth, Warning, TEXT("%s: Backed up component of actor '%s' no longer exists"),
+					*FString(__FUNCTION__), *Actor->GetName())
+				continue;
+			}
+
+			// Check whether number of stored materials is correct, if they are needed
+			const int SlotCount = ComponentEnd - ComponentFirst;
+			if (bDoRestore && SlotCount != PrimitiveComponent->GetNumMaterials())
+			{
+				UE_LOG(LogEasySynth, Error, TEXT("%s: %d instead of %d actor's mesh component materials found"),
+					*FString(__FUNCTION__), SlotCount, PrimitiveComponent->GetNumMaterials())
+				return;
+			}
+
+			// Collect the materials to be displayed
+			NewMaterials.Reset();
+			NewMaterials.SetNumZeroed(SlotCount);
+			for (int i = ComponentFirst; i < ComponentEnd; i++)
+			{
+				const FOriginalMaterialRecord& Record = OriginalMaterialRecords[i];
+				NewMaterials[Record.Slot] = bDoRestore ? Record.Material : MaterialInterface;
+			}
+
+			SetComponentMaterials(PrimitiveComponent, NewMaterials);
+		}
+	}
+
+	if (bDoRestore)
+	{
+		RemoveActorRange(Actor);
+	}
+}
 
-	// If no mesh components are found, ignore the actor
-	if (ActorComponents.Num() == 0)
+void UTextureBackupManager::RemoveActorRange(AActor* Actor)
+{
+	FOriginalActorRange ActorRange;
+	if (!OriginalActorRanges.RemoveAndCopyValue(Actor, ActorRange))
 	{
 		return;
 	}
 
-	// Set new materials
-	for (UActorComponent* ActorComponent : ActorComponents)
+	// Records are only released once all actors are restored or most of them are unused,
+	// so restoring actors one by one stays cheap
+	ReleasedRecordCount += ActorRange.Num;
+	if (OriginalActorRanges.Num() == 0)
 	{
-		// Apply to each static mesh component
-		UPrimitiveComponent* PrimitiveComponent = Cast<UPrimitiveComponent>(ActorComponent);
-		if (PrimitiveComponent == nullptr)
-		{
-			UE_LOG(LogEasySynth, Error, TEXT("%s: Got null static mesh component"), *FString(__FUNCTION__))
-			return;
-		}
+		OriginalMaterialRecords.Reset();
+		ReleasedRecordCount = 0;
+	}
+	else if (ReleasedRecordCount > OriginalMaterialRecords.Num() / 2)
+	{
+		CompactMaterialRecords();
+	}
+}
 
-		if (bDoAdd)
-		{
-			OriginalActorDescriptors[Actor].Add(PrimitiveComponent);
-		}
-		else if (!OriginalActorDescriptors[Actor].Contains(PrimitiveComponent))
-		{
-			UE_LOG(LogEasySynth, Warning, TEXT("%s: PrimitiveComponent expected but not found in OriginalActorDescriptors"),
-				*FString(__FUNCTION__))
-			return;
-		}
+void UTextureBackupManager::CompactMaterialRecords()
+{
+	TArray<FOriginalMaterialRecord> CompactedRecords;
+	CompactedRecords.Reserve(OriginalMaterialRecords.Num() - ReleasedRecordCount);
+	for (TPair<AActor*, FOriginalActorRange>& Element : OriginalActorRanges)
+	{
+		FOriginalActorRange& ActorRange = Element.Value;
+		const int First = CompactedRecords.Num();
+		CompactedRecords.Append(OriginalMaterialRecords.GetData() + ActorRange.First, ActorRange.Num);
+		ActorRange.First = First;
+	}
+	OriginalMaterialRecords = MoveTemp(CompactedRecords);
+	ReleasedRecordCount = 0;
+}
 
-		// Check whether number of stored materials is correct, if they are needed
-		if (!bDoAdd && bDoRestore &&
-			OriginalActorDescriptors[Actor][PrimitiveComponent].Num() != PrimitiveComponent->GetNumMaterials())
+void UTextureBackupManager::SetComponentMaterials(
+	UPrimitiveComponent* PrimitiveComponent,
+	TArrayView<UMaterialInterface* const> Materials)
+{
+	UMeshComponent* MeshComponent = Cast<UMeshComponent>(PrimitiveComponent);
+	if (MeshComponent == nullptr)
+	{
+		// Other primitive components only expose the per slot setter
+		for (int i = 0; i < Materials.Num(); i++)
 		{
-			UE_LOG(LogEasySynth, Error, TEXT("%s: %d instead of %d actor's mesh component materials found"),
-				*FString(__FUNCTION__),
-				OriginalActorDescriptors[Actor][PrimitiveComponent].Num(),
-				PrimitiveComponent->GetNumMaterials())
-			return;
+			PrimitiveComponent->SetMaterial(i, Materials[i]);
 		}
+		return;
+	}
 
-		// Store all mesh component materials
-		for (int i = 0; i < PrimitiveComponent->GetNumMaterials(); i++)
+	// Update all override materials at once, as SetMaterial marks the render state dirty
+	// and updates physical materials for every slot
+	bool bAnyMaterialChanged = false;
+	if (MeshComponent->OverrideMaterials.Num() < Materials.Num())
+	{
+		MeshComponent->OverrideMaterials.AddZeroed(Materials.Num() - MeshComponent->OverrideMaterials.Num());
+	}
+	for (int i = 0; i < Materials.Num(); i++)
+	{
+		if (MeshComponent->OverrideMaterials[i] != Materials[i])
 		{
-			if (bDoRestore)
-			{
-				// Revert to original material
-				if (bDoPaint)
-				{
-					PrimitiveComponent->SetMaterial(i, OriginalActorDescriptors[Actor][PrimitiveComponent][i]);
-				}
-			}
-			else
-			{
-				// Change to semantic material
-				if (bDoAdd)
-				{
-					OriginalActorDescriptors[Actor][PrimitiveComponent].Add(PrimitiveComponent->GetMaterial(i));
-				}
-				if (bDoPaint)
-				{
-					UMaterialInterface* MaterialInterface = Cast<UMaterialInterface>(Material);
-					if (MaterialInterface != nullptr)
-					{
-						PrimitiveComponent->SetMaterial(i, MaterialInterface);
-					}
-					else
-					{
-						UE_LOG(LogEasySynth, Error, TEXT("%s: Failed cast to UMaterialInterface"), *FString(__FUNCTION__))
-					}
-				}
-			}
+			MeshComponent->OverrideMaterials[i] = Materials[i];
+			bAnyMaterialChanged = true;
 		}
 	}
+	if (!bAnyMaterialChanged)
+	{
+		return;
+	}
 
-	if (bDoRestore)
+	MeshComponent->MarkCachedMaterialParameterNameIndicesDirty();
+	MeshComponent->MarkRenderStateDirty();
+	FBodyInstance* BodyInstance = MeshComponent->GetBodyInstance();
+	if (BodyInstance != nullptr && BodyInstance->IsValidBodyInstance())
 	{
-		OriginalActorDescriptors.Remove(Actor);
+		BodyInstance->UpdatePhysicalMaterials();
+	}
+}
+
+void UTextureBackupManager::GatherOriginalMaterials(AActor* Actor, TArray<FOriginalMaterialRecord>& OutRecords)
+{
+	// Get actor mesh components
+	TArray<UPrimitiveComponent*, TInlineAllocator<8>> PrimitiveComponents;
+	const bool bIncludeFromChildActors = true;
+	Actor->GetComponents(PrimitiveComponents, bIncludeFromChildActors);
+
+	for (UPrimitiveComponent* PrimitiveComponent : PrimitiveComponents)
+	{
+		for (int i = 0; i < PrimitiveComponent->GetNumMaterials(); i++)
+		{
+			FOriginalMaterialRecord& Record = OutRecords.AddDefaulted_GetRef();
+			Record.Component = PrimitiveComponent;
+			Record.Slot = i;
+			Record.Material = PrimitiveComponent->GetMaterial(i);
+		}
 	}
 }
@@ -1,3 +1,13 @@
 // Copyright (c) 2022 YDrive Inc. All rights reserved.
 
 #include "TextureStyles/TextureMappingAsset.h"
+
+
+int32 UTextureMappingAsset::FindClassId(const FString& ClassName) const
+{
+	// The number of classes is small, so a linear search is fast enough for the UI and CSV lookups
+	return SemanticClassTable.IndexOfByPredicate([&ClassName](const FSemanticClass& SemanticClass)
+	{
+		return SemanticClass.Name == ClassName;
+	});
+}
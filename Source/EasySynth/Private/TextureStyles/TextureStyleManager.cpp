@@ -3,28 +3,50 @@
 #include "TextureStyles/TextureStyleManager.h"
 
 #include "AssetRegistry/AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/PrimitiveComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "EditorAssetLibrary.h"
 #include "Engine/Selection.h"
 #include "Factories/MaterialInstanceConstantFactoryNew.h"
 #include "FileHelpers.h"
 #include "HAL/FileManagerGeneric.h"
+#include "HAL/IConsoleManager.h"
 #include "Kismet/GameplayStatics.h"
+#include "Materials/MaterialExpressionPerInstanceCustomData.h"
+#include "Materials/MaterialExpressionVectorParameter.h"
+#include "Misc/PackageName.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "UObject/SavePackage.h"
 
 #include "EasySynth.h"
 #include "PathUtils.h"
+#include "TextureStyles/SemanticCsvInterface.h"
 #include "TextureStyles/TextureBackupManager.h"
 #include "TextureStyles/TextureMappingAsset.h"
 
 
 const FString UTextureStyleManager::SemanticColorParameter(TEXT("SemanticColor"));
 const FString UTextureStyleManager::UndefinedSemanticClassName(TEXT("Undefined"));
+const uint16 UTextureStyleManager::UndefinedSemanticClassId = 0;
+const uint16 UTextureStyleManager::InheritedSemanticClassId = MAX_uint16;
+const int32 UTextureStyleManager::InstanceClassColorDataSize = 3;
+const uint32 UTextureStyleManager::MaxInstanceId = (1 << 24) - 1;
+const int UTextureStyleManager::MaxStencilSemanticClasses = 255;
+const int32 UTextureStyleManager::CustomDepthWithStencilMode = 3;
+const float UTextureStyleManager::SaveDelaySeconds = 2.0f;
 
 UTextureStyleManager::UTextureStyleManager() :
-	PlainColorMaterial(DuplicateObject<UMaterial>(
-		LoadObject<UMaterial>(nullptr, *FPathUtils::PlainColorMaterialPath()), nullptr)),
+	PlainColorMaterial(LoadObject<UMaterial>(nullptr, *FPathUtils::PlainColorMaterialPath())),
 	CurrentTextureStyle(ETextureStyle::COLOR),
 	TextureBackupManager(NewObject<UTextureBackupManager>()),
+	bStyledActorsIndexValid(false),
+	InstanceIdMaterial(nullptr),
+	InstancedSemanticMaterial(nullptr),
+	OriginalCustomDepthMode(0),
+	bSemanticStencilsApplied(false),
+	bTextureMappingAssetDirty(false),
 	bEventsBound(false)
 {
 	// Check if the plain color material is loaded correctly
@@ -53,6 +75,8 @@ void UTextureStyleManager::BindEvents()
 		GEngine->OnLevelActorAdded().AddUObject(this, &UTextureStyleManager::OnLevelActorAdded);
 		GEngine->OnLevelActorDeleted().AddUObject(this, &UTextureStyleManager::OnLevelActorDeleted);
 		GEngine->OnEditorClose().AddUObject(this, &UTextureStyleManager::OnEditorClose);
+		FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UTextureStyleManager::OnLevelsChanged);
+		FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UTextureStyleManager::OnLevelsChanged);
 		bEventsBound = true;
 	}
 }
@@ -68,10 +92,17 @@ bool UTextureStyleManager::NewSemanticClass(
 		return false;
 	}
 
+	// The last id is reserved for instances that use the class of their actor
+	if (TextureMappingAsset->SemanticClassTable.Num() >= InheritedSemanticClassId)
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: Cannot create more than %d semantic classes"),
+			*FString(__FUNCTION__), InheritedSemanticClassId);
+		return false;
+	}
+
 	// Check collisions with existing classes
-	for (auto& Element : TextureMappingAsset->SemanticClasses)
+	for (const FSemanticClass& SemanticClass : TextureMappingAsset->SemanticClassTable)
 	{
-		const FSemanticClass& SemanticClass = Element.Value;
 		if (SemanticClass.Name == ClassName || SemanticClass.Color == ClassColor)
 		{
 			UE_LOG(LogEasySynth, Warning, TEXT("%s: New semantic class (%s, (%d %d %d)) colliding with existing (%s, (%d %d %d))"),
@@ -82,11 +113,16 @@ bool UTextureStyleManager::NewSemanticClass(
 		}
 	}
 
-	// Crate the new class
-	FSemanticClass& NewSemanticClass = TextureMappingAsset->SemanticClasses.Add(ClassName);
+	// Crate the new class, its id is its index inside the class table
+	FSemanticClass& NewSemanticClass = TextureMappingAsset->SemanticClassTable.AddDefaulted_GetRef();
 	NewSemanticClass.Name = ClassName;
 	NewSemanticClass.Color = ClassColor;
+	NewSemanticClass.PlainColorMaterialInstance = nullptr;
 	// The semantic class material instance will be created when it's needed
+	if (bStyledActorsIndexValid)
+	{
+		ClassActorsIndex.AddDefaulted();
+	}
 
 	if (bSaveTextureMappingAsset)
 	{
@@ -101,9 +137,10 @@ bool UTextureStyleManager::NewSemanticClass(
 
 FColor UTextureStyleManager::ClassColor(const FString& ClassName)
 {
-	if (TextureMappingAsset->SemanticClasses.Contains(ClassName))
+	const int32 ClassId = TextureMappingAsset->FindClassId(ClassName);
+	if (ClassId != INDEX_NONE)
 	{
-		return TextureMappingAsset->SemanticClasses[ClassName].Color;
+		return TextureMappingAsset->SemanticClassTable[ClassId].Color;
 	}
 	return FColor::White;
 }
@@ -115,14 +152,15 @@ bool UTextureStyleManager::UpdateClassName(const FString& OldClassName, const FS
 		return true;
 	}
 
-	if (!TextureMappingAsset->SemanticClasses.Contains(OldClassName))
+	const int32 ClassId = TextureMappingAsset->FindClassId(OldClassName);
+	if (ClassId == INDEX_NONE)
 	{
 		UE_LOG(LogEasySynth, Log, TEXT("%s: Previous semantic class '%s' not found"),
 			*FString(__FUNCTION__), *OldClassName);
 		return false;
 	}
 
-	if (TextureMappingAsset->SemanticClasses.Contains(NewClassName))
+	if (TextureMappingAsset->FindClassId(NewClassName) != INDEX_NONE)
 	{
 		UE_LOG(LogEasySynth, Log, TEXT("%s: New semantic class '%s' already exists"),
 			*FString(__FUNCTION__), *NewClassName);
@@ -135,69 +173,63 @@ bool UTextureStyleManager::UpdateClassName(const FString& OldClassName, const FS
 		return false;
 	}
 
-	const FColor ClassColor = TextureMappingAsset->SemanticClasses[OldClassName].Color;
-
-	// Remove the existing class
-	TextureMappingAsset->SemanticClasses.Remove(OldClassName);
-	// Add new class with the same color
-	NewSemanticClass(NewClassName, ClassColor);
-	// Update actor mappings to the new semantic class name
-	TArray<AActor*> LevelActors;
-	UGameplayStatics::GetAllActorsOfClass(GEditor->GetEditorWorldContext().World(), AActor::StaticClass(), LevelActors);
-	for (AActor* Actor : LevelActors)
-	{
-		if (TextureMappingAsset->ActorClassPairs.Contains(Actor->GetActorGuid()) &&
-			TextureMappingAsset->ActorClassPairs[Actor->GetActorGuid()] == OldClassName)
-		{
-			TextureMappingAsset->ActorClassPairs[Actor->GetActorGuid()] = NewClassName;
-		}
-	}
+	// Actors reference the class by its id, so only the class itself needs to be renamed
+	TextureMappingAsset->SemanticClassTable[ClassId].Name = NewClassName;
 	// No action regarding actor materials necessary
 
 	SaveTextureMappingAsset();
 
+	// Broadcast the semantic classes change
+	SemanticClassesUpdatedEvent.Broadcast();
+
 	return true;
 }
 
 bool UTextureStyleManager::UpdateClassColor(const FString& ClassName, const FColor& NewClassColor)
 {
-	if (!TextureMappingAsset->SemanticClasses.Contains(ClassName))
+	const int32 ClassId = TextureMappingAsset->FindClassId(ClassName);
+	if (ClassId == INDEX_NONE)
 	{
 		UE_LOG(LogEasySynth, Log, TEXT("%s: Requested semantic class '%s' not found"),
 			*FString(__FUNCTION__), *ClassName);
 		return false;
 	}
 
-	if (TextureMappingAsset->SemanticClasses[ClassName].Color == NewClassColor)
+	FSemanticClass& SemanticClass = TextureMappingAsset->SemanticClassTable[ClassId];
+	if (SemanticClass.Color == NewClassColor)
 	{
 		return true;
 	}
 
 	// Check if color is already in use
-	for (auto& Element : TextureMappingAsset->SemanticClasses)
+	for (const FSemanticClass& OtherSemanticClass : TextureMappingAsset->SemanticClassTable)
 	{
-		const FSemanticClass& SemanticClass = Element.Value;
-		if (SemanticClass.Color == NewClassColor)
+		if (OtherSemanticClass.Color == NewClassColor)
 		{
 			UE_LOG(LogEasySynth, Warning, TEXT("%s: Requested color (%d %d %d) already used by %s"),
-				*FString(__FUNCTION__), NewClassColor.R, NewClassColor.G, NewClassColor.B, *SemanticClass.Name);
+				*FString(__FUNCTION__), NewClassColor.R, NewClassColor.G, NewClassColor.B, *OtherSemanticClass.Name);
 			return false;
 		}
 	}
 
 	// Update the class color
-	TextureMappingAsset->SemanticClasses[ClassName].Color = NewClassColor;
+	SemanticClass.Color = NewClassColor;
 	// Invalidate the material instance
-	TextureMappingAsset->SemanticClasses[ClassName].PlainColorMaterialInstance = nullptr;
-	// Update each actor color immediately in case of the semantic view mode
-	TArray<AActor*> LevelActors;
-	UGameplayStatics::GetAllActorsOfClass(GEditor->GetEditorWorldContext().World(), AActor::StaticClass(), LevelActors);
-	for (AActor* Actor : LevelActors)
+	SemanticClass.PlainColorMaterialInstance = nullptr;
+	// Update actors of this class immediately in case of the semantic view mode
+	if (CurrentTextureStyle == ETextureStyle::SEMANTIC)
 	{
-		if (TextureMappingAsset->ActorClassPairs.Contains(Actor->GetActorGuid()) &&
-			TextureMappingAsset->ActorClassPairs[Actor->GetActorGuid()] == ClassName)
+		for (AActor* Actor : ClassActors(static_cast<uint16>(ClassId)))
+		{
+			CheckoutActorTexture(Actor, ETextureStyle::SEMANTIC);
+		}
+		// Instances of the class can belong to actors of any class
+		if (TextureMappingAsset->ActorInstanceClassIds.Num() > 0)
 		{
-			SetSemanticClassToActor(Actor, ClassName);
+			for (AActor* Actor : StyledActors())
+			{
+				PaintInstanceClasses(Actor);
+			}
 		}
 	}
 
@@ -208,33 +240,64 @@ bool UTextureStyleManager::UpdateClassColor(const FString& ClassName, const FCol
 
 bool UTextureStyleManager::RemoveSemanticClass(const FString& ClassName)
 {
-	if (!TextureMappingAsset->SemanticClasses.Contains(ClassName))
+	const int32 ClassId = TextureMappingAsset->FindClassId(ClassName);
+	if (ClassId == INDEX_NONE)
 	{
 		UE_LOG(LogEasySynth, Log, TEXT("%s: Requested semantic class '%s' not found"),
 			*FString(__FUNCTION__), *ClassName);
 		return false;
 	}
 
-	if (ClassName == UndefinedSemanticClassName)
+	if (ClassId == UndefinedSemanticClassId)
 	{
 		// Just ignore removing the necessary undefined semantic class
 		return true;
 	}
 
 	// Reset all actor to the undefined class
-	TArray<AActor*> LevelActors;
-	UGameplayStatics::GetAllActorsOfClass(GEditor->GetEditorWorldContext().World(), AActor::StaticClass(), LevelActors);
-	for (AActor* Actor : LevelActors)
+	for (AActor* Actor : ClassActors(static_cast<uint16>(ClassId)))
+	{
+		SetSemanticClassToActor(Actor, UndefinedSemanticClassId);
+	}
+
+	// Remove the class by moving the last class into its place to keep the table dense,
+	// so only the bindings of the removed and the moved class need updating
+	const uint16 MovedClassId = static_cast<uint16>(TextureMappingAsset->SemanticClassTable.Num() - 1);
+	TextureMappingAsset->SemanticClassTable.RemoveAtSwap(ClassId);
+	if (bStyledActorsIndexValid)
+	{
+		ClassActorsIndex.RemoveAtSwap(ClassId);
+	}
+
+	// Update the remaining mappings, including the ones belonging to actors without primitive components
+	for (auto& Element : TextureMappingAsset->ActorClassIds)
 	{
-		if (TextureMappingAsset->ActorClassPairs.Contains(Actor->GetActorGuid()) &&
-			TextureMappingAsset->ActorClassPairs[Actor->GetActorGuid()] == ClassName)
+		if (Element.Value == ClassId)
+		{
+			Element.Value = UndefinedSemanticClassId;
+		}
+		else if (Element.Value == MovedClassId)
 		{
-			SetSemanticClassToActor(Actor, UndefinedSemanticClassName);
+			Element.Value = static_cast<uint16>(ClassId);
+		}
+	}
+	for (auto& Element : TextureMappingAsset->ActorInstanceClassIds)
+	{
+		for (FComponentInstanceClassIds& Component : Element.Value.Components)
+		{
+			for (uint16& InstanceClassId : Component.ClassIds)
+			{
+				if (InstanceClassId == ClassId)
+				{
+					InstanceClassId = UndefinedSemanticClassId;
+				}
+				else if (InstanceClassId == MovedClassId)
+				{
+					InstanceClassId = static_cast<uint16>(ClassId);
+				}
+			}
 		}
 	}
-
-	// Remove the class
-	TextureMappingAsset->SemanticClasses.Remove(ClassName);
 
 	SaveTextureMappingAsset();
 
@@ -246,23 +309,19 @@ bool UTextureStyleManager::RemoveSemanticClass(const FString& ClassName)
 
 void UTextureStyleManager::RemoveAllSemanticCLasses()
 {
-	for (auto& Element : TextureMappingAsset->SemanticClasses)
+	// Remove classes from the back, so that no class has to be moved to fill the gap
+	while (TextureMappingAsset->SemanticClassTable.Num() > 1)
 	{
-		const FString& ClassName = Element.Key;
-		// Skip the default undefined semantic class
-		if (ClassName != UndefinedSemanticClassName)
-		{
-			RemoveSemanticClass(ClassName);
-		}
+		RemoveSemanticClass(TextureMappingAsset->SemanticClassTable.Last().Name);
 	}
 }
 
 TArray<FString> UTextureStyleManager::SemanticClassNames() const
 {
 	TArray<FString> SemanticClassNames;
-	for (auto& Element : TextureMappingAsset->SemanticClasses)
+	for (const FSemanticClass& SemanticClass : TextureMappingAsset->SemanticClassTable)
 	{
-		SemanticClassNames.Add(Element.Key);
+		SemanticClassNames.Add(SemanticClass.Name);
 	}
 	return SemanticClassNames;
 }
@@ -270,16 +329,17 @@ TArray<FString> UTextureStyleManager::SemanticClassNames() const
 TArray<const FSemanticClass*> UTextureStyleManager::SemanticClasses() const
 {
 	TArray<const FSemanticClass*> SemanticClasses;
-	for (auto& Element : TextureMappingAsset->SemanticClasses)
+	for (const FSemanticClass& SemanticClass : TextureMappingAsset->SemanticClassTable)
 	{
-		SemanticClasses.Add(&Element.Value);
+		SemanticClasses.Add(&SemanticClass);
 	}
 	return SemanticClasses;
 }
 
 void UTextureStyleManager::ApplySemanticClassToSelectedActors(const FString& ClassName)
 {
-	if (!TextureMappingAsset->SemanticClasses.Contains(ClassName))
+	const int32 ClassId = TextureMappingAsset->FindClassId(ClassName);
+	if (ClassId == INDEX_NONE)
 	{
 		UE_LOG(LogEasySynth, Warning, TEXT("%s: Received semantic class '%s' not found"),
 			*FString(__FUNCTION__), *ClassName);
@@ -301,15 +361,201 @@ void UTextureStyleManager::ApplySemanticClassToSelectedActors(const FString& Cla
 			return;
 		}
 
-		// Set the class to the actor
-		SetSemanticClassToActor(SelectedActor, ClassName);
+		// Set the class to selected instances, e.g. trees selected inside the foliage mode
+		bool bInstancesSelected = false;
+		const bool bIncludeFromChildActors = false;
+		SelectedActor->ForEachComponent<UInstancedStaticMeshComponent>(bIncludeFromChildActors,
+			[this, ClassId, &bInstancesSelected](UInstancedStaticMeshComponent* Component)
+			{
+				TArray<int32> SelectedInstances;
+				for (int32 i = 0; i < Component->GetInstanceCount(); i++)
+				{
+					if (Component->IsInstanceSelected(i))
+					{
+						SelectedInstances.Add(i);
+					}
+				}
+				if (SelectedInstances.Num() > 0)
+				{
+					SetSemanticClassToInstances(Component, SelectedInstances, static_cast<uint16>(ClassId));
+					bInstancesSelected = true;
+				}
+			});
+		if (bInstancesSelected)
+		{
+			continue;
+		}
+
+		// Set the class to the whole actor, dropping classes of its instances
+		TextureMappingAsset->ActorInstanceClassIds.Remove(SelectedActor->GetActorGuid());
+		SetSemanticClassToActor(SelectedActor, static_cast<uint16>(ClassId));
 	}
 
 	SaveTextureMappingAsset();
 }
 
+int UTextureStyleManager::ApplyActorClassRules(const TArray<TPair<FString, FString>>& Rules)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UTextureStyleManager::ApplyActorClassRules);
+
+	// Split rules into GUID and pattern rules, skipping the ones with unknown classes
+	TMap<FGuid, uint16> NewClassIds;
+	TArray<TPair<FString, uint16>> PatternClassIds;
+	for (const TPair<FString, FString>& Rule : Rules)
+	{
+		const int32 ClassId = TextureMappingAsset->FindClassId(Rule.Value);
+		if (ClassId == INDEX_NONE)
+		{
+			UE_LOG(LogEasySynth, Warning, TEXT("%s: Skipping the rule '%s' with unknown semantic class '%s'"),
+				*FString(__FUNCTION__), *Rule.Key, *Rule.Value)
+			continue;
+		}
+		FGuid ActorGuid;
+		if (FGuid::Parse(Rule.Key, ActorGuid))
+		{
+			NewClassIds.Add(ActorGuid, static_cast<uint16>(ClassId));
+		}
+		else
+		{
+			PatternClassIds.Emplace(Rule.Key, static_cast<uint16>(ClassId));
+		}
+	}
+
+	// Actor names are gathered on the game thread, so that patterns can be matched without touching actors
+	TArray<AActor*> LevelActors;
+	UGameplayStatics::GetAllActorsOfClass(GEditor->GetEditorWorldContext().World(), AActor::StaticClass(), LevelActors);
+	TArray<FString> ActorLabels;
+	TArray<FString> ActorPaths;
+	TMap<FGuid, AActor*> GuidActors;
+	ActorLabels.Reserve(LevelActors.Num());
+	ActorPaths.Reserve(LevelActors.Num());
+	GuidActors.Reserve(LevelActors.Num());
+	for (AActor* Actor : LevelActors)
+	{
+		ActorLabels.Add(Actor->GetActorLabel());
+		ActorPaths.Add(Actor->GetPathName());
+		GuidActors.Add(Actor->GetActorGuid(), Actor);
+	}
+
+	// Rules can number in thousands and actors in millions, so each actor looks for its last matching pattern in parallel
+	TArray<int32> MatchedClassIds;
+	MatchedClassIds.Init(INDEX_NONE, LevelActors.Num());
+	if (PatternClassIds.Num() > 0)
+	{
+		ParallelFor(LevelActors.Num(), [&PatternClassIds, &ActorLabels, &ActorPaths, &MatchedClassIds](const int32 Index)
+		{
+			for (int i = PatternClassIds.Num() - 1; i >= 0; i--)
+			{
+				const FString& Pattern = PatternClassIds[i].Key;
+				if (ActorLabels[Index].MatchesWildcard(Pattern) || ActorPaths[Index].MatchesWildcard(Pattern))
+				{
+					MatchedClassIds[Index] = PatternClassIds[i].Value;
+					return;
+				}
+			}
+		});
+	}
+	for (int i = 0; i < LevelActors.Num(); i++)
+	{
+		const FGuid ActorGuid = LevelActors[i]->GetActorGuid();
+		if (MatchedClassIds[i] != INDEX_NONE && !NewClassIds.Contains(ActorGuid))
+		{
+			NewClassIds.Add(ActorGuid, static_cast<uint16>(MatchedClassIds[i]));
+		}
+	}
+
+	// Update all bindings first, so the bindings map grows only once
+	TArray<AActor*> PaintedActors;
+	TArray<UMaterialInstanceConstant*> PaintedMaterials;
+	int UpdatedCount = 0;
+	TextureMappingAsset->ActorClassIds.Reserve(TextureMappingAsset->ActorClassIds.Num() + NewClassIds.Num());
+	for (const TPair<FGuid, uint16>& Element : NewClassIds)
+	{
+		// Classes assigned to whole actors replace the classes of their instances
+		const uint16* PreviousClassId = TextureMappingAsset->ActorClassIds.Find(Element.Key);
+		const bool bInstanceClassesRemoved = TextureMappingAsset->ActorInstanceClassIds.Remove(Element.Key) > 0;
+		if (PreviousClassId != nullptr && *PreviousClassId == Element.Value && !bInstanceClassesRemoved)
+		{
+			continue;
+		}
+
+		AActor** Actor = GuidActors.Find(Element.Key);
+		if (Actor != nullptr)
+		{
+			IndexActorClass(*Actor, Element.Value);
+			if (CurrentTextureStyle == ETextureStyle::SEMANTIC && HasPrimitiveComponents(*Actor))
+			{
+				PaintedActors.Add(*Actor);
+				PaintedMaterials.Add(GetSemanticClassMaterial(TextureMappingAsset->SemanticClassTable[Element.Value]));
+			}
+		}
+		TextureMappingAsset->ActorClassIds.Add(Element.Key, Element.Value);
+		UpdatedCount++;
+	}
+
+	// Display the changes in case of the semantic mode being selected, painting all changed actors at once
+	if (PaintedActors.Num() > 0)
+	{
+		TextureBackupManager->AddAndPaintActors(PaintedActors, PaintedMaterials);
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Updated classes of %d actors using %d rules"),
+		*FString(__FUNCTION__), UpdatedCount, Rules.Num())
+
+	if (UpdatedCount > 0)
+	{
+		SaveTextureMappingAsset();
+	}
+
+	return UpdatedCount;
+}
+
+void UTextureStyleManager::SetSemanticClassToInstances(
+	UInstancedStaticMeshComponent* Component,
+	const TArray<int32>& InstanceIndices,
+	const uint16 ClassId)
+{
+	AActor* Actor = Component->GetOwner();
+	if (Actor == nullptr)
+	{
+		UE_LOG(LogEasySynth, Warning, TEXT("%s: Component '%s' has no owner"), *FString(__FUNCTION__), *Component->GetName())
+		return;
+	}
+
+	FActorInstanceClassIds& ActorInstanceClassIds =
+		TextureMappingAsset->ActorInstanceClassIds.FindOrAdd(Actor->GetActorGuid());
+	FComponentInstanceClassIds* ComponentClassIds = ActorInstanceClassIds.FindComponent(Component->GetFName());
+	if (ComponentClassIds == nullptr)
+	{
+		ComponentClassIds = &ActorInstanceClassIds.Components.AddDefaulted_GetRef();
+		ComponentClassIds->ComponentName = Component->GetFName();
+	}
+
+	// Instances added after the previous assignment use the class of their actor
+	while (ComponentClassIds->ClassIds.Num() < Component->GetInstanceCount())
+	{
+		ComponentClassIds->ClassIds.Add(InheritedSemanticClassId);
+	}
+	for (const int32 InstanceIndex : InstanceIndices)
+	{
+		if (ComponentClassIds->ClassIds.IsValidIndex(InstanceIndex))
+		{
+			ComponentClassIds->ClassIds[InstanceIndex] = ClassId;
+		}
+	}
+
+	// Immediately display the change when in the semantic mode
+	if (CurrentTextureStyle == ETextureStyle::SEMANTIC)
+	{
+		CheckoutActorTexture(Actor, ETextureStyle::SEMANTIC);
+	}
+
+	// No need to save the TextureMappingAsset for every component, the caller will do it
+}
+
 void UTextureStyleManager::CheckoutTextureStyle(const ETextureStyle NewTextureStyle)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UTextureStyleManager::CheckoutTextureStyle);
 	UE_LOG(LogEasySynth, Log, TEXT("%s: New texture style: %d"), *FString(__FUNCTION__), NewTextureStyle)
 
 	if (NewTextureStyle == CurrentTextureStyle)
@@ -319,24 +565,154 @@ void UTextureStyleManager::CheckoutTextureStyle(const ETextureStyle NewTextureSt
 		return;
 	}
 
-	// Apply materials to all actors
-	TArray<AActor*> LevelActors;
-	UGameplayStatics::GetAllActorsOfClass(GEditor->GetEditorWorldContext().World(), AActor::StaticClass(), LevelActors);
-	for (AActor* Actor : LevelActors)
+	// Assign ids again, in case actors were added since they were exported
+	if (NewTextureStyle == ETextureStyle::INSTANCE_ID)
 	{
-		CheckoutActorTexture(Actor, NewTextureStyle);
+		UpdateInstanceIds();
 	}
 
-	// Make sure any changes to the TextureMappingAsset are changed
-	SaveTextureMappingAsset();
+	// Apply materials to all actors that have primitive components
+	const int ActorClassIdsNum = TextureMappingAsset->ActorClassIds.Num();
+	TArray<AActor*> Actors;
+	TArray<UMaterialInstanceConstant*> Materials;
+	PlanTextureStyleCheckout(NewTextureStyle, Actors, Materials);
+	TextureBackupManager->AddAndPaintActors(Actors, Materials);
+	if (NewTextureStyle == ETextureStyle::SEMANTIC)
+	{
+		for (AActor* Actor : Actors)
+		{
+			PaintInstanceClasses(Actor);
+		}
+	}
+
+	if (CurrentTextureStyle == ETextureStyle::INSTANCE_ID)
+	{
+		RestorePrimitiveData();
+	}
+	else if (CurrentTextureStyle == ETextureStyle::SEMANTIC)
+	{
+		RestoreInstanceCustomData();
+	}
+
+	// Save the TextureMappingAsset only if actors without a class got the undefined class assigned
+	if (TextureMappingAsset->ActorClassIds.Num() != ActorClassIdsNum)
+	{
+		SaveTextureMappingAsset();
+	}
 
 	CurrentTextureStyle = NewTextureStyle;
 }
 
-bool UTextureStyleManager::ExportSemanticClasses(const FString& OutputDir)
+TArray<UMaterialInterface*> UTextureStyleManager::TextureStyleMaterials(const ETextureStyle TextureStyle)
+{
+	// Original materials are already displayed by the level, only the materials swapped in by the style are collected
+	TArray<UMaterialInterface*> Materials;
+	if (TextureStyle == ETextureStyle::SEMANTIC)
+	{
+		for (FSemanticClass& SemanticClass : TextureMappingAsset->SemanticClassTable)
+		{
+			Materials.Add(GetSemanticClassMaterial(SemanticClass));
+		}
+		Materials.Add(GetInstancedSemanticMaterial());
+	}
+	else if (TextureStyle == ETextureStyle::INSTANCE_ID)
+	{
+		Materials.Add(GetInstanceIdMaterial());
+	}
+	return Materials;
+}
+
+bool UTextureStyleManager::ApplySemanticStencils()
+{
+	if (bSemanticStencilsApplied)
+	{
+		return true;
+	}
+
+	if (TextureMappingAsset->SemanticClassTable.Num() > MaxStencilSemanticClasses)
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: %d semantic classes exceed the maximum of %d stencil values"),
+			*FString(__FUNCTION__), TextureMappingAsset->SemanticClassTable.Num(), MaxStencilSemanticClasses)
+		return false;
+	}
+
+	// Custom stencil values are only rendered if the custom depth pass is enabled with stencil
+	IConsoleVariable* CustomDepthVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("r.CustomDepth"));
+	if (CustomDepthVariable != nullptr)
+	{
+		OriginalCustomDepthMode = CustomDepthVariable->GetInt();
+		CustomDepthVariable->Set(CustomDepthWithStencilMode, ECVF_SetByCode);
+	}
+
+	for (AActor* Actor : StyledActors())
+	{
+		// Stencil values are class ids increased by one, zero is left for pixels without actors, rendered as undefined
+		// Actors without a valid class are rendered as undefined, same as when swapping materials
+		const uint16* ClassId = TextureMappingAsset->ActorClassIds.Find(Actor->GetActorGuid());
+		const int32 ClassStencilValue =
+			(ClassId != nullptr && TextureMappingAsset->SemanticClassTable.IsValidIndex(*ClassId) ?
+				*ClassId : UndefinedSemanticClassId) + 1;
+
+		const bool bIncludeFromChildActors = true;
+		Actor->ForEachComponent<UPrimitiveComponent>(bIncludeFromChildActors,
+			[this, ClassStencilValue](UPrimitiveComponent* Component)
+			{
+				OriginalStencilDescriptors.Add(
+					Component,
+					FOriginalStencilDescriptor{ Component->bRenderCustomDepth, Component->CustomDepthStencilValue });
+				Component->SetRenderCustomDepth(true);
+				Component->SetCustomDepthStencilValue(ClassStencilValue);
+			});
+	}
+
+	bSemanticStencilsApplied = true;
+	return true;
+}
+
+void UTextureStyleManager::RestoreSemanticStencils()
+{
+	if (!bSemanticStencilsApplied)
+	{
+		return;
+	}
+
+	for (auto& Element : OriginalStencilDescriptors)
+	{
+		UPrimitiveComponent* Component = Element.Key.Get();
+		if (Component != nullptr)
+		{
+			Component->SetRenderCustomDepth(Element.Value.bRenderCustomDepth);
+			Component->SetCustomDepthStencilValue(Element.Value.CustomDepthStencilValue);
+		}
+	}
+	OriginalStencilDescriptors.Empty();
+
+	IConsoleVariable* CustomDepthVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("r.CustomDepth"));
+	if (CustomDepthVariable != nullptr)
+	{
+		CustomDepthVariable->Set(OriginalCustomDepthMode, ECVF_SetByCode);
+	}
+
+	bSemanticStencilsApplied = false;
+}
+
+bool UTextureStyleManager::ExportSemanticClasses(const FString& OutputDir, FBackgroundFileWriter* FileWriter)
 {
 	FSemanticCsvInterface SemanticCsvInterface;
-	return SemanticCsvInterface.ExportSemanticClasses(OutputDir, TextureMappingAsset);
+	return SemanticCsvInterface.ExportSemanticClasses(OutputDir, TextureMappingAsset, FileWriter);
+}
+
+bool UTextureStyleManager::ExportInstanceIds(const FString& OutputDir, FBackgroundFileWriter* FileWriter)
+{
+	const TArray<AActor*> InstanceActors = UpdateInstanceIds();
+	FSemanticCsvInterface SemanticCsvInterface;
+	return SemanticCsvInterface.ExportInstanceIds(OutputDir, TextureMappingAsset, InstanceActors, FileWriter);
+}
+
+bool UTextureStyleManager::ExportActorClasses(const FString& FilePath)
+{
+	FSemanticCsvInterface SemanticCsvInterface;
+	return SemanticCsvInterface.ExportActorClasses(FilePath, TextureMappingAsset);
 }
 
 void UTextureStyleManager::LoadOrCreateTextureMappingAsset()
@@ -369,37 +745,253 @@ void UTextureStyleManager::LoadOrCreateTextureMappingAsset()
 
 		// Don't save the asset yet to prevent crashing the editor on startup
 	}
+	else
+	{
+		MigrateTextureMappingAsset();
+	}
+}
+
+void UTextureStyleManager::MigrateTextureMappingAsset()
+{
+	if (TextureMappingAsset->SemanticClasses_DEPRECATED.Num() > 0)
+	{
+		UE_LOG(LogEasySynth, Log, TEXT("%s: Converting %d name keyed semantic classes into the class table"),
+			*FString(__FUNCTION__), TextureMappingAsset->SemanticClasses_DEPRECATED.Num());
+
+		// The undefined class must get the id zero, other classes keep their previous order
+		TextureMappingAsset->SemanticClassTable.Empty(TextureMappingAsset->SemanticClasses_DEPRECATED.Num());
+		const FSemanticClass* UndefinedSemanticClass =
+			TextureMappingAsset->SemanticClasses_DEPRECATED.Find(UndefinedSemanticClassName);
+		if (UndefinedSemanticClass != nullptr)
+		{
+			TextureMappingAsset->SemanticClassTable.Add(*UndefinedSemanticClass);
+		}
+		else
+		{
+			NewSemanticClass(UndefinedSemanticClassName, FColor(255, 255, 255, 255), false);
+		}
+		for (auto& Element : TextureMappingAsset->SemanticClasses_DEPRECATED)
+		{
+			if (Element.Key != UndefinedSemanticClassName)
+			{
+				TextureMappingAsset->SemanticClassTable.Add(Element.Value);
+			}
+		}
+
+		// Bindings to classes that do not exist anymore fall back to the undefined class
+		TextureMappingAsset->ActorClassIds.Empty(TextureMappingAsset->ActorClassPairs_DEPRECATED.Num());
+		for (auto& Element : TextureMappingAsset->ActorClassPairs_DEPRECATED)
+		{
+			const int32 ClassId = TextureMappingAsset->FindClassId(Element.Value);
+			TextureMappingAsset->ActorClassIds.Add(
+				Element.Key,
+				ClassId != INDEX_NONE ? static_cast<uint16>(ClassId) : UndefinedSemanticClassId);
+		}
+
+		TextureMappingAsset->SemanticClasses_DEPRECATED.Empty();
+		TextureMappingAsset->ActorClassPairs_DEPRECATED.Empty();
+
+		// Don't save the asset yet to prevent crashing the editor on startup, it is saved with the next flush
+		TextureMappingAsset->MarkPackageDirty();
+		bTextureMappingAssetDirty = true;
+	}
+	else if (TextureMappingAsset->SemanticClassTable.Num() == 0)
+	{
+		NewSemanticClass(UndefinedSemanticClassName, FColor(255, 255, 255, 255), false);
+	}
 }
 
 void UTextureStyleManager::SaveTextureMappingAsset()
 {
 	check(TextureMappingAsset)
-	const bool bOnlyIfIsDirty = false;
-	UEditorAssetLibrary::SaveLoadedAsset(TextureMappingAsset, bOnlyIfIsDirty);
+	TextureMappingAsset->MarkPackageDirty();
+	bTextureMappingAssetDirty = true;
+
+	// Saving an asset with many actor bindings blocks the editor,
+	// so the save is delayed until no changes are made for a while
+	const bool bLoop = false;
+	GEditor->GetEditorWorldContext().World()->GetTimerManager().SetTimer(
+		SaveTimerHandle,
+		this,
+		&UTextureStyleManager::FlushTextureMappingAssetSave,
+		SaveDelaySeconds,
+		bLoop);
+}
+
+void UTextureStyleManager::FlushTextureMappingAssetSave()
+{
+	check(TextureMappingAsset)
+	GEditor->GetEditorWorldContext().World()->GetTimerManager().ClearTimer(SaveTimerHandle);
+	if (!bTextureMappingAssetDirty)
+	{
+		return;
+	}
+
+	// The package is serialized on the game thread, while the file is written asynchronously
+	UPackage* Package = TextureMappingAsset->GetPackage();
+	const FString PackageFileName = FPackageName::LongPackageNameToFilename(
+		Package->GetName(),
+		FPackageName::GetAssetPackageExtension());
+	FSavePackageArgs SaveArgs;
+	SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+	SaveArgs.SaveFlags = SAVE_Async | SAVE_NoError;
+	if (!UPackage::SavePackage(Package, TextureMappingAsset, *PackageFileName, SaveArgs))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: Failed while saving the texture mapping asset to %s"),
+			*FString(__FUNCTION__), *PackageFileName)
+		return;
+	}
+
+	bTextureMappingAssetDirty = false;
 }
 
 void UTextureStyleManager::OnLevelActorAdded(AActor* Actor)
 {
 	UE_LOG(LogEasySynth, Log, TEXT("%s: Adding actor '%s'"), *FString(__FUNCTION__), *Actor->GetName())
 
-	// Preemptively assign the undefined semantic class to the new actor
-	// In the case of the semantic mode being selected, assigned class will be immediately displayed
-	const bool bForceDisplaySemanticClass = false;
-	const bool bDelayAddingDescriptors = true;
-	SetSemanticClassToActor(Actor, UndefinedSemanticClassName, bForceDisplaySemanticClass, bDelayAddingDescriptors);
+	// Components may not be created yet, so the actor is indexed without checking them
+	if (bStyledActorsIndexValid)
+	{
+		StyledActorsIndex.Add(Actor);
+	}
+
+	// The undefined semantic class is assigned to all actors added within the delay at once,
+	// as procedural tools can spawn many actors at the same time
+	// Actor components may also not be ready to display the class immediately after spawning
+	DelayActorBuffer.Add(Actor);
+	FTimerManager& TimerManager = GEditor->GetEditorWorldContext().World()->GetTimerManager();
+	if (!TimerManager.IsTimerActive(DelayActorTimerHandle))
+	{
+		const float DelaySeconds = 0.2f;
+		const bool bLoop = false;
+		TimerManager.SetTimer(
+			DelayActorTimerHandle,
+			this,
+			&UTextureStyleManager::ProcessDelayActorBuffer,
+			DelaySeconds,
+			bLoop);
+	}
 }
 
 void UTextureStyleManager::OnLevelActorDeleted(AActor* Actor)
 {
 	UE_LOG(LogEasySynth, Log, TEXT("%s: Removing actor '%s'"), *FString(__FUNCTION__), *Actor->GetName())
-	TextureMappingAsset->ActorClassPairs.Remove(Actor->GetActorGuid());
+	StyledActorsIndex.Remove(Actor);
+	const uint16* ClassId = TextureMappingAsset->ActorClassIds.Find(Actor->GetActorGuid());
+	if (bStyledActorsIndexValid && ClassId != nullptr && ClassActorsIndex.IsValidIndex(*ClassId))
+	{
+		ClassActorsIndex[*ClassId].Remove(Actor);
+	}
+	TextureMappingAsset->ActorClassIds.Remove(Actor->GetActorGuid());
+	TextureMappingAsset->ActorInstanceClassIds.Remove(Actor->GetActorGuid());
 	TextureBackupManager->RemoveActor(Actor);
 }
 
+void UTextureStyleManager::UpdateStyledActorsIndex()
+{
+	UWorld* World = GEditor->GetEditorWorldContext().World();
+	if (bStyledActorsIndexValid && StyledActorsIndexWorld.Get() == World)
+	{
+		return;
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Rebuilding the styled actors index"), *FString(__FUNCTION__))
+
+	StyledActorsIndex.Empty();
+	ClassActorsIndex.Empty(TextureMappingAsset->SemanticClassTable.Num());
+	ClassActorsIndex.SetNum(TextureMappingAsset->SemanticClassTable.Num());
+	TArray<AActor*> LevelActors;
+	UGameplayStatics::GetAllActorsOfClass(World, AActor::StaticClass(), LevelActors);
+	for (AActor* Actor : LevelActors)
+	{
+		if (HasPrimitiveComponents(Actor))
+		{
+			StyledActorsIndex.Add(Actor);
+			const uint16* ClassId = TextureMappingAsset->ActorClassIds.Find(Actor->GetActorGuid());
+			if (ClassId != nullptr && ClassActorsIndex.IsValidIndex(*ClassId))
+			{
+				ClassActorsIndex[*ClassId].Add(Actor);
+			}
+		}
+	}
+	StyledActorsIndexWorld = World;
+	bStyledActorsIndexValid = true;
+}
+
+TArray<AActor*> UTextureStyleManager::StyledActors()
+{
+	UpdateStyledActorsIndex();
+
+	TArray<AActor*> Actors;
+	Actors.Reserve(StyledActorsIndex.Num());
+	for (const TWeakObjectPtr<AActor>& Actor : StyledActorsIndex)
+	{
+		if (Actor.IsValid())
+		{
+			Actors.Add(Actor.Get());
+		}
+	}
+	return Actors;
+}
+
+TArray<AActor*> UTextureStyleManager::ClassActors(const uint16 ClassId)
+{
+	UpdateStyledActorsIndex();
+
+	TArray<AActor*> Actors;
+	if (!ClassActorsIndex.IsValidIndex(ClassId))
+	{
+		return Actors;
+	}
+	Actors.Reserve(ClassActorsIndex[ClassId].Num());
+	for (const TWeakObjectPtr<AActor>& Actor : ClassActorsIndex[ClassId])
+	{
+		if (Actor.IsValid())
+		{
+			Actors.Add(Actor.Get());
+		}
+	}
+	return Actors;
+}
+
+void UTextureStyleManager::IndexActorClass(AActor* Actor, const uint16 ClassId)
+{
+	// Only actors inside the styled actors index are grouped by their classes
+	if (!bStyledActorsIndexValid || !StyledActorsIndex.Contains(Actor))
+	{
+		return;
+	}
+
+	const uint16* PreviousClassId = TextureMappingAsset->ActorClassIds.Find(Actor->GetActorGuid());
+	if (PreviousClassId != nullptr && ClassActorsIndex.IsValidIndex(*PreviousClassId))
+	{
+		ClassActorsIndex[*PreviousClassId].Remove(Actor);
+	}
+	if (ClassActorsIndex.IsValidIndex(ClassId))
+	{
+		ClassActorsIndex[ClassId].Add(Actor);
+	}
+}
+
+bool UTextureStyleManager::HasPrimitiveComponents(AActor* Actor)
+{
+	bool bHasPrimitiveComponents = false;
+	const bool bIncludeFromChildActors = true;
+	Actor->ForEachComponent<UPrimitiveComponent>(bIncludeFromChildActors, [&bHasPrimitiveComponents](UPrimitiveComponent*)
+	{
+		bHasPrimitiveComponents = true;
+	});
+	return bHasPrimitiveComponents;
+}
+
 void UTextureStyleManager::OnEditorClose()
 {
 	UE_LOG(LogEasySynth, Log, TEXT("%s: Making sure original mesh colors are selected"), *FString(__FUNCTION__))
 	CheckoutTextureStyle(ETextureStyle::COLOR);
+	RestoreSemanticStencils();
+	// Write pending changes and wait for them, as the editor is about to exit
+	FlushTextureMappingAssetSave();
+	UPackage::WaitForAsyncFileWrites();
 	// Make level dirty and save it
 	ULevel* Level = GWorld->GetCurrentLevel();
 	Level->MarkPackageDirty();
@@ -408,37 +1000,14 @@ void UTextureStyleManager::OnEditorClose()
 
 void UTextureStyleManager::SetSemanticClassToActor(
 	AActor* Actor,
-	const FString& ClassName,
-	const bool bForceDisplaySemanticClass,
-	const bool bDelayAddingDescriptors)
+	const uint16 ClassId,
+	const bool bForceDisplaySemanticClass)
 {
-	// Remove class if already assigned
-	TextureMappingAsset->ActorClassPairs.Remove(Actor->GetActorGuid());
-
-	// Set the new class
-	TextureMappingAsset->ActorClassPairs.Add(Actor->GetActorGuid(), ClassName);
+	// Set the new class, replacing the previous one if already assigned
+	IndexActorClass(Actor, ClassId);
+	TextureMappingAsset->ActorClassIds.Add(Actor->GetActorGuid(), ClassId);
 
 	// Immediately display the change when in the semantic mode
-	if (CurrentTextureStyle == ETextureStyle::SEMANTIC)
-	{
-		if (bDelayAddingDescriptors)
-		{
-			// Adding with a delay is requested, add the actor to the delay buffer, start the timer,
-			// stop the current execution and the callback will handle the rest
-			DelayActorBuffer.Add(Actor);
-			const float DelaySeconds = 0.2f;
-			const bool bLoop = false;
-			GEditor->GetEditorWorldContext().World()->GetTimerManager().SetTimer(
-				DelayActorTimerHandle,
-				this,
-				&UTextureStyleManager::ProcessDelayActorBuffer,
-				DelaySeconds,
-				bLoop);
-			return;
-		}
-	}
-
-	// No delay is requested, checkout the semantic color
 	if (bForceDisplaySemanticClass || CurrentTextureStyle == ETextureStyle::SEMANTIC)
 	{
 		CheckoutActorTexture(Actor, ETextureStyle::SEMANTIC);
@@ -447,30 +1016,91 @@ void UTextureStyleManager::SetSemanticClassToActor(
 	// No need to save the TextureMappingAsset for every actor, the caller will do it
 }
 
+void UTextureStyleManager::PlanTextureStyleCheckout(
+	const ETextureStyle NewTextureStyle,
+	TArray<AActor*>& OutActors,
+	TArray<UMaterialInstanceConstant*>& OutMaterials)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UTextureStyleManager::PlanTextureStyleCheckout);
+
+	// Look up actor classes in parallel, as the lookups do not modify any of the shared state
+	const TArray<AActor*> Actors = StyledActors();
+	TArray<int32> ActorClassIds;
+	ActorClassIds.SetNumUninitialized(Actors.Num());
+	ParallelFor(Actors.Num(), [this, &Actors, &ActorClassIds](const int32 Index)
+	{
+		const uint16* ClassId = TextureMappingAsset->ActorClassIds.Find(Actors[Index]->GetActorGuid());
+		ActorClassIds[Index] = ClassId != nullptr ? *ClassId : INDEX_NONE;
+	});
+
+	// Resolve materials with the same rules as CheckoutActorTexture
+	OutActors.Reset(Actors.Num());
+	OutMaterials.Reset(Actors.Num());
+	for (int i = 0; i < Actors.Num(); i++)
+	{
+		AActor* Actor = Actors[i];
+		int32 ClassId = ActorClassIds[i];
+		if (ClassId == INDEX_NONE && NewTextureStyle != ETextureStyle::INSTANCE_ID)
+		{
+			if (NewTextureStyle != ETextureStyle::SEMANTIC)
+			{
+				// Actors without a class are only painted by the instance id style, leaving it restores their materials
+				if (TextureBackupManager->ContainsActor(Actor))
+				{
+					OutActors.Add(Actor);
+					OutMaterials.Add(nullptr);
+				}
+				continue;
+			}
+			// If semantic view is being selected, assign the default class to the actor
+			IndexActorClass(Actor, UndefinedSemanticClassId);
+			TextureMappingAsset->ActorClassIds.Add(Actor->GetActorGuid(), UndefinedSemanticClassId);
+			ClassId = UndefinedSemanticClassId;
+		}
+
+		UMaterialInstanceConstant* Material = nullptr;
+		if (NewTextureStyle == ETextureStyle::SEMANTIC)
+		{
+			// Make sure the semantic class id assigned to the actor is valid
+			if (!TextureMappingAsset->SemanticClassTable.IsValidIndex(ClassId))
+			{
+				UE_LOG(LogEasySynth, Error, TEXT("%s: Uknown class id %d"), *FString(__FUNCTION__), ClassId)
+				continue;
+			}
+
+			Material = GetSemanticClassMaterial(TextureMappingAsset->SemanticClassTable[ClassId]);
+		}
+		else if (NewTextureStyle == ETextureStyle::INSTANCE_ID)
+		{
+			Material = GetInstanceIdMaterial();
+			WriteInstanceIdPrimitiveData(Actor);
+		}
+		OutActors.Add(Actor);
+		OutMaterials.Add(Material);
+	}
+}
+
 void UTextureStyleManager::CheckoutActorTexture(AActor* Actor, const ETextureStyle NewTextureStyle)
 {
-	// Check if the actor has a semantic class assigned
+	// Check if the actor has a semantic class assigned, instance ids are displayed regardless of the class
 	const FGuid& ActorGuid = Actor->GetActorGuid();
-	if (!TextureMappingAsset->ActorClassPairs.Contains(ActorGuid))
+	const uint16* ClassId = TextureMappingAsset->ActorClassIds.Find(ActorGuid);
+	if (ClassId == nullptr && NewTextureStyle != ETextureStyle::INSTANCE_ID)
 	{
 		if (NewTextureStyle == ETextureStyle::SEMANTIC)
 		{
 			// If semantic view is being selected, assign the default class to the actor
 			// This method will be recalled by the following method
 			const bool bForceDisplaySemanticClass = true;
-			SetSemanticClassToActor(Actor, UndefinedSemanticClassName, bForceDisplaySemanticClass);
+			SetSemanticClassToActor(Actor, UndefinedSemanticClassId, bForceDisplaySemanticClass);
+			return;
 		}
-		return;
-	}
 
-	// Get the name of the semantic class assigned to the actor
-	const FString& ClassName = TextureMappingAsset->ActorClassPairs[ActorGuid];
-
-	// Make sure the semantic class name is valid
-	if (!TextureMappingAsset->SemanticClasses.Contains(ClassName))
-	{
-		UE_LOG(LogEasySynth, Error, TEXT("%s: Uknown class name '%s'"), *FString(__FUNCTION__), *ClassName)
-		return;
+		// Actors without a class are only painted by the instance id style, leaving it restores their materials
+		if (!TextureBackupManager->ContainsActor(Actor))
+		{
+			return;
+		}
 	}
 
 	// Check whether the actor currently has its original materials active
@@ -489,60 +1119,322 @@ void UTextureStyleManager::CheckoutActorTexture(AActor* Actor, const ETextureSty
 	UMaterialInstanceConstant* Material = nullptr;
 	if (NewTextureStyle == ETextureStyle::SEMANTIC)
 	{
-		Material = GetSemanticClassMaterial(TextureMappingAsset->SemanticClasses[ClassName]);
+		// Make sure the semantic class id assigned to the actor is valid
+		if (!TextureMappingAsset->SemanticClassTable.IsValidIndex(*ClassId))
+		{
+			UE_LOG(LogEasySynth, Error, TEXT("%s: Uknown class id %d"), *FString(__FUNCTION__), *ClassId)
+			return;
+		}
+
+		Material = GetSemanticClassMaterial(TextureMappingAsset->SemanticClassTable[*ClassId]);
+	}
+	else if (NewTextureStyle == ETextureStyle::INSTANCE_ID)
+	{
+		Material = GetInstanceIdMaterial();
+		WriteInstanceIdPrimitiveData(Actor);
 	}
 	TextureBackupManager->AddAndPaint(Actor, bDoAdd, bDoPaint, Material);
+	if (NewTextureStyle == ETextureStyle::SEMANTIC)
+	{
+		PaintInstanceClasses(Actor);
+	}
 }
 
 void UTextureStyleManager::ProcessDelayActorBuffer()
 {
-	bool bAnyActorProcessed = false;
+	TArray<AActor*> AddedActors;
+	AddedActors.Reserve(DelayActorBuffer.Num());
 	for (AActor* Actor : DelayActorBuffer)
 	{
 		if (IsValid(Actor))
 		{
-			// Must not call with bDelayAddingDescriptors = true, to avoid infinite recursion
-			SetSemanticClassToActor(Actor, UndefinedSemanticClassName);
-			bAnyActorProcessed = true;
+			AddedActors.Add(Actor);
 		}
 	}
 	DelayActorBuffer.Empty();
-	if (bAnyActorProcessed)
+	if (AddedActors.Num() == 0)
 	{
-		SaveTextureMappingAsset();
+		return;
 	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Assigning the undefined class to %d added actors"),
+		*FString(__FUNCTION__), AddedActors.Num())
+
+	// Assign the class to all actors first, so the bindings map grows only once
+	TextureMappingAsset->ActorClassIds.Reserve(TextureMappingAsset->ActorClassIds.Num() + AddedActors.Num());
+	for (AActor* Actor : AddedActors)
+	{
+		IndexActorClass(Actor, UndefinedSemanticClassId);
+		TextureMappingAsset->ActorClassIds.Add(Actor->GetActorGuid(), UndefinedSemanticClassId);
+	}
+
+	// Display the assigned class in case of the semantic mode being selected
+	if (CurrentTextureStyle == ETextureStyle::SEMANTIC)
+	{
+		for (AActor* Actor : AddedActors)
+		{
+			CheckoutActorTexture(Actor, ETextureStyle::SEMANTIC);
+		}
+	}
+
+	SaveTextureMappingAsset();
 }
 
 UMaterialInstanceConstant* UTextureStyleManager::GetSemanticClassMaterial(FSemanticClass& SemanticClass)
 {
-	// If the plain color material is null, create it
+	// Instances are saved next to the texture mapping asset, which references them,
+	// so they are normally already loaded together with the asset
+	if (SemanticClass.PlainColorMaterialInstance != nullptr)
+	{
+		return SemanticClass.PlainColorMaterialInstance;
+	}
+
+	// Instances are keyed by the class color, so an instance created for a previous class can be reused
+	const FString PackageFileName = FPathUtils::SemanticMaterialAssetName(SemanticClass.Color);
+	const FString PackagePath = FPathUtils::SemanticMaterialsDir() / PackageFileName;
+	SemanticClass.PlainColorMaterialInstance = LoadObject<UMaterialInstanceConstant>(
+		nullptr,
+		*FString::Printf(TEXT("%s.%s"), *PackagePath, *PackageFileName),
+		nullptr,
+		LOAD_NoWarn | LOAD_Quiet);
+	if (SemanticClass.PlainColorMaterialInstance != nullptr)
+	{
+		return SemanticClass.PlainColorMaterialInstance;
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Creating the semantic material instance '%s'"),
+		*FString(__FUNCTION__), *PackagePath)
+
+	UMaterialInstanceConstantFactoryNew* Factory = NewObject<UMaterialInstanceConstantFactoryNew>();
+	Factory->InitialParent = PlainColorMaterial;
+
+	UPackage* Package = CreatePackage(*PackagePath);
+	SemanticClass.PlainColorMaterialInstance = Cast<UMaterialInstanceConstant>(Factory->FactoryCreateNew(
+		UMaterialInstanceConstant::StaticClass(),
+		Package,
+		*PackageFileName,
+		RF_Public | RF_Standalone,
+		NULL,
+		GWarn));
+
 	if (SemanticClass.PlainColorMaterialInstance == nullptr)
 	{
-		UMaterialInstanceConstantFactoryNew* Factory = NewObject<UMaterialInstanceConstantFactoryNew>();
-		Factory->InitialParent = PlainColorMaterial;
+		UE_LOG(LogTemp, Error, TEXT("%s: Could not create the plain color material instance"),
+			*FString(__FUNCTION__))
+		check(SemanticClass.PlainColorMaterialInstance)
+	}
+	SemanticClass.PlainColorMaterialInstance->SetVectorParameterValueEditorOnly(
+		*SemanticColorParameter,
+		SemanticClass.Color);
+	FAssetRegistryModule::AssetCreated(SemanticClass.PlainColorMaterialInstance);
+
+	// Persist the instance, so that following editor sessions do not need to create it again
+	const bool bOnlyIfIsDirty = false;
+	UEditorAssetLibrary::SaveLoadedAsset(SemanticClass.PlainColorMaterialInstance, bOnlyIfIsDirty);
 
-		const FString PackageFileName = FString::Printf(TEXT("M_%s"), *(SemanticClass.Name));
-		const FString PackagePath =
-			FPathUtils::ProjectPluginContentDir() / FString(TEXT("ConstMaterials")) / PackageFileName;
-		UPackage* Package = CreatePackage(*PackagePath);
-		SemanticClass.PlainColorMaterialInstance = Cast<UMaterialInstanceConstant>(Factory->FactoryCreateNew(
-			UMaterialInstanceConstant::StaticClass(),
-			Package,
-			*PackageFileName,
-			RF_Public | RF_Transient,
-			NULL,
-			GWarn));
+	return SemanticClass.PlainColorMaterialInstance;
+}
+
+FLinearColor UTextureStyleManager::EncodeInstanceId(const uint32 Id)
+{
+	// Each byte is stored as an exact 8-bit value, which the unlit material outputs unchanged
+	return FLinearColor(
+		(Id & 0xFF) / 255.0f,
+		((Id >> 8) & 0xFF) / 255.0f,
+		((Id >> 16) & 0xFF) / 255.0f,
+		1.0f);
+}
 
-		if (SemanticClass.PlainColorMaterialInstance == nullptr)
+TArray<AActor*> UTextureStyleManager::UpdateInstanceIds()
+{
+	TArray<AActor*> InstanceActors = StyledActors();
+	InstanceActors.Sort([](const AActor& A, const AActor& B) { return A.GetActorGuid() < B.GetActorGuid(); });
+	if (InstanceActors.Num() > static_cast<int64>(MaxInstanceId))
+	{
+		UE_LOG(LogEasySynth, Error, TEXT("%s: %d actors exceed the maximum of %u instance ids, remaining actors get the id 0"),
+			*FString(__FUNCTION__), InstanceActors.Num(), MaxInstanceId)
+		InstanceActors.SetNum(MaxInstanceId);
+	}
+
+	InstanceIds.Empty(InstanceActors.Num());
+	for (int i = 0; i < InstanceActors.Num(); i++)
+	{
+		InstanceIds.Add(InstanceActors[i]->GetActorGuid(), i + 1);
+	}
+
+	return InstanceActors;
+}
+
+void UTextureStyleManager::WriteInstanceIdPrimitiveData(AActor* Actor)
+{
+	const uint32* InstanceId = InstanceIds.Find(Actor->GetActorGuid());
+	const FVector4 EncodedId(EncodeInstanceId(InstanceId != nullptr ? *InstanceId : 0));
+
+	const bool bIncludeFromChildActors = true;
+	Actor->ForEachComponent<UPrimitiveComponent>(bIncludeFromChildActors,
+		[this, &EncodedId](UPrimitiveComponent* Component)
+		{
+			if (!OriginalPrimitiveData.Contains(Component))
+			{
+				OriginalPrimitiveData.Add(Component, Component->GetCustomPrimitiveData().Data);
+			}
+			Component->SetCustomPrimitiveDataVector4(0, EncodedId);
+		});
+}
+
+void UTextureStyleManager::RestorePrimitiveData()
+{
+	// Components that had less data keep zeros in place of the extended values
+	const int EncodedIdSize = 4;
+	for (auto& Element : OriginalPrimitiveData)
+	{
+		UPrimitiveComponent* Component = Element.Key.Get();
+		if (Component == nullptr)
 		{
-			UE_LOG(LogTemp, Error, TEXT("%s: Could not create the plain color material instance"),
-				*FString(__FUNCTION__))
-			check(SemanticClass.PlainColorMaterialInstance)
+			continue;
 		}
-		SemanticClass.PlainColorMaterialInstance->SetVectorParameterValueEditorOnly(
-			*SemanticColorParameter,
-			SemanticClass.Color);
+		const TArray<float>& OriginalData = Element.Value;
+		for (int i = 0; i < EncodedIdSize; i++)
+		{
+			Component->SetCustomPrimitiveDataFloat(i, i < OriginalData.Num() ? OriginalData[i] : 0.0f);
+		}
+	}
+	OriginalPrimitiveData.Empty();
+}
+
+UMaterialInstanceConstant* UTextureStyleManager::GetInstanceIdMaterial()
+{
+	if (InstanceIdMaterial == nullptr)
+	{
+		// A single material is shared by all meshes, ids are provided through the custom primitive data
+		UMaterial* ParentMaterial = NewObject<UMaterial>(this, NAME_None, RF_Transient);
+		ParentMaterial->SetShadingModel(EMaterialShadingModel::MSM_Unlit);
+
+		UMaterialExpressionVectorParameter* IdExpression = NewObject<UMaterialExpressionVectorParameter>(ParentMaterial);
+		IdExpression->ParameterName = TEXT("InstanceId");
+		IdExpression->bUseCustomPrimitiveData = true;
+		IdExpression->PrimitiveDataIndex = 0;
+		ParentMaterial->GetExpressionCollection().AddExpression(IdExpression);
+		ParentMaterial->GetEditorOnlyData()->EmissiveColor.Connect(0, IdExpression);
+		ParentMaterial->PreEditChange(nullptr);
+		ParentMaterial->PostEditChange();
+
+		InstanceIdMaterial = NewObject<UMaterialInstanceConstant>(this, NAME_None, RF_Transient);
+		check(InstanceIdMaterial)
+		InstanceIdMaterial->SetParentEditorOnly(ParentMaterial);
+		InstanceIdMaterial->PostEditChange();
 	}
 
-	return SemanticClass.PlainColorMaterialInstance;
+	return InstanceIdMaterial;
+}
+
+void UTextureStyleManager::PaintInstanceClasses(AActor* Actor)
+{
+	FActorInstanceClassIds* ActorInstanceClassIds = TextureMappingAsset->ActorInstanceClassIds.Find(Actor->GetActorGuid());
+	if (ActorInstanceClassIds == nullptr)
+	{
+		return;
+	}
+
+	const uint16* ActorClassId = TextureMappingAsset->ActorClassIds.Find(Actor->GetActorGuid());
+	const uint16 DefaultClassId = ActorClassId != nullptr ? *ActorClassId : UndefinedSemanticClassId;
+	UMaterialInstanceConstant* Material = GetInstancedSemanticMaterial();
+
+	// Component names are only unique inside their actor
+	const bool bIncludeFromChildActors = false;
+	Actor->ForEachComponent<UInstancedStaticMeshComponent>(bIncludeFromChildActors,
+		[this, ActorInstanceClassIds, DefaultClassId, Material](UInstancedStaticMeshComponent* Component)
+		{
+			const FComponentInstanceClassIds* ComponentClassIds = ActorInstanceClassIds->FindComponent(Component->GetFName());
+			if (ComponentClassIds == nullptr)
+			{
+				return;
+			}
+
+			if (!OriginalInstanceCustomData.Contains(Component))
+			{
+				OriginalInstanceCustomData.Add(
+					Component,
+					FOriginalInstanceCustomData{ Component->NumCustomDataFloats, Component->PerInstanceSMCustomData });
+			}
+			if (Component->NumCustomDataFloats < InstanceClassColorDataSize)
+			{
+				Component->SetNumCustomDataFloats(InstanceClassColorDataSize);
+			}
+
+			// Colors are converted the same way as the semantic material parameter values
+			const bool bMarkRenderStateDirty = false;
+			for (int32 i = 0; i < Component->GetInstanceCount(); i++)
+			{
+				uint16 ClassId = ComponentClassIds->ClassIds.IsValidIndex(i) ? ComponentClassIds->ClassIds[i] : DefaultClassId;
+				ClassId = ClassId == InheritedSemanticClassId ? DefaultClassId : ClassId;
+				if (!TextureMappingAsset->SemanticClassTable.IsValidIndex(ClassId))
+				{
+					ClassId = UndefinedSemanticClassId;
+				}
+				const FLinearColor ClassColor(TextureMappingAsset->SemanticClassTable[ClassId].Color);
+				const float ColorData[] = { ClassColor.R, ClassColor.G, ClassColor.B };
+				Component->SetCustomData(i, ColorData, bMarkRenderStateDirty);
+			}
+			Component->MarkRenderStateDirty();
+
+			TextureBackupManager->PaintComponent(Component, Material);
+		});
+}
+
+void UTextureStyleManager::RestoreInstanceCustomData()
+{
+	const bool bMarkRenderStateDirty = false;
+	for (auto& Element : OriginalInstanceCustomData)
+	{
+		UInstancedStaticMeshComponent* Component = Element.Key.Get();
+		if (Component == nullptr)
+		{
+			continue;
+		}
+
+		// Components whose instances were added or removed keep zeros in place of the original values
+		const FOriginalInstanceCustomData& OriginalData = Element.Value;
+		Component->SetNumCustomDataFloats(OriginalData.NumCustomDataFloats);
+		if (OriginalData.NumCustomDataFloats > 0 &&
+			OriginalData.PerInstanceCustomData.Num() == Component->PerInstanceSMCustomData.Num())
+		{
+			for (int32 i = 0; i < Component->GetInstanceCount(); i++)
+			{
+				Component->SetCustomData(
+					i,
+					MakeArrayView(
+						OriginalData.PerInstanceCustomData.GetData() + i * OriginalData.NumCustomDataFloats,
+						OriginalData.NumCustomDataFloats),
+					bMarkRenderStateDirty);
+			}
+		}
+		Component->MarkRenderStateDirty();
+	}
+	OriginalInstanceCustomData.Empty();
+}
+
+UMaterialInstanceConstant* UTextureStyleManager::GetInstancedSemanticMaterial()
+{
+	if (InstancedSemanticMaterial == nullptr)
+	{
+		// Same as the plain color material, the class color is displayed as the base color
+		UMaterial* ParentMaterial = NewObject<UMaterial>(this, NAME_None, RF_Transient);
+		ParentMaterial->bUsedWithInstancedStaticMeshes = true;
+
+		UMaterialExpressionPerInstanceCustomData3Vector* ColorExpression =
+			NewObject<UMaterialExpressionPerInstanceCustomData3Vector>(ParentMaterial);
+		ColorExpression->DataIndex = 0;
+		ParentMaterial->GetExpressionCollection().AddExpression(ColorExpression);
+		ParentMaterial->GetEditorOnlyData()->BaseColor.Connect(0, ColorExpression);
+		ParentMaterial->PreEditChange(nullptr);
+		ParentMaterial->PostEditChange();
+
+		InstancedSemanticMaterial = NewObject<UMaterialInstanceConstant>(this, NAME_None, RF_Transient);
+		check(InstancedSemanticMaterial)
+		InstancedSemanticMaterial->SetParentEditorOnly(ParentMaterial);
+		InstancedSemanticMaterial->PostEditChange();
+	}
+
+	return InstancedSemanticMaterial;
 }
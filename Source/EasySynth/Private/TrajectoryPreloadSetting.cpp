@@ -0,0 +1,117 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#include "TrajectoryPreloadSetting.h"
+
+#include "Algo/BinarySearch.h"
+#include "ContentStreaming.h"
+#include "Engine/World.h"
+#include "MoviePipeline.h"
+#include "MoviePipelineBlueprintLibrary.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "WorldPartition/WorldPartitionSubsystem.h"
+
+#include "EasySynth.h"
+
+
+void UMoviePipelineTrajectoryPreloadSetting::SetupForPipelineImpl(UMoviePipeline* InPipeline)
+{
+	check(InPipeline);
+	Pipeline = InPipeline;
+	PipelineWorld = InPipeline->GetWorld();
+	UpcomingPoses.Empty();
+
+	WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(
+		this, &UMoviePipelineTrajectoryPreloadSetting::OnWorldTickStart);
+
+	// Levels without world partition only get their textures preloaded
+	UWorldPartitionSubsystem* WorldPartitionSubsystem = UWorld::GetSubsystem<UWorldPartitionSubsystem>(PipelineWorld.Get());
+	if (WorldPartitionSubsystem != nullptr)
+	{
+		WorldPartitionSubsystem->RegisterStreamingSourceProvider(this);
+	}
+
+	UE_LOG(LogEasySynth, Log, TEXT("%s: Preloading %d upcoming frames of %d cameras"),
+		*FString(__FUNCTION__), PreloadFrameCount, Cameras.Num())
+}
+
+void UMoviePipelineTrajectoryPreloadSetting::TeardownForPipelineImpl(UMoviePipeline* InPipeline)
+{
+	FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+	WorldTickStartHandle.Reset();
+
+	UWorldPartitionSubsystem* WorldPartitionSubsystem = UWorld::GetSubsystem<UWorldPartitionSubsystem>(PipelineWorld.Get());
+	if (WorldPartitionSubsystem != nullptr)
+	{
+		WorldPartitionSubsystem->UnregisterStreamingSourceProvider(this);
+	}
+
+	Pipeline.Reset();
+	PipelineWorld.Reset();
+	UpcomingPoses.Empty();
+}
+
+bool UMoviePipelineTrajectoryPreloadSetting::GetStreamingSources(
+	TArray<FWorldPartitionStreamingSource>& OutStreamingSources) const
+{
+	// Upcoming cells only need to be loaded, the current view makes the cells it sees visible
+	for (int i = 0; i < UpcomingPoses.Num(); i++)
+	{
+		FWorldPartitionStreamingSource& StreamingSource = OutStreamingSources.AddDefaulted_GetRef();
+		StreamingSource.Name = FName(TEXT("EasySynthTrajectoryPreload"), i);
+		StreamingSource.Location = UpcomingPoses[i].GetLocation();
+		StreamingSource.Rotation = UpcomingPoses[i].Rotator();
+		StreamingSource.TargetState = EStreamingSourceTargetState::Loaded;
+		StreamingSource.Priority = EStreamingSourcePriority::Low;
+	}
+	return UpcomingPoses.Num() > 0;
+}
+
+void UMoviePipelineTrajectoryPreloadSetting::OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UMoviePipelineTrajectoryPreloadSetting::OnWorldTickStart);
+
+	if (World == nullptr || World != PipelineWorld.Get() || !Pipeline.IsValid())
+	{
+		return;
+	}
+
+	// Root frame numbers are sequence frame numbers in the display rate, the same ones camera poses are indexed by
+	const int32 CurrentFrame = UMoviePipelineBlueprintLibrary::GetRootFrameNumber(Pipeline.Get()).Value;
+
+	// Selected frames are not evenly spaced, so the upcoming ones are looked up after the current frame
+	TArray<int32> UpcomingFrames;
+	if (RenderedFrames.Num() > 0)
+	{
+		const int FirstUpcomingId = Algo::UpperBound(RenderedFrames, CurrentFrame);
+		for (int i = FirstUpcomingId; i < RenderedFrames.Num() && UpcomingFrames.Num() < PreloadFrameCount; i++)
+		{
+			UpcomingFrames.Add(RenderedFrames[i]);
+		}
+	}
+	else
+	{
+		for (int i = 1; i <= PreloadFrameCount; i++)
+		{
+			UpcomingFrames.Add(CurrentFrame + i * FrameStep);
+		}
+	}
+
+	UpcomingPoses.Reset();
+	for (const FPreloadedCamera& Camera : Cameras)
+	{
+		for (const int32 Frame : UpcomingFrames)
+		{
+			const int PoseId = Frame - FirstPoseFrame;
+			if (Camera.Poses.IsValidIndex(PoseId))
+			{
+				UpcomingPoses.Add(Camera.Poses[PoseId]);
+			}
+		}
+	}
+
+	// View locations without a duration only last until the next streaming update, so they are added every tick
+	for (const FTransform& Pose : UpcomingPoses)
+	{
+		IStreamingManager::Get().AddViewLocation(Pose.GetLocation());
+	}
+}
@@ -23,14 +23,14 @@ const FString FWidgetManager::TextureStyleSemanticName(TEXT("Semantic color text
 const FString FWidgetManager::JpegFormatName(TEXT("jpeg"));
 const FString FWidgetManager::PngFormatName(TEXT("png"));
 const FString FWidgetManager::ExrFormatName(TEXT("exr"));
+const FString FWidgetManager::VideoFormatName(TEXT("video"));
 const FIntPoint FWidgetManager::DefaultOutputImageResolution(1920, 1080);
 
 #define LOCTEXT_NAMESPACE "FWidgetManager"
 
 FWidgetManager::FWidgetManager() :
 	OutputImageResolution(DefaultOutputImageResolution),
-	OutputDirectory(FPathUtils::DefaultRenderingOutputPath()),
-	CurrentSequenceIndex(-1)
+	OutputDirectory(FPathUtils::DefaultRenderingOutputPath())
 {
 	// Create the texture style manager and add it to the root to avoid garbage collection
 	TextureStyleManager = NewObject<UTextureStyleManager>();
@@ -45,6 +45,8 @@ FWidgetManager::FWidgetManager() :
 	SequenceRenderer->AddToRoot();
 	// Register the rendering finished callback
 	SequenceRenderer->OnRenderingFinished().AddRaw(this, &FWidgetManager::OnRenderingFinished);
+	SequenceRenderer->OnPreparationProgress().AddRaw(this, &FWidgetManager::OnPreparationProgress);
+	SequenceRenderer->OnRenderingProgress().AddRaw(this, &FWidgetManager::OnRenderingProgress);
 	SequenceRenderer->SetTextureStyleManager(TextureStyleManager);
 
 	// No need to ever release the TextureStyleManager and the SequenceRenderer,
@@ -58,6 +60,8 @@ FWidgetManager::FWidgetManager() :
 	OutputFormatNames.Add(MakeShared<FString>(JpegFormatName));
 	OutputFormatNames.Add(MakeShared<FString>(PngFormatName));
 	OutputFormatNames.Add(MakeShared<FString>(ExrFormatName));
+	ColorOutputFormatNames = OutputFormatNames;
+	ColorOutputFormatNames.Add(MakeShared<FString>(VideoFormatName));
 
 	// Initialize SemanticClassesWidgetManager
 	SemanticsWidget.SetTextureStyleManager(TextureStyleManager);
@@ -82,6 +86,7 @@ TSharedRef<SDockTab> FWidgetManager::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 	TargetCheckBoxNames.Add(FRendererTargetOptions::NORMAL_IMAGE, LOCTEXT("NormalImagesCheckBoxText", "Normal images"));
 	TargetCheckBoxNames.Add(FRendererTargetOptions::OPTICAL_FLOW_IMAGE, LOCTEXT("OpticalFlowImagesCheckBoxText", "Optical flow images"));
 	TargetCheckBoxNames.Add(FRendererTargetOptions::SEMANTIC_IMAGE, LOCTEXT("SemanticImagesCheckBoxText", "Semantic images"));
+	TargetCheckBoxNames.Add(FRendererTargetOptions::INSTANCE_ID_IMAGE, LOCTEXT("InstanceIdImagesCheckBoxText", "Instance id images"));
 	for (auto Element : TargetCheckBoxNames)
 	{
 		const FRendererTargetOptions::TargetType TargetType = Element.Key;
@@ -103,7 +108,7 @@ TSharedRef<SDockTab> FWidgetManager::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 				+SHorizontalBox::Slot()
 				[
 					SNew(SComboBox<TSharedPtr<FString>>)
-					.OptionsSource(&OutputFormatNames)
+					.OptionsSource(TargetType == FRendererTargetOptions::COLOR_IMAGE ? &ColorOutputFormatNames : &OutputFormatNames)
 					.ContentPadding(2)
 					.OnGenerateWidget_Lambda(
 						[](TSharedPtr<FString> StringItem)
@@ -139,6 +144,34 @@ TSharedRef<SDockTab> FWidgetManager::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 			]
 			+SScrollBox::Slot()
 			.Padding(2)
+			[
+				SNew(SButton)
+				.OnClicked_Raw(
+					&SemanticCsvInterface,
+					&FSemanticCsvInterface::OnImportActorClassesClicked,
+					TextureStyleManager)
+				.Content()
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("ImportActorClassesButtonText", "Import actor classes CSV file"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SButton)
+				.OnClicked_Raw(
+					&SemanticCsvInterface,
+					&FSemanticCsvInterface::OnExportActorClassesClicked,
+					TextureStyleManager)
+				.Content()
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("ExportActorClassesButtonText", "Export actor classes CSV file"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
 			[
 				SNew(SButton)
 				.OnClicked_Raw(&CameraRigRosInterface, &FCameraRigRosInterface::OnImportCameraRigClicked)
@@ -234,6 +267,194 @@ TSharedRef<SDockTab> FWidgetManager::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 				]
 			]
 			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.BinaryCameraPoses();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{ SequenceRendererTargets.SetBinaryCameraPoses(NewState == ECheckBoxState::Checked); })
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("BinaryCameraPosesCheckBoxText", "Also write camera poses as binary npy files"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.SinglePassRendering();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{ SequenceRendererTargets.SetSinglePassRendering(NewState == ECheckBoxState::Checked); })
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("SinglePassRenderingCheckBoxText", "Render targets in a single pass"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.PackExrTargets();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{ SequenceRendererTargets.SetPackExrTargets(NewState == ECheckBoxState::Checked); })
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("PackExrTargetsCheckBoxText", "Pack exr targets rendered in a single pass into one image per frame"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.RenderAllCamerasInOneJob();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{ SequenceRendererTargets.SetRenderAllCamerasInOneJob(NewState == ECheckBoxState::Checked); })
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("AllCamerasInOneJobCheckBoxText", "Render all rig cameras in one job"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsEnabled_Lambda(
+					[this]()
+					{ return !SequenceRendererTargets.PackOutputArchives() && !SequenceRendererTargets.ColorVideoOutput(); })
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.ResumeRendering();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{ SequenceRendererTargets.SetResumeRendering(NewState == ECheckBoxState::Checked); })
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("ResumeRenderingCheckBoxText", "Resume previous rendering"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.StencilSemantics();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{ SequenceRendererTargets.SetStencilSemantics(NewState == ECheckBoxState::Checked); })
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("StencilSemanticsCheckBoxText", "Render semantic images using custom stencil"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.PaletteSemantics();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{ SequenceRendererTargets.SetPaletteSemantics(NewState == ECheckBoxState::Checked); })
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("PaletteSemanticsCheckBoxText", "Write semantic png images with a class color palette"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.MetricDepth();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{ SequenceRendererTargets.SetMetricDepth(NewState == ECheckBoxState::Checked); })
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("MetricDepthCheckBoxText", "Write metric depth values"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.PackOutputArchives();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{
+						// Resuming finds written frames by their image files, which packed archives replace
+						SequenceRendererTargets.SetPackOutputArchives(NewState == ECheckBoxState::Checked);
+						SequenceRendererTargets.SetResumeRendering(
+							SequenceRendererTargets.ResumeRendering() && NewState != ECheckBoxState::Checked);
+					})
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("PackOutputArchivesCheckBoxText", "Pack outputs into tar archives"))
+				]
+			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(SCheckBox)
+				.IsChecked_Lambda(
+					[this]()
+					{
+						const bool bChecked = SequenceRendererTargets.ProcessOpticalFlow();
+						return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+				.OnCheckStateChanged_Lambda(
+					[this](ECheckBoxState NewState)
+					{ SequenceRendererTargets.SetProcessOpticalFlow(NewState == ECheckBoxState::Checked); })
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("ProcessOpticalFlowCheckBoxText", "Write optical flow occlusion and consistency masks"))
+				]
+			]
+			+SScrollBox::Slot()
 			[
 				TargetsScrollBoxes
 			]
@@ -372,6 +593,13 @@ TSharedRef<SDockTab> FWidgetManager::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 					.Text(LOCTEXT("RenderImagesButtonText", "Render Images"))
 				]
 			]
+			+SScrollBox::Slot()
+			.Padding(2)
+			[
+				SNew(STextBlock)
+				.Text_Raw(this, &FWidgetManager::GetRenderingStatusText)
+				.AutoWrapText(true)
+			]
 		];
 }
 
@@ -433,7 +661,15 @@ void FWidgetManager::OnOutputFormatSelectionChanged(
 	ESelectInfo::Type SelectInfo,
 	const FRendererTargetOptions::TargetType TargetType)
 {
-	if (*StringItem == JpegFormatName)
+	// Videos are encoded from rendered images once the rendering finishes, which replaces the images resuming looks for
+	if (TargetType == FRendererTargetOptions::COLOR_IMAGE)
+	{
+		SequenceRendererTargets.SetColorVideoOutput(*StringItem == VideoFormatName);
+		SequenceRendererTargets.SetResumeRendering(
+			SequenceRendererTargets.ResumeRendering() && !SequenceRendererTargets.ColorVideoOutput());
+	}
+
+	if (*StringItem == JpegFormatName || *StringItem == VideoFormatName)
 	{
 		SequenceRendererTargets.SetOutputFormat(TargetType, EImageFormat::JPEG);
 	}
@@ -456,7 +692,11 @@ FText FWidgetManager::SelectedOutputFormat(const FRendererTargetOptions::TargetT
 {
 	EImageFormat OutputFormat = SequenceRendererTargets.OutputFormat(TargetType);
 
-	if (OutputFormat == EImageFormat::JPEG)
+	if (TargetType == FRendererTargetOptions::COLOR_IMAGE && SequenceRendererTargets.ColorVideoOutput())
+	{
+		return FText::FromString(VideoFormatName);
+	}
+	else if (OutputFormat == EImageFormat::JPEG)
 	{
 		return FText::FromString(JpegFormatName);
 	}
@@ -503,7 +743,6 @@ FReply FWidgetManager::OnRenderImagesClicked()
 {
 	// Scan folder for level sequences using Asset Registry
 	SequencesToRender.Empty();
-	CurrentSequenceIndex = -1;
 	
 	// Convert folder path to package path
 	FString PackagePath;
@@ -553,28 +792,41 @@ FReply FWidgetManager::OnRenderImagesClicked()
 	
 	// Store base output directory
 	BaseOutputDirectory = OutputDirectory;
-	
-	// Start rendering first sequence
-	CurrentSequenceIndex = 0;
-	RenderCurrentSequence();
-	
+
+	// Each sequence is rendered into its own output directory
+	TArray<FString> SequenceOutputDirectories;
+	for (const FAssetData& Sequence : SequencesToRender)
+	{
+		SequenceOutputDirectories.Add(SequenceOutputDirectory(Sequence));
+	}
+
+	// Render all sequences within the same batch
+	if (!SequenceRenderer->RenderSequences(
+		SequencesToRender,
+		SequenceRendererTargets,
+		OutputImageResolution,
+		SequenceOutputDirectories))
+	{
+		const FText MessageBoxTitle = LOCTEXT("StartRenderingErrorMessageBoxTitle", "Could not start rendering");
+		FMessageDialog::Open(
+			EAppMsgType::Ok,
+			FText::FromString(SequenceRenderer->GetErrorMessage()),
+			&MessageBoxTitle);
+
+		// Reset batch rendering state
+		SequencesToRender.Empty();
+	}
+
 	// Save widget options
 	SaveWidgetOptionStates();
-	
+
 	return FReply::Handled();
 }
 
-void FWidgetManager::RenderCurrentSequence()
+FString FWidgetManager::SequenceOutputDirectory(const FAssetData& Sequence) const
 {
-	if (CurrentSequenceIndex < 0 || CurrentSequenceIndex >= SequencesToRender.Num())
-	{
-		return;
-	}
-	
-	FAssetData& CurrentSequence = SequencesToRender[CurrentSequenceIndex];
-	
 	// Get the relative path from the selected folder
-	FString SequencePackagePath = CurrentSequence.PackageName.ToString();
+	FString SequencePackagePath = Sequence.PackageName.ToString();
 	
 	// Convert selected folder to package path
 	FString BaseFolderPackagePath;
@@ -595,34 +847,14 @@ void FWidgetManager::RenderCurrentSequence()
 	else
 	{
 		// Fallback to just the asset name
-		RelativePath = CurrentSequence.AssetName.ToString();
+		RelativePath = Sequence.AssetName.ToString();
 	}
 	
 	// Replace package path separators with filesystem separators
 	RelativePath = RelativePath.Replace(TEXT("/"), TEXT("\\"));
 	
 	// Create output directory preserving hierarchy
-	FString SequenceOutputDir = BaseOutputDirectory / RelativePath;
-	
-	UE_LOG(LogEasySynth, Log, TEXT("Rendering sequence %d/%d: %s"), 
-		CurrentSequenceIndex + 1, SequencesToRender.Num(), *RelativePath);
-	
-	if (!SequenceRenderer->RenderSequence(
-		CurrentSequence,
-		SequenceRendererTargets,
-		OutputImageResolution,
-		SequenceOutputDir))
-	{
-		const FText MessageBoxTitle = LOCTEXT("StartRenderingErrorMessageBoxTitle", "Could not start rendering");
-		FMessageDialog::Open(
-			EAppMsgType::Ok,
-			FText::FromString(SequenceRenderer->GetErrorMessage()),
-			&MessageBoxTitle);
-		
-		// Reset batch rendering state
-		SequencesToRender.Empty();
-		CurrentSequenceIndex = -1;
-	}
+	return BaseOutputDirectory / RelativePath;
 }
 
 void FWidgetManager::OnSemanticClassesUpdated()
@@ -651,52 +883,13 @@ void FWidgetManager::OnRenderingFinished(bool bSuccess)
 {
 	if (bSuccess)
 	{
-		// Check if we're in batch rendering mode
-		if (CurrentSequenceIndex >= 0 && CurrentSequenceIndex < SequencesToRender.Num())
-		{
-			CurrentSequenceIndex++;
-			
-			// Check if there are more sequences to render
-			if (CurrentSequenceIndex < SequencesToRender.Num())
-			{
-				// Force memory cleanup before next sequence
-				UE_LOG(LogEasySynth, Log, TEXT("Cleaning up memory before sequence %d/%d"), 
-					CurrentSequenceIndex + 1, SequencesToRender.Num());
-				
-				// Collect garbage to free memory
-				GEngine->ForceGarbageCollection(true);
-				
-				// Small delay before next render
-				FPlatformProcess::Sleep(1.0f);
-				
-				// Render next sequence
-				RenderCurrentSequence();
-				return;
-			}
-			else
-			{
-				// All sequences rendered successfully
-				const FText MessageBoxTitle = LOCTEXT("BatchRenderingCompleteTitle", "Batch Rendering Complete");
-				FMessageDialog::Open(
-					EAppMsgType::Ok,
-					FText::Format(LOCTEXT("BatchRenderingCompleteMessage", "Successfully rendered {0} sequences."),
-						FText::AsNumber(SequencesToRender.Num())),
-					&MessageBoxTitle);
-				
-				// Reset batch rendering state
-				SequencesToRender.Empty();
-				CurrentSequenceIndex = -1;
-			}
-		}
-		else
-		{
-			// Single sequence rendering (shouldn't happen now, but keep for safety)
-			const FText MessageBoxTitle = LOCTEXT("SuccessfulRenderingMessageBoxTitle", "Successful rendering");
-			FMessageDialog::Open(
-				EAppMsgType::Ok,
-				LOCTEXT("SuccessfulRenderingMessageBoxText", "Rendering finished successfully"),
-				&MessageBoxTitle);
-		}
+		// All sequences rendered successfully
+		const FText MessageBoxTitle = LOCTEXT("BatchRenderingCompleteTitle", "Batch Rendering Complete");
+		FMessageDialog::Open(
+			EAppMsgType::Ok,
+			FText::Format(LOCTEXT("BatchRenderingCompleteMessage", "Successfully rendered {0} sequences."),
+				FText::AsNumber(SequencesToRender.Num())),
+			&MessageBoxTitle);
 	}
 	else
 	{
@@ -704,17 +897,39 @@ void FWidgetManager::OnRenderingFinished(bool bSuccess)
 		const FText MessageBoxTitle = LOCTEXT("RenderingErrorMessageBoxTitle", "Rendering failed");
 		FMessageDialog::Open(
 			EAppMsgType::Ok,
-			FText::FromString(FString::Printf(TEXT("Failed on sequence: %s\n\nError: %s"),
-				CurrentSequenceIndex >= 0 && CurrentSequenceIndex < SequencesToRender.Num() 
-					? *SequencesToRender[CurrentSequenceIndex].AssetName.ToString() 
-					: TEXT("Unknown"),
-				*SequenceRenderer->GetErrorMessage())),
+			FText::FromString(SequenceRenderer->GetErrorMessage()),
 			&MessageBoxTitle);
-		
-		// Reset batch rendering state
-		SequencesToRender.Empty();
-		CurrentSequenceIndex = -1;
 	}
+
+	// Reset batch rendering state
+	SequencesToRender.Empty();
+	RenderingStatusText = FText::GetEmpty();
+}
+
+void FWidgetManager::OnPreparationProgress(const FString& Step, float Progress)
+{
+	RenderingStatusText = FText::Format(LOCTEXT("PreparationProgressText", "{0}... {1}"),
+		FText::FromString(Step), FText::AsPercent(Progress));
+}
+
+void FWidgetManager::OnRenderingProgress(const FRenderingProgress& Progress)
+{
+	const FText EtaText = Progress.EtaSeconds < 0.0 ?
+		LOCTEXT("UnknownEtaText", "estimating") :
+		FText::AsTimespan(FTimespan::FromSeconds(FMath::CeilToDouble(Progress.EtaSeconds)));
+	FFormatNamedArguments Arguments;
+	Arguments.Add(TEXT("Target"), FText::FromString(Progress.Target));
+	Arguments.Add(TEXT("Camera"), FText::FromString(Progress.Camera));
+	Arguments.Add(TEXT("CompletedFrames"), FText::AsNumber(Progress.CompletedFrames));
+	Arguments.Add(TEXT("TotalFrames"), FText::AsNumber(Progress.TotalFrames));
+	Arguments.Add(TEXT("WorkItem"), FText::AsNumber(Progress.CompletedWorkItems + 1));
+	Arguments.Add(TEXT("TotalWorkItems"), FText::AsNumber(Progress.TotalWorkItems));
+	Arguments.Add(TEXT("FramesPerSecond"), FText::AsNumber(Progress.FramesPerSecond));
+	Arguments.Add(TEXT("Eta"), EtaText);
+	Arguments.Add(TEXT("PendingImages"), FText::AsNumber(Progress.PendingImages));
+	RenderingStatusText = FText::Format(LOCTEXT("RenderingProgressText",
+		"Rendering {Target} of camera {Camera} ({WorkItem}/{TotalWorkItems}): frame {CompletedFrames}/{TotalFrames}, "
+		"{FramesPerSecond} fps, {PendingImages} images waiting to be written, remaining time {Eta}"), Arguments);
 }
 
 void FWidgetManager::LoadWidgetOptionStates()
@@ -727,11 +942,24 @@ void FWidgetManager::LoadWidgetOptionStates()
 		// Initialize the widget members using loaded options
 		SelectedSequencesFolder = TEXT("");
 		SequenceRendererTargets.SetExportCameraPoses(WidgetStateAsset->bCameraPosesSelected);
+		SequenceRendererTargets.SetBinaryCameraPoses(WidgetStateAsset->bBinaryCameraPosesSelected);
+		SequenceRendererTargets.SetSinglePassRendering(WidgetStateAsset->bSinglePassRenderingSelected);
+		SequenceRendererTargets.SetPackExrTargets(WidgetStateAsset->bPackExrTargetsSelected);
+		SequenceRendererTargets.SetRenderAllCamerasInOneJob(WidgetStateAsset->bAllCamerasInOneJobSelected);
+		SequenceRendererTargets.SetResumeRendering(WidgetStateAsset->bResumeRenderingSelected &&
+			!WidgetStateAsset->bPackOutputArchivesSelected && !WidgetStateAsset->bColorVideoOutputSelected);
+		SequenceRendererTargets.SetStencilSemantics(WidgetStateAsset->bStencilSemanticsSelected);
+		SequenceRendererTargets.SetPaletteSemantics(WidgetStateAsset->bPaletteSemanticsSelected);
+		SequenceRendererTargets.SetMetricDepth(WidgetStateAsset->bMetricDepthSelected);
+		SequenceRendererTargets.SetPackOutputArchives(WidgetStateAsset->bPackOutputArchivesSelected);
+		SequenceRendererTargets.SetProcessOpticalFlow(WidgetStateAsset->bProcessOpticalFlowSelected);
+		SequenceRendererTargets.SetColorVideoOutput(WidgetStateAsset->bColorVideoOutputSelected);
 		SequenceRendererTargets.SetSelectedTarget(FRendererTargetOptions::COLOR_IMAGE, WidgetStateAsset->bColorImagesSelected);
 		SequenceRendererTargets.SetSelectedTarget(FRendererTargetOptions::DEPTH_IMAGE, WidgetStateAsset->bDepthImagesSelected);
 		SequenceRendererTargets.SetSelectedTarget(FRendererTargetOptions::NORMAL_IMAGE, WidgetStateAsset->bNormalImagesSelected);
 		SequenceRendererTargets.SetSelectedTarget(FRendererTargetOptions::OPTICAL_FLOW_IMAGE, WidgetStateAsset->bOpticalFlowImagesSelected);
 		SequenceRendererTargets.SetSelectedTarget(FRendererTargetOptions::SEMANTIC_IMAGE, WidgetStateAsset->bSemanticImagesSelected);
+		SequenceRendererTargets.SetSelectedTarget(FRendererTargetOptions::INSTANCE_ID_IMAGE, WidgetStateAsset->bInstanceIdImagesSelected);
 		SequenceRendererTargets.SetOutputFormat(
 			FRendererTargetOptions::COLOR_IMAGE,
 			static_cast<EImageFormat>(WidgetStateAsset->bColorImagesOutputFormat));
@@ -747,6 +975,9 @@ void FWidgetManager::LoadWidgetOptionStates()
 		SequenceRendererTargets.SetOutputFormat(
 			FRendererTargetOptions::SEMANTIC_IMAGE,
 			static_cast<EImageFormat>(WidgetStateAsset->bSemanticImagesOutputFormat));
+		SequenceRendererTargets.SetOutputFormat(
+			FRendererTargetOptions::INSTANCE_ID_IMAGE,
+			static_cast<EImageFormat>(WidgetStateAsset->bInstanceIdImagesOutputFormat));
 		SequenceRendererTargets.SetCustomPPMaterialAssetData(WidgetStateAsset->CustomPPMaterialAssetPath.TryLoad());
 		SequenceRendererTargets.SetOutputFormat(
 			FRendererTargetOptions::CUSTOM_PP_MATERIAL,
@@ -786,11 +1017,23 @@ void FWidgetManager::SaveWidgetOptionStates()
 	// Update asset values
 	WidgetStateAsset->LevelSequenceAssetPath = FSoftObjectPath();
 	WidgetStateAsset->bCameraPosesSelected = SequenceRendererTargets.ExportCameraPoses();
+	WidgetStateAsset->bBinaryCameraPosesSelected = SequenceRendererTargets.BinaryCameraPoses();
+	WidgetStateAsset->bSinglePassRenderingSelected = SequenceRendererTargets.SinglePassRendering();
+	WidgetStateAsset->bPackExrTargetsSelected = SequenceRendererTargets.PackExrTargets();
+	WidgetStateAsset->bAllCamerasInOneJobSelected = SequenceRendererTargets.RenderAllCamerasInOneJob();
+	WidgetStateAsset->bResumeRenderingSelected = SequenceRendererTargets.ResumeRendering();
+	WidgetStateAsset->bStencilSemanticsSelected = SequenceRendererTargets.StencilSemantics();
+	WidgetStateAsset->bPaletteSemanticsSelected = SequenceRendererTargets.PaletteSemantics();
+	WidgetStateAsset->bMetricDepthSelected = SequenceRendererTargets.MetricDepth();
+	WidgetStateAsset->bPackOutputArchivesSelected = SequenceRendererTargets.PackOutputArchives();
+	WidgetStateAsset->bProcessOpticalFlowSelected = SequenceRendererTargets.ProcessOpticalFlow();
+	WidgetStateAsset->bColorVideoOutputSelected = SequenceRendererTargets.ColorVideoOutput();
 	WidgetStateAsset->bColorImagesSelected = SequenceRendererTargets.TargetSelected(FRendererTargetOptions::COLOR_IMAGE);
 	WidgetStateAsset->bDepthImagesSelected = SequenceRendererTargets.TargetSelected(FRendererTargetOptions::DEPTH_IMAGE);
 	WidgetStateAsset->bNormalImagesSelected = SequenceRendererTargets.TargetSelected(FRendererTargetOptions::NORMAL_IMAGE);
 	WidgetStateAsset->bOpticalFlowImagesSelected = SequenceRendererTargets.TargetSelected(FRendererTargetOptions::OPTICAL_FLOW_IMAGE);
 	WidgetStateAsset->bSemanticImagesSelected = SequenceRendererTargets.TargetSelected(FRendererTargetOptions::SEMANTIC_IMAGE);
+	WidgetStateAsset->bInstanceIdImagesSelected = SequenceRendererTargets.TargetSelected(FRendererTargetOptions::INSTANCE_ID_IMAGE);
 	WidgetStateAsset->bColorImagesOutputFormat = static_cast<int8>(
 		SequenceRendererTargets.OutputFormat(FRendererTargetOptions::COLOR_IMAGE));
 	WidgetStateAsset->bDepthImagesOutputFormat = static_cast<int8>(
@@ -801,6 +1044,8 @@ void FWidgetManager::SaveWidgetOptionStates()
 		SequenceRendererTargets.OutputFormat(FRendererTargetOptions::OPTICAL_FLOW_IMAGE));
 	WidgetStateAsset->bSemanticImagesOutputFormat = static_cast<int8>(
 		SequenceRendererTargets.OutputFormat(FRendererTargetOptions::SEMANTIC_IMAGE));
+	WidgetStateAsset->bInstanceIdImagesOutputFormat = static_cast<int8>(
+		SequenceRendererTargets.OutputFormat(FRendererTargetOptions::INSTANCE_ID_IMAGE));
 	WidgetStateAsset->CustomPPMaterialAssetPath = SequenceRendererTargets.CustomPPMaterial().ToSoftObjectPath();
 	WidgetStateAsset->bCustomPPMaterialOutputFormat = static_cast<int8>(
 		SequenceRendererTargets.OutputFormat(FRendererTargetOptions::CUSTOM_PP_MATERIAL));
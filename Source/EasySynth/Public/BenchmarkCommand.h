@@ -0,0 +1,140 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/Float16Color.h"
+
+#include "BenchmarkCommand.generated.h"
+
+class IConsoleObject;
+class UTextureStyleManager;
+
+
+/**
+ * Structure representing a single measured case inside of the benchmark report JSON file.
+ * Member names are lower case, as they need to exactly match the JSON file content.
+ */
+USTRUCT()
+struct FBenchmarkReportCase
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Name of the measured case, including its size */
+	UPROPERTY()
+	FString name;
+
+	/** Number of items processed by a single run, e.g. actors, frames or pixels */
+	UPROPERTY()
+	int64 items = 0;
+
+	/** Number of measured runs, not including the warm-up run */
+	UPROPERTY()
+	int iterations = 0;
+
+	/** Whether all of the runs succeeded */
+	UPROPERTY()
+	bool success = false;
+
+	/** Duration of the fastest run */
+	UPROPERTY()
+	double min_seconds = 0.0;
+
+	/** Median run duration, the value to compare between plugin versions */
+	UPROPERTY()
+	double median_seconds = 0.0;
+
+	/** Mean run duration */
+	UPROPERTY()
+	double mean_seconds = 0.0;
+};
+
+
+/**
+ * Structure representing the exact structure of benchmark report JSON files.
+ * Member names are lower case, as they need to exactly match the JSON file content.
+ */
+USTRUCT()
+struct FBenchmarkReportContent
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Version of the benchmarked plugin */
+	UPROPERTY()
+	FString plugin_version;
+
+	/** Version of the engine running the benchmark */
+	UPROPERTY()
+	FString engine_version;
+
+	/** Measured cases, in the order they were run */
+	UPROPERTY()
+	TArray<FBenchmarkReportCase> cases;
+};
+
+
+/**
+ * Class that provides the console command measuring the expensive parts of the plugin on synthetic data,
+ * so that timings of different plugin versions can be compared from batch jobs, e.g.
+ * -ExecCmds="EasySynth.Benchmark Output=D:/Benchmark Actors=10000,100000 Quit"
+ * Every case runs once to warm up caches and is then measured the requested number of times
+*/
+class FBenchmarkCommand
+{
+public:
+	/** Registers the console command, using the provided texture style manager for the level checkout case */
+	void Register(UTextureStyleManager* TextureStyleManager);
+
+	/** Unregisters the console command */
+	void Unregister();
+
+private:
+	/** Handles the console command */
+	void OnBenchmarkCommand(const TArray<FString>& Args);
+
+	/** Measures backing up and swapping materials of synthetic actors spawned inside a transient world */
+	void BenchmarkTextureBackup(const int ActorCount);
+
+	/** Measures texture style checkouts of the level opened inside the editor */
+	void BenchmarkTextureStyleCheckout();
+
+	/** Measures encoding and writing synthetic 8-bit images */
+	void BenchmarkImageWriting(const FIntPoint Resolution, const FString& ScratchDirectory);
+
+	/** Measures writing synthetic multi-layer EXR images */
+	void BenchmarkExrWriting(const FIntPoint Resolution, const int LayerCount, const FString& ScratchDirectory);
+
+	/** Measures extracting and writing camera poses of the sequence */
+	void BenchmarkPoseExport(const FString& SequencePath, const FString& ScratchDirectory);
+
+	/** Returns a synthetic image with smooth gradients and noise, which compresses similarly to rendered images */
+	static TArray64<FFloat16Color> SyntheticPixels(const FIntPoint Resolution);
+
+	/**
+	 * Runs the case once without measuring it and then the requested number of times,
+	 * the setup runs before every run and is not included inside the measured time
+	*/
+	void MeasureCase(
+		const FString& Name,
+		const int64 Items,
+		TFunctionRef<void()> Setup,
+		TFunctionRef<bool()> Run);
+
+	/** Registered console command */
+	IConsoleObject* ConsoleCommand = nullptr;
+
+	/** Manager used for the texture style checkout case */
+	UTextureStyleManager* TextureStyleManager = nullptr;
+
+	/** Number of measured runs of each case */
+	int Iterations = 0;
+
+	/** Report of the benchmark in progress */
+	FBenchmarkReportContent BenchmarkReport;
+
+	/** The name of the console command */
+	static const TCHAR* CommandName;
+
+	/** Name of the report file written inside the output directory */
+	static const FString ReportFileName;
+};
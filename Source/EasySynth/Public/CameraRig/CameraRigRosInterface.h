@@ -6,6 +6,7 @@
 
 #include "CameraRigRosInterface.generated.h"
 
+class FBackgroundFileWriter;
 class UCameraComponent;
 
 
@@ -65,17 +66,23 @@ public:
 	/** Imports camera rig from a ROS JSON file */
 	FReply OnImportCameraRigClicked();
 
-	/** Exports camera rig into a ROS JSON file */
+	/**
+	 * Exports camera rig into a ROS JSON file, written in the background if the writer is provided
+	 * Levels of the image pyramid get their own file, with intrinsics scaled to the level resolution
+	*/
 	bool ExportCameraRig(
 		const FString& OutputDir,
 		TArray<UCameraComponent*> RigCameras,
-		const FIntPoint& SensorSize);
+		const FIntPoint& SensorSize,
+		FBackgroundFileWriter* FileWriter = nullptr,
+		const int PyramidLevel = 0);
 
 private:
-	/** Adds lines describing a single camera to the output array */
+	/** Adds lines describing a single camera, as seen by images of the pyramid level, to the output array */
 	void AddCamera(
 		const int CameraId,
 		UCameraComponent* Camera,
 		const FIntPoint& SensorSize,
+		const int PyramidLevel,
 		FRosJsonContent& RosJsonContent);
 };
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 
+#include "BenchmarkCommand.h"
+#include "RenderCommand.h"
 #include "Widgets/WidgetManager.h"
 
 class FToolBarBuilder;
@@ -36,4 +38,10 @@ private:
 
 	/** Utility that manages editor tab UI */
 	FWidgetManager WidgetManager;
+
+	/** Console command that starts the rendering without the widget */
+	FRenderCommand RenderCommand;
+
+	/** Console command that measures the plugin performance on synthetic data */
+	FBenchmarkCommand BenchmarkCommand;
 };
@@ -0,0 +1,41 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MoviePipelineSetting.h"
+
+#include "FrameSelectionSetting.generated.h"
+
+class UMoviePipeline;
+struct FMoviePipelineMergerOutputFrame;
+
+
+/**
+ * Movie pipeline setting that lists the frames written by the job outputs
+ * Runs of subsampled frames close to each other are rendered by a single job to avoid the cost of starting a job,
+ * so frames rendered between the runs are dropped by the outputs instead of being written
+*/
+UCLASS()
+class UMoviePipelineFrameSelectionSetting : public UMoviePipelineSetting
+{
+	GENERATED_BODY()
+
+public:
+#if WITH_EDITOR
+	FText GetDisplayText() const override
+	{
+		return NSLOCTEXT("EasySynth", "FrameSelectionSettingDisplayName", "Frame Selection");
+	}
+#endif
+
+	bool IsValidOnShots() const override { return false; }
+	bool IsValidOnPrimary() const override { return true; }
+
+	/** Returns true if outputs of the pipeline should write the merged frame, which is the case for all frames if the setting is disabled */
+	static bool IsFrameWritten(UMoviePipeline* Pipeline, const FMoviePipelineMergerOutputFrame* MergedOutputFrame);
+
+	/** Sequence frame numbers written by the outputs in the increasing order */
+	UPROPERTY()
+	TArray<int32> WrittenFrames;
+};
@@ -0,0 +1,46 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+
+/**
+ * Class that writes metadata files on background threads, so that the game thread only collects their content
+ * Writes may finish in any order, all of them have to be waited for before the written files are used
+*/
+class FBackgroundFileWriter
+{
+public:
+	FBackgroundFileWriter() {}
+	~FBackgroundFileWriter() { Wait(); }
+
+	/** Runs the write on a background thread, the write returns whether it succeeded */
+	void Launch(TUniqueFunction<bool()>&& Write);
+
+	/** Waits for all of the launched writes, returns false if any of them failed */
+	bool Wait();
+
+	/**
+	 * Saves the string into the file, in the background if the writer is provided,
+	 * returns false only if the file is saved immediately and saving fails
+	*/
+	static bool SaveStringToFile(FBackgroundFileWriter* FileWriter, FString&& Content, const FString& FilePath);
+
+	/**
+	 * Saves the lines into the file, in the background if the writer is provided,
+	 * returns false only if the file is saved immediately and saving fails
+	*/
+	static bool SaveStringArrayToFile(FBackgroundFileWriter* FileWriter, TArray<FString>&& Lines, const FString& FilePath);
+
+private:
+	/** Saves the string into the file, logging the failure */
+	static bool SaveString(const FString& Content, const FString& FilePath);
+
+	/** Saves the lines into the file, logging the failure */
+	static bool SaveStringArray(const TArray<FString>& Lines, const FString& FilePath);
+
+	/** Results of the writes launched since the last wait */
+	TArray<TFuture<bool>> PendingWrites;
+};
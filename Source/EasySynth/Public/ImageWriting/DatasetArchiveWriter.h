@@ -0,0 +1,92 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Class that packs the rendering output directory into large tar archives,
+ * so that datasets are not stored as hundreds of thousands of small files
+ * Images of the same camera frame are stored next to each other as entries named <camera>/<frame>.<target>.<extension>,
+ * with downsampled pyramid levels named <camera>/<frame>.<target>.level<k>.<extension>,
+ * which matches the WebDataset sample layout, while other outputs such as camera poses are stored as sidecar entries
+ * under their relative paths. Offsets of all entries are written to the index file next to the archives
+*/
+class FDatasetArchiveWriter
+{
+public:
+	explicit FDatasetArchiveWriter(const int64 MaxArchiveBytes) :
+		MaxArchiveBytes(MaxArchiveBytes),
+		ArchiveId(0),
+		ArchiveBytes(0)
+	{}
+
+	/** Moves all output files inside the directory into archives, removing the packed files */
+	bool PackDirectory(const FString& Directory);
+
+private:
+	/** A single output file to be stored inside an archive */
+	struct FArchiveEntry
+	{
+		/** Full path of the packed file */
+		FString FilePath;
+
+		/** Name of the entry inside the archive */
+		FString EntryName;
+
+		/** Camera the file belongs to, empty for outputs shared by all cameras */
+		FString Camera;
+
+		/** Target the image belongs to, empty for sidecar entries */
+		FString Target;
+
+		/** Frame of the image, INDEX_NONE for sidecar entries */
+		int Frame = INDEX_NONE;
+
+		/** Image pyramid level of the file, zero for rendered resolution images and for files outside level directories */
+		int Level = 0;
+	};
+
+	/** Creates the archive entry describing the file at the path relative to the output directory */
+	static FArchiveEntry MakeEntry(const FString& FilePath, const FString& RelativePath);
+
+	/** Opens the next archive file, continuing the numbering of archives already inside the output directory */
+	bool OpenArchive();
+
+	/** Writes the lines of packed entries to the index file, which is extended if it already exists */
+	bool SaveIndex() const;
+
+	/** Writes the end of archive marker and closes the archive file */
+	bool CloseArchive();
+
+	/** Appends the tar header and the file content to the archive, adding the entry to the index */
+	bool AppendEntry(const FArchiveEntry& Entry);
+
+	/** Fills the 512 byte ustar header of an entry */
+	static bool WriteTarHeader(const FString& EntryName, const int64 Size, uint8* OutHeader);
+
+	/** Writes the zero padded octal number into the null terminated tar header field */
+	static bool WriteOctal(uint64 Value, const int FieldSize, uint8* OutField);
+
+	/** Maximum size of a single archive, the archive is allowed to exceed it to keep frame images together */
+	const int64 MaxArchiveBytes;
+
+	/** The output directory being packed */
+	FString OutputDirectory;
+
+	/** Id of the currently open archive */
+	int ArchiveId;
+
+	/** Number of bytes written to the currently open archive */
+	int64 ArchiveBytes;
+
+	/** The currently open archive file */
+	TUniquePtr<FArchive> ArchiveWriter;
+
+	/** Lines of the index file describing packed entries */
+	TArray<FString> IndexLines;
+
+	/** Size of tar headers and the block size data is padded to */
+	static const int64 TarBlockSize;
+};
@@ -0,0 +1,81 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IImageWrapper.h"
+#include "ImagePixelData.h"
+#include "ImageWriteTask.h"
+
+
+/**
+ * Image write task that receives the rendered pixel data at its original bit depth,
+ * and converts it to 8-bit colors right before encoding, on the writer thread running the task
+ * This way the game thread only moves the pixel data into the task, instead of converting it before enqueuing,
+ * while the converted copy of the image is only kept in memory while it is being encoded
+ * PNG images with the provided palette are written as palette-indexed images, if all of their colors are inside it
+ * Downsampled image pyramid levels are written after the image, each one downsampled from the previous level
+*/
+class FEncodedImageWriteTask : public IImageWriteTaskBase
+{
+public:
+	FEncodedImageWriteTask(
+		const FString& Filename,
+		const EImageFormat ImageFormat,
+		TUniquePtr<FImagePixelData>&& PixelData,
+		const bool bRequireTransparentOutput,
+		const TArray<FColor>& Palette = TArray<FColor>(),
+		const int PyramidLevelCount = 1,
+		const bool bAveragePyramidLevels = false,
+		const bool bConvertToSrgb = true) :
+		Filename(Filename),
+		ImageFormat(ImageFormat),
+		PixelData(MoveTemp(PixelData)),
+		bRequireTransparentOutput(bRequireTransparentOutput),
+		Palette(Palette),
+		PyramidLevelCount(PyramidLevelCount),
+		bAveragePyramidLevels(bAveragePyramidLevels),
+		bConvertToSrgb(bConvertToSrgb)
+	{}
+
+	/** IImageWriteTaskBase interface */
+	bool RunTask() override;
+	void OnAbandoned() override {}
+
+	/**
+	 * Returns the 8-bit BGRA copy of the pixel data, with linear colors sRGB encoded if requested
+	 * Data values, such as encoded ids, are converted without the sRGB encoding, so that byte values stay exact
+	*/
+	static TUniquePtr<FImagePixelData> QuantizeToColor(const FImagePixelData* PixelData, const bool bConvertToSrgb);
+
+private:
+	/** Returns the 8-bit BGRA copy of the pixel data, which is opaque unless transparency is required */
+	TUniquePtr<FImagePixelData> QuantizePixelData() const;
+
+	/** Encodes and writes the 8-bit pixel data to the file */
+	bool WriteQuantizedImage(const FImagePixelData* QuantizedPixelData, const FString& FilePath) const;
+
+	/** Path of the written file */
+	const FString Filename;
+
+	/** Format the image is encoded with, JPEG or PNG */
+	const EImageFormat ImageFormat;
+
+	/** Rendered pixel data, replaced by each of the downsampled levels as they are written */
+	TUniquePtr<FImagePixelData> PixelData;
+
+	/** Whether the alpha channel should be preserved */
+	const bool bRequireTransparentOutput;
+
+	/** Colors of palette-indexed PNG images, empty if images should be written with all color channels */
+	const TArray<FColor> Palette;
+
+	/** Number of written image pyramid levels, including the rendered resolution */
+	const int PyramidLevelCount;
+
+	/** Whether pyramid levels are downsampled by averaging, instead of keeping the most frequent value */
+	const bool bAveragePyramidLevels;
+
+	/** Whether rendered values are linear colors that are sRGB encoded, instead of data values stored unchanged */
+	const bool bConvertToSrgb;
+};
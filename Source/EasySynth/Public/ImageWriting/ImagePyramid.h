@@ -0,0 +1,67 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImagePixelData.h"
+
+#include "ImagePyramid.generated.h"
+
+
+/**
+ * Settings of the downsampled image levels written next to each rendered image
+*/
+USTRUCT()
+struct FImagePyramidSettings
+{
+	GENERATED_BODY()
+
+	/** Number of written levels, including the rendered resolution, each following level has half of the resolution */
+	UPROPERTY()
+	int32 LevelCount = 1;
+
+	/** Whether all passes are downsampled by averaging, used by targets rendering a single pass */
+	UPROPERTY()
+	bool bAverageAllPasses = false;
+
+	/** Names of passes downsampled by averaging, used by targets rendering multiple passes */
+	UPROPERTY()
+	TSet<FString> AveragedPasses;
+
+	/** Checks whether the pass is downsampled by averaging, instead of keeping the most frequent value */
+	bool AveragesPass(const FString& PassName) const { return bAverageAllPasses || AveragedPasses.Contains(PassName); }
+};
+
+
+/**
+ * Class that downsamples rendered images into the levels of the image pyramid
+ * Each level halves the resolution of the previous one, computing each pixel from a block of 2x2 pixels,
+ * either by averaging them, or by keeping the most frequent value, so that ids and labels never get blended
+*/
+class FImagePyramid
+{
+public:
+	/** Returns the image downsampled to half of its resolution, or nullptr if the pixel type is not supported */
+	static TUniquePtr<FImagePixelData> Downsample(const FImagePixelData* PixelData, const bool bAverage);
+
+	/** Returns the resolution of the pyramid level */
+	static FIntPoint LevelSize(const FIntPoint& BaseSize, const int Level);
+
+private:
+	/** Downsamples the pixels of a specific pixel type */
+	template <typename PixelType>
+	static TUniquePtr<FImagePixelData> DownsamplePixels(const FImagePixelData* PixelData, const bool bAverage);
+
+	/** Returns the average of the pixel block */
+	static FColor AveragePixels(const FColor (&Block)[4]);
+
+	/** Returns the average of the pixel block */
+	static FFloat16Color AveragePixels(const FFloat16Color (&Block)[4]);
+
+	/** Returns the average of the pixel block */
+	static FLinearColor AveragePixels(const FLinearColor (&Block)[4]);
+
+	/** Returns the most frequent pixel of the block, preferring the top-left pixels if some of them are equally frequent */
+	template <typename PixelType>
+	static PixelType MostFrequentPixel(const PixelType (&Block)[4]);
+};
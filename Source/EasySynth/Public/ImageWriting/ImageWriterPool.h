@@ -0,0 +1,77 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "IImageWrapper.h"
+#include "ImageWriteQueue.h"
+
+class FEvent;
+class FQueuedThreadPool;
+
+
+/**
+ * Image write queue that runs write tasks inside its own thread pool,
+ * with one pool per output image format, so that the pool size can match the cost of encoding the format
+ * Once the number of in-flight images reaches the limit, enqueuing blocks the caller until some of them are written,
+ * which throttles the rendering instead of accumulating rendered frames in memory
+*/
+class FImageWriterPool : public IImageWriteQueue
+{
+public:
+	FImageWriterPool(const TCHAR* PoolName, const int32 NumThreads);
+	~FImageWriterPool() override;
+
+	/** Returns the writer pool dedicated to the provided image format, creating it on first use */
+	static FImageWriterPool& ForImageFormat(const EImageFormat ImageFormat);
+
+	/** Destroys all of the writer pools, abandoning their queued tasks */
+	static void ShutdownPools();
+
+	/** Returns the number of images waiting to be written by all of the pools */
+	static int32 NumPendingImages();
+
+	/** Sets the maximum number of in-flight images of each pool, non-positive values disable the limit */
+	static void SetMaxInFlightImages(const int32 MaxImages) { MaxInFlightImages = MaxImages; }
+
+	/** IImageWriteQueue interface */
+	TFuture<bool> Enqueue(TUniquePtr<IImageWriteTaskBase>&& InTask, bool bInsertAtFront = false) override;
+	TFuture<void> CreateFence() override;
+	TFuture<void> GetLastFence() override;
+	int32 GetNumPendingTasks() const override { return NumPendingTasks.GetValue(); }
+
+private:
+	/** Queued work that runs a single image write task */
+	class FWriteWork;
+
+	/** Handles the write task completion, releasing the blocked callers and fulfilling fences */
+	void OnTaskFinished();
+
+	/** Threads running the write tasks */
+	FQueuedThreadPool* ThreadPool;
+
+	/** Number of enqueued tasks that have not finished yet */
+	FThreadSafeCounter NumPendingTasks;
+
+	/** Event triggered each time a task finishes, used to wait for a free in-flight slot */
+	FEvent* TaskFinishedEvent;
+
+	/** Fences waiting for all of the pending tasks to finish */
+	TArray<TPromise<void>> PendingFences;
+
+	/** Guards the pending fences */
+	FCriticalSection FencesCriticalSection;
+
+	/** Writer pools of each image format */
+	static TMap<EImageFormat, TUniquePtr<FImageWriterPool>> Pools;
+
+	/** Maximum number of in-flight images of each pool */
+	static int32 MaxInFlightImages;
+
+	/** Interval at which blocked callers re-check the number of in-flight images */
+	static const uint32 InFlightWaitIntervalMs;
+
+	/** Stack size of the writer threads, large enough for image encoders */
+	static const uint32 WriterThreadStackSize;
+};
@@ -0,0 +1,115 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Class that post-processes rendered optical flow images of a single camera once the rendering finishes
+ * Each flow image is converted into raw pixel offsets and written together with occlusion and consistency masks,
+ * computed by reprojecting the rendered depth into the neighbouring frames using camera poses
+ * Frames are processed in parallel, each frame only reads its own flow image and nearby depth images
+*/
+class FOpticalFlowPostProcessor
+{
+public:
+	FOpticalFlowPostProcessor(
+		const float OpticalFlowScale,
+		const float DepthScaleMeters,
+		const TArray<FTransform>& CameraPoses,
+		const int FirstPoseFrame,
+		const float FieldOfView) :
+		OpticalFlowScale(OpticalFlowScale),
+		DepthScaleMeters(DepthScaleMeters),
+		CameraPoses(CameraPoses),
+		FirstPoseFrame(FirstPoseFrame),
+		FieldOfView(FieldOfView)
+	{}
+
+	/**
+	 * Processes exr flow and depth images found inside the camera directory, either inside their target directories,
+	 * or inside the packed images directory, writing the results into the optical flow data directory
+	*/
+	bool ProcessCameraDirectory(
+		const FString& CameraDirectory,
+		const FString& FlowDirName,
+		const FString& DepthDirName,
+		const FString& PackedDirName) const;
+
+	/** Decodes the optical flow color into the offset from a pixel to the position of its content in the previous frame */
+	static FVector2f DecodeFlowColor(const float R, const float G, const float B, const FIntPoint& Size, const float Scale);
+
+private:
+	/** Decoded image channels of a single frame, stored row by row */
+	struct FFrameChannels
+	{
+		/** Size of the image */
+		FIntPoint Size = FIntPoint::ZeroValue;
+
+		/** Channel values, one array per channel */
+		TArray<TArray64<float>> Channels;
+	};
+
+	/** Processes a single frame, the depth of neighbouring frames is optional */
+	bool ProcessFrame(
+		const int FrameNumber,
+		const FString& FlowFilePath,
+		const TMap<int, FString>& DepthFilePaths,
+		const FString& OutputFilePath) const;
+
+	/**
+	 * Computes the content position in the other frame and its expected depth in centimeters for each pixel,
+	 * by reprojecting the depth using the camera poses, returns false if any of the poses is missing
+	*/
+	bool ReprojectDepth(
+		const FFrameChannels& Depth,
+		const int FrameNumber,
+		const int OtherFrameNumber,
+		TArray64<float>& OutX,
+		TArray64<float>& OutY,
+		TArray64<float>& OutDepth) const;
+
+	/** Reads the flow image, decoding color-coded flow if the image has no offset channels */
+	bool ReadFlow(const FString& FilePath, FFrameChannels& OutFlow) const;
+
+	/** Reads the depth image, with values converted to centimeters */
+	bool ReadDepth(const FString& FilePath, FFrameChannels& OutDepth) const;
+
+	/** Finds exr images inside the directory, keyed by their frame numbers */
+	static TMap<int, FString> FindFrameFiles(const FString& Directory);
+
+	/** Reads the first set of channels found inside the exr image */
+	static bool ReadExrChannels(
+		const FString& FilePath,
+		const TArray<TArray<FString>>& ChannelSets,
+		FFrameChannels& OutChannels);
+
+	/** Writes the decoded flow and masks into the exr image, masks are stored as half channels */
+	static bool WriteExr(
+		const FString& FilePath,
+		const FIntPoint& Size,
+		const TArray<TPair<FString, const TArray64<float>*>>& FloatChannels,
+		const TArray<TPair<FString, const TArray64<FFloat16>*>>& HalfChannels);
+
+	/** The scale optical flow colors were rendered with */
+	const float OpticalFlowScale;
+
+	/** Depth in meters represented by the depth image value of 1, the depth range unless depth is metric */
+	const float DepthScaleMeters;
+
+	/** Camera poses, one per frame starting at the first pose frame */
+	const TArray<FTransform> CameraPoses;
+
+	/** Sequence frame number of the first camera pose */
+	const int FirstPoseFrame;
+
+	/** Horizontal field of view of the camera in degrees */
+	const float FieldOfView;
+
+	/** Relative difference between the expected and the rendered depth above which the content is occluded */
+	static const float OcclusionDepthTolerance;
+
+	/** Distance in pixels between the rendered flow and the reprojected position above which the flow is inconsistent */
+	static const float ConsistencyTolerancePixels;
+};
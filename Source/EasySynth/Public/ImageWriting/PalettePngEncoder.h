@@ -0,0 +1,36 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Class that encodes flat color images into palette-indexed 8-bit PNG images
+ * Each pixel is stored as a single palette index instead of four color channels, which makes compressing and reading
+ * the image much cheaper, while the colors stay exact as long as all of them are found inside the palette
+*/
+class FPalettePngEncoder
+{
+public:
+	explicit FPalettePngEncoder(const TArray<FColor>& Palette);
+
+	/** Encodes the image, returns false if the palette is too large or some of the pixel colors are not inside it */
+	bool Encode(const FIntPoint Size, const TArray64<FColor>& Pixels, TArray64<uint8>& OutData) const;
+
+	/** Maximum number of colors of an 8-bit palette */
+	static const int MaxPaletteSize;
+
+private:
+	/** Appends the PNG chunk consisting of the data length, the chunk type, the data and the checksum */
+	static void AppendChunk(const char* ChunkType, const TArray64<uint8>& ChunkData, TArray64<uint8>& OutData);
+
+	/** Appends the 32-bit value in the big-endian byte order used by PNG */
+	static void AppendUInt32(const uint32 Value, TArray64<uint8>& OutData);
+
+	/** Palette colors, in the order of their indices */
+	TArray<FColor> Palette;
+
+	/** Palette indices of the opaque colors, for colors appearing multiple times the first index is used */
+	TMap<FColor, uint8> PaletteIndices;
+};
@@ -0,0 +1,111 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MoviePipelineImageSequenceOutput.h"
+
+#include "ImageWriting/ImagePyramid.h"
+
+#include "PooledImageSequenceOutputs.generated.h"
+
+class IImageWriteQueue;
+
+
+/**
+ * Shared implementation of the pooled 8-bit image sequence outputs,
+ * which hands the rendered pixel data to the writer pool without converting it on the game thread
+*/
+class FEncodedImageSequenceOutput
+{
+public:
+	/** Enqueues one encoded image write task for each render pass of the merged frame, which also writes its pyramid levels */
+	static void EnqueueFrame(
+		UMoviePipelineImageSequenceOutputBase* Output,
+		IImageWriteQueue* ImageWriteQueue,
+		FMoviePipelineMergerOutputFrame* MergedOutputFrame,
+		const EImageFormat ImageFormat,
+		const FImagePyramidSettings& PyramidSettings,
+		const bool bConvertToSrgb,
+		const TArray<FColor>& Palette = TArray<FColor>());
+
+	/**
+	 * Gives the main render pass of the merged frame the provided name, so that it is written the same way as the target
+	 * it renders, the main pass keeps its engine name if the provided name is empty
+	*/
+	static void RenameMainPass(FMoviePipelineMergerOutputFrame* MergedOutputFrame, const FString& MainPassName);
+
+	/** Name the engine gives to the main render pass */
+	static const TCHAR* EngineMainPassName;
+
+private:
+	/** Returns true if no other enabled output receives the merged frames, so their pixel data does not have to be copied */
+	static bool IsOnlyEnabledOutput(const UMoviePipelineImageSequenceOutputBase* Output);
+};
+
+
+/**
+ * JPEG image sequence output that writes images using the plugin JPEG writer pool
+*/
+UCLASS()
+class UMoviePipelineImageSequenceOutput_JPGLocal : public UMoviePipelineImageSequenceOutput_JPG
+{
+	GENERATED_BODY()
+
+public:
+	/** Writes the frame through encoded image write tasks, which convert the pixel data to 8 bits on the writer threads */
+	void OnReceiveImageDataImpl(FMoviePipelineMergerOutputFrame* InMergedOutputFrame) override;
+
+	/** Downsampled image levels written next to each image */
+	UPROPERTY()
+	FImagePyramidSettings PyramidSettings;
+
+	/** Whether rendered linear colors are sRGB encoded, data values such as encoded ids are written unchanged */
+	UPROPERTY()
+	bool bConvertToSrgb = true;
+
+	/** Name written in place of the main render pass name, the engine name is kept if empty */
+	UPROPERTY()
+	FString MainPassName;
+
+protected:
+	/** Replaces the engine image write queue with the writer pool */
+	void SetupForPipelineImpl(UMoviePipeline* InPipeline) override;
+};
+
+
+/**
+ * PNG image sequence output that writes images using the plugin PNG writer pool
+*/
+UCLASS()
+class UMoviePipelineImageSequenceOutput_PNGLocal : public UMoviePipelineImageSequenceOutput_PNG
+{
+	GENERATED_BODY()
+
+public:
+	/** Writes the frame through encoded image write tasks, which convert the pixel data to 8 bits on the writer threads */
+	void OnReceiveImageDataImpl(FMoviePipelineMergerOutputFrame* InMergedOutputFrame) override;
+
+	/** Downsampled image levels written next to each image */
+	UPROPERTY()
+	FImagePyramidSettings PyramidSettings;
+
+	/** Whether rendered linear colors are sRGB encoded, data values such as encoded ids are written unchanged */
+	UPROPERTY()
+	bool bConvertToSrgb = true;
+
+	/** Name written in place of the main render pass name, the engine name is kept if empty */
+	UPROPERTY()
+	FString MainPassName;
+
+	/**
+	 * Colors of palette-indexed images, with the index of each color matching its position
+	 * Images are written with all color channels if empty, or if some of their colors are not inside the palette
+	*/
+	UPROPERTY()
+	TArray<FColor> Palette;
+
+protected:
+	/** Replaces the engine image write queue with the writer pool */
+	void SetupForPipelineImpl(UMoviePipeline* InPipeline) override;
+};
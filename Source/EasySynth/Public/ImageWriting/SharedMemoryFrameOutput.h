@@ -0,0 +1,81 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MoviePipelineOutputBase.h"
+
+#include "SharedMemoryFrameOutput.generated.h"
+
+
+/**
+ * Camera whose frames are published by the shared memory output, together with its poses
+*/
+USTRUCT()
+struct FStreamedCamera
+{
+	GENERATED_BODY()
+
+	/** Name of the camera, matching the camera name of its render passes when all cameras are rendered in one job */
+	UPROPERTY()
+	FString Name;
+
+	/** Index of the camera inside the camera rig */
+	UPROPERTY()
+	int32 CameraId = 0;
+
+	/** Camera poses, one per frame starting at the first pose frame of the output */
+	UPROPERTY()
+	TArray<FTransform> Poses;
+};
+
+
+/**
+ * Output that publishes raw render pass pixels and camera poses to a shared memory frame ring,
+ * so that a process running on the same machine can consume frames without reading them back from disk
+ * Frames are published as they are received, without any conversion or encoding
+*/
+UCLASS()
+class UMoviePipelineSharedMemoryOutput : public UMoviePipelineOutputBase
+{
+	GENERATED_BODY()
+
+public:
+#if WITH_EDITOR
+	FText GetDisplayText() const override
+	{
+		return NSLOCTEXT("EasySynth", "SharedMemoryOutputDisplayName", "Shared Memory Frame Stream");
+	}
+#endif
+
+	/** Publishes the render passes of each camera of the merged frame into their own ring slot */
+	void OnReceiveImageDataImpl(FMoviePipelineMergerOutputFrame* InMergedOutputFrame) override;
+
+	/** Name of the shared memory region */
+	UPROPERTY()
+	FString RegionName;
+
+	/** Number of ring slots, how many frames a consumer can fall behind before frames are overwritten */
+	UPROPERTY()
+	int32 SlotCount = 4;
+
+	/** Size of each ring slot in bytes, large enough to hold all render passes of a single camera */
+	UPROPERTY()
+	int64 SlotSize = 0;
+
+	/** Rendered cameras, a single camera is used for all render passes regardless of their camera name */
+	UPROPERTY()
+	TArray<FStreamedCamera> Cameras;
+
+	/** Sequence frame number of the first camera pose */
+	UPROPERTY()
+	int32 FirstPoseFrame = 0;
+
+	/** Name published in place of the main render pass name, the engine name is kept if empty */
+	UPROPERTY()
+	FString MainPassName;
+
+private:
+	/** Returns the streamed camera matching the camera name of a render pass, or nullptr if there is none */
+	const FStreamedCamera* FindCamera(const FString& CameraName) const;
+};
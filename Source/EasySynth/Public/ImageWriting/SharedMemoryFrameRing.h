@@ -0,0 +1,134 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformMemory.h"
+
+
+/**
+ * Raw image layer published through the shared memory frame ring
+ * Pixels are stored row by row without padding, with interleaved channels
+*/
+struct FSharedMemoryFrameLayer
+{
+	/** Name of the layer, usually the render pass name */
+	FString Name;
+
+	/** Pixel channel type, 0 for 8-bit unsigned integers, 1 for 16-bit floats and 2 for 32-bit floats */
+	uint32 PixelType;
+
+	/** Number of channels of each pixel */
+	uint32 ChannelCount;
+
+	/** Layer width and height in pixels */
+	FIntPoint Size;
+
+	/** Raw pixel data, not owned */
+	const void* Data;
+
+	/** Size of the raw pixel data in bytes */
+	int64 DataSize;
+};
+
+
+/**
+ * Ring of frame slots inside a named shared memory region, which lets processes running on the same machine
+ * read rendered frames as soon as they are rendered, without encoding them or reading them from disk
+ * The region starts with the ring header, followed by the fixed size slots, each starting with its slot header
+ * Slot headers are guarded by sequence numbers, which are odd while the slot is being written,
+ * so readers can detect frames overwritten while they were reading them
+*/
+class FSharedMemoryFrameRing
+{
+public:
+	FSharedMemoryFrameRing(const FString& Name, const int32 SlotCount, const int64 SlotSize);
+	~FSharedMemoryFrameRing();
+
+	/** Returns the ring with the provided name, creating it on first use or if its size changed */
+	static FSharedMemoryFrameRing* Get(const FString& Name, const int32 SlotCount, const int64 SlotSize);
+
+	/** Unmaps all of the rings */
+	static void ReleaseRings();
+
+	/** Whether the shared memory region has been mapped */
+	bool IsValid() const { return Region != nullptr; }
+
+	/** Copies the frame seen by the rig camera into the next slot, returns false if the frame does not fit into a slot */
+	bool Publish(
+		const int32 FrameNumber,
+		const int32 CameraId,
+		const FVector& CameraLocation,
+		const FQuat& CameraRotation,
+		const TArray<FSharedMemoryFrameLayer>& Layers);
+
+	/** Maximum number of layers of a single frame */
+	static const int32 MaxLayerCount;
+
+private:
+	/** Header at the start of the region */
+	struct FRingHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 SlotCount;
+		uint32 SlotHeaderSize;
+		int64 SlotSize;
+		volatile int64 PublishedFrameCount;
+	};
+
+	/** Description of a single layer inside the slot header */
+	struct FLayerHeader
+	{
+		ANSICHAR Name[48];
+		uint32 PixelType;
+		uint32 ChannelCount;
+		uint32 Width;
+		uint32 Height;
+		int64 Offset;
+		int64 Size;
+	};
+
+	/** Header at the start of each slot */
+	struct FSlotHeader
+	{
+		volatile int64 Sequence;
+		int32 FrameNumber;
+		int32 LayerCount;
+		int32 CameraId;
+		int32 Reserved;
+		double CameraLocation[3];
+		double CameraRotation[4];
+		FLayerHeader Layers[8];
+	};
+
+	/** Returns the header of the slot with the provided index */
+	FSlotHeader* Slot(const int64 SlotIndex) const;
+
+	/** Name of the shared memory region */
+	const FString Name;
+
+	/** Number of slots inside the ring */
+	const int32 SlotCount;
+
+	/** Size of each slot, including its header */
+	const int64 SlotSize;
+
+	/** The mapped shared memory region */
+	FPlatformMemory::FSharedMemoryRegion* Region;
+
+	/** Header at the start of the region */
+	FRingHeader* Header;
+
+	/** Rings by their names */
+	static TMap<FString, TUniquePtr<FSharedMemoryFrameRing>> Rings;
+
+	/** Value identifying the region layout, the ASCII characters ESFR */
+	static const uint32 Magic;
+
+	/** Version of the region layout */
+	static const uint32 Version;
+
+	/** Size reserved for each slot header, the layer data starts right after */
+	static const uint32 SlotHeaderSize;
+};
@@ -0,0 +1,77 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IImageWrapper.h"
+
+
+/** Codecs rendered image sequences can be encoded with */
+enum class EVideoCodec : uint8
+{
+	H264,
+	HEVC,
+	AV1
+};
+
+
+/**
+ * Class that encodes the rendered image sequence of a single camera into one video file using the ffmpeg executable
+ * Hardware encoders of the codec are tried first, falling back to the software encoder if none of them is available
+ * The frame index written next to the video maps each video frame to the camera poses id and the sequence frame,
+ * as frames skipped by the rendering would otherwise shift the video frames
+*/
+class FVideoSequenceEncoder
+{
+public:
+	FVideoSequenceEncoder(
+		const FString& ExecutablePath,
+		const EVideoCodec Codec,
+		const double FrameRate,
+		const int FirstPoseFrame) :
+		ExecutablePath(ExecutablePath),
+		Codec(Codec),
+		FrameRate(FrameRate),
+		FirstPoseFrame(FirstPoseFrame)
+	{}
+
+	/** Encodes the images inside the directory into the video next to it, removing the directory on success */
+	bool EncodeDirectory(const FString& ImagesDirectory, const FString& ImageExtension) const;
+
+	/** Parses the codec name used by the render command */
+	static bool ParseCodec(const FString& CodecName, EVideoCodec& OutCodec);
+
+	/** Checks whether the ffmpeg executable can be run, so that missing encoders are reported before the rendering */
+	static bool IsExecutableAvailable(const FString& ExecutablePath);
+
+	/** Format of images rendered for the encoding, lossless so that the video encoding is the only lossy step */
+	static const EImageFormat ImageFormat;
+
+private:
+	/** Writes the ffmpeg concat list of images, in which every image lasts exactly one frame */
+	bool SaveInputList(const TArray<TPair<int, FString>>& Frames, const FString& FilePath) const;
+
+	/** Writes the index of sequence frames stored inside the video */
+	bool SaveFrameIndex(const TArray<TPair<int, FString>>& Frames, const FString& FilePath) const;
+
+	/** Runs ffmpeg using the provided encoder, returns true if the video was written */
+	bool RunEncoder(const FString& EncoderName, const FString& InputListPath, const FString& VideoFilePath) const;
+
+	/** Returns ffmpeg encoders of the codec in the order of preference, ending with the software encoder */
+	static TArray<FString> EncoderNames(const EVideoCodec Codec);
+
+	/** Path to the ffmpeg executable, a bare name is looked up inside the system path */
+	const FString ExecutablePath;
+
+	/** Codec the videos are encoded with */
+	const EVideoCodec Codec;
+
+	/** Frame rate of the encoded videos, matching the sequence display rate */
+	const double FrameRate;
+
+	/** Sequence frame that corresponds to the first line of camera poses files */
+	const int FirstPoseFrame;
+
+	/** Clean name of the ffmpeg concat list written inside the images directory */
+	static const FString InputListFileName;
+};
@@ -88,12 +88,27 @@ public:
 		return ProjectPluginContentDir() / WidgetStateAssetName;
 	}
 
+	/** Directory containing semantic class material instances */
+	static FString SemanticMaterialsDir()
+	{
+		return ProjectPluginContentDir() / SemanticMaterialsDirName;
+	}
+
+	/** Clean name of the semantic class material instance, which only depends on the class color */
+	static FString SemanticMaterialAssetName(const FColor& Color)
+	{
+		return FString::Printf(TEXT("MI_Semantic_%s"), *Color.ToHex());
+	}
+
 	/** Clean name of the texture mapping asset */
 	static const FString TextureMappingAssetName;
 
 	/** Clean name of the widget state asset */
 	static const FString WidgetStateAssetName;
 
+	/** Clean name of the semantic class material instances directory */
+	static const FString SemanticMaterialsDirName;
+
 	/**
 	 * Project output file saving utils
 	*/
@@ -116,6 +131,12 @@ public:
 		return Directory / SemanticClassesFileName;
 	}
 
+	/** Full path to the instance ids CSV file */
+	static FString InstanceIdsFilePath(const FString& Directory)
+	{
+		return Directory / InstanceIdsFileName;
+	}
+
 	/** Gets original camera name from the received camera component */
 	static FString GetCameraName(UCameraComponent* CameraComponent)
 	{
@@ -141,6 +162,76 @@ public:
 		return Directory / CameraPosesFileName;
 	}
 
+	/** Full path to the binary copy of the camera poses file */
+	static FString BinaryPosesFilePath(const FString& PosesFilePath)
+	{
+		return FPaths::ChangeExtension(PosesFilePath, BinaryPosesFileExtension);
+	}
+
+	/** Full path to the dataset archive with the provided id */
+	static FString DatasetArchiveFilePath(const FString& Directory, const int ArchiveId)
+	{
+		return Directory / FString::Printf(TEXT("%s-%06d.tar"), *DatasetArchiveBaseName, ArchiveId);
+	}
+
+	/** Full path to the index of entries stored inside dataset archives */
+	static FString DatasetIndexFilePath(const FString& Directory)
+	{
+		return Directory / DatasetIndexFileName;
+	}
+
+	/** Full path to the video encoded from the images inside the directory, stored next to the directory */
+	static FString VideoFilePath(const FString& ImagesDirectory)
+	{
+		return FString::Printf(TEXT("%s.%s"), *ImagesDirectory, *VideoFileExtension);
+	}
+
+	/** Full path to the index of sequence frames stored inside the video encoded from the directory */
+	static FString VideoFrameIndexFilePath(const FString& ImagesDirectory)
+	{
+		return ImagesDirectory + VideoFrameIndexFileSuffix;
+	}
+
+	/** Full path to the downsampled image pyramid level of the file, stored inside the level directory next to it */
+	static FString PyramidLevelFilePath(const FString& FilePath, const int Level)
+	{
+		if (Level == 0)
+		{
+			return FilePath;
+		}
+		return FPaths::GetPath(FilePath) / FString::Printf(TEXT("%s%d"), *PyramidLevelDirPrefix, Level) /
+			FPaths::GetCleanFilename(FilePath);
+	}
+
+	/** Parses the level of the image pyramid level directory name, returns false if the name is not a level directory */
+	static bool ParsePyramidLevelDirName(const FString& DirName, int& OutLevel)
+	{
+		const FString LevelString = DirName.RightChop(PyramidLevelDirPrefix.Len());
+		if (!DirName.StartsWith(PyramidLevelDirPrefix, ESearchCase::CaseSensitive) ||
+			LevelString.IsEmpty() || !LevelString.IsNumeric())
+		{
+			return false;
+		}
+		OutLevel = FCString::Atoi(*LevelString);
+		return OutLevel > 0;
+	}
+
+	/** Directory of the camera containing optical flow offsets and masks written by the post-processing */
+	static FString OpticalFlowDataDir(const FString& CameraDirectory)
+	{
+		return CameraDirectory / OpticalFlowDataDirName;
+	}
+
+	/** Full path to the render report JSON file, each shard writes its own report */
+	static FString RenderReportFilePath(const FString& Directory, const int ShardIndex, const int ShardCount)
+	{
+		if (ShardCount > 1)
+		{
+			return Directory / FString::Printf(TEXT("%s-Shard%d.json"), *RenderReportBaseName, ShardIndex);
+		}
+		return Directory / FString::Printf(TEXT("%s.json"), *RenderReportBaseName);
+	}
+
 	/** Clean name of the rendering output directory */
 	static const FString RenderingOutputDirName;
 
@@ -150,6 +241,33 @@ public:
 	/** Clean name of the semantic classes CSV output file */
 	static const FString SemanticClassesFileName;
 
+	/** Clean name of the instance ids CSV output file */
+	static const FString InstanceIdsFileName;
+
 	/** Clean name of the camera poses output file */
 	static const FString CameraPosesFileName;
+
+	/** Extension of binary camera poses files */
+	static const FString BinaryPosesFileExtension;
+
+	/** Base name of dataset archives, followed by the archive id */
+	static const FString DatasetArchiveBaseName;
+
+	/** Clean name of the dataset archives index file */
+	static const FString DatasetIndexFileName;
+
+	/** Extension of encoded video files */
+	static const FString VideoFileExtension;
+
+	/** Suffix appended to the images directory name to get the video frame index file name */
+	static const FString VideoFrameIndexFileSuffix;
+
+	/** Base name of render report files, followed by the shard index when sharded */
+	static const FString RenderReportBaseName;
+
+	/** Prefix of image pyramid level directories, followed by the level index */
+	static const FString PyramidLevelDirPrefix;
+
+	/** Clean name of the optical flow post-processing output directory */
+	static const FString OpticalFlowDataDirName;
 };
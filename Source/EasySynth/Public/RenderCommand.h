@@ -0,0 +1,57 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FRendererTargetOptions;
+class IConsoleObject;
+class USequenceRenderer;
+class UTextureStyleManager;
+
+
+/**
+ * Class that provides the console command for starting the rendering without the plugin widget,
+ * so that rendering can be run from batch jobs using the -ExecCmds command line argument, e.g.
+ * -ExecCmds="EasySynth.Render Sequences=/Game/Sequences/Seq Targets=ColorImage:jpeg,DepthImage:exr Output=D:/Out Quit"
+*/
+class FRenderCommand
+{
+public:
+	/** Registers the console command, using the provided texture style manager for rendering */
+	void Register(UTextureStyleManager* InTextureStyleManager);
+
+	/** Unregisters the console command */
+	void Unregister();
+
+private:
+	/** Handles the console command */
+	void OnRenderCommand(const TArray<FString>& Args);
+
+	/** Finds level sequence assets from the comma separated list of sequences and the sequences folder */
+	bool FindSequences(const FString& SequencesValue, const FString& FolderValue, TArray<FAssetData>& OutSequences) const;
+
+	/** Selects targets and their formats from the comma separated list of target:format pairs */
+	bool ParseTargets(const FString& TargetsValue, FRendererTargetOptions& OutRendererTargetOptions) const;
+
+	/** Handles the sequence renderer finished event */
+	void OnRenderingFinished(bool bSuccess);
+
+	/** Registered console command */
+	IConsoleObject* ConsoleCommand = nullptr;
+
+	/**
+	 * Module that runs sequence rendering,
+	 * must be added to the root to avoid garbage collection
+	*/
+	USequenceRenderer* SequenceRenderer = nullptr;
+
+	/** Manager whose actor classes are updated by the command before rendering */
+	UTextureStyleManager* TextureStyleManager = nullptr;
+
+	/** Whether the editor should be closed once the rendering finishes */
+	bool bQuitOnFinish = false;
+
+	/** The name of the console command */
+	static const TCHAR* CommandName;
+};
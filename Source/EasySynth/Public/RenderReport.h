@@ -0,0 +1,117 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "RenderReport.generated.h"
+
+
+/**
+ * Structure representing a single camera and target job inside of the render report JSON file.
+ * Member names are lower case, as they need to exactly match the JSON file content.
+ */
+USTRUCT()
+struct FRenderReportJob
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Name of the rendered camera, or all when all rig cameras are rendered in one job */
+	UPROPERTY()
+	FString camera;
+
+	/** Name of the rendered target */
+	UPROPERTY()
+	FString target;
+
+	/** Number of movie pipeline jobs, one per sequence frame range */
+	UPROPERTY()
+	int job_count = 0;
+
+	/** Number of rendered frames over all sequences and cameras */
+	UPROPERTY()
+	int frames = 0;
+
+	/** Time spent preparing sequences and the level for the target, including texture style checkouts */
+	UPROPERTY()
+	double preparation_seconds = 0.0;
+
+	/** Time spent waiting for the world to become ready before starting the movie pipeline */
+	UPROPERTY()
+	double pause_seconds = 0.0;
+
+	/** Time from starting the movie pipeline until all of its outputs are written */
+	UPROPERTY()
+	double render_seconds = 0.0;
+
+	/** Rendered frames per second of the render time */
+	UPROPERTY()
+	double frames_per_second = 0.0;
+
+	/** Growth of the target output directories while rendering */
+	UPROPERTY()
+	int64 bytes_written = 0;
+};
+
+
+/**
+ * Structure representing the exact structure of render report JSON files.
+ * Member names are lower case, as they need to exactly match the JSON file content.
+ */
+USTRUCT()
+struct FRenderReportContent
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Whether the rendering finished successfully */
+	UPROPERTY()
+	bool success = false;
+
+	/** Index of the rendered shard */
+	UPROPERTY()
+	int shard_index = 0;
+
+	/** Number of shards the rendering is split into */
+	UPROPERTY()
+	int shard_count = 1;
+
+	/** Name of the scheduler that ordered the camera and target jobs */
+	UPROPERTY()
+	FString scheduler;
+
+	/** Wall time of the whole rendering */
+	UPROPERTY()
+	double total_seconds = 0.0;
+
+	/** Time spent opening sequences and exporting sequence metadata */
+	UPROPERTY()
+	double sequence_preparation_seconds = 0.0;
+
+	/** Time spent creating target materials and compiling their shaders */
+	UPROPERTY()
+	double warm_up_seconds = 0.0;
+
+	/** Time spent exporting camera poses */
+	UPROPERTY()
+	double camera_pose_export_seconds = 0.0;
+
+	/** Time spent encoding videos and packing archives after all targets are rendered */
+	UPROPERTY()
+	double output_finalization_seconds = 0.0;
+
+	/** Number of rendered frames of all jobs */
+	UPROPERTY()
+	int frames = 0;
+
+	/** Bytes written by all jobs */
+	UPROPERTY()
+	int64 bytes_written = 0;
+
+	/** Peak physical memory used by the editor process */
+	UPROPERTY()
+	int64 peak_used_physical_bytes = 0;
+
+	/** Camera and target jobs, in the rendering order */
+	UPROPERTY()
+	TArray<FRenderReportJob> camera_target_jobs;
+};
@@ -0,0 +1,86 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "TextureStyles/TextureStyleManager.h"
+
+class FRendererTarget;
+
+
+/** Enum representing available orders of rendering work items */
+enum class ERenderSchedulerType : uint8
+{
+	CAMERA_MAJOR,
+	TEXTURE_STYLE_MAJOR
+};
+
+
+/** Structure representing a single work item, rendering one target for one rig camera iteration */
+struct FRenderWorkItem
+{
+	/** Id of the rig camera, zero when all rig cameras are rendered in one job */
+	int RigCameraId;
+
+	/** Target to be rendered */
+	TSharedPtr<FRendererTarget> Target;
+
+	/**
+	 * Id of the first distributed work item of this item, followed by the ids of its sequence frame ranges
+	 * Ids are assigned in the camera-major order, so that shards split the work the same way regardless of the order
+	*/
+	int FirstShardWorkItemId;
+};
+
+
+/**
+ * Base class of rendering schedulers, which order the work items to reduce the amount of state changes
+ * between them, e.g. texture style checkouts, rig camera moves or target material binds
+ * New orders are added by implementing this class and adding its type to Create
+*/
+class FRenderScheduler
+{
+public:
+	virtual ~FRenderScheduler() {}
+
+	/** Returns the scheduler name, used inside logs and render reports */
+	virtual FString Name() const = 0;
+
+	/**
+	 * Orders the work items, provided in the camera-major order
+	 * The provided texture style is the one selected before the rendering, which is restored once it finishes
+	*/
+	virtual void Schedule(TArray<FRenderWorkItem>& WorkItems, const ETextureStyle InitialTextureStyle) const = 0;
+
+	/** Creates the scheduler of the provided type */
+	static TUniquePtr<FRenderScheduler> Create(const ERenderSchedulerType SchedulerType);
+
+	/** Parses the scheduler type name, returns false if the name is not known */
+	static bool ParseSchedulerType(const FString& SchedulerName, ERenderSchedulerType& OutSchedulerType);
+};
+
+
+/** Scheduler that renders all targets of a rig camera before moving to the next one */
+class FCameraMajorRenderScheduler : public FRenderScheduler
+{
+public:
+	FString Name() const override { return TEXT("CameraMajor"); }
+
+	void Schedule(TArray<FRenderWorkItem>& WorkItems, const ETextureStyle InitialTextureStyle) const override {}
+};
+
+
+/**
+ * Scheduler that renders all cameras of targets sharing a texture style before checking out the next style,
+ * so the whole level is repainted once per style instead of once per camera and style
+ * Inside a style, all of its targets are rendered for a camera before moving to the next one,
+ * so that textures streamed in for a camera view stay useful
+*/
+class FTextureStyleMajorRenderScheduler : public FRenderScheduler
+{
+public:
+	FString Name() const override { return TEXT("TextureStyle"); }
+
+	void Schedule(TArray<FRenderWorkItem>& WorkItems, const ETextureStyle InitialTextureStyle) const override;
+};
@@ -4,10 +4,8 @@
 
 #include "CoreMinimal.h"
 
-#include "LevelSequence.h"
-
-#include "SequencerWrapper.h"
-
+class FBackgroundFileWriter;
+class FSequencerWrapper;
 class UCameraComponent;
 
 
@@ -18,32 +16,103 @@ class UCameraComponent;
 class FCameraPoseExporter
 {
 public:
+	/** Binary poses are written next to the CSV files if requested */
+	explicit FCameraPoseExporter(const bool bSaveBinaryPoses = false) :
+		bSaveBinaryPoses(bSaveBinaryPoses)
+	{}
+
 	/**
-	 * Export camera poses from the sequence to a file,
+	 * Export camera poses from the opened sequence to a file,
 	 * to export rig poses, pass nullptr for the CameraComponent
 	 */
 	bool ExportCameraPoses(
-		ULevelSequence* LevelSequence,
+		const FSequencerWrapper& SequencerWrapper,
 		const FIntPoint OutputImageResolution,
 		const FString& OutputDir,
 		UCameraComponent* CameraComponent);
 
+	/**
+	 * Export poses of multiple cameras from the sequence to their files, optionally including rig poses
+	 * Rig poses are only extracted once, and then offset by the relative transform of each camera
+	 * Files are written in the background if the writer is provided, as only extracting the poses needs the game thread
+	*/
+	bool ExportCameraPoses(
+		const FSequencerWrapper& SequencerWrapper,
+		const FIntPoint OutputImageResolution,
+		const FString& OutputDir,
+		const TArray<UCameraComponent*>& CameraComponents,
+		const bool bExportRigPoses,
+		FBackgroundFileWriter* FileWriter = nullptr);
+
+	/**
+	 * Extracts poses of multiple cameras from the sequence without writing them, one pose per frame
+	 * Poses start at the first frame of the first camera cut section, which is returned as the OutFirstFrame
+	*/
+	bool ExtractCameraPoses(
+		const FSequencerWrapper& SequencerWrapper,
+		const TArray<UCameraComponent*>& CameraComponents,
+		TArray<TArray<FTransform>>& OutCameraPoses,
+		int& OutFirstFrame);
+
+	/**
+	 * Selects the frames to be rendered, and restricts the exported poses to them, returns pose ids of selected frames
+	 * Every FrameStride-th frame is considered, and if any of the keyframe thresholds is positive,
+	 * only frames where the rig moved by at least the distance in centimeters or the angle in degrees
+	 * since the previously selected frame are selected
+	*/
+	bool SelectFrames(
+		const FSequencerWrapper& SequencerWrapper,
+		const int FrameStride,
+		const float KeyframeDistance,
+		const float KeyframeAngle,
+		TArray<int>& OutPoseIds);
+
 private:
-	/** Extract camera transforms using the sequencer wrapper */
-	bool ExtractCameraTransforms(const bool bAccumulateCameraOffset);
+	/** Extract camera rig transforms using the sequencer wrapper */
+	bool ExtractCameraTransforms(const FSequencerWrapper& SequencerWrapper);
+
+	/** Saves the extracted camera poses offset by each of the relative camera transforms to its files, in parallel */
+	bool SavePoseFiles(const TArray<FString>& FilePaths, const TArray<FTransform>& CameraOffsets) const;
+
+	/** Saves the extracted camera poses offset by the relative camera transform to a file, can run on any thread */
+	bool SavePosesToCSV(const FString& FilePath, const FTransform& CameraOffset) const;
+
+	/**
+	 * Saves the extracted camera poses offset by the relative camera transform to a numpy .npy file,
+	 * containing a little-endian float64 array with one row per frame and the same columns as the CSV file
+	*/
+	bool SavePosesToNpy(const FString& FilePath, const FTransform& CameraOffset) const;
+
+	/** Returns the number of exported poses */
+	int ExportedPoseCount() const;
 
-	/** Saves the extracted camera poses to a file */
-	bool SavePosesToCSV(const FString& FilePath);
+	/** Returns the pose id, i.e. the frame index of the exported pose */
+	int ExportedPoseId(const int ExportedPoseIndex) const;
 
-	/** Sequencer wrapper needed to acces the level sequence properties */
-	FSequencerWrapper SequencerWrapper;
+	/** Returns the camera pose of the frame, offset by the relative camera transform and without scaling */
+	FTransform CameraPose(const int Frame, const FTransform& CameraOffset) const;
+
+	/** Whether poses should also be written as binary files */
+	const bool bSaveBinaryPoses;
 
 	/** Resolution of output images */
 	FIntPoint OutputResolution;
 
-	/** Extracted camera pose transforms */
+	/** Extracted camera rig pose transforms */
 	TArray<FTransform> CameraTransforms;
 
 	/** Frame timestamps */
 	TArray<double> Timestamps;
+
+	/** Whether the camera rig transforms have already been extracted, so that they are not extracted again */
+	bool bTransformsExtracted = false;
+
+	/** Pose ids of frames selected for rendering, all poses are exported if empty */
+	TArray<int> SelectedPoseIds;
+
+	/**
+	 * Maximum number of frames interrogated by a single interrogator update
+	 * Interrogation data grows with the number of interrogations, so long sections are split into batches
+	*/
+	static const int InterrogationBatchSize;
 };
@@ -22,9 +22,27 @@ public:
 	/** Returns the name of the target */
 	virtual FString Name() const { return TEXT("ColorImage"); }
 
+	/** Returns the name of the target layer inside packed EXR images */
+	FString LayerName() const override { return TEXT("color"); }
+
+	/** Returns the texture style needed while rendering the target */
+	ETextureStyle TextureStyle() const override;
+
+	/** Color images are compressed using the lossy DWAB, with the level selected by the renderer options */
+	EEXRCompressionFormatLocal ExrCompression() const override;
+
+	/** Color images are downsampled by averaging, as their pixels do not hold ids */
+	bool AveragesPyramidLevels() const override { return true; }
+
+	/** Color images keep being the final image of the main pass when grouped with other targets */
+	bool RendersMainPass() const override { return true; }
+
+	/** Creates the post process material that renders the target */
+	UMaterialInterface* CreatePostProcessMaterial() override;
+
 	/** Prepares the sequence for rendering the target */
-	bool PrepareSequence(ULevelSequence* LevelSequence) override;
+	bool PrepareSequence(const FSequencerWrapper& SequencerWrapper) override;
 
 	/** Reverts changes made to the sequence by the PrepareSequence */
-	bool FinalizeSequence(ULevelSequence* LevelSequence) override;
+	bool FinalizeSequence(const FSequencerWrapper& SequencerWrapper) override;
 };
@@ -26,11 +26,23 @@ public:
 	/** Returns the name of the target */
 	virtual FString Name() const { return TEXT("CustomPPMaterial"); }
 
+	/** Returns the name of the target layer inside packed EXR images */
+	FString LayerName() const override { return TEXT("custom"); }
+
+	/** Returns the texture style needed while rendering the target */
+	ETextureStyle TextureStyle() const override;
+
+	/** Creates the post process material that renders the target */
+	UMaterialInterface* CreatePostProcessMaterial() override;
+
+	/** Each custom material is cached separately */
+	FString PostProcessMaterialKey() const override;
+
 	/** Prepares the sequence for rendering the target */
-	bool PrepareSequence(ULevelSequence* LevelSequence) override;
+	bool PrepareSequence(const FSequencerWrapper& SequencerWrapper) override;
 
 	/** Reverts changes made to the sequence by the PrepareSequence */
-	bool FinalizeSequence(ULevelSequence* LevelSequence) override;
+	bool FinalizeSequence(const FSequencerWrapper& SequencerWrapper) override;
 
 private:
 	UMaterial* CustomPPMaterial;
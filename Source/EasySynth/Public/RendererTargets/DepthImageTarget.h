@@ -19,24 +19,53 @@ public:
 	explicit FDepthImageTarget(
 		UTextureStyleManager* TextureStyleManager,
 		const EImageFormat ImageFormat,
-		const float DepthRangeMeters) :
+		const float DepthRangeMeters,
+		const bool bMetricDepth = false) :
 			FRendererTarget(TextureStyleManager, ImageFormat),
-			DepthRangeMeters(DepthRangeMeters)
+			DepthRangeMeters(DepthRangeMeters),
+			bMetricDepth(bMetricDepth)
 	{}
 
 	/** Returns the name of the target */
 	virtual FString Name() const { return TEXT("DepthImage"); }
 
+	/** Returns the name of the target layer inside packed EXR images */
+	FString LayerName() const override { return TEXT("depth"); }
+
+	/** Returns the texture style needed while rendering the target */
+	ETextureStyle TextureStyle() const override;
+
+	/**
+	 * Creates the post process material that renders the target,
+	 * in the metric mode it outputs the depth in meters directly, bypassing the tonemapper
+	*/
+	UMaterialInterface* CreatePostProcessMaterial() override;
+
+	/** Depth materials depend on the depth range and the metric mode */
+	FString PostProcessMaterialKey() const override;
+
+	/** Depth is a single value, so only one channel is stored */
+	EEXRChannelLayoutLocal ExrChannelLayout() const override;
+
 	/** Prepares the sequence for rendering the target */
-	bool PrepareSequence(ULevelSequence* LevelSequence) override;
+	bool PrepareSequence(const FSequencerWrapper& SequencerWrapper) override;
 
 	/** Reverts changes made to the sequence by the PrepareSequence */
-	bool FinalizeSequence(ULevelSequence* LevelSequence) override;
+	bool FinalizeSequence(const FSequencerWrapper& SequencerWrapper) override;
 
 private:
+	/** Creates the post process material that outputs the linear depth in meters */
+	UMaterialInterface* MetricDepthPostProcessMaterial() const;
+
 	/** The clipping range meters when rendering the depth target */
 	const float DepthRangeMeters;
 
+	/** Whether the depth is written in meters instead of being normalized by the depth range */
+	const bool bMetricDepth;
+
+	/** The largest depth in meters that half float images can represent, used for pixels without geometry */
+	static const float MaxMetricDepthMeters;
+
 	/** The name of the depth range meters material parameter */
 	static const FString DepthRangeMetersParameter;
 };
@@ -0,0 +1,60 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "RendererTargets/RendererTarget.h"
+
+class UTextureStyleManager;
+
+
+/**
+ * Class responsible for updating the world properties before
+ * the instance id image target rendering and restoring them after the rendering,
+ * instance ids are encoded as 24-bit integers inside the RGB channels of each pixel
+*/
+class FInstanceIdImageTarget : public FRendererTarget
+{
+public:
+	explicit FInstanceIdImageTarget(UTextureStyleManager* TextureStyleManager, const EImageFormat ImageFormat) :
+		FRendererTarget(TextureStyleManager, ImageFormat)
+	{}
+
+	/** Returns the name of the target */
+	virtual FString Name() const { return TEXT("InstanceIdImage"); }
+
+	/** Returns the name of the target layer inside packed EXR images */
+	FString LayerName() const override { return TEXT("instance_id"); }
+
+	/** Returns the texture style needed while rendering the target */
+	ETextureStyle TextureStyle() const override;
+
+	/** Ids have to be exact, and their flat regions compress well using the lossless ZIP */
+	EEXRCompressionFormatLocal ExrCompression() const override;
+
+	/**
+	 * Creates the post process material that renders the target,
+	 * it outputs the scene color directly, bypassing the tonemapper
+	*/
+	UMaterialInterface* CreatePostProcessMaterial() override;
+
+	/** Prepares the sequence for rendering the target */
+	bool PrepareSequence(const FSequencerWrapper& SequencerWrapper) override;
+
+	/** Reverts changes made to the sequence by the PrepareSequence */
+	bool FinalizeSequence(const FSequencerWrapper& SequencerWrapper) override;
+
+	/** Blending neighboring ids would produce ids of unrelated actors */
+	bool RequiresAntiAliasing() const override { return false; }
+
+	/** Encoded id bytes would not survive the sRGB encoding */
+	bool WritesDataValues() const override { return true; }
+
+private:
+	/**
+	 * Checks that ids survive encoding, storing as rendered half float values, quantizing and decoding,
+	 * using every byte value of each channel together with boundary and bit pattern ids
+	*/
+	static bool VerifyIdEncoding();
+};
@@ -0,0 +1,103 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/StrongObjectPtr.h"
+
+#include "RendererTargets/RendererTarget.h"
+
+class UTextureStyleManager;
+
+
+/**
+ * Class that groups multiple renderer targets sharing the same texture style and output format,
+ * so that all of them are rendered by a single rendering job, color images by the main pass
+ * and other targets as additional post process passes
+*/
+class FMultiPassTarget : public FRendererTarget
+{
+public:
+	explicit FMultiPassTarget(
+		UTextureStyleManager* TextureStyleManager,
+		const EImageFormat ImageFormat,
+		const ETextureStyle GroupTextureStyle,
+		const bool bPackedExr = false) :
+			FRendererTarget(TextureStyleManager, ImageFormat),
+			GroupTextureStyle(GroupTextureStyle),
+			bPackedExr(bPackedExr && ImageFormat == EImageFormat::EXR)
+	{}
+
+	/** Returns the name of the target */
+	virtual FString Name() const { return TEXT("MultiPass"); }
+
+	/** Returns the texture style shared by all grouped targets */
+	ETextureStyle TextureStyle() const override { return GroupTextureStyle; }
+
+	/** Grouped targets provide their own materials through render passes, so no camera material is created */
+	UMaterialInterface* CreatePostProcessMaterial() override { return nullptr; }
+
+	/** Grouped targets create the pass materials, so they share the cache */
+	void SetPostProcessMaterialCache(FPostProcessMaterialCache* MaterialCache) override;
+
+	/** Prepares the sequence for rendering the target */
+	bool PrepareSequence(const FSequencerWrapper& SequencerWrapper) override;
+
+	/** Reverts changes made to the sequence by the PrepareSequence */
+	bool FinalizeSequence(const FSequencerWrapper& SequencerWrapper) override;
+
+	/** Adds a post process pass of each grouped target to the deferred render pass */
+	bool ConfigureRenderPass(UMoviePipelineDeferredPassBase* DeferredPass) override;
+
+	/** Anti-aliasing is kept if any of the grouped targets requires it */
+	bool RequiresAntiAliasing() const override;
+
+	/** Grouped targets are rendered as separate passes */
+	bool RendersMultiplePasses() const override { return true; }
+
+	/** Returns the name of the grouped target rendered by the main pass, empty if all targets are post process passes */
+	FString MainPassName() const override;
+
+	/** Each grouped target is written to its own directory, unless all of them are packed into the same images */
+	TArray<FString> OutputNames() const override;
+
+	/** Returns whether grouped targets are written as layers of a single EXR image per frame */
+	bool WritesPackedExr() const override { return bPackedExr; }
+
+	/** Returns the channel layouts of grouped targets, keyed by their layer names */
+	TMap<FString, EEXRChannelLayoutLocal> ExrPassChannelLayouts() const override;
+
+	/** Returns pass names of grouped targets downsampled by averaging */
+	TSet<FString> AveragedPyramidPasses() const override;
+
+	/** Adds a target to the group */
+	void AddTarget(TSharedPtr<FRendererTarget> Target) { Targets.Add(Target); }
+
+	/** Returns grouped targets */
+	const TArray<TSharedPtr<FRendererTarget>>& GetTargets() const { return Targets; }
+
+	/** Name of the output directory packed EXR images are written to */
+	static const TCHAR* PackedOutputName;
+
+private:
+	/** Returns the first grouped target that renders the main pass, null if there is none */
+	const TSharedPtr<FRendererTarget>* MainPassTarget() const;
+
+	/** Texture style shared by all grouped targets */
+	const ETextureStyle GroupTextureStyle;
+
+	/**
+	 * Whether grouped targets are written as named layers of a single EXR image per frame,
+	 * instead of each target being written to its own directory
+	*/
+	const bool bPackedExr;
+
+	/** Targets rendered as passes of a single job */
+	TArray<TSharedPtr<FRendererTarget>> Targets;
+
+	/**
+	 * Post process materials of grouped targets, in the same order as targets,
+	 * kept alive until the job finishes as render passes only hold soft references to them
+	*/
+	TArray<TStrongObjectPtr<UMaterialInterface>> PassMaterials;
+};
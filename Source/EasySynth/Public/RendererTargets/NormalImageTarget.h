@@ -23,9 +23,21 @@ public:
 	/** Returns the name of the target */
 	virtual FString Name() const { return TEXT("NormalImage"); }
 
+	/** Returns the name of the target layer inside packed EXR images */
+	FString LayerName() const override { return TEXT("normal"); }
+
+	/** Returns the texture style needed while rendering the target */
+	ETextureStyle TextureStyle() const override;
+
+	/** Normals are half floats that tolerate the small error of the B44 compression */
+	EEXRCompressionFormatLocal ExrCompression() const override;
+
+	/** Creates the post process material that renders the target */
+	UMaterialInterface* CreatePostProcessMaterial() override;
+
 	/** Prepares the sequence for rendering the target */
-	bool PrepareSequence(ULevelSequence* LevelSequence) override;
+	bool PrepareSequence(const FSequencerWrapper& SequencerWrapper) override;
 
 	/** Reverts changes made to the sequence by the PrepareSequence */
-	bool FinalizeSequence(ULevelSequence* LevelSequence) override;
+	bool FinalizeSequence(const FSequencerWrapper& SequencerWrapper) override;
 };
@@ -27,11 +27,26 @@ public:
 	/** Returns the name of the target */
 	virtual FString Name() const { return TEXT("OpticalFlowImage"); }
 
+	/** Returns the name of the target layer inside packed EXR images */
+	FString LayerName() const override { return TEXT("flow"); }
+
+	/** Returns the texture style needed while rendering the target */
+	ETextureStyle TextureStyle() const override;
+
+	/** Creates the post process material that renders the target */
+	UMaterialInterface* CreatePostProcessMaterial() override;
+
+	/** Optical flow materials depend on the flow scale */
+	FString PostProcessMaterialKey() const override;
+
+	/** Optical flow colors are stored decoded into pixel offsets */
+	EEXRChannelLayoutLocal ExrChannelLayout() const override;
+
 	/** Prepares the sequence for rendering the target */
-	bool PrepareSequence(ULevelSequence* LevelSequence) override;
+	bool PrepareSequence(const FSequencerWrapper& SequencerWrapper) override;
 
 	/** Reverts changes made to the sequence by PrepareSequence */
-	bool FinalizeSequence(ULevelSequence* LevelSequence) override;
+	bool FinalizeSequence(const FSequencerWrapper& SequencerWrapper) override;
 
 private:
 	/** The scaling coefficient for increasing the saturation of optical flow images */
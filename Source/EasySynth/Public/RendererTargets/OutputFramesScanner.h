@@ -0,0 +1,40 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IImageWrapper.h"
+
+
+/**
+ * Class that scans output directories for frames that have already been rendered,
+ * so that an interrupted rendering can be resumed without rendering them again
+*/
+class FOutputFramesScanner
+{
+public:
+	/** Finds frame numbers of all complete image files of the provided format inside the directory */
+	static TSet<int> FindCompleteFrames(const FString& Directory, const EImageFormat ImageFormat);
+
+	/** Checks if the image file was written completely, by checking the format specific file ending */
+	static bool IsImageFileComplete(const FString& FilePath, const EImageFormat ImageFormat);
+
+	/** Extracts the frame number from the digits at the end of the file name */
+	static bool ParseFrameNumber(const FString& FilePath, int& OutFrameNumber);
+
+	/** Returns the extension of output files of the provided format */
+	static FString FileExtension(const EImageFormat ImageFormat);
+
+private:
+	/** Checks if the PNG file ends with the IEND chunk */
+	static bool IsPngFileComplete(const TArray<uint8>& FileEnd);
+
+	/** Checks if the JPEG file ends with the end of image marker */
+	static bool IsJpegFileComplete(const TArray<uint8>& FileEnd);
+
+	/**
+	 * Checks if the EXR file contains all of its scanline chunks,
+	 * EXR files have no footer, so the header and the offset table are parsed to find the last chunk
+	*/
+	static bool IsExrFileComplete(FArchive& FileReader);
+};
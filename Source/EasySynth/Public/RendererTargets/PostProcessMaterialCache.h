@@ -0,0 +1,49 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/StrongObjectPtr.h"
+
+class UMaterialInterface;
+
+
+/**
+ * Class that keeps post process materials created by renderer targets during a rendering,
+ * so that targets recreated for each camera and sequence reuse materials instead of loading and compiling them again
+ * Materials are keyed by the target name and all of the parameters they are created with
+*/
+class FPostProcessMaterialCache
+{
+public:
+	/** Returns the cached material, or nullptr if there is none */
+	UMaterialInterface* Find(const FString& Key) const
+	{
+		const TStrongObjectPtr<UMaterialInterface>* Material = Materials.Find(Key);
+		return Material != nullptr ? Material->Get() : nullptr;
+	}
+
+	/** Stores the material, keeping it alive until the cache is emptied */
+	void Add(const FString& Key, UMaterialInterface* Material) { Materials.Emplace(Key, Material); }
+
+	/** Returns all cached materials */
+	TArray<UMaterialInterface*> GetMaterials() const
+	{
+		TArray<UMaterialInterface*> CachedMaterials;
+		for (const TPair<FString, TStrongObjectPtr<UMaterialInterface>>& Material : Materials)
+		{
+			CachedMaterials.Add(Material.Value.Get());
+		}
+		return CachedMaterials;
+	}
+
+	/** Releases all cached materials */
+	void Empty() { Materials.Empty(); }
+
+	/** Returns the number of cached materials */
+	int Num() const { return Materials.Num(); }
+
+private:
+	/** Cached materials, strong pointers keep them alive while they are not bound to any camera */
+	TMap<FString, TStrongObjectPtr<UMaterialInterface>> Materials;
+};
@@ -7,9 +7,15 @@
 
 #include "PathUtils.h"
 
+class FPostProcessMaterialCache;
+class FSequencerWrapper;
 class UCameraComponent;
-class ULevelSequence;
+class UMaterialInterface;
+class UMoviePipelineDeferredPassBase;
 
+enum class EEXRChannelLayoutLocal : uint8;
+enum class EEXRCompressionFormatLocal : uint8;
+enum class ETextureStyle : uint8;
 class UTextureStyleManager;
 
 
@@ -23,27 +29,105 @@ class FRendererTarget
 public:
 	explicit FRendererTarget(UTextureStyleManager* TextureStyleManager, const EImageFormat ImageFormat) :
 		ImageFormat(ImageFormat),
-		TextureStyleManager(TextureStyleManager)
+		TextureStyleManager(TextureStyleManager),
+		PostProcessMaterialCache(nullptr)
 	{}
 
+	virtual ~FRendererTarget() {}
+
 	/** Returns a name of a specific target */
 	virtual FString Name() const = 0;
 
+	/** Returns the name of the layer a specific target is written to inside packed EXR images */
+	virtual FString LayerName() const { return Name(); }
+
+	/** Returns the texture style the level needs to have while rendering a specific target */
+	virtual ETextureStyle TextureStyle() const = 0;
+
+	/** Returns the post process material that renders a specific target, reusing the cached one if available */
+	UMaterialInterface* PostProcessMaterial();
+
+	/** Creates the post process material that renders a specific target, if it is not found inside the cache */
+	virtual UMaterialInterface* CreatePostProcessMaterial() = 0;
+
+	/** Returns the key of the target material inside the cache, covering all parameters the material depends on */
+	virtual FString PostProcessMaterialKey() const { return Name(); }
+
+	/** Sets the material cache shared by targets of a rendering, without it materials are created on each request */
+	virtual void SetPostProcessMaterialCache(FPostProcessMaterialCache* MaterialCache)
+	{
+		PostProcessMaterialCache = MaterialCache;
+	}
+
 	/** Prepares the sequence for rendering a specific target */
-	virtual bool PrepareSequence(ULevelSequence* LevelSequence) = 0;
+	virtual bool PrepareSequence(const FSequencerWrapper& SequencerWrapper) = 0;
 
 	/** Reverts changes made to the sequence by the PrepareSequence */
-	virtual bool FinalizeSequence(ULevelSequence* LevelSequence) = 0;
+	virtual bool FinalizeSequence(const FSequencerWrapper& SequencerWrapper) = 0;
+
+	/** Prepares level state a specific target needs besides the texture style */
+	virtual bool PrepareLevel() { return true; }
+
+	/** Reverts changes made to the level by the PrepareLevel */
+	virtual void FinalizeLevel() {}
+
+	/**
+	 * Updates the deferred render pass setting of the job rendering the target,
+	 * a single target only renders the main pass with its material bound to cameras
+	*/
+	virtual bool ConfigureRenderPass(UMoviePipelineDeferredPassBase* DeferredPass);
+
+	/** Checks whether the target can be rendered with the anti-aliasing selected inside the config */
+	virtual bool RequiresAntiAliasing() const { return true; }
+
+	/** Checks whether the target renders multiple post process passes within a single job */
+	virtual bool RendersMultiplePasses() const { return false; }
+
+	/** Checks whether the target is the final image of the main render pass, instead of needing its own post process pass */
+	virtual bool RendersMainPass() const { return false; }
+
+	/** Returns the pass name outputs give to the main render pass, empty if the main pass keeps its engine name */
+	virtual FString MainPassName() const { return TEXT(""); }
+
+	/** Returns the channels the target stores inside EXR images, all rendered channels are stored by default */
+	virtual EEXRChannelLayoutLocal ExrChannelLayout() const;
+
+	/** Returns the compression of EXR images written for the target, lossless PIZ by default */
+	virtual EEXRCompressionFormatLocal ExrCompression() const;
+
+	/** Checks whether all of the rendered passes are written as layers of a single EXR image per frame */
+	virtual bool WritesPackedExr() const { return false; }
+
+	/** Returns the channel layouts of passes written as layers of packed EXR images, keyed by pass names */
+	virtual TMap<FString, EEXRChannelLayoutLocal> ExrPassChannelLayouts() const { return {}; }
+
+	/** Checks whether 8-bit images store the rendered values unchanged, instead of sRGB encoding them as colors */
+	virtual bool WritesDataValues() const { return false; }
+
+	/** Returns the palette of PNG images written as palette-indexed images, empty by default */
+	virtual TArray<FColor> PngPalette() const { return {}; }
+
+	/** Checks whether image pyramid levels are downsampled by averaging, instead of keeping the most frequent value */
+	virtual bool AveragesPyramidLevels() const { return false; }
+
+	/** Returns names of rendered passes whose image pyramid levels are downsampled by averaging */
+	virtual TSet<FString> AveragedPyramidPasses() const { return {}; }
+
+	/** Returns names of output directories the target writes to inside the camera directory */
+	virtual TArray<FString> OutputNames() const { return { Name() }; }
 
 	/** Output image format selected for this target */
 	const EImageFormat ImageFormat;
 
 protected:
-	/** Extracts camera components used by the level sequence */
-	TArray<UCameraComponent*> GetCameras(ULevelSequence* LevelSequence);
+	/** Returns camera components used by the level sequence, resolved when the sequence was opened */
+	const TArray<UCameraComponent*>& GetCameras(const FSequencerWrapper& SequencerWrapper);
 
 	/** Removes renderer target specific post-process materials */
-	bool ClearCameraPostProcess(ULevelSequence* LevelSequence);
+	bool ClearCameraPostProcess(const FSequencerWrapper& SequencerWrapper);
+
+	/** Replaces post-process materials of all sequence cameras with the provided material */
+	bool BindCameraPostProcess(const FSequencerWrapper& SequencerWrapper, UMaterialInterface* Material);
 
 	/** Returns the path to the specific target post process material */
 	inline UMaterial* LoadPostProcessMaterial() const
@@ -54,4 +138,7 @@ protected:
 
 	/** Handle for managing texture style in the level */
 	UTextureStyleManager* TextureStyleManager;
+
+	/** Materials shared by targets of the current rendering, owned by the sequence renderer */
+	FPostProcessMaterialCache* PostProcessMaterialCache;
 };
@@ -16,16 +16,68 @@ class UTextureStyleManager;
 class FSemanticImageTarget : public FRendererTarget
 {
 public:
-	explicit FSemanticImageTarget(UTextureStyleManager* TextureStyleManager, const EImageFormat ImageFormat) :
-		FRendererTarget(TextureStyleManager, ImageFormat)
+	explicit FSemanticImageTarget(
+		UTextureStyleManager* TextureStyleManager,
+		const EImageFormat ImageFormat,
+		const bool bStencilSemantics = false,
+		const bool bPaletteImages = false) :
+			FRendererTarget(TextureStyleManager, ImageFormat),
+			bStencilSemantics(bStencilSemantics),
+			bPaletteImages(bPaletteImages)
 	{}
 
 	/** Returns the name of the target */
 	virtual FString Name() const { return TEXT("SemanticImage"); }
 
+	/** Returns the name of the target layer inside packed EXR images */
+	FString LayerName() const override { return TEXT("semantic"); }
+
+	/** Returns the texture style needed while rendering the target */
+	ETextureStyle TextureStyle() const override;
+
+	/** Class colors have to be exact, and their flat regions compress well using the lossless ZIP */
+	EEXRCompressionFormatLocal ExrCompression() const override;
+
+	/** Semantic class colors indexed by class ids, if palette-indexed PNG images are requested */
+	TArray<FColor> PngPalette() const override;
+
+	/** Blended class colors at object edges would not be found inside the palette of palette-indexed images */
+	bool RequiresAntiAliasing() const override { return !WritesPaletteImages(); }
+
+	/** Creates the post process material that renders the target */
+	UMaterialInterface* CreatePostProcessMaterial() override;
+
+	/** Stencil semantics use a different material than semantic texture styles */
+	FString PostProcessMaterialKey() const override;
+
 	/** Prepares the sequence for rendering the target */
-	bool PrepareSequence(ULevelSequence* LevelSequence) override;
+	bool PrepareSequence(const FSequencerWrapper& SequencerWrapper) override;
 
 	/** Reverts changes made to the sequence by the PrepareSequence */
-	bool FinalizeSequence(ULevelSequence* LevelSequence) override;
+	bool FinalizeSequence(const FSequencerWrapper& SequencerWrapper) override;
+
+	/** Writes semantic class stencil values if stencil semantics are used */
+	bool PrepareLevel() override;
+
+	/** Restores original stencil values if stencil semantics are used */
+	void FinalizeLevel() override;
+
+private:
+	/** Checks whether PNG images are written as palette-indexed images */
+	bool WritesPaletteImages() const { return bPaletteImages && ImageFormat == EImageFormat::PNG; }
+
+	/**
+	 * Creates the post process material that maps custom stencil values to semantic class colors,
+	 * class colors are baked into the material code so that the output colors are exact
+	*/
+	UMaterialInterface* StencilPostProcessMaterial();
+
+	/**
+	 * Whether semantic classes are rendered from the custom stencil buffer,
+	 * in which case the color texture style is kept in the level
+	*/
+	const bool bStencilSemantics;
+
+	/** Whether PNG images should store semantic class ids as palette indices, instead of class colors */
+	const bool bPaletteImages;
 };
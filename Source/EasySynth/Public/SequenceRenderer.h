@@ -4,19 +4,29 @@
 
 #include "CoreMinimal.h"
 
+#include "ImageWriting/BackgroundFileWriter.h"
+#include "ImageWriting/VideoSequenceEncoder.h"
+#include "RenderReport.h"
+#include "RenderScheduler.h"
 #include "RendererTargets/ColorImageTarget.h"
 #include "RendererTargets/CustomPPMaterialTarget.h"
 #include "RendererTargets/DepthImageTarget.h"
+#include "RendererTargets/InstanceIdImageTarget.h"
+#include "RendererTargets/MultiPassTarget.h"
 #include "RendererTargets/NormalImageTarget.h"
 #include "RendererTargets/OpticalFlowImageTarget.h"
+#include "RendererTargets/PostProcessMaterialCache.h"
 #include "RendererTargets/RendererTarget.h"
 #include "RendererTargets/SemanticImageTarget.h"
+#include "SequencerWrapper.h"
 #include "TextureStyles/TextureStyleManager.h"
 
 #include "SequenceRenderer.generated.h"
 
 class ULevelSequence;
+class UMoviePipelineAntiAliasingSetting;
 class UMoviePipelineExecutorBase;
+class UMoviePipelineExecutorJob;
 class UMoviePipelinePrimaryConfig;
 class UMoviePipelineQueueSubsystem;
 
@@ -34,12 +44,22 @@ public:
 		NORMAL_IMAGE,
 		OPTICAL_FLOW_IMAGE,
 		SEMANTIC_IMAGE,
+		INSTANCE_ID_IMAGE,
 		CUSTOM_PP_MATERIAL,
 		COUNT
 	};
 
 	FRendererTargetOptions();
 
+	/**
+	 * Applies the shard and frame range switches of editor instances started as render workers,
+	 * parsed from the provided command line once at the start of the rendering
+	*/
+	void ApplyCommandLineSwitches(const TCHAR* CommandLine);
+
+	/** Default value for the DWA EXR compression level */
+	static const int DefaultExrCompressionLevelValue;
+
 	/** Select a rendering target */
 	void SetSelectedTarget(const int TargetType, const bool Selected) { SelectedTargets[TargetType] = Selected; }
 
@@ -61,6 +81,137 @@ public:
 	/** Return should camera poses be exported */
 	bool ExportCameraPoses() const { return bExportCameraPoses; }
 
+	/** Updates should camera poses also be written as binary files */
+	void SetBinaryCameraPoses(const bool bValue) { bBinaryCameraPoses = bValue; }
+
+	/** Returns should camera poses also be written as binary files */
+	bool BinaryCameraPoses() const { return bBinaryCameraPoses; }
+
+	/** Updates should targets be rendered as passes of a single job */
+	void SetSinglePassRendering(const bool bValue) { bSinglePassRendering = bValue; }
+
+	/** Returns should targets be rendered as passes of a single job */
+	bool SinglePassRendering() const { return bSinglePassRendering; }
+
+	/** Updates should targets rendered within a single job be packed into one multi-layer EXR image per frame */
+	void SetPackExrTargets(const bool bValue) { bPackExrTargets = bValue; }
+
+	/** Returns should targets rendered within a single job be packed into one multi-layer EXR image per frame */
+	bool PackExrTargets() const { return bPackExrTargets; }
+
+	/** Updates should all rig cameras be rendered within the same job */
+	void SetRenderAllCamerasInOneJob(const bool bValue) { bRenderAllCamerasInOneJob = bValue; }
+
+	/** Returns should all rig cameras be rendered within the same job */
+	bool RenderAllCamerasInOneJob() const { return bRenderAllCamerasInOneJob; }
+
+	/** Updates should semantic images be rendered using custom stencil values instead of material swapping */
+	void SetStencilSemantics(const bool bValue) { bStencilSemantics = bValue; }
+
+	/** Returns should semantic images be rendered using custom stencil values instead of material swapping */
+	bool StencilSemantics() const { return bStencilSemantics; }
+
+	/** Updates should depth images store metric depth values instead of values normalized by the depth range */
+	void SetMetricDepth(const bool bValue) { bMetricDepth = bValue; }
+
+	/** Returns should depth images store metric depth values instead of values normalized by the depth range */
+	bool MetricDepth() const { return bMetricDepth; }
+
+	/** Updates should the outputs be packed into tar archives once the rendering finishes */
+	void SetPackOutputArchives(const bool bValue) { bPackOutputArchives = bValue; }
+
+	/** Returns should the outputs be packed into tar archives once the rendering finishes */
+	bool PackOutputArchives() const { return bPackOutputArchives; }
+
+	/** Updates should color images be encoded into one video per camera once the rendering finishes */
+	void SetColorVideoOutput(const bool bValue) { bColorVideoOutput = bValue; }
+
+	/** Returns should color images be encoded into one video per camera once the rendering finishes */
+	bool ColorVideoOutput() const { return bColorVideoOutput; }
+
+	/** Updates should semantic png images be written as palette-indexed images of semantic class colors */
+	void SetPaletteSemantics(const bool bValue) { bPaletteSemantics = bValue; }
+
+	/** Returns should semantic png images be written as palette-indexed images of semantic class colors */
+	bool PaletteSemantics() const { return bPaletteSemantics; }
+
+	/** Updates should optical flow images be converted into offsets with occlusion masks once the rendering finishes */
+	void SetProcessOpticalFlow(const bool bValue) { bProcessOpticalFlow = bValue; }
+
+	/** Returns should optical flow images be converted into offsets with occlusion masks once the rendering finishes */
+	bool ProcessOpticalFlow() const { return bProcessOpticalFlow; }
+
+	/** Selects the shard of the rendering work handled by this editor instance */
+	void SetShard(const int Index, const int Count) { ShardIndexValue = Index; ShardCountValue = Count; }
+
+	/** ShardIndexValue getter */
+	int ShardIndex() const { return ShardIndexValue; }
+
+	/** ShardCountValue getter */
+	int ShardCount() const { return ShardCountValue; }
+
+	/** Checks if the selected shard is valid */
+	bool ShardValid() const { return ShardCountValue > 0 && ShardIndexValue >= 0 && ShardIndexValue < ShardCountValue; }
+
+	/** Checks if the work item with the provided id belongs to the selected shard */
+	bool InShard(const int WorkItemId) const { return WorkItemId % ShardCountValue == ShardIndexValue; }
+
+	/** Checks if this instance is responsible for writing outputs shared by all shards */
+	bool IsPrimaryShard() const { return ShardIndexValue == 0; }
+
+	/** Selects the range of frames to be rendered, the end frame is exclusive */
+	void SetFrameRange(const int StartFrame, const int EndFrame)
+	{
+		bCustomFrameRange = true;
+		StartFrameValue = StartFrame;
+		EndFrameValue = EndFrame;
+	}
+
+	/** Returns should only the selected range of frames be rendered */
+	bool CustomFrameRange() const { return bCustomFrameRange; }
+
+	/** StartFrameValue getter */
+	int StartFrame() const { return StartFrameValue; }
+
+	/** EndFrameValue getter */
+	int EndFrame() const { return EndFrameValue; }
+
+	/** Updates should frames already written to the output directory be skipped */
+	void SetResumeRendering(const bool bValue) { bResumeRendering = bValue; }
+
+	/** Returns should frames already written to the output directory be skipped */
+	bool ResumeRendering() const { return bResumeRendering; }
+
+	/** FrameShardCountValue setter */
+	void SetFrameShardCount(const int FrameShardCount) { FrameShardCountValue = FrameShardCount; }
+
+	/** FrameShardCountValue getter */
+	int FrameShardCount() const { return FrameShardCountValue; }
+
+	/** FrameStrideValue setter */
+	void SetFrameStride(const int FrameStride) { FrameStrideValue = FrameStride; }
+
+	/** FrameStrideValue getter */
+	int FrameStride() const { return FrameStrideValue; }
+
+	/** KeyframeDistanceValue setter */
+	void SetKeyframeDistance(const float KeyframeDistance) { KeyframeDistanceValue = KeyframeDistance; }
+
+	/** KeyframeDistanceValue getter */
+	float KeyframeDistance() const { return KeyframeDistanceValue; }
+
+	/** KeyframeAngleValue setter */
+	void SetKeyframeAngle(const float KeyframeAngle) { KeyframeAngleValue = KeyframeAngle; }
+
+	/** KeyframeAngleValue getter */
+	float KeyframeAngle() const { return KeyframeAngleValue; }
+
+	/** Returns should only a subset of the sequence frames be rendered and exported */
+	bool SubsampleFrames() const
+	{
+		return FrameStrideValue > 1 || KeyframeDistanceValue > 0.0f || KeyframeAngleValue > 0.0f;
+	}
+
 	/** DepthRangeMetersValue setter */
 	void SetDepthRangeMeters(const float DepthRangeMeters) { DepthRangeMetersValue = DepthRangeMeters; }
 
@@ -79,6 +230,72 @@ public:
 	/** OpticalFlowScaleValue setter */
 	float OpticalFlowScale() const { return OpticalFlowScaleValue; }
 
+	/** ExrCompressionLevelValue setter */
+	void SetExrCompressionLevel(const int ExrCompressionLevel) { ExrCompressionLevelValue = ExrCompressionLevel; }
+
+	/** ExrCompressionLevelValue getter */
+	int ExrCompressionLevel() const { return ExrCompressionLevelValue; }
+
+	/** ArchiveSizeMegabytesValue setter */
+	void SetArchiveSizeMegabytes(const int ArchiveSizeMegabytes) { ArchiveSizeMegabytesValue = ArchiveSizeMegabytes; }
+
+	/** ArchiveSizeMegabytesValue getter */
+	int ArchiveSizeMegabytes() const { return ArchiveSizeMegabytesValue; }
+
+	/** MaxInFlightImagesValue setter */
+	void SetMaxInFlightImages(const int MaxInFlightImages) { MaxInFlightImagesValue = MaxInFlightImages; }
+
+	/** MaxInFlightImagesValue getter */
+	int MaxInFlightImages() const { return MaxInFlightImagesValue; }
+
+	/** VideoCodecValue setter */
+	void SetVideoCodec(const EVideoCodec VideoCodec) { VideoCodecValue = VideoCodec; }
+
+	/** VideoCodecValue getter */
+	EVideoCodec VideoCodec() const { return VideoCodecValue; }
+
+	/** VideoEncoderPathValue setter */
+	void SetVideoEncoderPath(const FString& VideoEncoderPath) { VideoEncoderPathValue = VideoEncoderPath; }
+
+	/** VideoEncoderPathValue getter */
+	const FString& VideoEncoderPath() const { return VideoEncoderPathValue; }
+
+	/** SchedulerTypeValue setter */
+	void SetSchedulerType(const ERenderSchedulerType SchedulerType) { SchedulerTypeValue = SchedulerType; }
+
+	/** SchedulerTypeValue getter */
+	ERenderSchedulerType SchedulerType() const { return SchedulerTypeValue; }
+
+	/** StreamNameValue setter */
+	void SetStreamName(const FString& StreamName) { StreamNameValue = StreamName; }
+
+	/** StreamNameValue getter */
+	const FString& StreamName() const { return StreamNameValue; }
+
+	/** StreamSlotCountValue setter */
+	void SetStreamSlotCount(const int StreamSlotCount) { StreamSlotCountValue = StreamSlotCount; }
+
+	/** StreamSlotCountValue getter */
+	int StreamSlotCount() const { return StreamSlotCountValue; }
+
+	/** StreamSlotSizeMegabytesValue setter */
+	void SetStreamSlotSizeMegabytes(const int StreamSlotSizeMegabytes) { StreamSlotSizeMegabytesValue = StreamSlotSizeMegabytes; }
+
+	/** StreamSlotSizeMegabytesValue getter */
+	int StreamSlotSizeMegabytes() const { return StreamSlotSizeMegabytesValue; }
+
+	/** PyramidLevelsValue setter */
+	void SetPyramidLevels(const int PyramidLevels) { PyramidLevelsValue = PyramidLevels; }
+
+	/** PyramidLevelsValue getter */
+	int PyramidLevels() const { return PyramidLevelsValue; }
+
+	/** PreloadFramesValue setter */
+	void SetPreloadFrames(const int PreloadFrames) { PreloadFramesValue = PreloadFrames; }
+
+	/** PreloadFramesValue getter */
+	int PreloadFrames() const { return PreloadFramesValue; }
+
 	/** Populate provided queue with selected renderer targets */
 	void GetSelectedTargets(
 		UTextureStyleManager* TextureStyleManager,
@@ -88,6 +305,13 @@ private:
 	/** Get the renderer target object from the target type id */
 	TSharedPtr<FRendererTarget> RendererTarget(const int TargetType, UTextureStyleManager* TextureStyleManager) const;
 
+	/**
+	 * Checks whether the engine EXR output, which writes separate EXR files of jobs rendering multiple passes,
+	 * writes the target images the same way as the plugin one, which requires no image pyramid levels,
+	 * all of the rendered channels and the default compression
+	*/
+	bool EngineExrOutputMatches(const FRendererTarget& Target) const;
+
 	/** Is the default color image rendering requested */
 	TArray<bool> SelectedTargets;
 
@@ -97,6 +321,113 @@ private:
 	/** Whether to export camera poses */
 	bool bExportCameraPoses;
 
+	/** Whether to also write camera poses as .npy files, which can be loaded without parsing */
+	bool bBinaryCameraPoses;
+
+	/**
+	 * Whether targets that share the texture style and the output format
+	 * should be rendered as post process passes of a single job, instead of one job per target
+	*/
+	bool bSinglePassRendering;
+
+	/**
+	 * Whether targets rendered as passes of a single job into the EXR format should be written
+	 * as named layers of one image per frame, instead of one image per target
+	*/
+	bool bPackExrTargets;
+
+	/**
+	 * Whether all rig cameras should be rendered as cameras of the same job,
+	 * instead of re-posing the first rig camera and rendering the sequence once per camera
+	*/
+	bool bRenderAllCamerasInOneJob;
+
+	/**
+	 * Whether semantic class indices should be written into the custom stencil buffer
+	 * and resolved to class colors by a post process material, instead of swapping mesh materials
+	*/
+	bool bStencilSemantics;
+
+	/**
+	 * Whether depth images should store the linear depth in meters,
+	 * instead of the depth normalized by the depth range, which requires the EXR output format
+	*/
+	bool bMetricDepth;
+
+	/**
+	 * Whether output files should be moved into large tar archives with an index once the rendering finishes,
+	 * instead of being kept as separate files
+	*/
+	bool bPackOutputArchives;
+
+	/**
+	 * Whether color images should be rendered as jpeg images and encoded into one video per camera
+	 * once the rendering finishes, instead of being kept as separate images
+	*/
+	bool bColorVideoOutput;
+
+	/**
+	 * Whether semantic png images should store semantic class ids as 8-bit palette indices,
+	 * instead of class colors, which is much cheaper to compress and read while the colors stay exact
+	*/
+	bool bPaletteSemantics;
+
+	/**
+	 * Whether exr optical flow images should be converted into raw pixel offsets together with occlusion
+	 * and consistency masks once the rendering finishes, which requires exr depth images
+	*/
+	bool bProcessOpticalFlow;
+
+	/**
+	 * Index of the shard rendered by this editor instance
+	 * Rendering work is split into camera and target work items, which are distributed
+	 * among shards in a round-robin manner, so that instances sharing the output directory
+	 * together produce the same output as a single instance
+	*/
+	int ShardIndexValue;
+
+	/** Total number of shards the rendering work is split into */
+	int ShardCountValue;
+
+	/**
+	 * Whether frames with complete output files of all target outputs should be skipped,
+	 * so that an interrupted rendering can be continued
+	*/
+	bool bResumeRendering;
+
+	/** Whether only the selected range of frames should be rendered, instead of the whole sequence */
+	bool bCustomFrameRange;
+
+	/** First rendered frame, in the sequence display rate */
+	int StartFrameValue;
+
+	/** Frame after the last rendered frame, in the sequence display rate */
+	int EndFrameValue;
+
+	/**
+	 * Number of contiguous frame sub-ranges each target is split into
+	 * Each sub-range is rendered as a separate job and represents a separate work item to be sharded
+	*/
+	int FrameShardCountValue;
+
+	/**
+	 * Only every FrameStrideValue-th frame, counted from the start of the sequence playback range, is rendered
+	 * Camera poses are only exported for the rendered frames, keeping the pose ids of the whole sequence
+	*/
+	int FrameStrideValue;
+
+	/**
+	 * If positive, frames are only rendered once the camera rig has moved by at least this many centimeters
+	 * since the previously rendered frame, or rotated by more than the KeyframeAngleValue
+	*/
+	float KeyframeDistanceValue;
+
+	/**
+	 * If positive, frames are only rendered once the camera rig has rotated by at least this many degrees
+	 * since the previously rendered frame, or moved by more than the KeyframeDistanceValue
+	*/
+	float KeyframeAngleValue;
+
 	/**
 	 * The clipping range when rendering the depth target
 	 * Larger values provide the longer range, but also the lower granularity
@@ -112,11 +443,228 @@ private:
 	*/
 	float OpticalFlowScaleValue;
 
+	/**
+	 * Compression level of targets using the lossy DWA EXR compression
+	 * Larger values produce smaller files, but also a larger compression error
+	*/
+	int ExrCompressionLevelValue;
+
+	/** Approximate size of a single output archive */
+	int ArchiveSizeMegabytesValue;
+
+	/**
+	 * Maximum number of rendered images waiting to be written to disk
+	 * Rendering is paused while the limit is reached, which bounds the memory used by images, zero disables the limit
+	*/
+	int MaxInFlightImagesValue;
+
+	/** Codec of the color videos */
+	EVideoCodec VideoCodecValue;
+
+	/** Path to the ffmpeg executable used to encode color videos */
+	FString VideoEncoderPathValue;
+
+	/** Order in which the camera and target work items are rendered */
+	ERenderSchedulerType SchedulerTypeValue;
+
+	/**
+	 * Name of the shared memory region rendered frames are published to, together with their camera poses
+	 * Frames are not published if empty
+	*/
+	FString StreamNameValue;
+
+	/** Number of frames kept inside the shared memory region, before the oldest frame gets overwritten */
+	int StreamSlotCountValue;
+
+	/** Size of a single frame slot of the shared memory region, which has to fit all passes of a rendered camera */
+	int StreamSlotSizeMegabytesValue;
+
+	/**
+	 * Number of image pyramid levels written for each rendered image, including the rendered resolution
+	 * Each following level halves the resolution of the previous one and is written to its own level directory
+	*/
+	int PyramidLevelsValue;
+
+	/**
+	 * Number of upcoming rendered frames whose camera poses are used to preload textures and streaming cells
+	 * Preloading is disabled if the value is not positive
+	*/
+	int PreloadFramesValue;
+
 	/** Default value for the depth range */
 	static const float DefaultDepthRangeMetersValue;
 
 	/** Default value for the optical flow scale */
 	static const float DefaultOpticalFlowScaleValue;
+
+	/** Default value for the output archive size */
+	static const int DefaultArchiveSizeMegabytesValue;
+
+	/** Default value for the maximum number of in-flight images */
+	static const int DefaultMaxInFlightImagesValue;
+
+	/** Default value for the video encoder path, looked up inside the system path */
+	static const FString DefaultVideoEncoderPathValue;
+
+	/** Default value for the number of shared memory frame slots */
+	static const int DefaultStreamSlotCountValue;
+
+	/** Default value for the shared memory frame slot size */
+	static const int DefaultStreamSlotSizeMegabytesValue;
+
+	/** Command line switch used to select the shard index */
+	static const TCHAR* ShardIndexSwitch;
+
+	/** Command line switch used to select the shard count */
+	static const TCHAR* ShardCountSwitch;
+
+	/** Command line switch used to select the first rendered frame */
+	static const TCHAR* StartFrameSwitch;
+
+	/** Command line switch used to select the frame after the last rendered frame */
+	static const TCHAR* EndFrameSwitch;
+
+	/** Command line switch used to select the frame shard count */
+	static const TCHAR* FrameShardCountSwitch;
+};
+
+
+/**
+ * Aspect ratio settings of a rig camera, changed to match the output resolution while preparing the sequence
+*/
+struct FCameraAspectRatioState
+{
+	/** Camera the settings belong to */
+	TWeakObjectPtr<UCameraComponent> Camera;
+
+	/** Aspect ratio of the camera */
+	float AspectRatio = 1.0f;
+
+	/** Whether the camera constrains its aspect ratio */
+	bool bConstrainAspectRatio = false;
+
+	/** Sensor height of the cine camera filmback, unused for other cameras */
+	float SensorHeight = 0.0f;
+
+	/** Sensor aspect ratio of the cine camera filmback, unused for other cameras */
+	float SensorAspectRatio = 0.0f;
+};
+
+
+/**
+ * Rendering state of a single level sequence inside the batch of rendered sequences
+*/
+USTRUCT()
+struct FSequenceRenderingState
+{
+	GENERATED_BODY()
+
+	/** Soft object path to the user-created level sequence */
+	FSoftObjectPath SequencePath;
+
+	/** Points to the user-created level sequence */
+	UPROPERTY()
+	ULevelSequence* Sequence = nullptr;
+
+	/** Output directory of the sequence */
+	FString OutputDirectory;
+
+	/** Opened sequence, shared by all targets and camera pose exports of the rendering */
+	FSequencerWrapper SequencerWrapper;
+
+	/** Points to the actor that serves as a camera source for the sequencer */
+	UPROPERTY()
+	AActor* CameraRigActor = nullptr;
+
+	/** Sequence binding of the CameraRigActor */
+	FGuid CameraRigBindingGuid;
+
+	/** Keeps all CameraRigActor's camera components during rendering to avoid getting them each time */
+	UPROPERTY()
+	TArray<UCameraComponent*> RigCameras;
+
+	/** Original name of the camera rig binding, renamed while all cameras are rendered in one job */
+	FString OriginalCameraRigBindingName;
+
+	/** Temporary bindings of rig cameras added to the sequence by the BindRigCameras */
+	TArray<FGuid> RigCameraBindings;
+
+	/** Keeps the original aspect ratio settings of rig cameras, so that they can be restored if the preparation fails */
+	TArray<FCameraAspectRatioState> OriginalCameraAspectRatios;
+
+	/** Keeps the original camera transform so it can be restored at the end */
+	FTransform OriginalCameraTransform;
+
+	/** Keeps the original camera field of view so it can be restored at the end */
+	double OriginalCameraFOV = 0.0;
+
+	/** First frame to be rendered */
+	int StartFrame = 0;
+
+	/** Frame after the last frame to be rendered */
+	int EndFrame = 0;
+
+	/** Frame sub-ranges of the current target that belong to the current shard */
+	TArray<TRange<int>> FrameRanges;
+
+	/** Frames selected by the frame subsampling in the increasing order, only used if frames are subsampled */
+	TArray<int> SelectedFrames;
+
+	/** Frames of the current target ranges written by the outputs in the increasing order, empty if all rendered frames are written */
+	TArray<int> OutputFrames;
+
+	/** Poses of each rig camera, one pose per frame, used by streamed frames and optical flow post-processing */
+	TArray<TArray<FTransform>> RigCameraPoses;
+
+	/** Sequence frame number of the first rig camera pose */
+	int FirstRigCameraPoseFrame = 0;
+};
+
+
+/**
+ * Progress of the rendering, broadcast periodically while targets are being rendered
+*/
+struct FRenderingProgress
+{
+	/** Name of the rendered camera, or all when all rig cameras are rendered in one job */
+	FString Camera;
+
+	/** Name of the rendered target */
+	FString Target;
+
+	/** Number of rendered frames of the current target, over all sequences and cameras */
+	int CompletedFrames = 0;
+
+	/** Number of frames of the current target, over all sequences and cameras */
+	int TotalFrames = 0;
+
+	/** Number of camera and target work items finished before the current one */
+	int CompletedWorkItems = 0;
+
+	/** Number of camera and target work items of the whole rendering */
+	int TotalWorkItems = 0;
+
+	/** Rendered frames per second of the current target */
+	double FramesPerSecond = 0.0;
+
+	/** Estimated time until the whole rendering finishes, negative while it can not be estimated */
+	double EtaSeconds = -1.0;
+
+	/** Number of rendered images waiting to be written */
+	int PendingImages = 0;
+};
+
+
+/**
+ * Step finalizing the written outputs, which only captures plain values, so that it can run outside of the game thread
+*/
+struct FOutputFinalizationStep
+{
+	/** Error reported if the step fails */
+	FString ErrorMessage;
+
+	/** Runs the step, returns false if it fails */
+	TFunction<bool()> Run;
 };
 
 
@@ -142,6 +690,19 @@ public:
 		const FIntPoint OutputImageResolution,
 		const FString& OutputDirectory);
 
+	/**
+	 * Runs rendering of multiple sequences, each into its own output directory,
+	 * jobs of all sequences are rendered from the same movie pipeline queue,
+	 * returns false if rendering could not start
+	 * Sequences are prepared in steps spread over editor ticks, reporting the preparation progress,
+	 * so failures found while preparing them are reported by the rendering finished event
+	*/
+	bool RenderSequences(
+		const TArray<FAssetData>& LevelSequenceAssets,
+		FRendererTargetOptions RenderingTargets,
+		const FIntPoint OutputImageResolution,
+		const TArray<FString>& OutputDirectories);
+
 	/** Checks if the rendering is currently in progress */
 	bool IsRendering() const { return bCurrentlyRendering; }
 
@@ -154,38 +715,176 @@ public:
 	/** Returns a reference to the event for others to bind */
 	FRenderingFinishedEvent& OnRenderingFinished() { return RenderingFinishedEvent; }
 
+	/** Delegate type used to broadcast the preparation progress, with the current step and the completed fraction */
+	DECLARE_EVENT_TwoParams(USequenceRenderer, FPreparationProgressEvent, const FString&, float);
+
+	/** Returns a reference to the event for others to bind */
+	FPreparationProgressEvent& OnPreparationProgress() { return PreparationProgressEvent; }
+
+	/** Delegate type used to broadcast the rendering progress */
+	DECLARE_EVENT_OneParam(USequenceRenderer, FRenderingProgressEvent, const FRenderingProgress&);
+
+	/** Returns a reference to the event for others to bind */
+	FRenderingProgressEvent& OnRenderingProgress() { return RenderingProgressEvent; }
+
+	/**
+	 * Returns the sub-range of sequence frames between the start and the end frame that belongs to the frame shard,
+	 * bounds only depend on the frame shard id, so that file names stay the same regardless of sharding
+	*/
+	static TRange<int> FrameShardRange(const int StartFrame, const int EndFrame, const int FrameShardId, const int FrameShardCount);
+
+	/**
+	 * Returns job frame ranges covering the selected frames inside the frame ranges, adding the covered frames to OutOutputFrames,
+	 * runs of selected frames one stride apart are joined if at most MaxDroppedFrames strided frames lie between them
+	*/
+	static TArray<TRange<int>> SelectedFrameRanges(
+		const TArray<TRange<int>>& FrameRanges,
+		const TArray<int>& SelectedFrames,
+		const int FrameStride,
+		const int MaxDroppedFrames,
+		TArray<int>& OutOutputFrames);
+
 private:
+	/** Finds the sequence rig and exports outputs shared by all targets */
+	bool PrepareSequenceState(
+		const FAssetData& LevelSequenceAssetData,
+		const FString& OutputDirectory,
+		FSequenceRenderingState& OutSequenceState);
+
+	/** Reverts the aspect ratio changes made to rig cameras by the PrepareSequenceState */
+	static void RestoreCameraAspectRatios(const FSequenceRenderingState& SequenceState);
+
+	/** Runs the next preparation step, and starts rendering the first camera once all of them are done */
+	void OnPreparationStep();
+
 	/** Movie rendering finished handle */
 	void OnExecutorFinished(UMoviePipelineExecutorBase* InPipelineExecutor, bool bSuccess);
 
-	/** Handles finding the next rig camera to be used for rendering all requested targets */
-	void FindNextCamera();
+	/** Binds rig cameras if all of them are rendered in one job and exports camera poses, before any camera is moved */
+	bool PrepareRigCameras();
+
+	/** Creates the camera and target work items of the rendering and orders them using the selected scheduler */
+	void ScheduleWorkItems();
+
+	/** Moves the first camera of each sequence rig into the place of the rig camera used for rendering */
+	void ActivateRigCamera(const int RigCameraId);
 
-	/** Handles finding the next target to be rendered by the current camera */
+	/** Handles finding the next work item and starting the rendering of its target */
 	void FindNextTarget();
 
+	/**
+	 * Periodically checks whether the world is ready, and once it is, waits for texture streaming
+	 * within the rest of the pause and starts the rendering
+	*/
+	void OnRendererPauseTimer();
+
+	/** Periodically broadcasts the rendering progress, also writing it to the log at a lower rate */
+	void OnRenderingProgressTimer();
+
+	/** Collects the progress of the current target and estimates the remaining rendering time */
+	FRenderingProgress CurrentProgress() const;
+
+	/** Checks whether shaders of materials swapped while preparing the target have been compiled */
+	bool IsWorldReadyForRendering() const;
+
+	/** Finds the range of frames to be rendered, in the sequence display rate */
+	bool FindRenderingFrameRange(FSequenceRenderingState& SequenceState);
+
+	/** Returns rig cameras of the sequence rendered by the current camera iteration */
+	TArray<UCameraComponent*> CurrentCameras(const FSequenceRenderingState& SequenceState) const;
+
+	/** Removes frames that all outputs of the current target have already written from the sequence frame ranges */
+	void RemoveWrittenFrames(FSequenceRenderingState& SequenceState);
+
+	/**
+	 * Restricts the sequence frame ranges to the frames selected by the frame subsampling,
+	 * joining runs of selected frames placed one frame stride apart if only a few frames lie between them,
+	 * in which case the frames between the runs are rendered but not written
+	*/
+	void RemoveUnselectedFrames(FSequenceRenderingState& SequenceState) const;
+
+	/** Returns the number of frames rendered from the frame range, taking the frame stride into account */
+	int RenderedFrameCount(const TRange<int>& FrameRange) const;
+
+	/** Returns the sequence frame of the camera pose with the id zero, the start of the sequence playback range */
+	static int FirstPoseFrame(const FSequenceRenderingState& SequenceState);
+
+	/** Collects the optical flow post-processing, color video encoding and archive packing selected by the renderer options */
+	TArray<FOutputFinalizationStep> OutputFinalizationSteps() const;
+
+	/**
+	 * Runs the output finalization steps on a separate thread once all targets are rendered,
+	 * and completes the rendering on the game thread after the last step
+	*/
+	void FinalizeOutputs();
+
+	/** Returns the step converting optical flow images of each sequence camera into offsets with occlusion and consistency masks */
+	TFunction<bool()> OpticalFlowProcessingStep(const FSequenceRenderingState& SequenceState) const;
+
+	/** Returns the step encoding color images of each sequence camera into a video */
+	TFunction<bool()> ColorVideoEncodingStep(const FSequenceRenderingState& SequenceState) const;
+
+	/** Binds each rig camera to the sequence, so that all of them can be rendered by the same job */
+	bool BindRigCameras(FSequenceRenderingState& SequenceState);
+
+	/** Reverts changes made to the sequence by the BindRigCameras */
+	void UnbindRigCameras(FSequenceRenderingState& SequenceState);
+
+	/** Creates post process materials of all selected targets before the first job starts */
+	bool WarmUpPostProcessMaterials();
+
+	/**
+	 * Requests shaders of target materials and of materials swapped in by texture styles of all selected targets,
+	 * so that the compilation happens once before the first job instead of stalling the first frames of each job
+	*/
+	void WarmUpShaders();
+
 	/** Runs the rendering of the currently selected target */
 	void StartRendering();
 
-	/** Clears the existing job queue and adds a fresh job */
+	/** Clears the existing job queue and adds fresh jobs of all sequences */
 	bool PrepareJobQueue(UMoviePipelineQueueSubsystem* MoviePipelineQueueSubsystem);
 
-	/** Finalizes rendering and broadcasts the event */
+	/** Returns the number of bytes inside the output directories of the current target job */
+	int64 CurrentTargetOutputSize() const;
+
+	/** Saves the timings of the rendering into the output directory of each sequence */
+	void SaveRenderReport(const bool bSuccess);
+
+	/** Finalizes rendering and broadcasts the event, once the outputs are finalized if the rendering succeeded */
 	void BroadcastRenderingFinished(const bool bSuccess);
 
+	/** Restores the level and the sequences after the outputs are finalized, and broadcasts the event */
+	void OnOutputsFinalized(const bool bSuccess, const double FinalizationSeconds);
+
 	/** Rendering finished event dispatcher */
 	FRenderingFinishedEvent RenderingFinishedEvent;
 
+	/** Preparation progress event dispatcher */
+	FPreparationProgressEvent PreparationProgressEvent;
+
+	/** Rendering progress event dispatcher */
+	FRenderingProgressEvent RenderingProgressEvent;
+
 	/** Default movie pipeline config file provided with the plugin content */
 	UPROPERTY()
 	UMoviePipelinePrimaryConfig* EasySynthMoviePipelineConfig;
 
-	/** Soft object path to the user-created level sequence */
-	FSoftObjectPath RenderingSequencePath;
-
-	/** Points to the user-created level sequence */
+	/** Rendering states of all sequences being rendered */
 	UPROPERTY()
-	ULevelSequence* RenderingSequence;
+	TArray<FSequenceRenderingState> RenderingSequences;
+
+	/** Sequences of the current rendering, prepared one per preparation step */
+	TArray<FAssetData> PreparingSequenceAssets;
+
+	/** Output directories of the sequences of the current rendering */
+	TArray<FString> PreparingOutputDirectories;
+
+	/** Id of the next preparation step, sequences are prepared first, followed by the warm-up steps */
+	int PreparationStepId;
+
+	/** Writes metadata files of the current rendering in the background */
+	FBackgroundFileWriter BackgroundFileWriter;
 
 	/** Keeps current rendering options */
 	FRendererTargetOptions RendererTargetOptions;
@@ -196,34 +895,46 @@ private:
 	/** Used to revert to this style after finishing the rendering */
 	ETextureStyle OriginalTextureStyle;
 
-	/** Points to the actor that serves as a camera source for the sequencer */
-	UPROPERTY()
-	AActor* CameraRigActor;
-
-	/** Keeps all CameraRigActor's camera components during rendering to avoid getting them each time */
-	UPROPERTY()
-	TArray<UCameraComponent*> RigCameras;
-
-	/** Keeps the original camera transform so it can be restored at the end */
-	FTransform OriginalCameraTransform;
-
-	/** Keeps the original camera field of view so it can be restored at the end */
-	double OriginalCameraFOV;
-
 	/** Keeps the currently selected rig camera */
 	int CurrentRigCameraId;
 
-	/** Queue of targets to be rendered */
-	TQueue<TSharedPtr<FRendererTarget>> TargetsQueue;
+	/** Camera and target work items of the rendering, in the rendering order */
+	TArray<FRenderWorkItem> WorkItems;
+
+	/** Index of the next work item to be rendered */
+	int NextWorkItemIndex;
 
 	/** Target currently being rendered */
 	TSharedPtr<FRendererTarget> CurrentTarget;
 
+	/** Post process materials of the current rendering, reused by targets of all cameras and sequences */
+	FPostProcessMaterialCache PostProcessMaterialCache;
+
+	/** Id of the last camera, target and frame range work item, used to select work items of the current shard */
+	int CurrentWorkItemId;
+
+	/** Number of camera and target work items of the whole rendering, used to estimate the remaining time */
+	int TotalWorkItems;
+
+	/** Number of camera and target work items started so far, including the skipped ones */
+	int StartedWorkItems;
+
+	/** Movie pipeline jobs of the current target */
+	UPROPERTY()
+	TArray<UMoviePipelineExecutorJob*> TargetJobs;
+
+	/** Number of frames rendered by each of the current target jobs, over all of their cameras */
+	TArray<int> TargetJobFrames;
+
 	/** Output image resolution */
 	FIntPoint OutputResolution;
 
-	/** Currently selected output directory */
-	FString RenderingDirectory;
+	/** File name format of the default movie pipeline config output setting */
+	FString DefaultFileNameFormat;
+
+	/** Anti-aliasing setting of the default movie pipeline config, restored for targets that require it */
+	UPROPERTY()
+	UMoviePipelineAntiAliasingSetting* DefaultAntiAliasingSetting;
 
 	/** Marks if rendering is currently in process */
 	bool bCurrentlyRendering;
@@ -231,6 +942,48 @@ private:
 	/** Handle for a timer needed to make a brief pause between targets */
 	FTimerHandle RendererPauseTimerHandle;
 
+	/** Time at which the pause before the current target started */
+	double RendererPauseStartTime;
+
+	/** Handle for a timer broadcasting the rendering progress */
+	FTimerHandle RenderingProgressTimerHandle;
+
+	/** Time at which the rendering progress was last written to the log */
+	double LastProgressLogTime;
+
+	/** Time at which the shaders of the current rendering were requested */
+	double ShaderWarmUpStartTime;
+
+	/** Duration of the shader warm-up of the current rendering */
+	double ShaderWarmUpSeconds;
+
+	/** Time at which the current rendering started */
+	double RenderingStartTime;
+
+	/** Time at which the movie pipeline of the current target started */
+	double TargetRenderStartTime;
+
+	/** Size of the current target output directories before its rendering */
+	int64 TargetOutputSizeBefore;
+
+	/** Timings of the current rendering, saved once it finishes */
+	FRenderReportContent RenderReport;
+
+	/** Interval between two checks of whether the world is ready for rendering */
+	static const float RendererPauseCheckIntervalSeconds;
+
+	/** Longest pause between targets, after which the rendering starts even if the world is not ready */
+	static const float RendererPauseMaxSeconds;
+
+	/** Interval between two rendering progress broadcasts */
+	static const float RenderingProgressIntervalSeconds;
+
+	/** Most frames rendered and dropped between two runs of subsampled frames to render them with one job */
+	static const int MaxDroppedFrameCount;
+
+	/** Interval between two rendering progress log lines, parsed by render farm schedulers */
+	static const double RenderingProgressLogIntervalSeconds;
+
 	/** Stores the latest error message */
 	FString ErrorMessage;
 };
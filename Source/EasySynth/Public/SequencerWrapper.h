@@ -5,8 +5,10 @@
 #include "CoreMinimal.h"
 
 class ISequencer;
+class UCameraComponent;
 class ULevelSequence;
 class UMovieScene;
+class UMovieScene3DTransformTrack;
 class UMovieSceneCameraCutSection;
 class UMovieSceneTrack;
 
@@ -15,49 +17,68 @@ class UMovieSceneTrack;
  * Class that loads the sequencer for the given level sequence asset,
  * checks the validity of all needed components and provides access to them.
  *
- * It should be used locally during an action that requires the sequencer,
- * as it only holds weak references to its contents.
+ * Cut sections, their cameras and their transform tracks are resolved once when the sequence is opened,
+ * so a single wrapper can be shared by everything that needs them during a rendering.
+ * It only holds weak references to its contents, so the level sequence has to be kept alive by its user.
 */
 class FSequencerWrapper
 {
 public:
-	/** Opens the requested sequence */
+	/** Opens the requested sequence and resolves its cut sections */
 	bool OpenSequence(ULevelSequence* LevelSequence);
 
 	/** Access the movie scene */
-	UMovieScene* GetMovieScene()
+	UMovieScene* GetMovieScene() const
 	{
 		check(MovieScene)
 		return MovieScene;
 	}
 
 	/** Access the camera cut track */
-	UMovieSceneTrack* GetCameraCutTrack()
+	UMovieSceneTrack* GetCameraCutTrack() const
 	{
 		check(CameraCutTrack)
 		return CameraCutTrack;
 	}
 
 	/** Access the movie scene cut sections */
-	TArray<UMovieSceneCameraCutSection*>& GetMovieSceneCutSections();
+	const TArray<UMovieSceneCameraCutSection*>& GetMovieSceneCutSections() const { return MovieSceneCutSections; }
 
-	/** Access the sequencer */
-	ISequencer* GetSequencer()
+	/** Access camera components of the cut sections, empty if any of them could not be resolved */
+	const TArray<UCameraComponent*>& GetCutSectionCameras() const { return CutSectionCameras; }
+
+	/** Access transform tracks of the cut section cameras, null for cut sections without one */
+	const TArray<UMovieScene3DTransformTrack*>& GetCutSectionTransformTracks() const { return CutSectionTransformTracks; }
+
+	/** Access the sequencer, only valid while the sequence editor stays open */
+	ISequencer* GetSequencer() const
 	{
 		check(WeakSequencer.IsValid())
 		return WeakSequencer.Pin().Get();
 	}
 
 private:
+	/** Collects the camera track cut sections */
+	void FindMovieSceneCutSections();
+
+	/** Collects camera components and transform tracks bound to the cut sections */
+	void FindCutSectionBindings();
+
 	/** Sequence movie scene */
-	UMovieScene* MovieScene;
+	UMovieScene* MovieScene = nullptr;
 
 	/** Sequence camera cut track */
-	UMovieSceneTrack* CameraCutTrack;
+	UMovieSceneTrack* CameraCutTrack = nullptr;
 
 	/** Camera track cut sections */
 	TArray<UMovieSceneCameraCutSection*> MovieSceneCutSections;
 
+	/** Camera components of the cut sections */
+	TArray<UCameraComponent*> CutSectionCameras;
+
+	/** Transform tracks of the cut section camera bindings */
+	TArray<UMovieScene3DTransformTrack*> CutSectionTransformTracks;
+
 	/** Level sequence editor */
 	TWeakPtr<ISequencer> WeakSequencer;
 };
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 
+class AActor;
+class FBackgroundFileWriter;
 class UTextureMappingAsset;
 class UTextureStyleManager;
 
@@ -20,6 +22,43 @@ public:
 	/** Handles importing semantic classes from a CSV file */
 	FReply OnImportSemanticClassesClicked(UTextureStyleManager* TextureStyleManager);
 
-	/** Handles exporting semantic classes into a CSV file */
-	bool ExportSemanticClasses(const FString& OutputDir, UTextureMappingAsset* TextureMappingAsset);
+	/** Handles importing actor class rules from a CSV file selected through the file dialog */
+	FReply OnImportActorClassesClicked(UTextureStyleManager* TextureStyleManager);
+
+	/** Handles exporting actor class bindings into a CSV file selected through the file dialog */
+	FReply OnExportActorClassesClicked(UTextureStyleManager* TextureStyleManager);
+
+	/**
+	 * Imports actor class rules from the CSV file and applies them in a single batch,
+	 * each line contains an actor GUID or an actor label or path wildcard pattern, followed by the class name
+	 * The optional first line can contain the column names
+	*/
+	bool ImportActorClasses(const FString& FilePath, UTextureStyleManager* TextureStyleManager);
+
+	/** Exports bindings of actor GUIDs to semantic class names into the CSV file, in the format accepted by the import */
+	bool ExportActorClasses(const FString& FilePath, UTextureMappingAsset* TextureMappingAsset);
+
+	/** Handles exporting semantic classes into a CSV file, written in the background if the writer is provided */
+	bool ExportSemanticClasses(
+		const FString& OutputDir,
+		UTextureMappingAsset* TextureMappingAsset,
+		FBackgroundFileWriter* FileWriter = nullptr);
+
+	/**
+	 * Handles exporting the instance id table into a CSV file,
+	 * the instance id of each actor is its index inside the array increased by one
+	 * The file is written in the background if the writer is provided
+	*/
+	bool ExportInstanceIds(
+		const FString& OutputDir,
+		UTextureMappingAsset* TextureMappingAsset,
+		const TArray<AActor*>& InstanceActors,
+		FBackgroundFileWriter* FileWriter = nullptr);
+
+private:
+	/** Displays the file dialog for selecting a CSV file, returns false if no file was selected */
+	static bool SelectCsvFile(const FString& Title, const bool bSave, FString& OutFilePath);
+
+	/** Column names written into the first line of actor class CSV files */
+	static const TCHAR* ActorClassesHeader;
 };
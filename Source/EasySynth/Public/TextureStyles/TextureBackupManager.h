@@ -11,45 +11,39 @@ class UMaterialInstanceConstant;
 class UMaterialInterface;
 
 
-/** Structure wrapping TArray of static mesh component materials */
+/** Structure representing the original material of a single component material slot */
 USTRUCT()
-struct FOriginalComponentDescriptor
+struct FOriginalMaterialRecord
 {
 	GENERATED_USTRUCT_BODY()
 
-	/** The array of material interfaces */
+	/** The component owning the material slot */
 	UPROPERTY()
-	TArray<UMaterialInterface*> MaterialInterfaces;
+	UPrimitiveComponent* Component = nullptr;
 
-	/** Wrap TArray Add method */
-	void Add(UMaterialInterface* MaterialInterface) { MaterialInterfaces.Add(MaterialInterface); }
-
-	/** Wrap TArray Num method */
-	int Num() const { return MaterialInterfaces.Num(); }
+	/** Index of the material slot inside the component */
+	UPROPERTY()
+	int Slot = 0;
 
-	/** Wrap TArray [] operator */
-	UMaterialInterface* operator[](int i) { return MaterialInterfaces[i]; }
+	/** The original material of the slot */
+	UPROPERTY()
+	UMaterialInterface* Material = nullptr;
 };
 
 
-/** Structure wrapping TMap of static mesh components to their original materials */
+/** Structure representing the range of material records that belong to a single actor */
 USTRUCT()
-struct FOriginalActorDescriptor
+struct FOriginalActorRange
 {
 	GENERATED_USTRUCT_BODY()
 
-	/** The map of component descriptors */
+	/** Index of the first actor record */
 	UPROPERTY()
-	TMap<UPrimitiveComponent*, FOriginalComponentDescriptor> CompDescriptors;
+	int First = 0;
 
-	/** Wrap TMap Add method */
-	void Add(UPrimitiveComponent* Component) { CompDescriptors.Add(Component); }
-
-	/** Wrap TMap Contains method */
-	bool Contains(UPrimitiveComponent* Component) const { return CompDescriptors.Contains(Component); }
-
-	/** Wrap TMap [] operator */
-	FOriginalComponentDescriptor& operator[](UPrimitiveComponent* Component) { return CompDescriptors[Component]; }
+	/** Number of actor records, records of the same component are stored next to each other */
+	UPROPERTY()
+	int Num = 0;
 };
 
 /**
@@ -74,6 +68,16 @@ public:
 		const bool bDoPaint,
 		UMaterialInstanceConstant* Material = nullptr);
 
+	/**
+	 * Paints many actors at once, each with its own material, restoring the original materials of actors with null ones
+	 * Original materials of actors that are not backed up yet are gathered in parallel,
+	 * after which the materials are swapped on the game thread
+	*/
+	void AddAndPaintActors(const TArray<AActor*>& Actors, const TArray<UMaterialInstanceConstant*>& Materials);
+
+	/** Paints all material slots of the component, whose actor has to be backed up already */
+	void PaintComponent(UPrimitiveComponent* PrimitiveComponent, UMaterialInterface* Material);
+
 	/** Checks whether the actor exists inside any of the caches */
 	bool ContainsActor(AActor* Actor);
 
@@ -95,14 +99,41 @@ private:
 		const bool bDoPaint,
 		UMaterialInstanceConstant* Material);
 
+	/**
+	 * Applies all materials of the component at once,
+	 * so that the render state is recreated once per component instead of once per material slot
+	*/
+	void SetComponentMaterials(UPrimitiveComponent* PrimitiveComponent, TArrayView<UMaterialInterface* const> Materials);
+
+	/**
+	 * Appends the original materials of all actor component slots to the records
+	 * Only reads the actor, so it can be called for different actors in parallel
+	*/
+	static void GatherOriginalMaterials(AActor* Actor, TArray<FOriginalMaterialRecord>& OutRecords);
+
+	/** Removes the actor range, releasing its records once most of the records are no longer used */
+	void RemoveActorRange(AActor* Actor);
+
+	/** Moves the records of the backed up actors next to each other, dropping the released ones */
+	void CompactMaterialRecords();
+
 	/**
 	 * Storage of the original actor materials while semantics are displayed
-	 * Mimics the behavior of the structure defined as
-	 * TMap<AActor*, TMap<UPrimitiveComponent*, TArray<UMaterialInterface*>>>
-	 * which throws the UE specific compile error "Nested containers are not supported."
+	 * Records of all actors are kept inside a single array instead of separate per actor and per component
+	 * containers, so that backing up and restoring many actors does not allocate memory for each of them
 	*/
 	UPROPERTY()
-	TMap<AActor*, FOriginalActorDescriptor> OriginalActorDescriptors;
+	TArray<FOriginalMaterialRecord> OriginalMaterialRecords;
+
+	/** Ranges of the original material records of each backed up actor */
+	UPROPERTY()
+	TMap<AActor*, FOriginalActorRange> OriginalActorRanges;
+
+	/** Number of records no longer referenced by any of the actor ranges */
+	int ReleasedRecordCount = 0;
+
+	/** Minimum number of actors whose original materials are gathered by a single parallel task */
+	static const int MinActorsPerGatherTask;
 
 	/** Storage of the original landscape materials while semantics are displayed */
 	UPROPERTY()
@@ -23,12 +23,52 @@ struct FSemanticClass
 	UPROPERTY(EditAnywhere, Category = "Semantic Class Properties", meta = (IgnoreForMemberInitializationTest))
 	FColor Color;
 
-	/** Reference to the plain color material instance */
+	/** Reference to the saved plain color material instance, shared by all classes of the same color */
 	UPROPERTY(EditAnywhere, Category = "Semantic Class Material")
 	UMaterialInstanceConstant* PlainColorMaterialInstance;
 };
 
 
+/** Structure that represents semantic classes of the instances of a single instanced static mesh component */
+USTRUCT(BlueprintType)
+struct FComponentInstanceClassIds
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Name of the component inside its actor */
+	UPROPERTY(EditAnywhere, Category = "Instance Data")
+	FName ComponentName;
+
+	/**
+	 * Semantic class ids indexed by instance indices,
+	 * instances outside of the array or with the inherited class id use the class of their actor
+	*/
+	UPROPERTY(EditAnywhere, Category = "Instance Data")
+	TArray<uint16> ClassIds;
+};
+
+
+/** Structure wrapping the per-instance semantic classes of all instanced components of an actor */
+USTRUCT(BlueprintType)
+struct FActorInstanceClassIds
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Per-instance classes of the actor components */
+	UPROPERTY(EditAnywhere, Category = "Instance Data")
+	TArray<FComponentInstanceClassIds> Components;
+
+	/** Returns the classes of the component with the provided name or nullptr if it has none */
+	FComponentInstanceClassIds* FindComponent(const FName ComponentName)
+	{
+		return Components.FindByPredicate([ComponentName](const FComponentInstanceClassIds& Component)
+		{
+			return Component.ComponentName == ComponentName;
+		});
+	}
+};
+
+
 /** An asset containing semantic mapping for each actor */
 UCLASS()
 class EASYSYNTH_API UTextureMappingAsset : public UDataAsset
@@ -36,11 +76,26 @@ class EASYSYNTH_API UTextureMappingAsset : public UDataAsset
 	GENERATED_BODY()
 
 public:
-	/** Created semantic classes */
+	/** Created semantic classes, indexed by their class ids */
 	UPROPERTY(EditAnywhere, Category = "Semantic Classes")
-	TMap<FString, FSemanticClass> SemanticClasses;
+	TArray<FSemanticClass> SemanticClassTable;
 
-	/** Actor to semantic class name bindings */
+	/** Actor to semantic class id bindings */
 	UPROPERTY(EditAnywhere, Category = "Actor Data")
-	TMap<FGuid, FString> ActorClassPairs;
+	TMap<FGuid, uint16> ActorClassIds;
+
+	/** Actor to per-instance semantic class id bindings, only used by actors with instanced static mesh components */
+	UPROPERTY(EditAnywhere, Category = "Actor Data")
+	TMap<FGuid, FActorInstanceClassIds> ActorInstanceClassIds;
+
+	/** Returns the id of the class with the provided name or INDEX_NONE if it does not exist */
+	int32 FindClassId(const FString& ClassName) const;
+
+	/** Semantic classes keyed by their names, only loaded from assets saved by older plugin versions */
+	UPROPERTY()
+	TMap<FString, FSemanticClass> SemanticClasses_DEPRECATED;
+
+	/** Actor to semantic class name bindings, only loaded from assets saved by older plugin versions */
+	UPROPERTY()
+	TMap<FGuid, FString> ActorClassPairs_DEPRECATED;
 };
@@ -9,8 +9,14 @@
 #include "TextureStyleManager.generated.h"
 
 class AActor;
+class ULevel;
 class UMaterial;
+class UMaterialInterface;
+class UInstancedStaticMeshComponent;
+class UPrimitiveComponent;
+class UWorld;
 
+class FBackgroundFileWriter;
 struct FSemanticClass;
 class UTextureBackupManager;
 class UTextureMappingAsset;
@@ -22,6 +28,29 @@ enum class ETextureStyle : uint8
 {
 	COLOR = 0 UMETA(DisplayName = "COLOR"),
 	SEMANTIC = 1 UMETA(DisplayName = "SEMANTIC"),
+	INSTANCE_ID = 2 UMETA(DisplayName = "INSTANCE_ID"),
+};
+
+
+/** Original custom depth settings of a component, backed up while semantic stencil values are written */
+struct FOriginalStencilDescriptor
+{
+	/** Whether the component was rendered into the custom depth buffer */
+	bool bRenderCustomDepth;
+
+	/** The original custom stencil value */
+	int32 CustomDepthStencilValue;
+};
+
+
+/** Original per-instance custom data of a component, backed up while per-instance semantic classes are displayed */
+struct FOriginalInstanceCustomData
+{
+	/** The original number of custom data floats of each instance */
+	int32 NumCustomDataFloats;
+
+	/** The original custom data of all instances */
+	TArray<float> PerInstanceCustomData;
 };
 
 
@@ -64,15 +93,48 @@ public:
 	/** Returns names of existing semantic classes */
 	TArray<FString> SemanticClassNames() const;
 
-	/** Returns array of const pointers to semantic classes */
+	/** Returns array of const pointers to semantic classes, ordered by their class ids */
 	TArray<const FSemanticClass*> SemanticClasses() const;
 
-	/** Applies desired class to all selected actors */
+	/**
+	 * Applies desired class to all selected actors,
+	 * instanced static mesh components with selected instances only apply it to the selected instances
+	*/
 	void ApplySemanticClassToSelectedActors(const FString& ClassName);
 
+	/**
+	 * Applies semantic classes to many actors at once, each rule maps an actor GUID, or a wildcard pattern
+	 * matched against actor labels and paths, to a class name, returns the number of updated actor bindings
+	 * GUID rules also bind actors that are not loaded and take precedence over patterns,
+	 * while the last matching pattern wins, patterns are matched against loaded actors in parallel
+	 * Bindings are updated and saved as a single batch, changed actors are repainted together if needed
+	*/
+	int ApplyActorClassRules(const TArray<TPair<FString, FString>>& Rules);
+
+	/**
+	 * Sets the semantic class to the instances of the instanced static mesh component,
+	 * displayed through the per-instance custom data so that the instances keep being drawn together
+	*/
+	void SetSemanticClassToInstances(
+		UInstancedStaticMeshComponent* Component,
+		const TArray<int32>& InstanceIndices,
+		const uint16 ClassId);
+
 	/** Update mesh materials to show requested texture styles */
 	void CheckoutTextureStyle(const ETextureStyle NewTextureStyle);
 
+	/** Returns materials the texture style swaps into the level, creating them if needed, without applying the style */
+	TArray<UMaterialInterface*> TextureStyleMaterials(const ETextureStyle TextureStyle);
+
+	/**
+	 * Writes semantic class stencil values into the custom stencil buffer of all actor components,
+	 * the stencil value of a class is its id inside the class table increased by one
+	*/
+	bool ApplySemanticStencils();
+
+	/** Restores the original custom depth settings of components modified by ApplySemanticStencils */
+	void RestoreSemanticStencils();
+
 	/** Get the selected texture style */
 	ETextureStyle SelectedTextureStyle() const { return CurrentTextureStyle; }
 
@@ -82,14 +144,38 @@ public:
 	/** Returns a reference to the event for others to bind */
 	FSemanticClassesUpdatedEvent& OnSemanticClassesUpdated() { return SemanticClassesUpdatedEvent; }
 
-	/** Export current semantic classes to a CSV file */
-	bool ExportSemanticClasses(const FString& OutputDir);
+	/** Export current semantic classes to a CSV file, written in the background if the writer is provided */
+	bool ExportSemanticClasses(const FString& OutputDir, FBackgroundFileWriter* FileWriter = nullptr);
+
+	/**
+	 * Assigns instance ids to actors and exports the id to actor and semantic class mapping to a CSV file,
+	 * written in the background if the writer is provided
+	*/
+	bool ExportInstanceIds(const FString& OutputDir, FBackgroundFileWriter* FileWriter = nullptr);
+
+	/** Export actor GUID to semantic class bindings to a CSV file, which can be imported as actor class rules */
+	bool ExportActorClasses(const FString& FilePath);
+
+	/** Immediately saves the texture mapping asset if it has changes waiting for the delayed save */
+	void FlushTextureMappingAssetSave();
+
+	/** Encodes the instance id bytes into the RGB channels, as values that 8-bit images store without the sRGB encoding */
+	static FLinearColor EncodeInstanceId(const uint32 Id);
+
+	/** Decodes the instance id from the RGB channels of an 8-bit instance id image */
+	static uint32 DecodeInstanceId(const FColor& Color) { return Color.R | (Color.G << 8) | (Color.B << 16); }
 
 private:
 	/** Load or create texture mapping asset on startup */
 	void LoadOrCreateTextureMappingAsset();
 
-	/** Save texture mapping asset modifications */
+	/**
+	 * Converts the name keyed semantic classes loaded from an asset saved by an older plugin version
+	 * into the class table, making sure the undefined class has the id zero
+	*/
+	void MigrateTextureMappingAsset();
+
+	/** Marks the texture mapping asset as modified and schedules a delayed save, restarting any pending one */
 	void SaveTextureMappingAsset();
 
 	/** Handles adding a new actor to the level */
@@ -98,23 +184,76 @@ private:
 	/** Handles removing actor references from the manager */
 	void OnLevelActorDeleted(AActor* Actor);
 
+	/** Handles level streaming adding or removing levels, invalidating the styled actors index */
+	void OnLevelsChanged(ULevel* Level, UWorld* World) { bStyledActorsIndexValid = false; }
+
+	/** Rebuilds the styled actors index and the class actors index if they are not valid anymore */
+	void UpdateStyledActorsIndex();
+
+	/** Returns actors whose materials are managed, rebuilding the index if it is not valid anymore */
+	TArray<AActor*> StyledActors();
+
+	/** Returns actors whose materials are managed and have the class with the provided id assigned */
+	TArray<AActor*> ClassActors(const uint16 ClassId);
+
+	/** Moves the actor inside the class actors index, must be called before its class binding is updated */
+	void IndexActorClass(AActor* Actor, const uint16 ClassId);
+
+	/** Checks if the actor has any components whose materials can be swapped */
+	static bool HasPrimitiveComponents(AActor* Actor);
+
 	/** Handles editor closing, making sure original mesh colors are selected */
 	void OnEditorClose();
 
 	/** Sets a semantic class to the actor */
 	void SetSemanticClassToActor(
 		AActor* Actor,
-		const FString& ClassName,
-		const bool bForceDisplaySemanticClass = false,
-		const bool bDelayAddingDescriptors = false);
+		const uint16 ClassId,
+		const bool bForceDisplaySemanticClass = false);
+
+	/**
+	 * Collects styled actors and the materials they display with the new texture style,
+	 * null materials mark actors whose original materials are restored
+	*/
+	void PlanTextureStyleCheckout(
+		const ETextureStyle NewTextureStyle,
+		TArray<AActor*>& OutActors,
+		TArray<UMaterialInstanceConstant*>& OutMaterials);
 
 	/** Set active actor texture style to original or semantic color */
 	void CheckoutActorTexture(AActor* Actor, const ETextureStyle NewTextureStyle);
 
-	/** Adds semantic classes to actors in the delay actor buffer after a delay */
+	/**
+	 * Assigns consecutive instance ids starting from one to actors sorted by their GUIDs,
+	 * so that the same level always produces the same ids, zero is left for pixels without actors
+	*/
+	TArray<AActor*> UpdateInstanceIds();
+
+	/** Writes the encoded actor instance id into the custom primitive data of its components */
+	void WriteInstanceIdPrimitiveData(AActor* Actor);
+
+	/** Restores the custom primitive data of components modified by WriteInstanceIdPrimitiveData */
+	void RestorePrimitiveData();
+
+	/** Creates the unlit material that displays the instance id stored inside the custom primitive data */
+	UMaterialInstanceConstant* GetInstanceIdMaterial();
+
+	/**
+	 * Writes class colors of the actor instances with per-instance classes into their custom data
+	 * and displays them using the instanced semantic material, the actor has to be painted already
+	*/
+	void PaintInstanceClasses(AActor* Actor);
+
+	/** Restores the per-instance custom data of components modified by PaintInstanceClasses */
+	void RestoreInstanceCustomData();
+
+	/** Creates the material that displays the semantic color stored inside the per-instance custom data */
+	UMaterialInstanceConstant* GetInstancedSemanticMaterial();
+
+	/** Adds the undefined semantic class to all actors in the delay actor buffer in a single batch */
 	void ProcessDelayActorBuffer();
 
-	/** Generates the semantic class material if needed and returns it */
+	/** Loads or generates and saves the semantic class material if needed and returns it */
 	UMaterialInstanceConstant* GetSemanticClassMaterial(FSemanticClass& SemanticClass);
 
 	/** Semantic classes updated event dispatcher */
@@ -124,7 +263,10 @@ private:
 	UPROPERTY()
 	UTextureMappingAsset* TextureMappingAsset;
 
-	/** Plain color material used for semantic mesh coloring */
+	/**
+	 * Plain color material used for semantic mesh coloring,
+	 * used directly as the saved semantic material instances need a persistent parent
+	*/
 	UPROPERTY()
 	UMaterial* PlainColorMaterial;
 
@@ -137,7 +279,8 @@ private:
 
 	/**
 	 * Buffer used to store actors that need to have the semantic class set with a delay
-	 * This is needed when immediately setting the undefined class to just spawned actor
+	 * This is needed when immediately setting the undefined class to just spawned actor,
+	 * and lets actors spawned together be processed as a single batch
 	*/
 	UPROPERTY()
 	TArray<AActor*> DelayActorBuffer;
@@ -145,6 +288,56 @@ private:
 	/** The handle for the timer that managers DelayActorBuffer */
 	FTimerHandle DelayActorTimerHandle;
 
+	/**
+	 * Index of the editor world actors that have primitive components,
+	 * kept updated using actor events so that style changes do not iterate the whole world
+	*/
+	TSet<TWeakObjectPtr<AActor>> StyledActorsIndex;
+
+	/** The world StyledActorsIndex was built for */
+	TWeakObjectPtr<UWorld> StyledActorsIndexWorld;
+
+	/**
+	 * Actors from StyledActorsIndex grouped by their semantic classes, indexed by class ids,
+	 * so that class edits only visit the actors of the edited class
+	*/
+	TArray<TSet<TWeakObjectPtr<AActor>>> ClassActorsIndex;
+
+	/** Marks if StyledActorsIndex and ClassActorsIndex are up to date */
+	bool bStyledActorsIndexValid;
+
+	/** Material instance used for all meshes while instance ids are displayed */
+	UPROPERTY()
+	UMaterialInstanceConstant* InstanceIdMaterial;
+
+	/** Instance ids assigned to actor GUIDs by the latest UpdateInstanceIds call */
+	TMap<FGuid, uint32> InstanceIds;
+
+	/** Original custom primitive data of components whose data is overwritten by instance ids */
+	TMap<TWeakObjectPtr<UPrimitiveComponent>, TArray<float>> OriginalPrimitiveData;
+
+	/** Material instance used for instanced static mesh components whose instances have their own classes */
+	UPROPERTY()
+	UMaterialInstanceConstant* InstancedSemanticMaterial;
+
+	/** Original per-instance custom data of components whose data is overwritten by instance class colors */
+	TMap<TWeakObjectPtr<UInstancedStaticMeshComponent>, FOriginalInstanceCustomData> OriginalInstanceCustomData;
+
+	/** Original custom depth settings of components whose stencil values are overwritten */
+	TMap<TWeakObjectPtr<UPrimitiveComponent>, FOriginalStencilDescriptor> OriginalStencilDescriptors;
+
+	/** The original custom depth mode, restored once semantic stencils are not needed anymore */
+	int32 OriginalCustomDepthMode;
+
+	/** Marks if semantic stencil values are currently written to components */
+	bool bSemanticStencilsApplied;
+
+	/** Marks if the texture mapping asset has changes that are not saved yet */
+	bool bTextureMappingAssetDirty;
+
+	/** The handle for the timer that saves the texture mapping asset after a delay */
+	FTimerHandle SaveTimerHandle;
+
 	/** Marks if events have already been bounded */
 	bool bEventsBound;
 
@@ -153,4 +346,25 @@ private:
 
 	/** The name of the Undefined semantic class */
 	static const FString UndefinedSemanticClassName;
+
+	/** The id of the Undefined semantic class, which is always the first class inside the class table */
+	static const uint16 UndefinedSemanticClassId;
+
+	/** Per-instance class id of instances that use the class of their actor */
+	static const uint16 InheritedSemanticClassId;
+
+	/** Number of per-instance custom data floats holding the instance class color, starting from the first one */
+	static const int32 InstanceClassColorDataSize;
+
+	/** Maximum instance id that can be encoded inside the RGB channels of 8-bit images */
+	static const uint32 MaxInstanceId;
+
+	/** Maximum number of semantic classes that can be represented by custom stencil values */
+	static const int MaxStencilSemanticClasses;
+
+	/** The r.CustomDepth mode that enables writing custom stencil values */
+	static const int32 CustomDepthWithStencilMode;
+
+	/** Time without texture mapping asset changes after which the asset is saved */
+	static const float SaveDelaySeconds;
 };
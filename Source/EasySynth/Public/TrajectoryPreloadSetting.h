@@ -0,0 +1,99 @@
+// Copyright (c) 2022 YDrive Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "MoviePipelineSetting.h"
+#include "WorldPartition/WorldPartitionStreamingSource.h"
+
+#include "TrajectoryPreloadSetting.generated.h"
+
+class UMoviePipeline;
+class UWorld;
+
+
+/**
+ * Camera whose upcoming poses are preloaded by the trajectory preload setting
+*/
+USTRUCT()
+struct FPreloadedCamera
+{
+	GENERATED_BODY()
+
+	/** Camera poses, one per frame starting at the first pose frame of the setting */
+	UPROPERTY()
+	TArray<FTransform> Poses;
+};
+
+
+/**
+ * Movie pipeline setting that preloads the content cameras are going to see in the upcoming frames
+ * Camera poses are known before the rendering starts, so on every world tick the poses of the next frames
+ * are added as texture streaming view locations and as world partition streaming sources,
+ * which gets textures and streaming cells loaded before the shot reaches them
+*/
+UCLASS()
+class UMoviePipelineTrajectoryPreloadSetting : public UMoviePipelineSetting, public IWorldPartitionStreamingSourceProvider
+{
+	GENERATED_BODY()
+
+public:
+#if WITH_EDITOR
+	FText GetDisplayText() const override
+	{
+		return NSLOCTEXT("EasySynth", "TrajectoryPreloadSettingDisplayName", "Camera Trajectory Preloading");
+	}
+#endif
+
+	bool IsValidOnShots() const override { return false; }
+	bool IsValidOnPrimary() const override { return true; }
+
+	/** Starts following the rendered frames of the pipeline */
+	void SetupForPipelineImpl(UMoviePipeline* InPipeline) override;
+
+	/** Stops following the rendered frames and removes the streaming sources */
+	void TeardownForPipelineImpl(UMoviePipeline* InPipeline) override;
+
+	/** Provides the upcoming camera poses to the world partition streaming */
+	bool GetStreamingSources(TArray<FWorldPartitionStreamingSource>& OutStreamingSources) const override;
+
+	/** Owner of the provided streaming sources */
+	UObject* GetStreamingSourceOwner() override { return this; }
+
+	/** Rendered cameras */
+	UPROPERTY()
+	TArray<FPreloadedCamera> Cameras;
+
+	/** Sequence frame number of the first camera pose */
+	UPROPERTY()
+	int32 FirstPoseFrame = 0;
+
+	/** Number of upcoming rendered frames whose camera poses are preloaded */
+	UPROPERTY()
+	int32 PreloadFrameCount = 0;
+
+	/** Number of sequence frames between two rendered frames, used if the rendered frames are not listed */
+	UPROPERTY()
+	int32 FrameStep = 1;
+
+	/** Sequence frame numbers selected for rendering in the increasing order, empty if all frames one step apart are rendered */
+	UPROPERTY()
+	TArray<int32> RenderedFrames;
+
+private:
+	/** Updates the upcoming camera poses before the pipeline world ticks, so that streaming sees them in the same frame */
+	void OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/** Pipeline whose rendered frames are followed */
+	TWeakObjectPtr<UMoviePipeline> Pipeline;
+
+	/** World the streaming sources are registered with */
+	TWeakObjectPtr<UWorld> PipelineWorld;
+
+	/** Handle of the world tick callback */
+	FDelegateHandle WorldTickStartHandle;
+
+	/** Camera poses of the upcoming frames, updated on every world tick */
+	TArray<FTransform> UpcomingPoses;
+};
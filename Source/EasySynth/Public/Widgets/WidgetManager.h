@@ -27,6 +27,9 @@ public:
 	/** Handles the UI tab creation when requested */
 	TSharedRef<SDockTab> OnSpawnPluginTab(const FSpawnTabArgs& SpawnTabArgs);
 
+	/** TextureStyleManager getter, so that other rendering entry points share the same texture style state */
+	UTextureStyleManager* GetTextureStyleManager() const { return TextureStyleManager; }
+
 private:
 	/**
 	 * Main plugin widget handlers
@@ -74,8 +77,8 @@ private:
 	/** Handles render images button click */
 	FReply OnRenderImagesClicked();
 
-	/** Renders the current sequence in the batch */
-	void RenderCurrentSequence();
+	/** Returns the output directory of the sequence, preserving its hierarchy inside the selected folder */
+	FString SequenceOutputDirectory(const FAssetData& Sequence) const;
 
 	/** Handles the semantic classes updated event */
 	void OnSemanticClassesUpdated();
@@ -83,6 +86,15 @@ private:
 	/** Handles the sequence renderer finished event */
 	void OnRenderingFinished(bool bSuccess);
 
+	/** Handles the sequence renderer preparation progress event */
+	void OnPreparationProgress(const FString& Step, float Progress);
+
+	/** Handles the sequence renderer progress event */
+	void OnRenderingProgress(const FRenderingProgress& Progress);
+
+	/** Returns the status of the rendering in progress, displayed below the render images button */
+	FText GetRenderingStatusText() const { return RenderingStatusText; }
+
 	/**
 	 * Local members
 	*/
@@ -93,6 +105,9 @@ private:
 	/** Save widget options states */
 	void SaveWidgetOptionStates();
 
+	/** Status of the rendering in progress, empty if the rendering is not running */
+	FText RenderingStatusText;
+
 	/** Interface that handles importing semantic classes from CSV */
 	FSemanticCsvInterface SemanticCsvInterface;
 
@@ -114,15 +129,15 @@ private:
 	/** FStrings output image format names referenced by the combo box */
 	TArray<TSharedPtr<FString>> OutputFormatNames;
 
+	/** FStrings output format names referenced by the color images combo box, which can also select the video */
+	TArray<TSharedPtr<FString>> ColorOutputFormatNames;
+
 	/** Currently selected sequences folder */
 	FString SelectedSequencesFolder;
 
 	/** Array of sequences to render in batch */
 	TArray<FAssetData> SequencesToRender;
 
-	/** Current sequence being rendered in batch */
-	int32 CurrentSequenceIndex;
-
 	/** Base output directory (before sequence subfolder) */
 	FString BaseOutputDirectory;
 
@@ -162,6 +177,9 @@ private:
 	/** The name of the EXR output format */
 	static const FString ExrFormatName;
 
+	/** The name of the video output format, only available for color images */
+	static const FString VideoFormatName;
+
 	/** Default output image resolution */
 	static const FIntPoint DefaultOutputImageResolution;
 };
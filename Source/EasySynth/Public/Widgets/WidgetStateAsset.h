@@ -27,6 +27,50 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
 	bool bCameraPosesSelected;
 
+	/** Whether camera poses should also be written as binary files */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bBinaryCameraPosesSelected;
+
+	/** Whether targets should be rendered as passes of a single job */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bSinglePassRenderingSelected;
+
+	/** Whether targets rendered in a single pass should be packed into one multi-layer exr image per frame */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bPackExrTargetsSelected;
+
+	/** Whether all rig cameras should be rendered within the same job */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bAllCamerasInOneJobSelected;
+
+	/** Whether frames written by a previous rendering should be skipped */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bResumeRenderingSelected;
+
+	/** Whether semantic images should be rendered using custom stencil values instead of material swapping */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bStencilSemanticsSelected;
+
+	/** Whether semantic png images should be written as palette-indexed images */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bPaletteSemanticsSelected;
+
+	/** Is writing metric depth values instead of range normalized ones selected */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bMetricDepthSelected;
+
+	/** Whether outputs should be packed into tar archives once the rendering finishes */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bPackOutputArchivesSelected;
+
+	/** Whether optical flow images should be post-processed into offsets and masks once the rendering finishes */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bProcessOpticalFlowSelected;
+
+	/** Whether color images should be encoded into videos */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bColorVideoOutputSelected;
+
 	/** Whether color images are selected */
 	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
 	bool bColorImagesSelected;
@@ -67,6 +111,14 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
 	int8 bSemanticImagesOutputFormat;
 
+	/** Whether instance id images are selected */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	bool bInstanceIdImagesSelected;
+
+	/** Output format for instance id images */
+	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
+	int8 bInstanceIdImagesOutputFormat;
+
 	/** Selected custom PP material asset */
 	UPROPERTY(EditAnywhere, Category = "Rendering Targets")
 	FSoftObjectPath CustomPPMaterialAssetPath;